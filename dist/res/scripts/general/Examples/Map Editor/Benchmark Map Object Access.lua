@@ -0,0 +1,88 @@
+-- Times various ways of accessing map objects and their properties from a
+-- script, best run on a large (UDMF) map
+-- Requires a map opened in the map editor
+-------------------------------------------------------------------------------
+
+-- Set to true to also time setting properties (note that this will modify the
+-- map, though all properties are set to their existing values)
+local benchmarkWrites = false
+
+-- Number of times to repeat each test
+local repeats = 5
+
+local map = App.MapEditor().map
+
+-- Runs [func] [repeats] times and logs the average time taken
+function Time(name, func)
+   local start = App.RunTime()
+   for _ = 1, repeats do
+      func()
+   end
+   App.LogMessage(string.format("%-40s %8.1fms", name, (App.RunTime() - start) / repeats))
+end
+
+App.LogMessage(string.format(
+   "Map %s: %d vertices, %d lines, %d sides, %d sectors, %d things",
+   map.name, #map.vertices, #map.linedefs, #map.sidedefs, #map.sectors, #map.things))
+
+-- Object access
+Time("Index loop (map.linedefs[i])", function()
+   for i = 1, #map.linedefs do
+      local line = map.linedefs[i]
+   end
+end)
+
+Time("Index loop (local list)", function()
+   local lines = map.linedefs
+   for i = 1, #lines do
+      local line = lines[i]
+   end
+end)
+
+Time("ipairs loop", function()
+   for _, line in ipairs(map.linedefs) do
+   end
+end)
+
+Time("pairs loop", function()
+   for _, line in pairs(map.linedefs) do
+   end
+end)
+
+-- Property reads
+Time("Get property (per object)", function()
+   local specials = {}
+   for i, line in ipairs(map.linedefs) do
+      specials[i] = line:IntProperty("special")
+   end
+end)
+
+Time("Get property (bulk)", function()
+   local specials = map.linedefs:IntProperties("special")
+end)
+
+Time("Get string property (per object)", function()
+   local textures = {}
+   for i, side in ipairs(map.sidedefs) do
+      textures[i] = side:StringProperty("texturemiddle")
+   end
+end)
+
+Time("Get string property (bulk)", function()
+   local textures = map.sidedefs:StringProperties("texturemiddle")
+end)
+
+-- Property writes
+if benchmarkWrites then
+   local lights = map.sectors:IntProperties("lightlevel")
+
+   Time("Set property (per object)", function()
+      for i, sector in ipairs(map.sectors) do
+         sector:SetIntProperty("lightlevel", lights[i])
+      end
+   end)
+
+   Time("Set property (bulk)", function()
+      map.sectors:SetIntProperties("lightlevel", lights)
+   end)
+end
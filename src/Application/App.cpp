@@ -59,6 +59,8 @@
 #include "UI/SBrush.h"
 #include "UI/WxUtils.h"
 #include "Utility/StringUtils.h"
+#include "Utility/TaskGraph.h"
+#include "Utility/ThreadPool.h"
 #include "Utility/Tokenizer.h"
 #include "thirdparty/dumb/dumb.h"
 #include <filesystem>
@@ -77,6 +79,7 @@ wxStopWatch     timer;
 int             temp_fail_count = 0;
 bool            init_ok         = false;
 bool            exiting         = false;
+bool            profile_startup = false;
 std::thread::id main_thread_id;
 
 // Version
@@ -336,6 +339,10 @@ vector<string> processCommandLine(vector<string>& args)
 			log::info("Debugging stuff enabled");
 		}
 
+		// -profile-startup: Log the time taken by each initialisation step
+		else if (strutil::equalCI(arg, "-profile-startup"))
+			profile_startup = true;
+
 		// Other (no dash), open as archive
 		else if (!strutil::startsWith(arg, '-'))
 			to_open.push_back(arg);
@@ -405,6 +412,15 @@ long app::runTimer()
 	return timer.Time();
 }
 
+// -----------------------------------------------------------------------------
+// Returns the shared worker thread pool
+// -----------------------------------------------------------------------------
+ThreadPool& app::threadPool()
+{
+	static ThreadPool pool;
+	return pool;
+}
+
 // -----------------------------------------------------------------------------
 // Returns true if the application is exiting
 // -----------------------------------------------------------------------------
@@ -462,81 +478,139 @@ bool app::init(vector<string>& args, double ui_scale)
 		return false;
 	}
 
+	// Set up the remaining initialisation steps.
+	// Anything that only reads resources/config can run on a worker thread,
+	// anything that touches the UI (or wx GDI objects) must run on the main one
+	TaskGraph startup;
+	auto      step = [](string_view msg, const std::function<void()>& func) {
+		return [msg = string{ msg }, func]() {
+			if (!msg.empty())
+				log::info(msg);
+			func();
+			return true;
+		};
+	};
+
 	// Init SActions
-	SAction::setBaseWxId(26000);
-	SAction::initActions();
+	startup.add(
+		"actions",
+		step(
+			"",
+			[]() {
+				SAction::setBaseWxId(26000);
+				SAction::initActions();
+			}),
+		{},
+		true);
 
 #ifdef USE_LUA
 	// Init lua
-	lua::init();
+	startup.add("lua", step("", lua::init), { "actions" }, true);
 #endif
 
-	// Init UI
-	ui::init(ui_scale);
-
-	// Show splash screen
-	ui::showSplash("Starting up...");
+	// Init UI and show splash screen
+	startup.add(
+		"ui",
+		step(
+			"",
+			[ui_scale]() {
+				ui::init(ui_scale);
+				ui::showSplash("Starting up...");
+			}),
+		{},
+		true);
 
 	// Init palettes
-	if (!palette_manager.init())
-	{
-		log::error("Failed to initialise palettes");
-		return false;
-	}
+	startup.add(
+		"palettes",
+		[]() {
+			if (!palette_manager.init())
+			{
+				log::error("Failed to initialise palettes");
+				return false;
+			}
+			return true;
+		},
+		{ "image_formats" });
 
 	// Init SImage formats
-	SIFormat::initFormats();
+	startup.add("image_formats", step("", SIFormat::initFormats));
 
-	// Init brushes
-	SBrush::initBrushes();
+	// Init brushes (loads brush images, so needs the image formats)
+	startup.add("brushes", step("", SBrush::initBrushes), { "ui", "image_formats" }, true);
 
 	// Load program icons
-	log::info("Loading icons");
-	icons::loadIcons();
+	startup.add("icons", step("Loading icons", icons::loadIcons), { "ui" }, true);
 
 	// Load program fonts
-	drawing::initFonts();
+	startup.add("fonts", step("", drawing::initFonts), { "ui" }, true);
 
 	// Load entry types
-	log::info("Loading entry types");
-	EntryType::loadEntryTypes();
+	startup.add("entry_types", step("Loading entry types", EntryType::loadEntryTypes));
 
 	// Load text languages
-	log::info("Loading text languages");
-	TextLanguage::loadLanguages();
-
-	// Init text stylesets
-	log::info("Loading text style sets");
-	StyleSet::loadResourceStyles();
-	StyleSet::loadCustomStyles();
+	startup.add("text_languages", step("Loading text languages", TextLanguage::loadLanguages));
+
+	// Init text stylesets (uses wxFont so has to be on the main thread)
+	startup.add(
+		"text_styles",
+		step(
+			"Loading text style sets",
+			[]() {
+				StyleSet::loadResourceStyles();
+				StyleSet::loadCustomStyles();
+			}),
+		{ "ui" },
+		true);
 
 	// Init colour configuration
-	log::info("Loading colour configuration");
-	colourconfig::init();
+	startup.add("colours", step("Loading colour configuration", []() { colourconfig::init(); }));
 
 	// Init nodebuilders
-	nodebuilders::init();
+	startup.add("nodebuilders", step("", nodebuilders::init));
 
 	// Init game executables
-	executables::init();
+	startup.add("executables", step("", executables::init));
 
 	// Init main editor
-	maineditor::init();
+	vector<string> editor_deps = { "actions",     "ui",          "palettes",       "image_formats", "brushes",
+								   "icons",       "fonts",       "entry_types",    "text_languages",
+								   "text_styles", "colours",     "nodebuilders",   "executables" };
+#ifdef USE_LUA
+	editor_deps.emplace_back("lua");
+#endif
+	startup.add("main_editor", step("", []() { maineditor::init(); }), editor_deps, true);
 
 	// Init base resource
-	log::info("Loading base resource");
-	archive_manager.initBaseResource();
-	log::info("Base resource loaded");
+	startup.add(
+		"base_resource",
+		step(
+			"Loading base resource",
+			[]() {
+				archive_manager.initBaseResource();
+				log::info("Base resource loaded");
+			}),
+		{ "main_editor" },
+		true);
 
 	// Init game configuration
-	log::info("Loading game configurations");
-	game::init();
+	startup.add("game_config", step("Loading game configurations", game::init), { "base_resource" }, true);
 
 #ifdef USE_LUA
 	// Init script manager
-	scriptmanager::init();
+	startup.add("script_manager", step("", scriptmanager::init), { "game_config" }, true);
 #endif
 
+	// Run initialisation
+	auto init_steps_ok = startup.run(threadPool());
+	if (profile_startup)
+	{
+		log::info("Startup profile:");
+		startup.logTimings();
+	}
+	if (!init_steps_ok)
+		return false;
+
 	// Show the main window
 	maineditor::windowWx()->Show(true);
 	wxGetApp().SetTopWindow(maineditor::windowWx());
@@ -691,6 +765,9 @@ void app::exit(bool save_config)
 	// Close DUMB
 	dumb_exit();
 
+	// Write any remaining log messages
+	log::close();
+
 	// Exit wx Application
 	wxGetApp().Exit();
 }
@@ -9,6 +9,7 @@ class Console;
 class PaletteManager;
 class Clipboard;
 class ResourceManager;
+class ThreadPool;
 
 namespace app
 {
@@ -20,6 +21,7 @@ namespace app
 	ArchiveManager&  archiveManager();
 	Clipboard&       clipboard();
 	ResourceManager& resources();
+	ThreadPool&      threadPool();
 
 	bool init(vector<string>& args, double ui_scale = 1.);
 	void saveConfigFile();
@@ -31,10 +31,13 @@
 // -----------------------------------------------------------------------------
 #include "Main.h"
 #include "Archive.h"
+#include "App.h"
+#include "ArchiveSearchIndex.h"
 #include "General/UndoRedo.h"
 #include "Utility/FileUtils.h"
 #include "Utility/Parser.h"
 #include "Utility/StringUtils.h"
+#include "Utility/ThreadPool.h"
 #include <filesystem>
 
 using namespace slade;
@@ -50,6 +53,14 @@ CVAR(Bool, backup_archives, true, CVar::Flag::Save)
 bool                  Archive::save_backup = true;
 vector<ArchiveFormat> Archive::formats_;
 
+namespace
+{
+// Number of searches (since the last change to the archive) before the search
+// index is built, so code that alternates searching with modifying entries
+// doesn't rebuild it every time
+constexpr unsigned SEARCH_INDEX_MIN_QUERIES = 2;
+} // namespace
+
 
 // -----------------------------------------------------------------------------
 //
@@ -349,6 +360,52 @@ void Archive::MapDesc::updateMapFormatHints() const
 }
 
 
+// -----------------------------------------------------------------------------
+//
+// Local Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// -----------------------------------------------------------------------------
+// Returns true if [entry] matches the type, name and namespace criteria in
+// [options]. [options.match_name] must already be uppercase
+// -----------------------------------------------------------------------------
+bool entryMatchesSearch(Archive& archive, ArchiveEntry* entry, const Archive::SearchOptions& options)
+{
+	// Check type
+	if (options.match_type)
+	{
+		if (entry->type() == EntryType::unknownType())
+		{
+			if (!options.match_type->isThisType(*entry))
+				return false;
+		}
+		else if (options.match_type != entry->type())
+			return false;
+	}
+
+	// Check name
+	if (!options.match_name.empty())
+	{
+		// Cut extension if ignoring
+		const auto check_name = options.ignore_ext ? entry->upperNameNoExt() : entry->upperName();
+		if (!strutil::matches(check_name, options.match_name))
+			return false;
+	}
+
+	// Check namespace
+	if (!options.match_namespace.empty())
+	{
+		if (!strutil::equalCI(archive.detectNamespace(entry), options.match_namespace))
+			return false;
+	}
+
+	return true;
+}
+} // namespace
+
+
 // -----------------------------------------------------------------------------
 //
 // Archive Class Functions
@@ -540,6 +597,10 @@ ArchiveEntry* Archive::entry(string_view name, bool cut_ext, ArchiveDir* dir) co
 	if (!dir)
 		dir = dir_root_.get(); // None given, use root
 
+	// Use the search index if possible
+	if (auto index = searchIndex())
+		return index->entry(name, cut_ext, *dir);
+
 	return dir->entry(name, cut_ext);
 }
 
@@ -1315,14 +1376,25 @@ bool Archive::revertEntry(ArchiveEntry* entry)
 }
 
 // -----------------------------------------------------------------------------
-// Returns the namespace of the entry at [index] within [dir]
+// Returns the namespace of the entry at [index] within [dir]. Namespaces are
+// directories by default, so this is the namespace of [dir] even if there is no
+// entry at [index] (eg. for an entry that is about to be added there)
 // -----------------------------------------------------------------------------
 string Archive::detectNamespace(unsigned index, ArchiveDir* dir)
 {
-	if (dir && index < dir->numEntries())
-		return detectNamespace(dir->entryAt(index));
+	// If the dir is the root dir, it's the global namespace
+	if (!dir || dir == dir_root_.get())
+		return "global";
+
+	// Get the *first* parent directory after root (ie <root>/namespace/)
+	while (dir && dir->parent() != dir_root_)
+		dir = dir->parent().get();
 
-	return "global";
+	// Namespace is the directory's name (in lowercase)
+	if (dir)
+		return strutil::lower(dir->name());
+	else
+		return "global"; // Error, just return global
 }
 
 // -----------------------------------------------------------------------------
@@ -1334,20 +1406,7 @@ string Archive::detectNamespace(ArchiveEntry* entry)
 	if (!checkEntry(entry))
 		return "global";
 
-	// If the entry is in the root dir, it's in the global namespace
-	if (entry->parentDir() == dir_root_.get())
-		return "global";
-
-	// Get the entry's *first* parent directory after root (ie <root>/namespace/)
-	auto dir = entry->parentDir();
-	while (dir && dir->parent() != dir_root_)
-		dir = dir->parent().get();
-
-	// Namespace is the directory's name (in lowercase)
-	if (dir)
-		return strutil::lower(dir->name());
-	else
-		return "global"; // Error, just return global
+	return Archive::detectNamespace(0, entry->parentDir());
 }
 
 // -----------------------------------------------------------------------------
@@ -1362,6 +1421,17 @@ ArchiveEntry* Archive::findFirst(SearchOptions& options)
 		dir = dir_root_.get();
 	strutil::upperIP(options.match_name); // Force case-insensitive
 
+	// Use the search index to get the entries to check, if possible
+	vector<ArchiveSearchIndex::Item> candidates;
+	if (auto index = searchIndex(); index && index->candidates(options, !options.ignore_ext, candidates))
+	{
+		for (const auto& item : candidates)
+			if (entryMatchesSearch(*this, item.entry, options))
+				return item.entry;
+
+		return nullptr;
+	}
+
 	// Begin search
 
 	// Search entries
@@ -1369,36 +1439,9 @@ ArchiveEntry* Archive::findFirst(SearchOptions& options)
 	{
 		const auto entry = dir->entryAt(a);
 
-		// Check type
-		if (options.match_type)
-		{
-			if (entry->type() == EntryType::unknownType())
-			{
-				if (!options.match_type->isThisType(*entry))
-					continue;
-			}
-			else if (options.match_type != entry->type())
-				continue;
-		}
-
-		// Check name
-		if (!options.match_name.empty())
-		{
-			// Cut extension if ignoring
-			const auto check_name = options.ignore_ext ? entry->upperNameNoExt() : entry->upperName();
-			if (!strutil::matches(check_name, options.match_name))
-				continue;
-		}
-
-		// Check namespace
-		if (!options.match_namespace.empty())
-		{
-			if (!strutil::equalCI(detectNamespace(entry), options.match_namespace))
-				continue;
-		}
-
-		// Entry passed all checks so far, so we found a match
-		return entry;
+		// Entry passed all checks, so we found a match
+		if (entryMatchesSearch(*this, entry, options))
+			return entry;
 	}
 
 	// Search subdirectories (if needed)
@@ -1432,6 +1475,22 @@ ArchiveEntry* Archive::findLast(SearchOptions& options)
 		dir = dir_root_.get();
 	strutil::upperIP(options.match_name); // Force case-insensitive
 
+	// Use the search index to get the entries to check, if possible
+	vector<ArchiveSearchIndex::Item> candidates;
+	if (auto index = searchIndex(); index && index->candidates(options, !options.ignore_ext, candidates))
+	{
+		// Sort so that the entry that would be found first (bottom-up) is first
+		std::sort(candidates.begin(), candidates.end(), [](const auto& left, const auto& right) {
+			return left.order_last > right.order_last;
+		});
+
+		for (const auto& item : candidates)
+			if (entryMatchesSearch(*this, item.entry, options))
+				return item.entry;
+
+		return nullptr;
+	}
+
 	// Begin search
 
 	// Search entries (bottom-up)
@@ -1439,36 +1498,9 @@ ArchiveEntry* Archive::findLast(SearchOptions& options)
 	{
 		const auto entry = dir->entryAt(a);
 
-		// Check type
-		if (options.match_type)
-		{
-			if (entry->type() == EntryType::unknownType())
-			{
-				if (!options.match_type->isThisType(*entry))
-					continue;
-			}
-			else if (options.match_type != entry->type())
-				continue;
-		}
-
-		// Check name
-		if (!options.match_name.empty())
-		{
-			// Cut extension if ignoring
-			const auto check_name = options.ignore_ext ? entry->upperNameNoExt() : entry->upperName();
-			if (!strutil::matches(check_name, options.match_name))
-				continue;
-		}
-
-		// Check namespace
-		if (!options.match_namespace.empty())
-		{
-			if (!strutil::equalCI(detectNamespace(entry), options.match_namespace))
-				continue;
-		}
-
-		// Entry passed all checks so far, so we found a match
-		return entry;
+		// Entry passed all checks, so we found a match
+		if (entryMatchesSearch(*this, entry, options))
+			return entry;
 	}
 
 	// Search subdirectories (if needed) (bottom-up)
@@ -1502,6 +1534,17 @@ vector<ArchiveEntry*> Archive::findAll(SearchOptions& options)
 	vector<ArchiveEntry*> ret;
 	strutil::upperIP(options.match_name); // Force case-insensitive
 
+	// Use the search index to get the entries to check, if possible
+	vector<ArchiveSearchIndex::Item> candidates;
+	if (auto index = searchIndex(); index && index->candidates(options, !options.ignore_ext, candidates))
+	{
+		for (const auto& item : candidates)
+			if (entryMatchesSearch(*this, item.entry, options))
+				ret.push_back(item.entry);
+
+		return ret;
+	}
+
 	// Begin search
 
 	// Search entries
@@ -1509,36 +1552,9 @@ vector<ArchiveEntry*> Archive::findAll(SearchOptions& options)
 	{
 		auto entry = dir->entryAt(a);
 
-		// Check type
-		if (options.match_type)
-		{
-			if (entry->type() == EntryType::unknownType())
-			{
-				if (!options.match_type->isThisType(*entry))
-					continue;
-			}
-			else if (options.match_type != entry->type())
-				continue;
-		}
-
-		// Check name
-		if (!options.match_name.empty())
-		{
-			// Cut extension if ignoring
-			const auto check_name = options.ignore_ext ? entry->upperNameNoExt() : entry->upperName();
-			if (!strutil::matches(check_name, options.match_name))
-				continue;
-		}
-
-		// Check namespace
-		if (!options.match_namespace.empty())
-		{
-			if (!strutil::equalCI(detectNamespace(entry), options.match_namespace))
-				continue;
-		}
-
-		// Entry passed all checks so far, so we found a match
-		ret.push_back(entry);
+		// Entry passed all checks, so we found a match
+		if (entryMatchesSearch(*this, entry, options))
+			ret.push_back(entry);
 	}
 
 	// Search subdirectories (if needed)
@@ -1595,6 +1611,110 @@ vector<ArchiveEntry*> Archive::findModifiedEntries(ArchiveDir* dir)
 	return ret;
 }
 
+// -----------------------------------------------------------------------------
+// Returns a list of groups of entries with identical data (ignoring folders and
+// empty entries).
+// Entries are grouped by size first, so only entries with the same size as
+// another are hashed (see ArchiveEntry::contentHash). Hashing is done on the
+// thread pool
+// -----------------------------------------------------------------------------
+vector<vector<ArchiveEntry*>> Archive::findDuplicateEntries()
+{
+	// Group entries by size
+	vector<ArchiveEntry*> entries;
+	putEntryTreeAsList(entries);
+	std::map<uint32_t, vector<ArchiveEntry*>> size_groups;
+	for (auto& entry : entries)
+	{
+		if (entry->size() == 0 || entry->type() == EntryType::folderType())
+			continue;
+
+		size_groups[entry->size()].push_back(entry);
+	}
+
+	// Get entries that need to be hashed
+	vector<ArchiveEntry*> to_hash;
+	for (auto& group : size_groups)
+		if (group.second.size() > 1)
+			to_hash.insert(to_hash.end(), group.second.begin(), group.second.end());
+
+	// Hash entries in batches, since entry data can only be loaded from the
+	// archive on this thread. Data is unloaded again after hashing if it wasn't
+	// already loaded, to limit memory usage on large archives
+	vector<uint64_t> hashes(to_hash.size());
+	vector<bool>     was_loaded(to_hash.size());
+	unsigned         start = 0;
+	while (start < to_hash.size())
+	{
+		// Load batch data
+		unsigned end        = start;
+		uint64_t batch_size = 0;
+		while (end < to_hash.size() && batch_size < 64 * 1024 * 1024)
+		{
+			auto entry      = to_hash[end];
+			was_loaded[end] = entry->isLoaded();
+			if (!entry->hasContentHash())
+				entry->data();
+			batch_size += entry->size();
+			++end;
+		}
+
+		// Hash
+		app::threadPool().parallelFor(
+			end - start, [&](size_t i) { hashes[start + i] = to_hash[start + i]->contentHash(false); }, 4);
+
+		// Unload
+		for (unsigned a = start; a < end; a++)
+			if (!was_loaded[a])
+				to_hash[a]->unloadData();
+
+		start = end;
+	}
+
+	// Group entries by size+hash
+	std::map<std::pair<uint32_t, uint64_t>, vector<ArchiveEntry*>> hash_groups;
+	for (unsigned a = 0; a < to_hash.size(); a++)
+	{
+		// Ignore any entries that failed to load
+		if (to_hash[a]->hasContentHash())
+			hash_groups[{ to_hash[a]->size(), hashes[a] }].push_back(to_hash[a]);
+	}
+
+	vector<vector<ArchiveEntry*>> duplicates;
+	for (auto& group : hash_groups)
+		if (group.second.size() > 1)
+			duplicates.push_back(std::move(group.second));
+
+	return duplicates;
+}
+
+// -----------------------------------------------------------------------------
+// Returns the search index for this archive (see ArchiveSearchIndex), building
+// it if needed. Returns null if the archive has changed since the index was
+// last built and it hasn't been searched enough times since to rebuild it yet
+// -----------------------------------------------------------------------------
+shared_ptr<const ArchiveSearchIndex> Archive::searchIndex() const
+{
+	std::lock_guard lock(search_index_mutex_);
+
+	if (!search_index_ && ++search_index_queries_ >= SEARCH_INDEX_MIN_QUERIES)
+		search_index_ = std::make_shared<ArchiveSearchIndex>(*dir_root_);
+
+	return search_index_;
+}
+
+// -----------------------------------------------------------------------------
+// Discards the search index. This is called whenever an entry is added,
+// removed, moved, renamed or changes type
+// -----------------------------------------------------------------------------
+void Archive::invalidateSearchIndex() const
+{
+	std::lock_guard lock(search_index_mutex_);
+
+	search_index_.reset();
+	search_index_queries_ = 0;
+}
+
 // -----------------------------------------------------------------------------
 // Blocks or unblocks signals for archive/entry modifications
 // -----------------------------------------------------------------------------
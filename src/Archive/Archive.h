@@ -3,9 +3,12 @@
 #include "ArchiveDir.h"
 #include "ArchiveEntry.h"
 #include "General/Defs.h"
+#include <mutex>
 
 namespace slade
 {
+class ArchiveSearchIndex;
+
 struct ArchiveFormat
 {
 	string             id;
@@ -160,6 +163,11 @@ public:
 	virtual ArchiveEntry*         findLast(SearchOptions& options);
 	virtual vector<ArchiveEntry*> findAll(SearchOptions& options);
 	virtual vector<ArchiveEntry*> findModifiedEntries(ArchiveDir* dir = nullptr);
+	vector<vector<ArchiveEntry*>> findDuplicateEntries();
+
+	// Search index
+	shared_ptr<const ArchiveSearchIndex> searchIndex() const;
+	void                                 invalidateSearchIndex() const;
 
 	// Signals
 	struct Signals
@@ -195,6 +203,11 @@ private:
 	shared_ptr<ArchiveDir> dir_root_;
 	Signals                signals_;
 
+	// Search index (see searchIndex)
+	mutable shared_ptr<const ArchiveSearchIndex> search_index_;
+	mutable unsigned                             search_index_queries_ = 0;
+	mutable std::mutex                           search_index_mutex_;
+
 	static vector<ArchiveFormat> formats_;
 };
 
@@ -117,6 +117,9 @@ void ArchiveDir::setArchive(Archive* archive)
 	archive_ = archive;
 	for (const auto& subdir : subdirs_)
 		subdir->setArchive(archive);
+
+	if (archive_)
+		archive_->invalidateSearchIndex();
 }
 
 // -----------------------------------------------------------------------------
@@ -130,33 +133,34 @@ int ArchiveDir::entryIndex(ArchiveEntry* entry, size_t startfrom) const
 		return -1;
 
 	// Search for it
-	const size_t size = entries_.size();
-	if (entry->index_guess_ < startfrom || entry->index_guess_ >= size)
+	const size_t size  = entries_.size();
+	const size_t guess = entry->index_guess_.load(std::memory_order_relaxed);
+	if (guess < startfrom || guess >= size)
 	{
 		for (auto a = startfrom; a < size; a++)
 		{
 			if (entries_[a].get() == entry)
 			{
-				entry->index_guess_ = a;
+				entry->index_guess_.store(a, std::memory_order_relaxed);
 				return static_cast<int>(a);
 			}
 		}
 	}
 	else
 	{
-		for (auto a = entry->index_guess_; a < size; a++)
+		for (auto a = guess; a < size; a++)
 		{
 			if (entries_[a].get() == entry)
 			{
-				entry->index_guess_ = a;
+				entry->index_guess_.store(a, std::memory_order_relaxed);
 				return static_cast<int>(a);
 			}
 		}
-		for (auto a = startfrom; a < entry->index_guess_; a++)
+		for (auto a = startfrom; a < guess; a++)
 		{
 			if (entries_[a].get() == entry)
 			{
-				entry->index_guess_ = a;
+				entry->index_guess_.store(a, std::memory_order_relaxed);
 				return static_cast<int>(a);
 			}
 		}
@@ -314,6 +318,9 @@ bool ArchiveDir::addEntry(shared_ptr<ArchiveEntry> entry, unsigned index)
 	if (!allow_duplicate_names_)
 		ensureUniqueName(entry.get());
 
+	if (archive_)
+		archive_->invalidateSearchIndex();
+
 	return true;
 }
 
@@ -333,6 +340,9 @@ bool ArchiveDir::removeEntry(unsigned index)
 	// Remove it from the entry list
 	entries_.erase(entries_.begin() + index);
 
+	if (archive_)
+		archive_->invalidateSearchIndex();
+
 	return true;
 }
 
@@ -349,6 +359,9 @@ bool ArchiveDir::swapEntries(unsigned index1, unsigned index2)
 	// Swap entries
 	entries_[index1].swap(entries_[index2]);
 
+	if (archive_)
+		archive_->invalidateSearchIndex();
+
 	return true;
 }
 
@@ -407,6 +420,9 @@ bool ArchiveDir::addSubdir(shared_ptr<ArchiveDir> subdir, unsigned index)
 	subdir->archive_               = archive_;
 	subdir->allow_duplicate_names_ = allow_duplicate_names_;
 
+	if (archive_)
+		archive_->invalidateSearchIndex();
+
 	return true;
 }
 
@@ -427,6 +443,9 @@ shared_ptr<ArchiveDir> ArchiveDir::removeSubdir(string_view name)
 			break;
 		}
 
+	if (removed && archive_)
+		archive_->invalidateSearchIndex();
+
 	return removed;
 }
 
@@ -442,6 +461,9 @@ shared_ptr<ArchiveDir> ArchiveDir::removeSubdirAt(unsigned index)
 	auto removed = subdirs_[index];
 	subdirs_.erase(subdirs_.begin() + index);
 
+	if (archive_)
+		archive_->invalidateSearchIndex();
+
 	return removed;
 }
 
@@ -452,6 +474,9 @@ void ArchiveDir::clear()
 {
 	entries_.clear();
 	subdirs_.clear();
+
+	if (archive_)
+		archive_->invalidateSearchIndex();
 }
 
 // -----------------------------------------------------------------------------
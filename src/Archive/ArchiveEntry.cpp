@@ -230,6 +230,24 @@ void ArchiveEntry::setName(string_view name)
 {
 	name_       = name;
 	upper_name_ = strutil::upper(name);
+
+	// Parent archive's search index is now out of date
+	if (auto archive = parent())
+		archive->invalidateSearchIndex();
+}
+
+// -----------------------------------------------------------------------------
+// Sets the entry's type to [type], with detection reliability [r]
+// -----------------------------------------------------------------------------
+void ArchiveEntry::setType(EntryType* type, int r)
+{
+	// Parent archive's search index is now out of date
+	if (type != type_)
+		if (auto archive = parent())
+			archive->invalidateSearchIndex();
+
+	type_        = type;
+	reliability_ = r;
 }
 
 // -----------------------------------------------------------------------------
@@ -243,8 +261,14 @@ void ArchiveEntry::setState(State state, bool silent)
 
 	if (state == State::Unmodified)
 		state_ = State::Unmodified;
-	else if (state > state_)
-		state_ = state;
+	else
+	{
+		if (state > state_)
+			state_ = state;
+
+		// Data may have been changed
+		content_hash_valid_ = false;
+	}
 
 	// Notify parent archive this entry has been modified
 	if (!silent)
@@ -300,17 +324,12 @@ void ArchiveEntry::unlock()
 // -----------------------------------------------------------------------------
 void ArchiveEntry::formatName(const ArchiveFormat& format)
 {
-	bool changed = false;
-
 	// Perform character substitution if needed
 	name_ = misc::fileNameToLumpName(name_);
 
 	// Max length
 	if (format.max_name_length > 0 && static_cast<int>(name_.size()) > format.max_name_length)
-	{
 		strutil::truncateIP(name_, format.max_name_length);
-		changed = true;
-	}
 
 	// Uppercase
 	if (format.prefer_uppercase && wad_force_uppercase)
@@ -318,10 +337,7 @@ void ArchiveEntry::formatName(const ArchiveFormat& format)
 
 	// Remove \ or / if the format supports folders
 	if (format.supports_dirs && (name_.find('/') != string::npos || name_.find('\\') != string::npos))
-	{
-		name_   = misc::lumpNameToFileName(name_);
-		changed = true;
-	}
+		name_ = misc::lumpNameToFileName(name_);
 
 	// Remove extension if the format doesn't have them
 	if (!format.names_extensions)
@@ -329,8 +345,11 @@ void ArchiveEntry::formatName(const ArchiveFormat& format)
 			strutil::truncateIP(name_, pos);
 
 	// Update upper name
-	if (changed)
-		upper_name_ = strutil::upper(name_);
+	upper_name_ = strutil::upper(name_);
+
+	// Parent archive's search index is now out of date
+	if (auto archive = parent())
+		archive->invalidateSearchIndex();
 }
 
 // -----------------------------------------------------------------------------
@@ -367,6 +386,7 @@ bool ArchiveEntry::resize(uint32_t new_size, bool preserve_data)
 
 	// Update attributes
 	setState(State::Modified);
+	content_hash_valid_ = false;
 
 	return data_.reSize(new_size, preserve_data);
 }
@@ -387,8 +407,9 @@ void ArchiveEntry::clearData()
 	data_.clear();
 
 	// Reset attributes
-	size_        = 0;
-	data_loaded_ = false;
+	size_               = 0;
+	data_loaded_        = false;
+	content_hash_valid_ = false;
 }
 
 // -----------------------------------------------------------------------------
@@ -502,7 +523,8 @@ bool ArchiveEntry::importFileStream(wxFile& file, uint32_t len)
 	if (data_.importFileStreamWx(file, len))
 	{
 		// Update attributes
-		size_ = data_.size();
+		size_               = data_.size();
+		content_hash_valid_ = false;
 		setLoaded();
 		setType(EntryType::unknownType());
 		setState(State::Modified);
@@ -581,7 +603,8 @@ bool ArchiveEntry::write(const void* data, uint32_t size)
 	if (data_.write(data, size))
 	{
 		// Update attributes
-		size_ = data_.size();
+		size_               = data_.size();
+		content_hash_valid_ = false;
 		setState(State::Modified);
 
 		return true;
@@ -622,6 +645,25 @@ void ArchiveEntry::stateChanged()
 		parent_archive->entryStateChanged(this);
 }
 
+// -----------------------------------------------------------------------------
+// Returns a 64-bit hash of the entry data, for quickly checking if entries have
+// identical data. The hash is cached until the entry data is changed
+// -----------------------------------------------------------------------------
+uint64_t ArchiveEntry::contentHash(bool allow_load)
+{
+	if (hasContentHash())
+		return content_hash_;
+
+	// If the data isn't loaded (and [allow_load] is false) this will be the hash
+	// of no data, which won't be kept since the size won't match
+	auto& mc            = data(allow_load);
+	content_hash_       = mc.hash();
+	content_hash_size_  = mc.size();
+	content_hash_valid_ = true;
+
+	return content_hash_;
+}
+
 // -----------------------------------------------------------------------------
 // Sets the entry's name extension to the extension defined in its EntryType
 // -----------------------------------------------------------------------------
@@ -2,6 +2,7 @@
 
 #include "EntryType/EntryType.h"
 #include "Utility/Property.h"
+#include <atomic>
 
 namespace slade
 {
@@ -64,11 +65,7 @@ public:
 	// Modifiers (won't change entry state, except setState of course :P)
 	void setName(string_view name);
 	void setLoaded(bool loaded = true) { data_loaded_ = loaded; }
-	void setType(EntryType* type, int r = 0)
-	{
-		type_        = type;
-		reliability_ = r;
-	}
+	void setType(EntryType* type, int r = 0);
 	void setState(State state, bool silent = false);
 	void setEncryption(Encryption enc) { encrypted_ = enc; }
 	void unloadData();
@@ -110,6 +107,8 @@ public:
 	int           typeReliability() const { return (type_ ? (type()->reliability() * reliability_ / 255) : 0); }
 	bool          isInNamespace(string_view ns);
 	ArchiveEntry* relativeEntry(string_view path, bool allow_absolute_path = true) const;
+	uint64_t      contentHash(bool allow_load = true);
+	bool          hasContentHash() const { return content_hash_valid_ && content_hash_size_ == size(); }
 
 private:
 	// Entry Info
@@ -129,8 +128,13 @@ private:
 	Encryption encrypted_    = Encryption::None; // Is there some encrypting on the archive?
 
 	// Misc stuff
-	int    reliability_ = 0; // The reliability of the entry's identification
-	size_t index_guess_ = 0; // for speed
+	int                 reliability_ = 0; // The reliability of the entry's identification
+	std::atomic<size_t> index_guess_{ 0 }; // for speed (atomic since entries can be looked up from worker threads)
+
+	// Cached data hash (see contentHash)
+	uint64_t content_hash_       = 0;
+	uint32_t content_hash_size_  = 0;
+	bool     content_hash_valid_ = false;
 };
 
 template<typename T> T ArchiveEntry::exProp(const string& key)
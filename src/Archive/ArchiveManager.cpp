@@ -52,6 +52,7 @@ using namespace slade;
 CVAR(Int, base_resource, -1, CVar::Flag::Save)
 CVAR(Int, max_recent_files, 25, CVar::Flag::Save)
 CVAR(Bool, auto_open_wads_root, false, CVar::Flag::Save)
+EXTERN_CVAR(Bool, archive_load_data)
 
 
 // -----------------------------------------------------------------------------
@@ -143,6 +144,10 @@ bool ArchiveManager::init()
 		dir_slade_pk3 = "slade.pk3";
 
 	// Open slade.pk3
+	// (keep all entry data loaded, since resources are read from multiple
+	// threads during startup and entries can't be lazily loaded concurrently)
+	bool load_data    = archive_load_data;
+	archive_load_data = true;
 	if (!program_resource_archive_->open(dir_slade_pk3))
 	{
 		log::error("Unable to find slade.pk3!");
@@ -150,6 +155,7 @@ bool ArchiveManager::init()
 	}
 	else
 		res_archive_open_ = true;
+	archive_load_data = load_data;
 
 	if (!initArchiveFormats())
 		log::error("An error occurred reading archive formats configuration");
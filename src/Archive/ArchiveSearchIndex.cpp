@@ -0,0 +1,194 @@
+
+// -----------------------------------------------------------------------------
+// SLADE - It's a Doom Editor
+// Copyright(C) 2008 - 2020 Simon Judd
+//
+// Email:       sirjuddington@gmail.com
+// Web:         http://slade.mancubus.net
+// Filename:    ArchiveSearchIndex.cpp
+// Description: ArchiveSearchIndex class - lookup tables of the entries in an
+//              archive by name and type, so that entry searches only need to
+//              check the entries that could possibly match
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301, USA.
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+//
+// Includes
+//
+// -----------------------------------------------------------------------------
+#include "Main.h"
+#include "ArchiveSearchIndex.h"
+#include "Utility/StringUtils.h"
+
+using namespace slade;
+
+
+// -----------------------------------------------------------------------------
+//
+// ArchiveSearchIndex Class Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// ArchiveSearchIndex class constructor, builds the index for all entries in
+// [root] and its subdirs
+// -----------------------------------------------------------------------------
+ArchiveSearchIndex::ArchiveSearchIndex(const ArchiveDir& root) : root_{ &root }
+{
+	// Get all entries in tree order
+	vector<Item> items;
+	addDir(root, items);
+	setOrderLast(root, items, 0);
+	n_entries_ = items.size();
+
+	// Build lookup tables
+	for (const auto& item : items)
+	{
+		by_name_[item.entry->upperName()].push_back(item);
+		by_name_noext_[string{ item.entry->upperNameNoExt() }].push_back(item);
+		by_type_[item.entry->type()].push_back(item);
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Returns the entry matching [name] (case-insensitive) directly within [dir],
+// or null if no entries match. If [cut_ext] is true, entry names are compared
+// without their extensions
+// -----------------------------------------------------------------------------
+ArchiveEntry* ArchiveSearchIndex::entry(string_view name, bool cut_ext, const ArchiveDir& dir) const
+{
+	if (name.empty())
+		return nullptr;
+
+	// Check the dir is indexed
+	auto range = dir_ranges_.find(&dir);
+	if (range == dir_ranges_.end())
+		return dir.entry(name, cut_ext);
+
+	// Find the first entry with the name in the dir
+	const auto& names = cut_ext ? by_name_noext_ : by_name_;
+	auto        it    = names.find(strutil::upper(name));
+	if (it == names.end())
+		return nullptr;
+	for (const auto& item : it->second)
+		if (item.order >= range->second.start && item.order < range->second.own_end)
+			return item.entry;
+
+	return nullptr;
+}
+
+// -----------------------------------------------------------------------------
+// Gets a list of entries (in tree order) that could match the search criteria
+// in [options] and adds them to [list]. [options.match_name] must already be
+// uppercase, and if [full_name] is true it is compared with entry names
+// including their extensions.
+// The entries in [list] still need to be checked against [options], only the
+// search dir/subdirs are guaranteed to match. Returns false if the index can't
+// narrow down the search (eg. a name search with wildcards)
+// -----------------------------------------------------------------------------
+bool ArchiveSearchIndex::candidates(const Archive::SearchOptions& options, bool full_name, vector<Item>& list) const
+{
+	list.clear();
+
+	// Get range of entries to search
+	auto range = dir_ranges_.find(options.dir ? options.dir : root_);
+	if (range == dir_ranges_.end())
+		return false;
+	auto start = range->second.start;
+	auto end   = options.search_subdirs ? range->second.all_end : range->second.own_end;
+
+	// Name (can't be looked up if it has wildcards)
+	if (!options.match_name.empty() && options.match_name.find_first_of("*?") == string::npos)
+	{
+		const auto& names = full_name ? by_name_ : by_name_noext_;
+		if (auto it = names.find(options.match_name); it != names.end())
+			for (const auto& item : it->second)
+				if (item.order >= start && item.order < end)
+					list.push_back(item);
+
+		return true;
+	}
+
+	// Type, entries of unknown type are also included since they could be
+	// detected as the type when checked
+	if (options.match_type)
+	{
+		const auto add_type = [&](EntryType* type) {
+			if (auto it = by_type_.find(type); it != by_type_.end())
+				for (const auto& item : it->second)
+					if (item.order >= start && item.order < end)
+						list.push_back(item);
+		};
+
+		add_type(options.match_type);
+		if (options.match_type != EntryType::unknownType())
+		{
+			auto n_typed = list.size();
+			add_type(EntryType::unknownType());
+
+			// Merge the two (already sorted) lists back into tree order
+			std::inplace_merge(
+				list.begin(),
+				list.begin() + n_typed,
+				list.end(),
+				[](const Item& left, const Item& right) { return left.order < right.order; });
+		}
+
+		return true;
+	}
+
+	return false;
+}
+
+// -----------------------------------------------------------------------------
+// Adds all entries in [dir] to [items], followed by all entries in its subdirs
+// (recursively), and records the range of entries for each dir
+// -----------------------------------------------------------------------------
+void ArchiveSearchIndex::addDir(const ArchiveDir& dir, vector<Item>& items)
+{
+	DirRange range;
+	range.start = items.size();
+	for (const auto& entry : dir.entries())
+		items.push_back({ entry.get(), static_cast<unsigned>(items.size()), 0 });
+	range.own_end = items.size();
+
+	for (const auto& subdir : dir.subdirs())
+		addDir(*subdir, items);
+	range.all_end = items.size();
+
+	dir_ranges_[&dir] = range;
+}
+
+// -----------------------------------------------------------------------------
+// Sets the order_last position of all [items] in [dir] and its subdirs,
+// starting from [order]. Subdirs come before a dir's own entries in this order,
+// which matches the order findLast searches in.
+// Returns the next order_last position after [dir]
+// -----------------------------------------------------------------------------
+unsigned ArchiveSearchIndex::setOrderLast(const ArchiveDir& dir, vector<Item>& items, unsigned order) const
+{
+	for (const auto& subdir : dir.subdirs())
+		order = setOrderLast(*subdir, items, order);
+
+	const auto& range = dir_ranges_.at(&dir);
+	for (auto a = range.start; a < range.own_end; ++a)
+		items[a].order_last = order++;
+
+	return order;
+}
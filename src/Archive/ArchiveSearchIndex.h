@@ -0,0 +1,48 @@
+#pragma once
+
+#include "Archive.h"
+
+namespace slade
+{
+// Lookup tables for the entries in an archive by name and type, used to speed
+// up Archive::entry and the Archive::find* functions. Built on demand by the
+// archive and discarded whenever its entry tree, or any entry's name or type,
+// changes
+class ArchiveSearchIndex
+{
+public:
+	struct Item
+	{
+		ArchiveEntry* entry;
+		unsigned      order;      // Position in tree (each dir's entries, then its subdirs)
+		unsigned      order_last; // Position in tree (each dir's subdirs, then its entries)
+	};
+
+	explicit ArchiveSearchIndex(const ArchiveDir& root);
+	~ArchiveSearchIndex() = default;
+
+	unsigned size() const { return n_entries_; }
+
+	ArchiveEntry* entry(string_view name, bool cut_ext, const ArchiveDir& dir) const;
+	bool          candidates(const Archive::SearchOptions& options, bool full_name, vector<Item>& list) const;
+
+private:
+	// Range of entry positions in a dir (own) and in it + its subdirs (all)
+	struct DirRange
+	{
+		unsigned start   = 0;
+		unsigned own_end = 0;
+		unsigned all_end = 0;
+	};
+
+	const ArchiveDir*                               root_;
+	std::unordered_map<string, vector<Item>>        by_name_;
+	std::unordered_map<string, vector<Item>>        by_name_noext_;
+	std::unordered_map<EntryType*, vector<Item>>    by_type_;
+	std::unordered_map<const ArchiveDir*, DirRange> dir_ranges_;
+	unsigned                                        n_entries_ = 0;
+
+	void     addDir(const ArchiveDir& dir, vector<Item>& items);
+	unsigned setOrderLast(const ArchiveDir& dir, vector<Item>& items, unsigned order) const;
+};
+} // namespace slade
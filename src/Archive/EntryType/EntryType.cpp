@@ -133,9 +133,11 @@ string EntryType::fileFilterString() const
 }
 
 // -----------------------------------------------------------------------------
-// Returns true if [entry] matches the EntryType's criteria, false otherwise
+// Returns true if [entry] matches the EntryType's criteria, false otherwise.
+// If [context] is given, it is used for the archive format and namespace checks
+// instead of the entry's parent archive
 // -----------------------------------------------------------------------------
-int EntryType::isThisType(ArchiveEntry& entry)
+int EntryType::isThisType(ArchiveEntry& entry, const DetectContext* context)
 {
 	// Check type is detectable
 	if (!detectable_)
@@ -152,10 +154,17 @@ int EntryType::isThisType(ArchiveEntry& entry)
 	// Check for archive match if needed
 	if (!match_archive_.empty())
 	{
+		const bool in_archive = context || entry.parent();
+		string     archive_format;
+		if (context)
+			archive_format = context->archive_format;
+		else if (in_archive)
+			archive_format = entry.parent()->formatDesc().entry_format;
+
 		bool match = false;
 		for (const auto& a : match_archive_)
 		{
-			if (entry.parent() && entry.parent()->formatDesc().entry_format == a)
+			if (in_archive && archive_format == a)
 			{
 				match = true;
 				break;
@@ -284,10 +293,10 @@ int EntryType::isThisType(ArchiveEntry& entry)
 	if (!section_.empty())
 	{
 		// Check entry is part of an archive (if not it can't be in a section)
-		if (!entry.parent())
+		if (!context && !entry.parent())
 			return EntryDataFormat::MATCH_FALSE;
 
-		const auto e_section = entry.parent()->detectNamespace(&entry);
+		const auto e_section = context ? context->section : entry.parent()->detectNamespace(&entry);
 
 		r = EntryDataFormat::MATCH_FALSE;
 		for (const auto& ns : section_)
@@ -585,9 +594,13 @@ bool EntryType::loadEntryTypes()
 }
 
 // -----------------------------------------------------------------------------
-// Attempts to detect the given entry's type
+// Attempts to detect the given entry's type.
+// If [context] is given, the entry is treated as being in an archive as
+// described by it, rather than its parent archive. Detection doesn't access any
+// archive in this case, so it can be done on a worker thread for an entry that
+// isn't in an archive yet (as long as its data is loaded)
 // -----------------------------------------------------------------------------
-bool EntryType::detectEntryType(ArchiveEntry& entry)
+bool EntryType::detectEntryType(ArchiveEntry& entry, const DetectContext* context)
 {
 	// Do nothing if the entry is a folder or a map marker
 	if (entry.type() == etype_folder || entry.type() == etype_map)
@@ -612,7 +625,7 @@ bool EntryType::detectEntryType(ArchiveEntry& entry)
 			continue;
 
 		// Check for possible type match
-		const int r = entry_types[a]->isThisType(entry);
+		const int r = entry_types[a]->isThisType(entry, context);
 		if (r > 0)
 		{
 			// Type matches, set it
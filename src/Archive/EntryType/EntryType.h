@@ -10,6 +10,14 @@ class ArchiveEntry;
 class EntryType
 {
 public:
+	// Where an entry will be in an archive, for detecting the type of an entry
+	// before it is added to the archive
+	struct DetectContext
+	{
+		string archive_format; // Entry format of the archive (see ArchiveFormat::entry_format)
+		string section;        // Namespace the entry will be in
+	};
+
 	EntryType(string_view id = "Unknown") : id_{ id }, format_{ EntryDataFormat::anyFormat() } {}
 	~EntryType() = default;
 
@@ -32,13 +40,13 @@ public:
 	string fileFilterString() const;
 
 	// Magic goes here
-	int isThisType(ArchiveEntry& entry);
+	int isThisType(ArchiveEntry& entry, const DetectContext* context = nullptr);
 
 	// Static functions
 	static void               initTypes();
 	static bool               readEntryTypeDefinition(MemChunk& mc, string_view source);
 	static bool               loadEntryTypes();
-	static bool               detectEntryType(ArchiveEntry& entry);
+	static bool               detectEntryType(ArchiveEntry& entry, const DetectContext* context = nullptr);
 	static EntryType*         fromId(string_view id);
 	static EntryType*         unknownType();
 	static EntryType*         folderType();
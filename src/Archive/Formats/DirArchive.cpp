@@ -36,6 +36,7 @@
 #include "App.h"
 #include "General/UI.h"
 #include "Utility/FileUtils.h"
+#include "Utility/FileWatcher.h"
 #include "Utility/StringUtils.h"
 #include "WadArchive.h"
 
@@ -154,6 +155,9 @@ bool DirArchive::open(string_view filename)
 	setModified(false);
 	on_disk_ = true;
 
+	// Watch for external changes
+	startWatching();
+
 	ui::setSplashProgressMessage("");
 
 	return true;
@@ -732,3 +736,138 @@ bool DirArchive::shouldIgnoreEntryChange(DirEntryChange& change)
 	// and an unmodified file will never change mtime.)
 	return (old_change.mtime == change.mtime);
 }
+
+// -----------------------------------------------------------------------------
+// Gets all changes on disk picked up by the file watcher since the last call,
+// and adds them to [changes].
+// Returns false if the watcher lost track of changes, in which case the whole
+// directory needs to be checked instead
+// -----------------------------------------------------------------------------
+bool DirArchive::takeWatchedChanges(vector<DirEntryChange>& changes)
+{
+	if (watch_rescan_)
+	{
+		watch_rescan_ = false;
+		watched_paths_.clear();
+		watched_paths_set_.clear();
+		return false;
+	}
+
+	for (const auto& path : watched_paths_)
+		checkChangedPath(path, changes);
+
+	watched_paths_.clear();
+	watched_paths_set_.clear();
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Starts watching the archive directory for changes on disk, if supported
+// -----------------------------------------------------------------------------
+void DirArchive::startWatching()
+{
+	watcher_ = std::make_unique<FileWatcher>();
+	if (!watcher_->watchDir(filename_))
+	{
+		// Not available, changes will be checked by scanning the directory
+		watcher_.reset();
+		return;
+	}
+
+	watcher_->signals().changed.connect([this](const vector<FileChange>& changes) { onWatchedChanges(changes); });
+}
+
+// -----------------------------------------------------------------------------
+// Called when the file watcher reports a batch of [changes] on disk
+// -----------------------------------------------------------------------------
+void DirArchive::onWatchedChanges(const vector<FileChange>& changes)
+{
+	for (const auto& change : changes)
+	{
+		if (change.type == FileChange::Type::Rescan)
+			watch_rescan_ = true;
+		else if (change.type == FileChange::Type::Renamed)
+		{
+			addWatchedPath(change.old_path);
+			addWatchedPath(change.path);
+		}
+		else
+			addWatchedPath(change.path);
+	}
+
+	dir_signals_.external_changes(*this);
+}
+
+// -----------------------------------------------------------------------------
+// Adds [path] to the list of paths to check for changes (if it isn't already)
+// -----------------------------------------------------------------------------
+void DirArchive::addWatchedPath(const string& path)
+{
+	if (watched_paths_set_.insert(path).second)
+		watched_paths_.push_back(path);
+}
+
+// -----------------------------------------------------------------------------
+// Compares the file or directory at [path] on disk with the archive, and adds
+// any resulting change to [changes]
+// -----------------------------------------------------------------------------
+void DirArchive::checkChangedPath(const string& path, vector<DirEntryChange>& changes)
+{
+	// Ignore files removed from archive since last save
+	if (VECTOR_EXISTS(removed_files_, path))
+		return;
+
+	// Get path within the archive
+	if (path.size() <= filename_.size() || !strutil::startsWith(path, filename_))
+		return;
+	auto entry_path = path.substr(filename_.size());
+	std::replace(entry_path.begin(), entry_path.end(), '\\', '/');
+
+	// Find matching entry/dir (that was loaded from this path) in the archive
+	auto dir   = dirAtPath(entry_path);
+	auto entry = dir ? nullptr : entryAtPath(entry_path);
+	if (entry && entry->exProps().getOr<string>("filePath", "") != path)
+		entry = nullptr;
+
+	DirEntryChange change;
+	if (fileutil::dirExists(path))
+	{
+		// New directory
+		if (!dir)
+			change = DirEntryChange(DirEntryChange::Action::AddedDir, path, "", wxDateTime::Now().GetTicks());
+		else
+			return;
+	}
+	else if (fileutil::fileExists(path))
+	{
+		auto mod = fileutil::fileModifiedTime(path);
+
+		// New file
+		if (!entry)
+			change = DirEntryChange(DirEntryChange::Action::AddedFile, path, "", mod);
+
+		// Modified file
+		else if (mod > file_modification_times_[entry])
+			change = DirEntryChange(DirEntryChange::Action::Updated, path, entry->path(true), mod);
+
+		else
+			return;
+	}
+	else
+	{
+		// Deleted directory
+		if (dir && dir->dirEntry()->exProps().getOr<string>("filePath", "") == path)
+			change = DirEntryChange(DirEntryChange::Action::DeletedDir, path, dir->path());
+
+		// Deleted file
+		else if (entry)
+			change = DirEntryChange(DirEntryChange::Action::DeletedFile, path, entry->path(true));
+
+		else
+			return;
+	}
+
+	if (!shouldIgnoreEntryChange(change))
+		changes.push_back(change);
+}
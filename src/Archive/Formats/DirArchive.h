@@ -1,6 +1,7 @@
 #pragma once
 
 #include "Archive/Archive.h"
+#include "Utility/FileWatcher.h"
 
 namespace slade
 {
@@ -78,12 +79,35 @@ public:
 	void updateChangedEntries(vector<DirEntryChange>& changes);
 	bool shouldIgnoreEntryChange(DirEntryChange& change);
 
+	// External change watching
+	bool isWatched() const { return watcher_ != nullptr; }
+	bool takeWatchedChanges(vector<DirEntryChange>& changes);
+
+	// Signals
+	struct DirSignals
+	{
+		sigslot::signal<DirArchive&> external_changes; // Emitted when the watcher picks up changes on disk
+	};
+	DirSignals& dirSignals() { return dir_signals_; }
+
 private:
 	char                            separator_;
 	vector<StringPair>              renamed_dirs_;
 	std::map<ArchiveEntry*, time_t> file_modification_times_;
 	vector<string>                  removed_files_;
 	IgnoredFileChanges              ignored_file_changes_;
+
+	// External change watching
+	unique_ptr<FileWatcher> watcher_;
+	vector<string>          watched_paths_;
+	std::set<string>        watched_paths_set_;
+	bool                    watch_rescan_ = false;
+	DirSignals              dir_signals_;
+
+	void startWatching();
+	void onWatchedChanges(const vector<FileChange>& changes);
+	void addWatchedPath(const string& path);
+	void checkChangedPath(const string& path, vector<DirEntryChange>& changes);
 };
 
 class DirArchiveTraverser : public wxDirTraverser
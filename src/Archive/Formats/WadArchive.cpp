@@ -31,6 +31,7 @@
 // -----------------------------------------------------------------------------
 #include "Main.h"
 #include "WadArchive.h"
+#include "Archive/ArchiveSearchIndex.h"
 #include "General/Misc.h"
 #include "General/UI.h"
 #include "Utility/StringUtils.h"
@@ -119,6 +120,34 @@ bool isNamespaceEntry(ArchiveEntry* entry)
 {
 	return strutil::endsWith(entry->upperName(), "_START") || strutil::endsWith(entry->upperName(), "_END");
 }
+
+// -----------------------------------------------------------------------------
+// Returns true if [entry] matches the type and name criteria in [options].
+// [options.match_name] must already be uppercase
+// -----------------------------------------------------------------------------
+bool wadEntryMatchesSearch(ArchiveEntry* entry, const Archive::SearchOptions& options)
+{
+	// Check type
+	if (options.match_type)
+	{
+		if (entry->type() == EntryType::unknownType())
+		{
+			if (!options.match_type->isThisType(*entry))
+				return false;
+		}
+		else if (options.match_type != entry->type())
+			return false;
+	}
+
+	// Check name
+	if (!options.match_name.empty())
+	{
+		if (!strutil::matches(entry->upperName(), options.match_name))
+			return false;
+	}
+
+	return true;
+}
 } // namespace
 
 
@@ -1287,33 +1316,26 @@ ArchiveEntry* WadArchive::findFirst(SearchOptions& options)
 			return nullptr;
 	}
 
+	// Use the search index to get the entries to check, if possible
+	vector<ArchiveSearchIndex::Item> candidates;
+	if (auto search_index = searchIndex(); search_index && search_index->candidates(options, true, candidates))
+	{
+		for (const auto& item : candidates)
+			if (item.order >= index && item.order < index_end && wadEntryMatchesSearch(item.entry, options))
+				return item.entry;
+
+		return nullptr;
+	}
+
 	// Begin search
 	ArchiveEntry* entry;
 	for (; index < index_end; ++index)
 	{
 		entry = entryAt(index);
 
-		// Check type
-		if (options.match_type)
-		{
-			if (entry->type() == EntryType::unknownType())
-			{
-				if (!options.match_type->isThisType(*entry))
-					continue;
-			}
-			else if (options.match_type != entry->type())
-				continue;
-		}
-
-		// Check name
-		if (!options.match_name.empty())
-		{
-			if (!strutil::matches(options.match_name, entry->upperName()))
-				continue;
-		}
-
-		// Entry passed all checks so far, so we found a match
-		return entry;
+		// Entry passed all checks, so we found a match
+		if (wadEntryMatchesSearch(entry, options))
+			return entry;
 	}
 
 	// No match found
@@ -1360,33 +1382,27 @@ ArchiveEntry* WadArchive::findLast(SearchOptions& options)
 			return nullptr;
 	}
 
+	// Use the search index to get the entries to check, if possible
+	vector<ArchiveSearchIndex::Item> candidates;
+	if (auto search_index = searchIndex(); search_index && search_index->candidates(options, true, candidates))
+	{
+		for (auto it = candidates.rbegin(); it != candidates.rend(); ++it)
+			if (static_cast<int>(it->order) >= index_start && static_cast<int>(it->order) <= index
+				&& wadEntryMatchesSearch(it->entry, options))
+				return it->entry;
+
+		return nullptr;
+	}
+
 	// Begin search
 	ArchiveEntry* entry;
 	for (; index >= index_start; --index)
 	{
 		entry = entryAt(index);
 
-		// Check type
-		if (options.match_type)
-		{
-			if (entry->type() == EntryType::unknownType())
-			{
-				if (!options.match_type->isThisType(*entry))
-					continue;
-			}
-			else if (options.match_type != entry->type())
-				continue;
-		}
-
-		// Check name
-		if (!options.match_name.empty())
-		{
-			if (!strutil::matches(entry->upperName(), options.match_name))
-				continue;
-		}
-
-		// Entry passed all checks so far, so we found a match
-		return entry;
+		// Entry passed all checks, so we found a match
+		if (wadEntryMatchesSearch(entry, options))
+			return entry;
 	}
 
 	// No match found
@@ -1430,32 +1446,25 @@ vector<ArchiveEntry*> WadArchive::findAll(SearchOptions& options)
 			return ret;
 	}
 
+	// Use the search index to get the entries to check, if possible
+	vector<ArchiveSearchIndex::Item> candidates;
+	if (auto search_index = searchIndex(); search_index && search_index->candidates(options, true, candidates))
+	{
+		for (const auto& item : candidates)
+			if (item.order >= index && item.order < index_end && wadEntryMatchesSearch(item.entry, options))
+				ret.push_back(item.entry);
+
+		return ret;
+	}
+
 	ArchiveEntry* entry;
 	for (; index < index_end; ++index)
 	{
 		entry = entryAt(index);
 
-		// Check type
-		if (options.match_type)
-		{
-			if (entry->type() == EntryType::unknownType())
-			{
-				if (!options.match_type->isThisType(*entry))
-					continue;
-			}
-			else if (options.match_type != entry->type())
-				continue;
-		}
-
-		// Check name
-		if (!options.match_name.empty())
-		{
-			if (!strutil::matches(entry->upperName(), options.match_name))
-				continue;
-		}
-
-		// Entry passed all checks so far, so we found a match
-		ret.push_back(entry);
+		// Entry passed all checks, so we found a match
+		if (wadEntryMatchesSearch(entry, options))
+			ret.push_back(entry);
 	}
 
 	// Return search result
@@ -33,6 +33,7 @@
 #include "Main.h"
 #include "MIDIPlayer.h"
 #include "App.h"
+#include "MIDIRenderer.h"
 #include "Utility/StringUtils.h"
 
 using namespace slade;
@@ -94,15 +95,6 @@ public:
 		if (app::platform() == app::Platform::Linux && fs_driver.value.empty())
 			fs_driver = "alsa";
 
-		// Init soundfont path
-		if (fs_soundfont_path.value.empty())
-		{
-			if (app::platform() == app::Platform::Linux)
-				fs_soundfont_path = "/usr/share/sounds/sf2/FluidR3_GM.sf2:/usr/share/sounds/sf2/FluidR3_GS.sf2";
-			else
-				log::warning(1, "No FluidSynth soundfont set, MIDI playback will not work");
-		}
-
 		// Setup fluidsynth
 		initFluidsynth();
 		FluidSynthMIDIPlayer::reloadSoundfont();
@@ -119,6 +111,8 @@ public:
 		FluidSynthMIDIPlayer::stop();
 		delete_fluid_audio_driver(fs_adriver_);
 		delete_fluid_player(fs_player_);
+		if (soundfonts_)
+			soundfonts_->removeFrom(fs_synth_);
 		delete_fluid_synth(fs_synth_);
 		delete_fluid_settings(fs_settings_);
 	}
@@ -126,7 +120,12 @@ public:
 	// -------------------------------------------------------------------------
 	// Returns true if the MIDIPlayer has a soundfont loaded
 	// -------------------------------------------------------------------------
-	bool isSoundfontLoaded() override { return !fs_soundfont_ids_.empty(); }
+	bool isSoundfontLoaded() override { return soundfonts_ && soundfonts_->isLoaded(); }
+
+	// -------------------------------------------------------------------------
+	// Returns true, this player uses FluidSynth
+	// -------------------------------------------------------------------------
+	bool isFluidSynth() const override { return true; }
 
 	// -------------------------------------------------------------------------
 	// Reloads the current soundfont
@@ -137,32 +136,15 @@ public:
 		if (!fs_initialised_)
 			return false;
 
-		char separator = app::platform() == app::Platform::Windows ? ';' : ':';
+		// Remove current soundfonts
+		if (soundfonts_)
+			soundfonts_->removeFrom(fs_synth_);
 
-		// Unload any current soundfont
-		for (int a = fs_soundfont_ids_.size() - 1; a >= 0; --a)
-		{
-			if (fs_soundfont_ids_[a] != FLUID_FAILED)
-				fluid_synth_sfunload(fs_synth_, fs_soundfont_ids_[a], 1);
-			fs_soundfont_ids_.pop_back();
-		}
-
-		// Load soundfonts
-		auto paths  = strutil::split(fs_soundfont_path, separator);
-		bool retval = false;
-		for (int a = paths.size() - 1; a >= 0; --a)
-		{
-			auto path = paths[a];
-			if (!path.empty())
-			{
-				int fs_id = fluid_synth_sfload(fs_synth_, path.c_str(), 1);
-				fs_soundfont_ids_.push_back(fs_id);
-				if (fs_id != FLUID_FAILED)
-					retval = true;
-			}
-		}
+		// Load soundfonts (shared with any other fluidsynth synths)
+		soundfonts_ = reloadSoundfonts();
+		soundfonts_->addTo(fs_synth_);
 
-		return retval;
+		return soundfonts_->isLoaded();
 	}
 
 	// -------------------------------------------------------------------------
@@ -221,7 +203,7 @@ public:
 	// -------------------------------------------------------------------------
 	// Returns true if the MIDIPlayer is ready to play some MIDI
 	// -------------------------------------------------------------------------
-	bool isReady() override { return fs_initialised_ && !fs_soundfont_ids_.empty(); }
+	bool isReady() override { return fs_initialised_ && isSoundfontLoaded(); }
 
 	// -------------------------------------------------------------------------
 	// Begins playback of the currently loaded MIDI stream.
@@ -320,8 +302,8 @@ private:
 	fluid_player_t*       fs_player_   = nullptr;
 	fluid_audio_driver_t* fs_adriver_  = nullptr;
 
-	bool        fs_initialised_ = false;
-	vector<int> fs_soundfont_ids_;
+	bool                     fs_initialised_ = false;
+	shared_ptr<SoundfontSet> soundfonts_;
 
 	// -------------------------------------------------------------------------
 	// Initialises fluidsynth
@@ -15,6 +15,10 @@ public:
 
 	virtual bool isReady() = 0;
 
+	// Returns true if this player synthesizes MIDI with FluidSynth (and so
+	// uses the same soundfonts as the MIDI renderer)
+	virtual bool isFluidSynth() const { return false; }
+
 	virtual bool play()  = 0;
 	virtual bool pause() = 0;
 	virtual bool stop()  = 0;
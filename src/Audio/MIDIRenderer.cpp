@@ -0,0 +1,408 @@
+// -----------------------------------------------------------------------------
+// SLADE - It's a Doom Editor
+// Copyright(C) 2008 - 2020 Simon Judd
+//
+// Email:       sirjuddington@gmail.com
+// Web:         http://slade.mancubus.net
+// Filename:    MIDIRenderer.cpp
+// Description: Offline rendering of MIDI to PCM audio (using fluidsynth), and
+//              the soundfont set shared by all fluidsynth synths.
+//              Rendering doesn't need an audio device, and runs as fast as the
+//              synth can go rather than in real time
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301, USA.
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+//
+// Includes
+//
+// -----------------------------------------------------------------------------
+#include "Main.h"
+#include "MIDIRenderer.h"
+#include "App.h"
+#include "MIDIPlayer.h"
+#include "Utility/StringUtils.h"
+#include "Utility/ThreadPool.h"
+
+using namespace slade;
+using namespace audio;
+
+
+// -----------------------------------------------------------------------------
+//
+// Variables
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+constexpr int MIDI_RENDER_SAMPLE_RATE = 44100;
+constexpr int MIDI_RENDER_BLOCK_SIZE  = 4096; // Frames rendered per fluidsynth call
+constexpr int MIDI_RENDER_MAX_LENGTH  = 600;  // Default max seconds, in case of MIDIs that never end
+constexpr int MIDI_RENDER_MAX_TAIL    = 5;    // Seconds to render after the end for notes to fade out
+
+#ifndef NO_FLUIDSYNTH
+shared_ptr<SoundfontSet> current_soundfonts;
+std::mutex               current_soundfonts_mutex;
+#endif
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// External Variables
+//
+// -----------------------------------------------------------------------------
+EXTERN_CVAR(String, fs_soundfont_path)
+
+
+#ifndef NO_FLUIDSYNTH
+// -----------------------------------------------------------------------------
+//
+// SoundfontSet Class Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// SoundfontSet class constructor
+//
+// Loads all soundfonts in [paths] (separated by ';' on Windows, ':' otherwise)
+// -----------------------------------------------------------------------------
+SoundfontSet::SoundfontSet(string_view paths)
+{
+	// The soundfonts are loaded by a synth with no audio driver, which is only
+	// kept around so they stay loaded
+	settings_ = new_fluid_settings();
+	synth_    = new_fluid_synth(settings_);
+	if (!synth_)
+	{
+		log::warning("Failed to initialise FluidSynth, unable to load soundfonts");
+		return;
+	}
+
+	// Load soundfonts (in reverse order, so the first is on top of the stack)
+	char separator = app::platform() == app::Platform::Windows ? ';' : ':';
+	auto split     = strutil::split(paths, separator);
+	for (int a = split.size() - 1; a >= 0; --a)
+	{
+		auto path = split[a];
+		if (path.empty())
+			continue;
+
+		int fs_id = fluid_synth_sfload(synth_, path.c_str(), 1);
+		if (fs_id == FLUID_FAILED)
+		{
+			log::warning("Unable to load soundfont \"{}\"", path);
+			continue;
+		}
+
+		if (auto sfont = fluid_synth_get_sfont_by_id(synth_, fs_id))
+			sfonts_.push_back(sfont);
+	}
+}
+
+// -----------------------------------------------------------------------------
+// SoundfontSet class destructor
+//
+// All synths the soundfonts were added to must have had them removed (or have
+// been deleted) by now
+// -----------------------------------------------------------------------------
+SoundfontSet::~SoundfontSet()
+{
+	if (synth_)
+		delete_fluid_synth(synth_);
+	delete_fluid_settings(settings_);
+}
+
+// -----------------------------------------------------------------------------
+// Adds the soundfonts to [synth], in the same order they were loaded.
+// They must be removed via removeFrom before [synth] is deleted
+// -----------------------------------------------------------------------------
+void SoundfontSet::addTo(fluid_synth_t* synth) const
+{
+	// Synths can be created on any thread, and adding a soundfont to a synth
+	// (re)sets its id
+	std::lock_guard lock(mutex_);
+
+	for (auto* sfont : sfonts_)
+		fluid_synth_add_sfont(synth, sfont);
+}
+
+// -----------------------------------------------------------------------------
+// Removes the soundfonts from [synth], without unloading them
+// -----------------------------------------------------------------------------
+void SoundfontSet::removeFrom(fluid_synth_t* synth) const
+{
+	std::lock_guard lock(mutex_);
+
+	for (auto* sfont : sfonts_)
+		fluid_synth_remove_sfont(synth, sfont);
+}
+#endif // !NO_FLUIDSYNTH
+
+
+// -----------------------------------------------------------------------------
+//
+// Local Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+constexpr unsigned WAV_HEADER_SIZE = 44;
+
+// -----------------------------------------------------------------------------
+// Writes the header of a 16-bit stereo WAV file with [data_size] bytes of
+// samples to the start of [out]
+// -----------------------------------------------------------------------------
+void writeRenderedWavHeader(MemChunk& out, u32 data_size)
+{
+	u32 riff_size   = data_size + 36;
+	u32 fmt_size    = 16;
+	u16 tag         = 1; // PCM
+	u16 channels    = 2;
+	u32 sample_rate = MIDI_RENDER_SAMPLE_RATE;
+	u16 block_size  = channels * sizeof(i16);
+	u32 data_rate   = sample_rate * block_size;
+	u16 bps         = 16;
+
+	out.seek(0, SEEK_SET);
+	out.write("RIFF", 4);
+	out.write(&riff_size, 4);
+	out.write("WAVEfmt ", 8);
+	out.write(&fmt_size, 4);
+	out.write(&tag, 2);
+	out.write(&channels, 2);
+	out.write(&sample_rate, 4);
+	out.write(&data_rate, 4);
+	out.write(&block_size, 2);
+	out.write(&bps, 2);
+	out.write("data", 4);
+	out.write(&data_size, 4);
+}
+
+#ifndef NO_FLUIDSYNTH
+// -----------------------------------------------------------------------------
+// Renders up to [max_length] seconds of [midi] to [wav] with a new synth using
+// [soundfonts]. Samples are written straight into [wav] after its header.
+// Returns false if rendering failed or was cancelled via [cancel]
+// -----------------------------------------------------------------------------
+bool renderMIDIWith(
+	const SoundfontSet&      soundfonts,
+	const MemChunk&          midi,
+	MemChunk&                wav,
+	const std::atomic<bool>* cancel,
+	int                      max_length)
+{
+	// Setup a synth with no audio driver. The player is timed by the samples
+	// the synth writes (rather than the system clock), so the MIDI is played
+	// as fast as it can be rendered
+	auto settings = new_fluid_settings();
+	fluid_settings_setnum(settings, "synth.sample-rate", MIDI_RENDER_SAMPLE_RATE);
+	fluid_settings_setstr(settings, "player.timing-source", "sample");
+	fluid_settings_setint(settings, "synth.lock-memory", 0);
+	auto synth = new_fluid_synth(settings);
+	if (!synth)
+	{
+		delete_fluid_settings(settings);
+		return false;
+	}
+	soundfonts.addTo(synth);
+
+	// Open midi
+	auto player = new_fluid_player(synth);
+	bool ok     = player && fluid_player_add_mem(player, midi.data(), midi.size()) == FLUID_OK
+			  && fluid_player_play(player) == FLUID_OK;
+
+	if (ok)
+	{
+		constexpr unsigned block_bytes = MIDI_RENDER_BLOCK_SIZE * 2 * sizeof(i16);
+		const unsigned     bytes_per_s = MIDI_RENDER_SAMPLE_RATE * 2 * sizeof(i16);
+		const unsigned     max_bytes   = WAV_HEADER_SIZE + (max_length + MIDI_RENDER_MAX_TAIL) * bytes_per_s;
+		i16                block[MIDI_RENDER_BLOCK_SIZE * 2];
+
+		// Allocate enough for the expected length up front, so the samples
+		// don't need to be copied as the chunk grows (usually)
+		auto expected_length = std::min(audio::midiLength(midi) / 1000 + 1, max_length) + MIDI_RENDER_MAX_TAIL;
+		wav.clear();
+		wav.reSize(WAV_HEADER_SIZE + expected_length * bytes_per_s, false);
+		wav.seek(WAV_HEADER_SIZE, SEEK_SET);
+
+		// Appends the current block to the wav data
+		auto write_block = [&]() {
+			if (wav.currentPos() + block_bytes > wav.size())
+				wav.reSize(std::min(std::max(wav.size() * 2, wav.currentPos() + block_bytes), max_bytes));
+			wav.write(block, block_bytes);
+		};
+
+		// Render until the player reaches the end of the MIDI
+		const unsigned max_data = WAV_HEADER_SIZE + max_length * bytes_per_s;
+		while (fluid_player_get_status(player) == FLUID_PLAYER_PLAYING && wav.currentPos() < max_data)
+		{
+			if (cancel && *cancel)
+			{
+				ok = false;
+				break;
+			}
+
+			fluid_synth_write_s16(synth, MIDI_RENDER_BLOCK_SIZE, block, 0, 2, block, 1, 2);
+			write_block();
+		}
+
+		// Keep rendering until any notes still sounding have faded out
+		int tail = 0;
+		while (ok && tail < MIDI_RENDER_MAX_TAIL * MIDI_RENDER_SAMPLE_RATE)
+		{
+			fluid_synth_write_s16(synth, MIDI_RENDER_BLOCK_SIZE, block, 0, 2, block, 1, 2);
+			if (std::all_of(block, block + MIDI_RENDER_BLOCK_SIZE * 2, [](i16 s) { return s == 0; }))
+				break;
+
+			write_block();
+			tail += MIDI_RENDER_BLOCK_SIZE;
+		}
+	}
+
+	// Clean up
+	if (player)
+	{
+		fluid_player_stop(player);
+		delete_fluid_player(player);
+	}
+	soundfonts.removeFrom(synth);
+	delete_fluid_synth(synth);
+	delete_fluid_settings(settings);
+
+	if (!ok)
+	{
+		wav.clear();
+		return false;
+	}
+
+	// Trim any unused space and fill in the header
+	auto data_size = wav.currentPos() - WAV_HEADER_SIZE;
+	if (wav.size() > wav.currentPos())
+		wav.reSize(wav.currentPos());
+	writeRenderedWavHeader(wav, data_size);
+
+	return true;
+}
+#endif
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// audio Namespace Functions
+//
+// -----------------------------------------------------------------------------
+namespace slade::audio
+{
+#ifndef NO_FLUIDSYNTH
+// -----------------------------------------------------------------------------
+// Returns the current shared soundfont set, loading it first if needed.
+// Can be called from any thread
+// -----------------------------------------------------------------------------
+shared_ptr<SoundfontSet> soundfonts()
+{
+	{
+		std::lock_guard lock(current_soundfonts_mutex);
+		if (current_soundfonts)
+			return current_soundfonts;
+	}
+
+	return reloadSoundfonts();
+}
+
+// -----------------------------------------------------------------------------
+// (Re)loads the shared soundfont set from the fs_soundfont_path cvar.
+// The previous set stays loaded until all synths using it are done with it
+// -----------------------------------------------------------------------------
+shared_ptr<SoundfontSet> reloadSoundfonts()
+{
+	std::lock_guard lock(current_soundfonts_mutex);
+
+	// Init soundfont path
+	if (fs_soundfont_path.value.empty())
+	{
+		if (app::platform() == app::Platform::Linux)
+			fs_soundfont_path = "/usr/share/sounds/sf2/FluidR3_GM.sf2:/usr/share/sounds/sf2/FluidR3_GS.sf2";
+		else
+			log::warning(1, "No FluidSynth soundfont set, MIDI playback will not work");
+	}
+
+	current_soundfonts = std::make_shared<SoundfontSet>(fs_soundfont_path.value);
+	return current_soundfonts;
+}
+#endif
+
+// -----------------------------------------------------------------------------
+// Returns true if MIDI can be rendered to audio (ie. fluidsynth is available
+// and has a soundfont loaded)
+// -----------------------------------------------------------------------------
+bool canRenderMIDI()
+{
+#ifndef NO_FLUIDSYNTH
+	return soundfonts()->isLoaded();
+#else
+	return false;
+#endif
+}
+
+// -----------------------------------------------------------------------------
+// Renders [midi] to [wav] as 16-bit stereo PCM, stopping after [max_length]
+// seconds (or a default maximum if 0).
+// Rendering can be cancelled from another thread by setting [cancel] to true.
+// Returns false if rendering failed or was cancelled
+// -----------------------------------------------------------------------------
+bool renderMIDI(const MemChunk& midi, MemChunk& wav, const std::atomic<bool>* cancel, int max_length)
+{
+#ifndef NO_FLUIDSYNTH
+	auto sf = soundfonts();
+	if (!sf->isLoaded())
+		return false;
+
+	return renderMIDIWith(*sf, midi, wav, cancel, max_length > 0 ? max_length : MIDI_RENDER_MAX_LENGTH);
+#else
+	return false;
+#endif
+}
+
+// -----------------------------------------------------------------------------
+// Renders all [renders] in parallel (on the thread pool), each with its own
+// synth sharing the current soundfonts.
+// Returns the number of MIDIs successfully rendered
+// -----------------------------------------------------------------------------
+unsigned renderMIDIs(vector<MIDIRender>& renders)
+{
+#ifndef NO_FLUIDSYNTH
+	auto sf = soundfonts();
+	if (!sf->isLoaded())
+		return 0;
+
+	std::atomic<unsigned> count{ 0 };
+	app::threadPool().parallelFor(renders.size(), [&](size_t index) {
+		auto& render    = renders[index];
+		render.rendered = render.midi && renderMIDIWith(*sf, *render.midi, render.wav, nullptr, MIDI_RENDER_MAX_LENGTH);
+		if (render.rendered)
+			++count;
+	});
+
+	return count;
+#else
+	return 0;
+#endif
+}
+} // namespace slade::audio
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <atomic>
+#include <mutex>
+
+namespace slade::audio
+{
+#ifndef NO_FLUIDSYNTH
+// A set of soundfonts that are loaded once and shared between any number of
+// fluidsynth synths (the MIDIPlayer and offline renders), so that each synth
+// doesn't need to load its own copy
+class SoundfontSet
+{
+public:
+	SoundfontSet(string_view paths);
+	~SoundfontSet();
+
+	SoundfontSet(const SoundfontSet&)            = delete;
+	SoundfontSet& operator=(const SoundfontSet&) = delete;
+
+	bool isLoaded() const { return !sfonts_.empty(); }
+
+	void addTo(fluid_synth_t* synth) const;
+	void removeFrom(fluid_synth_t* synth) const;
+
+private:
+	fluid_settings_t*      settings_ = nullptr;
+	fluid_synth_t*         synth_    = nullptr; // Synth the soundfonts are loaded by (not used for playback)
+	vector<fluid_sfont_t*> sfonts_;
+	mutable std::mutex     mutex_;
+};
+
+shared_ptr<SoundfontSet> soundfonts();
+shared_ptr<SoundfontSet> reloadSoundfonts();
+#endif
+
+// A MIDI to render with renderMIDIs
+struct MIDIRender
+{
+	const MemChunk* midi     = nullptr; // MIDI data to render
+	MemChunk        wav;                // Rendered audio (16-bit stereo 44.1kHz WAV)
+	bool            rendered = false;
+};
+
+bool     canRenderMIDI();
+bool     renderMIDI(
+		const MemChunk&          midi,
+		MemChunk&                wav,
+		const std::atomic<bool>* cancel     = nullptr,
+		int                      max_length = 0);
+unsigned renderMIDIs(vector<MIDIRender>& renders);
+} // namespace slade::audio
@@ -106,6 +106,7 @@ bool Mp3Music::openFromFile(const std::string& filename)
 
 	if (handle_)
 		mpg123_close(handle_);
+	scanned_ = false;
 
 	if (mpg123_open(handle_, filename.c_str()) != MPG123_OK)
 	{
@@ -147,6 +148,7 @@ bool Mp3Music::loadFromMemory(void* data, size_t size_in_bytes)
 
 	if (handle_)
 		mpg123_close(handle_);
+	scanned_ = false;
 
 	auto mp3_data = new Mp3MemoryData{ data, size_in_bytes, 0 };
 	if (!mp3_data)
@@ -221,7 +223,22 @@ void Mp3Music::onSeek(sf::Time time_offset)
 {
 	sf::Lock lock(mutex_);
 
+	if (!handle_)
+		return;
+
+	// mpg123 keeps a (fixed size) index of frame positions, but only for the
+	// frames it has read so far, so seeking past them means reading through
+	// every frame in between. Scanning fills in the index for the whole stream
+	// (only frame headers are parsed, nothing is decoded) so that this and any
+	// later seeks can jump close to the target frame. It's done on the first
+	// seek (other than back to the start, eg. when stopped) rather than when
+	// opening so that playback can start immediately
+	if (!scanned_ && time_offset > sf::Time::Zero)
+	{
+		mpg123_scan(handle_);
+		scanned_ = true;
+	}
+
 	// tschumacher: sampleoff must be (seconds * samplingRate) to make this working correctly
-	if (handle_)
-		mpg123_seek(handle_, static_cast<off_t>(time_offset.asSeconds() * sampling_rate_), SEEK_SET);
+	mpg123_seek(handle_, static_cast<off_t>(time_offset.asSeconds() * sampling_rate_), SEEK_SET);
 }
@@ -25,5 +25,6 @@ private:
 	unsigned char* buffer_      = nullptr;
 	sf::Mutex      mutex_;
 	long           sampling_rate_ = 0;
+	bool           scanned_       = false; // Whether the seek index has been built for the whole stream
 };
 } // namespace slade::audio
@@ -32,8 +32,12 @@
 #include "Main.h"
 #include "App.h"
 #include <fmt/chrono.h>
+#include <condition_variable>
+#include <deque>
 #include <fmt/format.h>
 #include <fstream>
+#include <mutex>
+#include <thread>
 
 using namespace slade;
 
@@ -45,10 +49,166 @@ using namespace slade;
 // -----------------------------------------------------------------------------
 namespace slade::log
 {
-vector<Message> log;
-std::ofstream   log_file;
+std::deque<Message> log; // Most recent messages, up to log_history_size
+uint64_t            next_sequence = 0;
+std::ofstream       log_file;
+std::mutex          log_mutex; // Messages can be logged from worker threads
 } // namespace slade::log
+namespace
+{
+constexpr auto log_flush_interval = std::chrono::seconds(1);
+
+// Writes lines to the log file on a background thread, so that logging doesn't
+// wait on file I/O. Lines are written in batches and the file is flushed at
+// least every log_flush_interval (or immediately when requested, eg. for
+// errors)
+class LogFileWriter
+{
+public:
+	~LogFileWriter() { stop(); }
+
+	void start()
+	{
+		std::lock_guard lock(mutex_);
+		if (running_)
+			return;
+
+		running_ = true;
+		thread_  = std::thread([this] { run(); });
+	}
+
+	void stop()
+	{
+		{
+			std::lock_guard lock(mutex_);
+			if (!running_ || stop_)
+				return;
+			stop_ = true;
+		}
+		cv_.notify_one();
+		thread_.join();
+
+		// Write anything that was added after the writer thread finished
+		std::lock_guard lock(mutex_);
+		for (const auto& line : queue_)
+			log::log_file << line << '\n';
+		queue_.clear();
+		log::log_file.flush();
+		running_ = false;
+		stop_    = false;
+	}
+
+	void write(string line, bool flush)
+	{
+		std::lock_guard lock(mutex_);
+
+		// Write directly if the writer thread isn't running
+		if (!running_)
+		{
+			if (log::log_file.is_open())
+			{
+				log::log_file << line << '\n';
+				if (flush)
+					log::log_file.flush();
+			}
+			return;
+		}
+
+		queue_.push_back(std::move(line));
+		flush_ = flush_ || flush;
+
+		// Only wake the writer when needed, otherwise lines are written
+		// when it next wakes up to flush
+		if (flush || queue_.size() >= 1000)
+			cv_.notify_one();
+	}
+
+private:
+	std::thread             thread_;
+	std::mutex              mutex_;
+	std::condition_variable cv_;
+	vector<string>          queue_;
+	bool                    running_ = false;
+	bool                    flush_   = false;
+	bool                    stop_    = false;
+
+	void run()
+	{
+		auto             last_flush = std::chrono::steady_clock::now();
+		vector<string>   lines;
+		std::unique_lock lock(mutex_);
+		while (true)
+		{
+			cv_.wait_for(lock, log_flush_interval, [this] { return stop_ || flush_ || !queue_.empty(); });
+
+			lines.swap(queue_);
+			const bool flush = flush_ || stop_;
+			const bool stop  = stop_;
+			flush_           = false;
+			lock.unlock();
+
+			for (const auto& line : lines)
+				log::log_file << line << '\n';
+			lines.clear();
+
+			const auto now = std::chrono::steady_clock::now();
+			if (flush || now - last_flush >= log_flush_interval)
+			{
+				log::log_file.flush();
+				last_flush = now;
+			}
+
+			lock.lock();
+			if (stop && queue_.empty())
+				break;
+		}
+	}
+};
+LogFileWriter log_writer;
+
+// Stream buffer for sf::err() that sends each line written to it to the log
+// file writer. SFML can write errors from its own threads (eg. audio), so the
+// current line is guarded by the log mutex
+class SFMLErrorBuf : public std::streambuf
+{
+protected:
+	int overflow(int c) override
+	{
+		std::lock_guard lock(log::log_mutex);
+		if (c != traits_type::eof())
+			put(static_cast<char>(c));
+
+		return c;
+	}
+
+	std::streamsize xsputn(const char* s, std::streamsize count) override
+	{
+		std::lock_guard lock(log::log_mutex);
+		for (std::streamsize a = 0; a < count; ++a)
+			put(s[a]);
+
+		return count;
+	}
+
+private:
+	string line_;
+
+	void put(char c)
+	{
+		if (c == '\n')
+		{
+			log_writer.write(line_, false);
+			line_.clear();
+		}
+		else
+			line_ += c;
+	}
+};
+SFMLErrorBuf    sfml_error_buf;
+std::streambuf* sfml_error_buf_prev = nullptr; // The original sf::err() buffer, restored in log::close
+} // namespace
 CVAR(Int, log_verbosity, 1, CVar::Flag::Save)
+CVAR(Int, log_history_size, 10000, CVar::Flag::Save)
 
 
 // -----------------------------------------------------------------------------
@@ -127,7 +287,8 @@ void log::init()
 {
 	// Redirect sf::err output to the log file
 	log_file.open(app::path("slade3.log", app::Dir::User));
-	sf::err().rdbuf(log_file.rdbuf());
+	sfml_error_buf_prev = sf::err().rdbuf(&sfml_error_buf);
+	log_writer.start();
 
 	// Write logfile header
 	auto t  = std::time(nullptr);
@@ -158,11 +319,38 @@ void log::init()
 }
 
 // -----------------------------------------------------------------------------
-// Returns the log message history
+// Closes the log file, writing any log messages that haven't been written yet.
+// Any messages logged after this are written to the file immediately (if it is
+// still open)
+// -----------------------------------------------------------------------------
+void log::close()
+{
+	// Stop sending sf::err output to the log
+	{
+		std::lock_guard lock(log_mutex);
+		if (sfml_error_buf_prev)
+		{
+			sf::err().rdbuf(sfml_error_buf_prev);
+			sfml_error_buf_prev = nullptr;
+		}
+	}
+
+	log_writer.stop();
+}
+
+// -----------------------------------------------------------------------------
+// Returns the most recent [count] log messages, or all messages in the history
+// if [count] is 0. The history only keeps the most recent log_history_size
+// messages
 // -----------------------------------------------------------------------------
-const vector<log::Message>& log::history()
+vector<log::Message> log::history(unsigned count)
 {
-	return log;
+	std::lock_guard lock(log_mutex);
+
+	if (count == 0 || count > log.size())
+		count = log.size();
+
+	return { log.end() - count, log.end() };
 }
 
 // -----------------------------------------------------------------------------
@@ -182,25 +370,44 @@ void log::setVerbosity(int verbosity)
 	log_verbosity = verbosity;
 }
 
+// -----------------------------------------------------------------------------
+// Returns true if messages at verbosity [level] will be logged. Can be used to
+// avoid building a log message that would be discarded anyway
+// -----------------------------------------------------------------------------
+bool log::enabled(int level)
+{
+	return level <= log_verbosity;
+}
+
 // -----------------------------------------------------------------------------
 // Logs a message [text] of [type]
 // -----------------------------------------------------------------------------
 void log::message(MessageType type, string_view text)
 {
+	std::lock_guard lock(log_mutex);
+
 	// Add log message
-	auto t = std::time(nullptr);
-	log.emplace_back(text, type, *std::localtime(&t));
+	auto  t      = std::time(nullptr);
+	auto& msg    = log.emplace_back(text, type, *std::localtime(&t));
+	msg.sequence = next_sequence++;
+
+	// Remove the oldest message(s) if the history is full
+	const auto max_size = static_cast<unsigned>(std::max(static_cast<int>(log_history_size), 100));
+	while (log.size() > max_size)
+		log.pop_front();
 
 	// Write to log file
-	if (log_file.is_open() && type != MessageType::Console) {
-		sf::err() << log.back().formattedMessageLine() << "\n";
-		sf::err().flush();
-	}
+	if (log_file.is_open() && type != MessageType::Console)
+		log_writer.write(msg.formattedMessageLine(), type == MessageType::Error);
 }
 
 void log::message(MessageType type, int level, string_view text, fmt::format_args args)
 {
-	message(type, level, fmt::vformat(text, args));
+	// Don't bother formatting the message if it won't be logged
+	if (level > log_verbosity)
+		return;
+
+	message(type, fmt::vformat(text, args));
 }
 
 void log::message(MessageType type, string_view text, fmt::format_args args)
@@ -211,15 +418,41 @@ void log::message(MessageType type, string_view text, fmt::format_args args)
 // -----------------------------------------------------------------------------
 // Returns a list of log messages of [type] that have been recorded since [time]
 // -----------------------------------------------------------------------------
-vector<log::Message*> log::since(time_t time, MessageType type)
+vector<log::Message> log::since(time_t time, MessageType type)
 {
-	vector<Message*> list;
-	for (auto& msg : log)
-		if (mktime(&msg.timestamp) >= time && (type == MessageType::Any || msg.type == type))
-			list.push_back(&msg);
+	std::lock_guard lock(log_mutex);
+
+	// Messages are in time order, so go back from the most recent until one
+	// is older than [time]
+	auto first = log.end();
+	while (first != log.begin() && mktime(&std::prev(first)->timestamp) >= time)
+		--first;
+
+	vector<Message> list;
+	for (auto i = first; i != log.end(); ++i)
+		if (type == MessageType::Any || i->type == type)
+			list.push_back(*i);
 	return list;
 }
 
+// -----------------------------------------------------------------------------
+// Returns all log messages with a sequence number of [sequence] or later that
+// are still in the history
+// -----------------------------------------------------------------------------
+vector<log::Message> log::messagesSince(uint64_t sequence)
+{
+	std::lock_guard lock(log_mutex);
+
+	if (log.empty() || sequence >= next_sequence)
+		return {};
+
+	// Get the position of [sequence] in the history
+	auto first_sequence = log.front().sequence;
+	auto first          = sequence > first_sequence ? log.begin() + (sequence - first_sequence) : log.begin();
+
+	return { first, log.end() };
+}
+
 // -----------------------------------------------------------------------------
 // Logs a debug message [text] at verbosity [level] only if debug mode is on
 // -----------------------------------------------------------------------------
@@ -258,11 +491,5 @@ void log::message(MessageType type, int level, string_view text)
 	if (level > log_verbosity)
 		return;
 
-	// Add log message
-	auto t = std::time(nullptr);
-	log.emplace_back(text, type, *std::localtime(&t));
-
-	// Write to log file
-	if (log_file.is_open() && type != MessageType::Console)
-		sf::err() << log.back().formattedMessageLine() << "\n";
+	message(type, text);
 }
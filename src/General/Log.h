@@ -20,6 +20,7 @@ namespace log
 		string      message;
 		MessageType type;
 		std::tm     timestamp;
+		uint64_t    sequence = 0; // Number of messages logged before this one
 
 		Message(string_view message, MessageType type, std::tm timestamp) :
 			message{ message.data(), message.size() }, type{ type }, timestamp{ timestamp }
@@ -29,15 +30,18 @@ namespace log
 		string formattedMessageLine() const;
 	};
 
-	const vector<Message>& history();
-	int                    verbosity();
-	void                   setVerbosity(int verbosity);
-	void                   init();
-	void                   message(MessageType type, int level, string_view text);
-	void                   message(MessageType type, string_view text);
-	void                   message(MessageType type, int level, string_view text, fmt::format_args args);
-	void                   message(MessageType type, string_view text, fmt::format_args args);
-	vector<Message*>       since(time_t time, MessageType type = MessageType::Any);
+	vector<Message> history(unsigned count = 0);
+	int             verbosity();
+	void            setVerbosity(int verbosity);
+	bool            enabled(int level);
+	void            init();
+	void            close();
+	void            message(MessageType type, int level, string_view text);
+	void            message(MessageType type, string_view text);
+	void            message(MessageType type, int level, string_view text, fmt::format_args args);
+	void            message(MessageType type, string_view text, fmt::format_args args);
+	vector<Message> since(time_t time, MessageType type = MessageType::Any);
+	vector<Message> messagesSince(uint64_t sequence);
 
 
 	// Message shortcuts by type
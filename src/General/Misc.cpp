@@ -503,6 +503,105 @@ uint32_t misc::crc(const uint8_t* buf, uint32_t len)
 	return update_crc(0xffffffffL, buf, len) ^ 0xffffffffL;
 }
 
+// XXH64 constants and helpers
+namespace
+{
+constexpr uint64_t XXH_PRIME1 = 0x9E3779B185EBCA87ULL;
+constexpr uint64_t XXH_PRIME2 = 0xC2B2AE3D27D4EB4FULL;
+constexpr uint64_t XXH_PRIME3 = 0x165667B19E3779F9ULL;
+constexpr uint64_t XXH_PRIME4 = 0x85EBCA77C2B2AE63ULL;
+constexpr uint64_t XXH_PRIME5 = 0x27D4EB2F165667C5ULL;
+
+uint64_t xxhRotl(uint64_t val, int bits)
+{
+	return (val << bits) | (val >> (64 - bits));
+}
+
+uint64_t xxhRead64(const uint8_t* p)
+{
+	uint64_t val = 0;
+	for (int a = 7; a >= 0; a--)
+		val = (val << 8) | p[a];
+	return val;
+}
+
+uint32_t xxhRead32(const uint8_t* p)
+{
+	return p[0] | (p[1] << 8) | (p[2] << 16) | (static_cast<uint32_t>(p[3]) << 24);
+}
+
+uint64_t xxhRound(uint64_t acc, uint64_t input)
+{
+	acc += input * XXH_PRIME2;
+	acc  = xxhRotl(acc, 31);
+	return acc * XXH_PRIME1;
+}
+
+uint64_t xxhMergeRound(uint64_t acc, uint64_t val)
+{
+	acc ^= xxhRound(0, val);
+	return acc * XXH_PRIME1 + XXH_PRIME4;
+}
+} // namespace
+
+// -----------------------------------------------------------------------------
+// Returns a 64-bit hash of the bytes [buf][0..len-1].
+// This is XXH64 (with a seed of 0), a fast non-cryptographic hash suitable for
+// detecting identical data
+// -----------------------------------------------------------------------------
+uint64_t misc::hash64(const uint8_t* buf, size_t len)
+{
+	const uint8_t* p   = buf;
+	const uint8_t* end = buf + len;
+	uint64_t       hash;
+
+	if (len >= 32)
+	{
+		// Process 32 byte stripes
+		uint64_t v1 = XXH_PRIME1 + XXH_PRIME2;
+		uint64_t v2 = XXH_PRIME2;
+		uint64_t v3 = 0;
+		uint64_t v4 = 0 - XXH_PRIME1;
+		for (; p + 32 <= end; p += 32)
+		{
+			v1 = xxhRound(v1, xxhRead64(p));
+			v2 = xxhRound(v2, xxhRead64(p + 8));
+			v3 = xxhRound(v3, xxhRead64(p + 16));
+			v4 = xxhRound(v4, xxhRead64(p + 24));
+		}
+
+		hash = xxhRotl(v1, 1) + xxhRotl(v2, 7) + xxhRotl(v3, 12) + xxhRotl(v4, 18);
+		hash = xxhMergeRound(hash, v1);
+		hash = xxhMergeRound(hash, v2);
+		hash = xxhMergeRound(hash, v3);
+		hash = xxhMergeRound(hash, v4);
+	}
+	else
+		hash = XXH_PRIME5;
+
+	hash += len;
+
+	// Remaining bytes
+	for (; p + 8 <= end; p += 8)
+		hash = xxhRotl(hash ^ xxhRound(0, xxhRead64(p)), 27) * XXH_PRIME1 + XXH_PRIME4;
+	if (p + 4 <= end)
+	{
+		hash = xxhRotl(hash ^ (xxhRead32(p) * XXH_PRIME1), 23) * XXH_PRIME2 + XXH_PRIME3;
+		p += 4;
+	}
+	for (; p < end; ++p)
+		hash = xxhRotl(hash ^ (*p * XXH_PRIME5), 11) * XXH_PRIME1;
+
+	// Avalanche
+	hash ^= hash >> 33;
+	hash *= XXH_PRIME2;
+	hash ^= hash >> 29;
+	hash *= XXH_PRIME3;
+	hash ^= hash >> 32;
+
+	return hash;
+}
+
 
 // -----------------------------------------------------------------------------
 // Find the given name in a texture lump and returns a point2_t which contains
@@ -34,6 +34,7 @@ namespace misc
 	string   lumpNameToFileName(string_view lump);
 	string   fileNameToLumpName(string_view file);
 	uint32_t crc(const uint8_t* buf, uint32_t len);
+	uint64_t hash64(const uint8_t* buf, size_t len);
 	Vec2i    findJaguarTextureDimensions(ArchiveEntry* entry, string_view name);
 
 	// Mass Rename
@@ -339,7 +339,7 @@ void CTexture::copyTexture(const CTexture& tex, bool keep_type)
 	clear();
 
 	// Copy texture info
-	name_          = tex.name_;
+	setName(tex.name_);
 	size_          = tex.size_;
 	def_size_      = tex.def_size_;
 	scale_         = tex.scale_;
@@ -414,12 +414,24 @@ int CTexture::index() const
 	return in_list_->textureIndex(name());
 }
 
+// -----------------------------------------------------------------------------
+// Sets the texture's name to [name]
+// -----------------------------------------------------------------------------
+void CTexture::setName(string_view name)
+{
+	name_ = name;
+
+	// Parent list's name index is now out of date
+	if (in_list_)
+		in_list_->name_index_valid_ = false;
+}
+
 // -----------------------------------------------------------------------------
 // Clears all texture data
 // -----------------------------------------------------------------------------
 void CTexture::clear()
 {
-	name_          = "";
+	setName("");
 	size_          = { 0, 0 };
 	def_size_      = { 0, 0 };
 	scale_         = { 1., 1. };
@@ -947,20 +959,13 @@ bool CTexture::loadPatchImage(unsigned pindex, SImage& image, Archive* parent, P
 		// Search the texture list we're in first
 		if (in_list_)
 		{
-			for (unsigned a = 0; a < in_list_->size(); a++)
+			// Don't look past this texture in the list
+			auto index = in_list_->textureIndex(patch->name());
+			auto self  = in_list_->textureIndex(name_);
+			if (index >= 0 && (self < 0 || index < self))
 			{
-				auto* tex = in_list_->texture(a);
-
-				// Don't look past this texture in the list
-				if (tex->name() == name_)
-					break;
-
-				// Check for name match
-				if (strutil::equalCI(tex->name(), patch->name()))
-				{
-					// Load texture to image
-					return tex->toImage(image, parent, pal, force_rgba);
-				}
+				// Load texture to image
+				return in_list_->texture(index)->toImage(image, parent, pal, force_rgba);
 			}
 		}
 
@@ -65,14 +65,11 @@ PatchTable::Patch& PatchTable::patch(size_t index)
 // -----------------------------------------------------------------------------
 PatchTable::Patch& PatchTable::patch(string_view name)
 {
-	// Go through list
-	for (auto& patch : patches_)
-	{
-		if (patch.name == name)
-			return patch;
-	}
+	auto index = patchIndex(name);
+	if (index < 0)
+		return patch_invalid_;
 
-	return patch_invalid_;
+	return patches_[index];
 }
 
 // -----------------------------------------------------------------------------
@@ -113,15 +110,11 @@ ArchiveEntry* PatchTable::patchEntry(size_t index)
 // -----------------------------------------------------------------------------
 ArchiveEntry* PatchTable::patchEntry(string_view name)
 {
-	// Search for patch by name
-	for (size_t a = 0; a < patches_.size(); a++)
-	{
-		if (strutil::equalCI(patches_[a].name, name))
-			return patchEntry(a);
-	}
+	auto index = patchIndex(name);
+	if (index < 0)
+		return nullptr;
 
-	// Not found
-	return nullptr;
+	return patchEntry(index);
 }
 
 // -----------------------------------------------------------------------------
@@ -129,12 +122,12 @@ ArchiveEntry* PatchTable::patchEntry(string_view name)
 // -----------------------------------------------------------------------------
 int32_t PatchTable::patchIndex(string_view name) const
 {
+	updateNameIndex();
+
 	// Search for patch by name
-	for (size_t a = 0; a < patches_.size(); a++)
-	{
-		if (strutil::equalCI(patches_[a].name, name))
-			return a;
-	}
+	auto i = name_index_.find(strutil::upper(name));
+	if (i != name_index_.end())
+		return i->second;
 
 	// Not found
 	return -1;
@@ -146,6 +139,12 @@ int32_t PatchTable::patchIndex(string_view name) const
 // -----------------------------------------------------------------------------
 int32_t PatchTable::patchIndex(ArchiveEntry* entry) const
 {
+	// Check the patch named after the entry first, this will almost always be
+	// the one
+	auto index = patchIndex(entry->upperNameNoExt());
+	if (index >= 0 && app::resources().getPatchEntry(patches_[index].name, "patches", parent_) == entry)
+		return index;
+
 	// Search for patch by entry
 	for (size_t a = 0; a < patches_.size(); a++)
 	{
@@ -169,6 +168,7 @@ bool PatchTable::removePatch(unsigned index)
 
 	// Remove the patch
 	patches_.erase(patches_.begin() + index);
+	name_index_valid_ = false;
 
 	// Announce
 	signals_.modified();
@@ -190,6 +190,7 @@ bool PatchTable::replacePatch(unsigned index, string_view newname)
 
 	// Change the patch name
 	patches_[index].name = newname;
+	name_index_valid_    = false;
 
 	// Announce
 	signals_.modified();
@@ -203,17 +204,13 @@ bool PatchTable::replacePatch(unsigned index, string_view newname)
 bool PatchTable::addPatch(string_view name, bool allow_dup)
 {
 	// Check patch doesn't already exist
-	if (!allow_dup)
-	{
-		for (auto& patch : patches_)
-		{
-			if (name == patch.name)
-				return false;
-		}
-	}
+	if (!allow_dup && patchIndex(name) >= 0)
+		return false;
 
 	// Add the patch
 	patches_.emplace_back(name);
+	if (name_index_valid_)
+		name_index_.emplace(strutil::upper(name), patches_.size() - 1);
 
 	// Announce
 	signals_.modified();
@@ -230,11 +227,9 @@ bool PatchTable::loadPNAMES(ArchiveEntry* pnames, Archive* parent)
 	if (!pnames)
 		return false;
 
-	// Mute while loading
-	signals_.modified.block();
-
 	// Clear current table
 	patches_.clear();
+	name_index_valid_ = false;
 
 	// Setup parent archive
 	if (!parent)
@@ -242,37 +237,32 @@ bool PatchTable::loadPNAMES(ArchiveEntry* pnames, Archive* parent)
 
 	// Read number of pnames
 	uint32_t n_pnames = 0;
-	pnames->seek(0, SEEK_SET);
-	if (!pnames->read(&n_pnames, 4))
+	auto&    data     = pnames->data();
+	if (!data.read(0, &n_pnames, 4))
 	{
 		log::error("PNAMES lump is corrupt");
+		signals_.modified();
 		return false;
 	}
 
-	// Read pnames content
-	for (uint32_t a = 0; a < n_pnames; a++)
-	{
-		char pname[9] = "";
-		pname[8]      = 0;
-
-		// Try to read pname
-		if (!pnames->read(&pname, 8))
-		{
-			log::error("PNAMES entry {} is corrupt", a);
-			return false;
-		}
-
-		// Add new patch
-		addPatch(strutil::upper(pname), true);
-	}
+	// Read pnames content (all at once)
+	auto n_valid = std::min<uint32_t>(n_pnames, (data.size() - 4) / 8);
+	patches_.reserve(n_valid);
+	for (uint32_t a = 0; a < n_valid; a++)
+		patches_.emplace_back(strutil::upper(strutil::viewFromChars((const char*)data.data() + 4 + a * 8, 8)));
 
 	// Update variables
 	parent_ = parent;
-	signals_.modified.unblock();
 
 	// Announce
 	signals_.modified();
 
+	if (n_valid < n_pnames)
+	{
+		log::error("PNAMES entry {} is corrupt", n_valid);
+		return false;
+	}
+
 	return true;
 }
 
@@ -314,6 +304,22 @@ bool PatchTable::writePNAMES(ArchiveEntry* pnames)
 	return true;
 }
 
+// -----------------------------------------------------------------------------
+// Rebuilds the patch name index if it isn't up to date
+// -----------------------------------------------------------------------------
+void PatchTable::updateNameIndex() const
+{
+	if (name_index_valid_)
+		return;
+
+	name_index_.clear();
+	name_index_.reserve(patches_.size());
+	for (unsigned a = 0; a < patches_.size(); a++)
+		name_index_.emplace(strutil::upper(patches_[a].name), a); // Won't replace an earlier duplicate
+
+	name_index_valid_ = true;
+}
+
 // -----------------------------------------------------------------------------
 // Clears all patch use count data
 // -----------------------------------------------------------------------------
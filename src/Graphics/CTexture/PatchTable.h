@@ -66,5 +66,13 @@ private:
 	vector<Patch> patches_;
 	Patch         patch_invalid_{ "INVALID_PATCH" };
 	Signals       signals_;
+
+	// Index of the first patch with each (uppercase) name, built on demand.
+	// Kept up to date when patches are added to the end of the table, and
+	// discarded when patches are removed or renamed
+	mutable std::unordered_map<string, unsigned> name_index_;
+	mutable bool                                 name_index_valid_ = false;
+
+	void updateNameIndex() const;
 };
 } // namespace slade
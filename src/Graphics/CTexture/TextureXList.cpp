@@ -136,15 +136,11 @@ CTexture* TextureXList::texture(size_t index)
 // -----------------------------------------------------------------------------
 CTexture* TextureXList::texture(string_view name)
 {
-	// Search for texture by name
-	for (auto& texture : textures_)
-	{
-		if (strutil::equalCI(texture->name(), name))
-			return texture.get();
-	}
+	auto index = textureIndex(name);
+	if (index < 0)
+		return &tex_invalid_;
 
-	// Not found
-	return &tex_invalid_;
+	return textures_[index].get();
 }
 
 // -----------------------------------------------------------------------------
@@ -152,14 +148,14 @@ CTexture* TextureXList::texture(string_view name)
 // -----------------------------------------------------------------------------
 int TextureXList::textureIndex(string_view name)
 {
+	updateNameIndex();
+
 	// Search for texture by name
-	for (unsigned a = 0; a < textures_.size(); a++)
+	auto i = name_index_.find(strutil::upper(name));
+	if (i != name_index_.end())
 	{
-		if (strutil::equalCI(textures_[a]->name(), name))
-		{
-			textures_[a]->index_ = a;
-			return a;
-		}
+		textures_[i->second]->index_ = i->second;
+		return i->second;
 	}
 
 	// Not found
@@ -177,10 +173,13 @@ void TextureXList::addTexture(unique_ptr<CTexture> tex, int position)
 	{
 		tex->index_ = position;
 		textures_.insert(textures_.begin() + position, std::move(tex));
+		name_index_valid_ = false;
 	}
 	else
 	{
 		tex->index_ = textures_.size();
+		if (name_index_valid_)
+			name_index_.emplace(strutil::upper(tex->name()), tex->index_);
 		textures_.push_back(std::move(tex));
 	}
 }
@@ -197,6 +196,7 @@ unique_ptr<CTexture> TextureXList::removeTexture(unsigned index)
 	// Remove the texture from the list
 	auto removed = std::move(textures_[index]);
 	textures_.erase(textures_.begin() + index);
+	name_index_valid_ = false;
 
 	return removed;
 }
@@ -212,6 +212,7 @@ void TextureXList::swapTextures(unsigned index1, unsigned index2)
 
 	// Swap them
 	textures_[index1].swap(textures_[index2]);
+	name_index_valid_ = false;
 
 	// Swap indices
 	int ti                    = textures_[index1]->index_;
@@ -230,8 +231,9 @@ unique_ptr<CTexture> TextureXList::replaceTexture(unsigned index, unique_ptr<CTe
 		return nullptr;
 
 	// Replace texture
-	auto replaced    = std::move(textures_[index]);
-	textures_[index] = std::move(replacement);
+	auto replaced     = std::move(textures_[index]);
+	textures_[index]  = std::move(replacement);
+	name_index_valid_ = false;
 
 	return replaced;
 }
@@ -242,6 +244,23 @@ unique_ptr<CTexture> TextureXList::replaceTexture(unsigned index, unique_ptr<CTe
 void TextureXList::clear(bool clear_patches)
 {
 	textures_.clear();
+	name_index_valid_ = false;
+}
+
+// -----------------------------------------------------------------------------
+// Rebuilds the texture name index if it isn't up to date
+// -----------------------------------------------------------------------------
+void TextureXList::updateNameIndex()
+{
+	if (name_index_valid_)
+		return;
+
+	name_index_.clear();
+	name_index_.reserve(textures_.size());
+	for (unsigned a = 0; a < textures_.size(); a++)
+		name_index_.emplace(strutil::upper(textures_[a]->name()), a); // Won't replace an earlier duplicate
+
+	name_index_valid_ = true;
 }
 
 // -----------------------------------------------------------------------------
@@ -296,6 +315,7 @@ bool TextureXList::readTEXTUREXData(ArchiveEntry* texturex, const PatchTable& pa
 		log::error("TEXTUREx entry is corrupt (can't read first offset)");
 		return false;
 	}
+	textures_.reserve(textures_.size() + n_tex);
 
 	// Read the first texture definition to try to identify the format
 	if (!texturex->seek(wxINT32_SWAP_ON_BE(offsets[0]), SEEK_SET))
@@ -8,6 +8,8 @@ namespace slade
 {
 class TextureXList
 {
+	friend class CTexture;
+
 public:
 	// TEXTUREx texture patch
 	struct Patch
@@ -68,5 +70,14 @@ private:
 	vector<unique_ptr<CTexture>> textures_;
 	Format                       txformat_ = Format::Normal;
 	CTexture tex_invalid_{ static_cast<string_view>("INVALID_TEXTURE") }; // Deliberately set the invalid name to >8 characters
+
+	// Index of the first texture with each (uppercase) name, built on demand.
+	// Kept up to date when textures are added to the end of the list, and
+	// discarded when textures are inserted, removed, replaced, swapped or
+	// renamed
+	std::unordered_map<string, unsigned> name_index_;
+	bool                                 name_index_valid_ = false;
+
+	void updateNameIndex();
 };
 } // namespace slade
@@ -57,6 +57,11 @@ EXTERN_CVAR(Float, col_greyscale_r)
 EXTERN_CVAR(Float, col_greyscale_g)
 EXTERN_CVAR(Float, col_greyscale_b)
 
+namespace
+{
+std::atomic<unsigned long> palette_version{ 0 }; // Last version given to any palette (see Palette::version)
+} // namespace
+
 
 // -----------------------------------------------------------------------------
 //
@@ -70,6 +75,8 @@ EXTERN_CVAR(Float, col_greyscale_b)
 // -----------------------------------------------------------------------------
 Palette::Palette(unsigned size) : colours_{ size }, colours_hsl_{ size }, colours_lab_{ size }, index_trans_{ -1 }
 {
+	updateVersion();
+
 	// Init palette (to greyscale)
 	for (unsigned a = 0; a < size; a++)
 	{
@@ -90,6 +97,7 @@ bool Palette::loadMem(MemChunk& mc)
 		return false;
 
 	// Read in colours
+	updateVersion();
 	mc.seek(0, SEEK_SET);
 	int c = 0;
 	while (mc.currentPos() < mc.size())
@@ -124,6 +132,7 @@ bool Palette::loadMem(const uint8_t* data, uint32_t size)
 		return false;
 
 	// Read in colours
+	updateVersion();
 	int c = 0;
 	for (size_t a = 0; a < size; a += 3)
 	{
@@ -430,6 +439,7 @@ void Palette::setColour(uint8_t index, const ColRGBA& col)
 	colours_[index].index = index;
 	colours_lab_[index]   = colours_[index].asLAB();
 	colours_hsl_[index]   = colours_[index].asHSL();
+	updateVersion();
 }
 
 // -----------------------------------------------------------------------------
@@ -440,6 +450,7 @@ void Palette::setColourR(uint8_t index, uint8_t val)
 	colours_[index].r   = val;
 	colours_lab_[index] = colours_[index].asLAB();
 	colours_hsl_[index] = colours_[index].asHSL();
+	updateVersion();
 }
 
 // -----------------------------------------------------------------------------
@@ -450,6 +461,7 @@ void Palette::setColourG(uint8_t index, uint8_t val)
 	colours_[index].g   = val;
 	colours_lab_[index] = colours_[index].asLAB();
 	colours_hsl_[index] = colours_[index].asHSL();
+	updateVersion();
 }
 
 // -----------------------------------------------------------------------------
@@ -460,6 +472,7 @@ void Palette::setColourB(uint8_t index, uint8_t val)
 	colours_[index].b   = val;
 	colours_lab_[index] = colours_[index].asLAB();
 	colours_hsl_[index] = colours_[index].asHSL();
+	updateVersion();
 }
 
 // -----------------------------------------------------------------------------
@@ -495,6 +508,8 @@ void Palette::setGradient(uint8_t startIndex, uint8_t endIndex, const ColRGBA& s
 			a + startIndex);
 		colours_[a + startIndex].set(gradCol);
 	}
+
+	updateVersion();
 }
 
 // -----------------------------------------------------------------------------
@@ -512,6 +527,14 @@ void Palette::copyPalette(const Palette* copy)
 	index_trans_ = copy->transIndex();
 }
 
+// -----------------------------------------------------------------------------
+// Gives the palette a new version number, called whenever any colour changes
+// -----------------------------------------------------------------------------
+void Palette::updateVersion()
+{
+	version_ = ++palette_version;
+}
+
 // -----------------------------------------------------------------------------
 // Returns the index of the colour in the palette matching [colour], or -1 if
 // no match is found
@@ -648,8 +671,9 @@ void Palette::applyTranslation(Translation* trans)
 	temp.copyPalette(this);
 
 	// Translate colors
+	auto& table = trans->table(this);
 	for (size_t i = 0; i < 256; ++i)
-		temp.setColour(i, trans->translate(colours_[i], this));
+		temp.setColour(i, table.colour[i]);
 
 	// Load translated palette
 	copyPalette(&temp);
@@ -776,6 +800,8 @@ void Palette::saturate(float amount, int start, int end)
 		colours_[i]     = colours_hsl_[i].asRGB();
 		colours_lab_[i] = colours_[i].asLAB();
 	}
+
+	updateVersion();
 }
 
 // -----------------------------------------------------------------------------
@@ -804,6 +830,8 @@ void Palette::illuminate(float amount, int start, int end)
 		colours_[i]     = colours_hsl_[i].asRGB();
 		colours_lab_[i] = colours_[i].asLAB();
 	}
+
+	updateVersion();
 }
 
 // -----------------------------------------------------------------------------
@@ -832,6 +860,8 @@ void Palette::shift(float amount, int start, int end)
 		colours_[i]     = colours_hsl_[i].asRGB();
 		colours_lab_[i] = colours_[i].asLAB();
 	}
+
+	updateVersion();
 }
 
 // -----------------------------------------------------------------------------
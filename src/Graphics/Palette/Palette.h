@@ -33,6 +33,7 @@ public:
 	~Palette() = default;
 
 	const vector<ColRGBA>& colours() const { return colours_; }
+	unsigned long          version() const { return version_; }
 	ColRGBA                colour(uint8_t index) const { return colours_[index]; }
 	short                  transIndex() const { return index_trans_; }
 
@@ -47,7 +48,11 @@ public:
 	void setColourR(uint8_t index, uint8_t val);
 	void setColourG(uint8_t index, uint8_t val);
 	void setColourB(uint8_t index, uint8_t val);
-	void setColourA(uint8_t index, uint8_t val) { colours_[index].a = val; }
+	void setColourA(uint8_t index, uint8_t val)
+	{
+		colours_[index].a = val;
+		updateVersion();
+	}
 	void setTransIndex(short index) { index_trans_ = index; }
 
 	void   copyPalette(const Palette* copy);
@@ -73,7 +78,9 @@ private:
 	vector<ColHSL>  colours_hsl_;
 	vector<ColLAB>  colours_lab_;
 	short           index_trans_;
+	unsigned long   version_ = 0; // Changes whenever any colour is changed, unique across all palettes
 
+	void   updateVersion();
 	double colourDiff(const ColRGBA& rgb, const ColHSL& hsl, const ColLAB& lab, int index, ColourMatch match);
 };
 } // namespace slade
@@ -36,6 +36,7 @@
 #include "Archive/EntryType/EntryType.h"
 #include "General/Misc.h"
 #include "SIFormat.h"
+#include "Utility/ThreadPool.h"
 
 using namespace slade;
 
@@ -495,6 +496,28 @@ SIFormat::SIFormat(string_view id, string_view name, string_view ext, uint8_t re
 	simage_formats.push_back(this);
 }
 
+// -----------------------------------------------------------------------------
+// Converts the image of each item in [items] to be writable as this format,
+// using the item's conversion options. The conversions are done in parallel on
+// the thread pool, so the images must not be in use elsewhere (eg. displayed
+// in a canvas) until this returns.
+// Returns the number of images successfully converted
+// -----------------------------------------------------------------------------
+unsigned SIFormat::convertAllWritable(vector<ConvertItem>& items)
+{
+	std::atomic<unsigned> converted{ 0 };
+
+	app::threadPool().parallelFor(items.size(), [&](size_t index) {
+		auto& item     = items[index];
+		item.converted = item.image && canWrite(*item.image) != Writable::No
+						 && convertWritable(*item.image, item.opt);
+		if (item.converted)
+			++converted;
+	});
+
+	return converted;
+}
+
 
 // -----------------------------------------------------------------------------
 //
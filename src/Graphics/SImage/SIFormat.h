@@ -75,6 +75,15 @@ public:
 	virtual bool     convertWritable(SImage& image, ConvertOptions opt) { return false; }
 	virtual bool     writeOffset(SImage& image, ArchiveEntry* entry, Vec2i offset) { return false; }
 
+	// Batch conversion
+	struct ConvertItem
+	{
+		SImage*        image = nullptr;
+		ConvertOptions opt;
+		bool           converted = false; // Set by convertAllWritable
+	};
+	unsigned convertAllWritable(vector<ConvertItem>& items);
+
 	bool saveImage(SImage& image, MemChunk& out, Palette* pal = nullptr, int index = 0)
 	{
 		// Attempt to write image data
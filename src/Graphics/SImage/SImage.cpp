@@ -1314,6 +1314,9 @@ bool SImage::applyTranslation(Translation* tr, Palette* pal, bool truecolor)
 	else
 		newdata = data_.data();
 
+	// Compile the translation for the palette, so each pixel is just a lookup
+	auto& table = tr->table(pal);
+
 	// Go through pixels
 	for (int p = 0; p < width_ * height_; p++)
 	{
@@ -1324,7 +1327,7 @@ bool SImage::applyTranslation(Translation* tr, Palette* pal, bool truecolor)
 		ColRGBA col;
 		int     q = p * bpp;
 		if (type_ == Type::PalMask)
-			col.set(pal->colour(data_[p]));
+			col = table.colour[data_[p]];
 		else if (type_ == Type::RGBA)
 		{
 			col.set(data_[q], data_[q + 1], data_[q + 2], data_[q + 3]);
@@ -1333,9 +1336,14 @@ bool SImage::applyTranslation(Translation* tr, Palette* pal, bool truecolor)
 			col.index = pal->nearestColour(col);
 			if (!col.equals(pal->colour(col.index)))
 				continue;
-		}
 
-		col = tr->translate(col, pal);
+			// The table is compiled from the palette colours, so can't be used
+			// if the pixel's alpha differs
+			if (col.a == pal->colour(col.index).a)
+				col = table.colour[col.index];
+			else
+				col = tr->translate(col, pal);
+		}
 
 		if (truecolor)
 		{
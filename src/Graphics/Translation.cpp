@@ -58,6 +58,7 @@ using namespace slade;
 EXTERN_CVAR(Float, col_greyscale_r)
 EXTERN_CVAR(Float, col_greyscale_g)
 EXTERN_CVAR(Float, col_greyscale_b)
+EXTERN_CVAR(Int, col_match)
 
 
 // -----------------------------------------------------------------------------
@@ -103,6 +104,8 @@ enum SpecialBlend
 // -----------------------------------------------------------------------------
 void Translation::parse(string_view def)
 {
+	++edits_;
+
 	// Test for ZDoom built-in translation
 	string     def_str{ def };
 	const auto test = strutil::lower(def);
@@ -173,6 +176,8 @@ void Translation::parse(string_view def)
 // -----------------------------------------------------------------------------
 TransRange* Translation::parseRange(string_view range)
 {
+	++edits_;
+
 	// Open definition string for processing w/tokenizer
 	Tokenizer tz;
 	tz.setSpecialCharacters("[]:%,=#@$");
@@ -359,6 +364,8 @@ TransRange* Translation::parseRange(string_view range)
 // -----------------------------------------------------------------------------
 void Translation::read(const uint8_t* data)
 {
+	++edits_;
+
 	int     i = 0;
 	uint8_t val, o_start, o_end, d_start, d_end;
 	o_start = 0;
@@ -414,6 +421,8 @@ string Translation::asText()
 // -----------------------------------------------------------------------------
 void Translation::clear()
 {
+	++edits_;
+
 	translations_.clear();
 	built_in_name_ = "";
 	desat_amount_  = 0;
@@ -424,6 +433,8 @@ void Translation::clear()
 // -----------------------------------------------------------------------------
 void Translation::copy(const Translation& copy)
 {
+	++edits_;
+
 	// Clear current definitions
 	clear();
 
@@ -636,12 +647,96 @@ ColRGBA Translation::translate(const ColRGBA& col, Palette* pal)
 	return colour;
 }
 
+// -----------------------------------------------------------------------------
+// Returns the translation compiled against [pal] (or the current palette if
+// none given), for translating many pixels at once. The table is cached and
+// only recompiled if the translation ranges or the palette change
+// -----------------------------------------------------------------------------
+const Translation::Table& Translation::table(Palette* pal)
+{
+	if (pal == nullptr)
+		pal = maineditor::currentPalette();
+
+	// Nothing has changed since the table was compiled
+	CompiledTable::Source source{
+		edits_, TransRange::editCount(), pal, pal->version(), col_match, col_greyscale_r, col_greyscale_g, col_greyscale_b
+	};
+	if (compiled_ && compiled_->source == source)
+		return compiled_->table;
+
+	// Something changed, check if it affects the table (eg. a range was
+	// changed then changed back, or a different palette with the same colours)
+	auto key     = tableKey();
+	bool compile = !compiled_ || key != compiled_->key;
+	for (unsigned a = 0; a < 256 && !compile; a++)
+		compile = !pal->colour(a).equals(compiled_->palette[a], true);
+	if (!compile)
+	{
+		compiled_->source = source;
+		return compiled_->table;
+	}
+
+	// Compile
+	if (!compiled_)
+		compiled_ = std::make_unique<CompiledTable>();
+	auto& table = compiled_->table;
+	for (unsigned a = 0; a < 256; a++)
+	{
+		auto col  = pal->colour(a);
+		col.index = a;
+
+		auto tcol             = translate(col, pal);
+		table.colour[a]       = tcol;
+		table.index[a]        = tcol.index < 0 ? pal->nearestColour(tcol) : tcol.index;
+		compiled_->palette[a] = pal->colour(a);
+	}
+	compiled_->key    = std::move(key);
+	compiled_->source = source;
+
+	return table;
+}
+
+// -----------------------------------------------------------------------------
+// Returns a key identifying the current translation ranges (and colour
+// settings affecting them), used to check if the compiled table is out of date
+// -----------------------------------------------------------------------------
+string Translation::tableKey()
+{
+	auto key = fmt::format(
+		"{}|{}|{}|{}|{}|{}|",
+		built_in_name_,
+		desat_amount_,
+		*col_match,
+		*col_greyscale_r,
+		*col_greyscale_g,
+		*col_greyscale_b);
+
+	for (auto& range : translations_)
+	{
+		key += range->asText();
+
+		// Desaturation ranges are only written to 2 decimal places, so add the exact values
+		if (range->type_ == TransRange::Type::Desat)
+		{
+			auto tr = dynamic_cast<TransRangeDesat*>(range.get());
+			key.append(reinterpret_cast<const char*>(&tr->rgb_start_), sizeof(TransRangeDesat::RGB));
+			key.append(reinterpret_cast<const char*>(&tr->rgb_end_), sizeof(TransRangeDesat::RGB));
+		}
+
+		key += '|';
+	}
+
+	return key;
+}
+
 // -----------------------------------------------------------------------------
 // Adds a new translation range of [type] at [pos] in the list, with the range
 // spanning from [range_start] to [range_end]
 // -----------------------------------------------------------------------------
 TransRange* Translation::addRange(TransRange::Type type, int pos, int range_start, int range_end)
 {
+	++edits_;
+
 	// Create range
 	unique_ptr<TransRange> tr;
 	TransRange::IndexRange range{ range_start, range_end };
@@ -670,6 +765,8 @@ TransRange* Translation::addRange(TransRange::Type type, int pos, int range_star
 // -----------------------------------------------------------------------------
 void Translation::removeRange(int pos)
 {
+	++edits_;
+
 	// Check position
 	if (pos < 0 || pos >= static_cast<int>(translations_.size()))
 		return;
@@ -683,6 +780,8 @@ void Translation::removeRange(int pos)
 // -----------------------------------------------------------------------------
 void Translation::swapRanges(int pos1, int pos2)
 {
+	++edits_;
+
 	// Check positions
 	if (pos1 < 0 || pos2 < 0 || pos1 >= static_cast<int>(translations_.size())
 		|| pos2 >= static_cast<int>(translations_.size()))
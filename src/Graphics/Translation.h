@@ -1,5 +1,6 @@
 #pragma once
 #include "Utility/Colour.h"
+#include <atomic>
 
 namespace slade
 {
@@ -38,15 +39,36 @@ public:
 	uint8_t           start() const { return range_.start; }
 	uint8_t           end() const { return range_.end; }
 
-	void setRange(const IndexRange& range) { range_ = range; }
-	void setStart(uint8_t val) { range_.start = val; }
-	void setEnd(uint8_t val) { range_.end = val; }
+	void setRange(const IndexRange& range)
+	{
+		range_ = range;
+		edited();
+	}
+	void setStart(uint8_t val)
+	{
+		range_.start = val;
+		edited();
+	}
+	void setEnd(uint8_t val)
+	{
+		range_.end = val;
+		edited();
+	}
 
 	virtual string asText() { return ""; }
 
+	// Returns the number of edits made to any translation range, used to check
+	// if a compiled translation table could be out of date
+	static unsigned long editCount() { return edit_count_; }
+
 protected:
 	Type       type_;
 	IndexRange range_;
+
+	static void edited() { ++edit_count_; }
+
+private:
+	inline static std::atomic<unsigned long> edit_count_{ 0 };
 };
 
 class TransRangePalette : public TransRange
@@ -68,8 +90,16 @@ public:
 	uint8_t dStart() const { return dest_range_.start; }
 	uint8_t dEnd() const { return dest_range_.end; }
 
-	void setDStart(uint8_t val) { dest_range_.start = val; }
-	void setDEnd(uint8_t val) { dest_range_.end = val; }
+	void setDStart(uint8_t val)
+	{
+		dest_range_.start = val;
+		edited();
+	}
+	void setDEnd(uint8_t val)
+	{
+		dest_range_.end = val;
+		edited();
+	}
 
 	string asText() override
 	{
@@ -104,8 +134,16 @@ public:
 	const ColRGBA& startColour() const { return col_start_; }
 	const ColRGBA& endColour() const { return col_end_; }
 
-	void setStartColour(const ColRGBA& col) { col_start_.set(col); }
-	void setEndColour(const ColRGBA& col) { col_end_.set(col); }
+	void setStartColour(const ColRGBA& col)
+	{
+		col_start_.set(col);
+		edited();
+	}
+	void setEndColour(const ColRGBA& col)
+	{
+		col_end_.set(col);
+		edited();
+	}
 
 	string asText() override
 	{
@@ -151,8 +189,16 @@ public:
 	const RGB& rgbStart() const { return rgb_start_; }
 	const RGB& rgbEnd() const { return rgb_end_; }
 
-	void setRGBStart(float r, float g, float b) { rgb_start_ = { r, g, b }; }
-	void setRGBEnd(float r, float g, float b) { rgb_end_ = { r, g, b }; }
+	void setRGBStart(float r, float g, float b)
+	{
+		rgb_start_ = { r, g, b };
+		edited();
+	}
+	void setRGBEnd(float r, float g, float b)
+	{
+		rgb_end_ = { r, g, b };
+		edited();
+	}
 
 	string asText() override
 	{
@@ -186,7 +232,11 @@ public:
 	TransRangeBlend(const TransRangeBlend& copy) : TransRange{ Type::Blend, copy.range_ }, colour_{ copy.colour_ } {}
 
 	const ColRGBA& colour() const { return colour_; }
-	void           setColour(const ColRGBA& c) { colour_ = c; }
+	void           setColour(const ColRGBA& c)
+	{
+		colour_ = c;
+		edited();
+	}
 
 	string asText() override
 	{
@@ -217,8 +267,16 @@ public:
 
 	ColRGBA colour() const { return colour_; }
 	uint8_t amount() const { return amount_; }
-	void    setColour(const ColRGBA& c) { colour_ = c; }
-	void    setAmount(uint8_t a) { amount_ = a; }
+	void    setColour(const ColRGBA& c)
+	{
+		colour_ = c;
+		edited();
+	}
+	void setAmount(uint8_t a)
+	{
+		amount_ = a;
+		edited();
+	}
 
 	string asText() override
 	{
@@ -247,7 +305,11 @@ public:
 	}
 
 	const string& special() const { return special_; }
-	void          setSpecial(string_view sp) { special_ = sp; }
+	void          setSpecial(string_view sp)
+	{
+		special_ = sp;
+		edited();
+	}
 
 	string asText() override { return fmt::format("{}:{}=${}", range_.start, range_.end, special_); }
 
@@ -259,6 +321,14 @@ class Palette;
 class Translation
 {
 public:
+	// The translation compiled against a palette, giving the translated colour
+	// (and palette index) for each palette index
+	struct Table
+	{
+		uint8_t index[256];
+		ColRGBA colour[256];
+	};
+
 	Translation()  = default;
 	~Translation() = default;
 
@@ -277,10 +347,19 @@ public:
 	const string& builtInName() const { return built_in_name_; }
 	uint8_t       desaturationAmount() const { return desat_amount_; }
 
-	void setBuiltInName(string_view name) { built_in_name_ = name; }
-	void setDesaturationAmount(uint8_t amount) { desat_amount_ = amount; }
+	void setBuiltInName(string_view name)
+	{
+		built_in_name_ = name;
+		++edits_;
+	}
+	void setDesaturationAmount(uint8_t amount)
+	{
+		desat_amount_ = amount;
+		++edits_;
+	}
 
-	ColRGBA translate(const ColRGBA& col, Palette* pal = nullptr);
+	ColRGBA      translate(const ColRGBA& col, Palette* pal = nullptr);
+	const Table& table(Palette* pal = nullptr);
 
 	TransRange* addRange(TransRange::Type type, int pos = -1, int range_start = 0, int range_end = 0);
 	void        removeRange(int pos);
@@ -293,5 +372,40 @@ private:
 	vector<unique_ptr<TransRange>> translations_;
 	string                         built_in_name_;
 	uint8_t                        desat_amount_ = 0;
+	unsigned long                  edits_        = 0; // Incremented whenever the translation is changed
+
+	// Compiled table, and what it was compiled from
+	struct CompiledTable
+	{
+		// Versions of everything the table depends on, if none of these have
+		// changed the table is up to date
+		struct Source
+		{
+			unsigned long edits       = 0;
+			unsigned long range_edits = 0;
+			Palette*      palette     = nullptr;
+			unsigned long pal_version = 0;
+			int           col_match   = 0;
+			double        greyscale_r = 0.;
+			double        greyscale_g = 0.;
+			double        greyscale_b = 0.;
+
+			bool operator==(const Source& other) const
+			{
+				return edits == other.edits && range_edits == other.range_edits && palette == other.palette
+					   && pal_version == other.pal_version && col_match == other.col_match
+					   && greyscale_r == other.greyscale_r && greyscale_g == other.greyscale_g
+					   && greyscale_b == other.greyscale_b;
+			}
+		};
+
+		Table   table;
+		ColRGBA palette[256];
+		string  key;
+		Source  source;
+	};
+	unique_ptr<CompiledTable> compiled_;
+
+	string tableKey();
 };
 } // namespace slade
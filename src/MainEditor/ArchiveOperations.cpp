@@ -38,6 +38,7 @@
 #include "General/ResourceManager.h"
 #include "Graphics/CTexture/TextureXList.h"
 #include "MainEditor/MainEditor.h"
+#include "MainEditor/TextureUsage.h"
 #include "MainEditor/UI/MainWindow.h"
 #include "SLADEMap/MapFormat/Doom64MapFormat.h"
 #include "SLADEMap/MapFormat/DoomMapFormat.h"
@@ -47,7 +48,6 @@
 #include "UI/Dialogs/ExtMessageDialog.h"
 #include "UI/WxUtils.h"
 #include "Utility/StringUtils.h"
-#include "Utility/Tokenizer.h"
 
 using namespace slade;
 
@@ -59,7 +59,6 @@ using namespace slade;
 // -----------------------------------------------------------------------------
 typedef std::map<wxString, int>                   StrIntMap;
 typedef std::map<wxString, vector<ArchiveEntry*>> PathMap;
-typedef std::map<int, vector<ArchiveEntry*>>      CRCMap;
 
 
 // -----------------------------------------------------------------------------
@@ -285,7 +284,7 @@ void archiveoperations::removeEntriesUnchangedFromIWAD(Archive* archive)
 		other                  = bra->findLast(search);
 
 		// If there is one, and it is identical, remove it
-		if (other != nullptr && (other->data().crc() == entry->data().crc()))
+		if (other != nullptr && other->size() == entry->size() && other->contentHash() == entry->contentHash())
 		{
 			++count;
 			dups += wxString::Format("%s\n", search.match_name);
@@ -320,47 +319,22 @@ void archiveoperations::removeEntriesUnchangedFromIWAD(Archive* archive)
 // -----------------------------------------------------------------------------
 bool archiveoperations::checkDuplicateEntryContent(Archive* archive)
 {
-	CRCMap map_entries;
-
-	// Get list of all entries in archive
-	vector<ArchiveEntry*> entries;
-	archive->putEntryTreeAsList(entries);
-	wxString dups = "";
-
-	// Go through list
-	for (auto& entry : entries)
-	{
-		// Skip directory entries
-		if (entry->type() == EntryType::folderType())
-			continue;
-
-		// Skip markers
-		if (entry->type() == EntryType::mapMarkerType() || entry->size() == 0)
-			continue;
-
-		// Enqueue entries
-		map_entries[entry->data().crc()].push_back(entry);
-	}
+	// Find entries with identical data
+	auto     duplicates = archive->findDuplicateEntries();
+	wxString dups       = "";
 
 	// Now iterate through the dupes to list the name of the duplicated entries
-	auto i = map_entries.begin();
-	while (i != map_entries.end())
+	for (auto& group : duplicates)
 	{
-		if (i->second.size() > 1)
+		wxString name = group[0]->path(true);
+		name.Remove(0, 1);
+		dups += wxString::Format("\n%s\t(%016llx) duplicated by", name, (unsigned long long)group[0]->contentHash());
+		for (unsigned a = 1; a < group.size(); a++)
 		{
-			wxString name = i->second[0]->path(true);
+			name = group[a]->path(true);
 			name.Remove(0, 1);
-			dups += wxString::Format("\n%s\t(%8x) duplicated by", name, i->first);
-			auto j = i->second.begin() + 1;
-			while (j != i->second.end())
-			{
-				name = (*j)->path(true);
-				name.Remove(0, 1);
-				dups += wxString::Format("\t%s", name);
-				++j;
-			}
+			dups += wxString::Format("\t%s", name);
 		}
-		++i;
 	}
 
 	// If no duplicates exist, do nothing
@@ -400,100 +374,21 @@ wxString flat_anim_end[] = {
 	"NUKAGE3", "FWATER4", "SWATER4", "LAVA4", "BLOOD3", "RROCK08", "SLIME04", "SLIME08", "SLIME12",
 };
 
-struct texused_t
-{
-	bool used;
-	texused_t() { used = false; }
-};
-WX_DECLARE_STRING_HASH_MAP(texused_t, TexUsedMap);
 void archiveoperations::removeUnusedTextures(Archive* archive)
 {
 	// Check archive was given
 	if (!archive)
 		return;
 
-	// --- Build list of used textures ---
-	TexUsedMap used_textures;
-	int        total_maps = 0;
-
-	// Get all SIDEDEFS entries
-	Archive::SearchOptions opt;
-	opt.match_type = EntryType::fromId("map_sidedefs");
-	auto sidedefs  = archive->findAll(opt);
-	total_maps += sidedefs.size();
-
-	// Go through and add used textures to list
-	DoomMapFormat::SideDef sdef;
-	wxString               tex_lower, tex_middle, tex_upper;
-	for (auto& sidedef : sidedefs)
-	{
-		int nsides = sidedef->size() / 30;
-		sidedef->seek(0, SEEK_SET);
-		for (int s = 0; s < nsides; s++)
-		{
-			// Read side data
-			sidedef->read(&sdef, 30);
-
-			// Get textures
-			tex_lower  = wxString::FromAscii(sdef.tex_lower, 8);
-			tex_middle = wxString::FromAscii(sdef.tex_middle, 8);
-			tex_upper  = wxString::FromAscii(sdef.tex_upper, 8);
-
-			// Add to used textures list
-			used_textures[tex_lower].used  = true;
-			used_textures[tex_middle].used = true;
-			used_textures[tex_upper].used  = true;
-		}
-	}
-
-	// Get all TEXTMAP entries
-	opt.match_name = "TEXTMAP";
-	opt.match_type = EntryType::fromId("udmf_textmap");
-	auto udmfmaps  = archive->findAll(opt);
-	total_maps += udmfmaps.size();
-
-	// Go through and add used textures to list
-	Tokenizer tz;
-	tz.setSpecialCharacters("{};=");
-	for (auto& udmfmap : udmfmaps)
-	{
-		// Open in tokenizer
-		tz.openMem(udmfmap->data(), "UDMF TEXTMAP");
-
-		// Go through text tokens
-		wxString token = tz.getToken();
-		while (!token.IsEmpty())
-		{
-			// Check for sidedef definition
-			if (token == "sidedef")
-			{
-				tz.getToken(); // Skip {
-
-				token = tz.getToken();
-				while (token != "}")
-				{
-					// Check for texture property
-					if (token == "texturetop" || token == "texturemiddle" || token == "texturebottom")
-					{
-						tz.getToken(); // Skip =
-						used_textures[tz.getToken()].used = true;
-					}
-
-					token = tz.getToken();
-				}
-			}
-
-			// Next token
-			token = tz.getToken();
-		}
-	}
+	// Get texture usage for all maps in the archive
+	auto usage = textureusage::scanArchive(*archive);
 
 	// Check if any maps were found
-	if (total_maps == 0)
+	if (usage.n_lumps == 0)
 		return;
 
 	// Find all TEXTUREx entries
-	opt.match_name  = "";
+	Archive::SearchOptions opt;
 	opt.match_type  = EntryType::fromId("texturex");
 	auto tx_entries = archive->findAll(opt);
 
@@ -534,7 +429,7 @@ void archiveoperations::removeUnusedTextures(Archive* archive)
 			}
 
 			// Mark if unused and not part of an animation
-			if (!used_textures[texname].used && !anim && !thisend)
+			if (usage.textureCount(wxutil::strToView(texname)) == 0 && !anim && !thisend)
 				unused_tex.Add(txlist.texture(t)->name());
 		}
 	}
@@ -573,7 +468,7 @@ void archiveoperations::removeUnusedTextures(Archive* archive)
 			swname.Replace("SW1", "SW2", false);
 
 			// Check if its counterpart is used
-			if (used_textures[swname].used)
+			if (usage.textureCount(wxutil::strToView(swname)) > 0)
 				swtex = true;
 		}
 		else if (unused_tex[a].StartsWith("SW2"))
@@ -583,7 +478,7 @@ void archiveoperations::removeUnusedTextures(Archive* archive)
 			swname.Replace("SW2", "SW1", false);
 
 			// Check if its counterpart is used
-			if (used_textures[swname].used)
+			if (usage.textureCount(wxutil::strToView(swname)) > 0)
 				swtex = true;
 		}
 
@@ -644,88 +539,16 @@ void archiveoperations::removeUnusedFlats(Archive* archive)
 	if (!archive)
 		return;
 
-	// --- Build list of used flats ---
-	TexUsedMap used_textures;
-	int        total_maps = 0;
-
-	// Get all SECTORS entries
-	Archive::SearchOptions opt;
-	opt.match_type = EntryType::fromId("map_sectors");
-	auto sectors   = archive->findAll(opt);
-	total_maps += sectors.size();
-
-	// Go through and add used flats to list
-	DoomMapFormat::Sector sec;
-	wxString              tex_floor, tex_ceil;
-	for (auto& sector : sectors)
-	{
-		int nsec = sector->size() / 26;
-		sector->seek(0, SEEK_SET);
-		for (int s = 0; s < nsec; s++)
-		{
-			// Read sector data
-			sector->read(&sec, 26);
-
-			// Get textures
-			tex_floor = wxString::FromAscii(sec.f_tex, 8);
-			tex_ceil  = wxString::FromAscii(sec.c_tex, 8);
-
-			// Add to used textures list
-			used_textures[tex_floor].used = true;
-			used_textures[tex_ceil].used  = true;
-		}
-	}
-
-	// Get all TEXTMAP entries
-	opt.match_name = "TEXTMAP";
-	opt.match_type = EntryType::fromId("udmf_textmap");
-	auto udmfmaps  = archive->findAll(opt);
-	total_maps += udmfmaps.size();
-
-	// Go through and add used flats to list
-	Tokenizer tz;
-	tz.setSpecialCharacters("{};=");
-	for (auto& udmfmap : udmfmaps)
-	{
-		// Open in tokenizer
-		tz.openMem(udmfmap->data(), "UDMF TEXTMAP");
-
-		// Go through text tokens
-		wxString token = tz.getToken();
-		while (!token.IsEmpty())
-		{
-			// Check for sector definition
-			if (token == "sector")
-			{
-				tz.getToken(); // Skip {
-
-				token = tz.getToken();
-				while (token != "}")
-				{
-					// Check for texture property
-					if (token == "texturefloor" || token == "textureceiling")
-					{
-						tz.getToken(); // Skip =
-						used_textures[tz.getToken()].used = true;
-					}
-
-					token = tz.getToken();
-				}
-			}
-
-			// Next token
-			token = tz.getToken();
-		}
-	}
+	// Get flat usage for all maps in the archive
+	auto usage = textureusage::scanArchive(*archive);
 
 	// Check if any maps were found
-	if (total_maps == 0)
+	if (usage.n_lumps == 0)
 		return;
 
 	// Find all flats
-	opt.match_name      = "";
+	Archive::SearchOptions opt;
 	opt.match_namespace = "flats";
-	opt.match_type      = nullptr;
 	auto flats          = archive->findAll(opt);
 
 	// Create list of all unused flats
@@ -763,7 +586,7 @@ void archiveoperations::removeUnusedFlats(Archive* archive)
 		}
 
 		// Add if not animated
-		if (!used_textures[flatname].used && !anim && !thisend)
+		if (usage.flatCount(flatname) == 0 && !anim && !thisend)
 			unused_tex.Add(flatname);
 	}
 
@@ -1542,6 +1365,80 @@ bool replaceTextureString(char* str, wxString oldtex, wxString newtex)
 	}
 	return go;
 }
+// Returns true if texture [name] matches [oldtex], using the same rules as
+// replaceTextureString but ignoring case
+bool textureNameMatches(string_view name, const wxString& oldtex)
+{
+	for (unsigned c = 0; c < oldtex.Length(); ++c)
+	{
+		if (oldtex[c] == '*')
+			break;
+
+		char ch = c < name.size() ? name[c] : 0;
+		if (oldtex[c] != '?' && toupper(ch) != toupper(static_cast<char>(oldtex[c])))
+			return false;
+	}
+	return true;
+}
+
+// Replaces texture [name] with [newtex] if it matches [oldtex], using the same
+// rules as replaceTextureString (without the 8 character limit)
+bool replaceTextureName(string& name, const wxString& oldtex, const wxString& newtex)
+{
+	for (unsigned c = 0; c < oldtex.Length(); ++c)
+	{
+		if (oldtex[c] == '*')
+			break;
+
+		char ch = c < name.size() ? name[c] : 0;
+		if (oldtex[c] != '?' && ch != oldtex[c])
+			return false;
+	}
+
+	string replaced;
+	for (unsigned c = 0; c < newtex.Length(); ++c)
+	{
+		// Keep the rest of the name as-is?
+		if (newtex[c] == '*')
+		{
+			if (c < name.size())
+				replaced.append(name, c, string::npos);
+			break;
+		}
+		// Keep just this character as-is?
+		if (newtex[c] == '?')
+		{
+			if (c < name.size())
+				replaced += name[c];
+			continue;
+		}
+		// Else, copy the character
+		replaced += static_cast<char>(newtex[c]);
+	}
+	name = replaced;
+
+	return true;
+}
+
+// Returns false if map lump [usage] shows it doesn't use any texture (if
+// [textures] is true) or flat (if [flats] is true) matching [oldtex]
+bool lumpMayUseTexture(const textureusage::Usage* usage, const wxString& oldtex, bool textures, bool flats)
+{
+	// Not scanned (eg. Doom64 format)
+	if (!usage || usage->n_lumps == 0)
+		return true;
+
+	if (textures)
+		for (const auto& tex : usage->textures)
+			if (textureNameMatches(tex.first, oldtex))
+				return true;
+	if (flats)
+		for (const auto& flat : usage->flats)
+			if (textureNameMatches(flat.first, oldtex))
+				return true;
+
+	return false;
+}
 size_t replaceFlatsDoomHexen(
 	ArchiveEntry*   entry,
 	const wxString& oldtex,
@@ -1723,12 +1620,56 @@ size_t replaceTexturesUDMF(
 	if (entry == nullptr)
 		return 0;
 
-	size_t changed = 0;
-	// TODO: parse and replace code
+	// Go through texture values in the textmap, building a copy of it with
+	// replaced values as they are found
+	auto&       data = entry->data();
+	string_view textmap{ reinterpret_cast<const char*>(data.data()), data.size() };
+	string      replaced;
+	size_t      copied  = 0;
+	size_t      changed = 0;
+	textureusage::scanUDMF(
+		textmap,
+		[&](textureusage::Part part, string_view value) {
+			switch (part)
+			{
+			case textureusage::Part::Upper:
+				if (!upper)
+					return;
+				break;
+			case textureusage::Part::Middle:
+				if (!middle)
+					return;
+				break;
+			case textureusage::Part::Lower:
+				if (!lower)
+					return;
+				break;
+			case textureusage::Part::Floor:
+				if (!floor)
+					return;
+				break;
+			case textureusage::Part::Ceiling:
+				if (!ceiling)
+					return;
+				break;
+			}
+
+			string name{ value };
+			if (!replaceTextureName(name, oldtex, newtex))
+				return;
+
+			size_t offset = value.data() - textmap.data();
+			replaced.append(textmap.substr(copied, offset - copied));
+			replaced.append(name);
+			copied = offset + value.size();
+			++changed;
+		});
+
 	// Import the changes if needed
 	if (changed > 0)
 	{
-		// entry->importMemChunk(mc);
+		replaced.append(textmap.substr(copied));
+		importEntryDataKeepType(entry, replaced.data(), replaced.size());
 	}
 	return changed;
 }
@@ -1751,9 +1692,68 @@ size_t archiveoperations::replaceTextures(
 	auto     maps   = archive->detectMaps();
 	wxString report = "";
 
-	for (auto& map : maps)
+	// Find the map entries to modify
+	vector<ArchiveEntry*> map_sectors(maps.size(), nullptr);
+	vector<ArchiveEntry*> map_sides(maps.size(), nullptr);
+	vector<ArchiveEntry*> scan_lumps;
+	for (unsigned m = 0; m < maps.size(); ++m)
 	{
-		auto m_head = map.head.lock();
+		const auto& map = maps[m];
+		if (map.archive)
+			continue;
+
+		auto entries = map.entries(*archive);
+		if (map.format == MapFormat::Doom || map.format == MapFormat::Doom64 || map.format == MapFormat::Hexen)
+		{
+			for (auto mapentry : entries)
+			{
+				if ((floor || ceiling) && (mapentry->type() == EntryType::fromId("map_sectors")))
+				{
+					map_sectors[m] = mapentry;
+					if (map_sides[m] || !(lower || middle || upper))
+						break;
+				}
+				if ((lower || middle || upper) && (mapentry->type() == EntryType::fromId("map_sidedefs")))
+				{
+					map_sides[m] = mapentry;
+					if (map_sectors[m] || !(floor || ceiling))
+						break;
+				}
+			}
+		}
+		else if (map.format == MapFormat::UDMF)
+		{
+			for (auto mapentry : entries)
+			{
+				if (mapentry->type() == EntryType::fromId("udmf_textmap"))
+				{
+					map_sectors[m] = map_sides[m] = mapentry;
+					break;
+				}
+			}
+		}
+
+		// Doom64 maps reference textures by hash, so can't be scanned
+		if (map.format == MapFormat::Doom64)
+			continue;
+
+		if (map_sectors[m])
+			scan_lumps.push_back(map_sectors[m]);
+		if (map_sides[m] && map_sides[m] != map_sectors[m])
+			scan_lumps.push_back(map_sides[m]);
+	}
+
+	// Scan all map entries for texture usage first (in parallel), so entries
+	// that don't use any matching textures can be skipped
+	std::map<ArchiveEntry*, const textureusage::Usage*> lump_usage;
+	auto                                                scanned = textureusage::scanLumps(scan_lumps);
+	for (unsigned a = 0; a < scan_lumps.size(); ++a)
+		lump_usage[scan_lumps[a]] = scanned[a].get();
+
+	for (unsigned m = 0; m < maps.size(); ++m)
+	{
+		auto& map    = maps[m];
+		auto  m_head = map.head.lock();
 		if (!m_head)
 			continue;
 
@@ -1787,38 +1787,21 @@ size_t archiveoperations::replaceTextures(
 		}
 		else
 		{
-			// Find the map entry to modify
-			ArchiveEntry* sectors = nullptr;
-			ArchiveEntry* sides   = nullptr;
-			auto          entries = map.entries(*archive);
-			if (map.format == MapFormat::Doom || map.format == MapFormat::Doom64 || map.format == MapFormat::Hexen)
+			auto sectors = map_sectors[m];
+			auto sides   = map_sides[m];
+
+			// Skip entries that don't use any matching textures
+			if (sectors && sectors == sides)
 			{
-				for (auto mapentry : entries)
-				{
-					if ((floor || ceiling) && (mapentry->type() == EntryType::fromId("map_sectors")))
-					{
-						sectors = mapentry;
-						if (sides || !(lower || middle || upper))
-							break;
-					}
-					if ((lower || middle || upper) && (mapentry->type() == EntryType::fromId("map_sidedefs")))
-					{
-						sides = mapentry;
-						if (sectors || !(floor || ceiling))
-							break;
-					}
-				}
+				if (!lumpMayUseTexture(lump_usage[sectors], oldtex, lower || middle || upper, floor || ceiling))
+					sectors = sides = nullptr;
 			}
-			else if (map.format == MapFormat::UDMF)
+			else
 			{
-				for (auto mapentry : entries)
-				{
-					if (mapentry->type() == EntryType::fromId("udmf_textmap"))
-					{
-						sectors = sides = mapentry;
-						break;
-					}
-				}
+				if (sectors && !lumpMayUseTexture(lump_usage[sectors], oldtex, false, true))
+					sectors = nullptr;
+				if (sides && !lumpMayUseTexture(lump_usage[sides], oldtex, true, false))
+					sides = nullptr;
 			}
 
 			// Did we get a map entry?
@@ -0,0 +1,441 @@
+
+// -----------------------------------------------------------------------------
+// SLADE - It's a Doom Editor
+// Copyright(C) 2008 - 2020 Simon Judd
+//
+// Email:       sirjuddington@gmail.com
+// Web:         http://slade.mancubus.net
+// Filename:    EntryJob.cpp
+// Description: EntryJob class and subclasses - batch operations on many
+//              entries (importing, exporting) that do most of their work on
+//              the thread pool, and apply their results to the archive on the
+//              main thread once done
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301, USA.
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+//
+// Includes
+//
+// -----------------------------------------------------------------------------
+#include "Main.h"
+#include "EntryJob.h"
+#include "App.h"
+#include "General/Misc.h"
+#include "General/UndoRedo.h"
+#include "Graphics/SImage/SIFormat.h"
+#include "Graphics/SImage/SImage.h"
+#include "MainEditor/MainEditor.h"
+#include "MainEditor/UI/ArchivePanel.h"
+#include "Utility/StringUtils.h"
+#include "Utility/ThreadPool.h"
+#include <filesystem>
+
+using namespace slade;
+
+
+// -----------------------------------------------------------------------------
+//
+// Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// -----------------------------------------------------------------------------
+// Returns true if [dir] is (still) part of [archive]'s directory tree
+// -----------------------------------------------------------------------------
+bool entryJobDirInArchive(ArchiveDir* dir, const Archive& archive)
+{
+	while (dir)
+	{
+		auto parent = dir->parent();
+		if (!parent)
+			return dir == archive.rootDir().get();
+
+		// Check the dir wasn't removed from its parent
+		const auto& subdirs = parent->subdirs();
+		if (std::none_of(subdirs.begin(), subdirs.end(), [dir](const auto& subdir) { return subdir.get() == dir; }))
+			return false;
+
+		dir = parent.get();
+	}
+
+	return false;
+}
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// EntryJob Class Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// EntryJob class destructor, cancels the job if it is still being processed
+// -----------------------------------------------------------------------------
+EntryJob::~EntryJob()
+{
+	cancel();
+	wait();
+}
+
+// -----------------------------------------------------------------------------
+// Returns true if all items in the job have been processed (or skipped if the
+// job was cancelled)
+// -----------------------------------------------------------------------------
+bool EntryJob::isProcessed() const
+{
+	return !processing_.valid() || processing_.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+}
+
+// -----------------------------------------------------------------------------
+// Returns a list of errors that occurred while processing the job
+// -----------------------------------------------------------------------------
+vector<string> EntryJob::errors() const
+{
+	std::lock_guard lock(errors_mutex_);
+	return errors_;
+}
+
+// -----------------------------------------------------------------------------
+// Starts processing all items in the job on the thread pool, in the background
+// -----------------------------------------------------------------------------
+void EntryJob::start()
+{
+	num_items_ = countItems();
+	if (num_items_ == 0)
+		return;
+
+	processing_ = app::threadPool().submit([this]() {
+		app::threadPool().parallelFor(num_items_, [this](size_t index) {
+			if (cancelled_)
+				return;
+
+			processItem(index);
+			++num_processed_;
+		});
+	});
+}
+
+// -----------------------------------------------------------------------------
+// Waits for the job to finish processing
+// -----------------------------------------------------------------------------
+void EntryJob::wait() const
+{
+	if (processing_.valid())
+		processing_.wait();
+}
+
+// -----------------------------------------------------------------------------
+// Applies the results of the job once it has been processed.
+// Must be called from the main thread. Returns false if the job was cancelled
+// or nothing was committed
+// -----------------------------------------------------------------------------
+bool EntryJob::commit()
+{
+	wait();
+
+	if (cancelled_)
+		return false;
+
+	return commitItems();
+}
+
+// -----------------------------------------------------------------------------
+// Adds [error] to the job's list of errors (can be called from any thread)
+// -----------------------------------------------------------------------------
+void EntryJob::addError(string_view error)
+{
+	std::lock_guard lock(errors_mutex_);
+	errors_.emplace_back(error);
+}
+
+
+// -----------------------------------------------------------------------------
+//
+// ImportFilesJob Class Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// ImportFilesJob class constructor. Files will be imported to [dir] in
+// [archive], starting at [index] (or at the end of [dir] if negative)
+// -----------------------------------------------------------------------------
+ImportFilesJob::ImportFilesJob(
+	const shared_ptr<Archive>& archive,
+	ArchiveDir*                dir,
+	int                        index,
+	UndoManager*               undo_manager) :
+	EntryJob{ "Importing Files" },
+	archive_{ archive },
+	dir_{ ArchiveDir::getShared(dir ? dir : archive->rootDir().get()) },
+	index_{ index },
+	undo_manager_{ undo_manager },
+	format_{ archive->formatDesc() }
+{
+	// Get where the imported entries will be in the archive, so their types
+	// can be detected before they are added
+	context_.archive_format = format_.entry_format;
+	context_.section        = archive->detectNamespace(index < 0 ? 0xFFFFFFFF : index, dir_.get());
+}
+
+// -----------------------------------------------------------------------------
+// ImportFilesJob class destructor
+// -----------------------------------------------------------------------------
+ImportFilesJob::~ImportFilesJob()
+{
+	// Stop processing before items are deleted
+	cancel();
+	wait();
+}
+
+// -----------------------------------------------------------------------------
+// Adds [filename] to be imported. If [replace] is given, the file is imported
+// into that (existing) entry rather than a new one
+// -----------------------------------------------------------------------------
+void ImportFilesJob::addFile(string_view filename, ArchiveEntry* replace)
+{
+	auto& item    = items_.emplace_back();
+	item.filename = filename;
+	item.entry    = std::make_shared<ArchiveEntry>(strutil::Path::fileNameOf(filename));
+	if (replace)
+		item.replace = replace->getShared();
+}
+
+// -----------------------------------------------------------------------------
+// Reads the file for the item at [index] and detects its entry type
+// -----------------------------------------------------------------------------
+void ImportFilesJob::processItem(unsigned index)
+{
+	auto& item = items_[index];
+
+	if (!item.entry->importFile(item.filename))
+	{
+		addError(fmt::format("Unable to import file \"{}\": {}", item.filename, global::error));
+		item.entry.reset();
+		return;
+	}
+
+	// The type of a replaced entry depends on its existing name and position,
+	// so it is detected when committed
+	if (item.replace)
+		return;
+
+	// Format the name as it will be in the archive, since types can be
+	// detected by name
+	item.entry->formatName(format_);
+	EntryType::detectEntryType(*item.entry, &context_);
+}
+
+// -----------------------------------------------------------------------------
+// Adds all imported entries to the archive, as a single undo level
+// -----------------------------------------------------------------------------
+bool ImportFilesJob::commitItems()
+{
+	auto archive = archive_.lock();
+	if (!archive)
+		return false;
+
+	// Import to the root dir instead if the dir was removed while processing
+	auto dir = dir_.get();
+	if (!entryJobDirInArchive(dir, *archive))
+		dir = archive->rootDir().get();
+
+	// Begin recording undo level
+	if (undo_manager_)
+		undo_manager_->beginRecord("Import Files");
+
+	bool ok    = false;
+	auto index = index_;
+	for (auto& item : items_)
+	{
+		// Skip files that couldn't be read
+		if (!item.entry)
+			continue;
+
+		// Import into an existing entry
+		if (item.replace)
+		{
+			// Check the entry is still in the archive
+			if (item.replace->parent() != archive.get())
+				continue;
+
+			if (undo_manager_)
+				undo_manager_->recordUndoStep(std::make_unique<EntryDataUS>(item.replace.get()));
+
+			item.replace->importMemChunk(item.entry->data());
+			EntryType::detectEntryType(*item.replace);
+			ok = true;
+			continue;
+		}
+
+		// Add new entry (its type was already detected)
+		if (archive->addEntry(item.entry, index, dir))
+		{
+			ok = true;
+			if (index >= 0)
+				index++;
+		}
+	}
+
+	// End recording undo level
+	if (undo_manager_)
+		undo_manager_->endRecord(ok);
+
+	return ok;
+}
+
+
+// -----------------------------------------------------------------------------
+//
+// ExportEntriesJob Class Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// ExportEntriesJob class constructor. If [as_png] is true, entries are
+// converted to PNG images when exported
+// -----------------------------------------------------------------------------
+ExportEntriesJob::ExportEntriesJob(bool as_png) :
+	EntryJob{ as_png ? "Exporting Entries as PNG" : "Exporting Entries" },
+	as_png_{ as_png }
+{
+}
+
+// -----------------------------------------------------------------------------
+// ExportEntriesJob class destructor
+// -----------------------------------------------------------------------------
+ExportEntriesJob::~ExportEntriesJob()
+{
+	// Stop processing before items are deleted
+	cancel();
+	wait();
+}
+
+// -----------------------------------------------------------------------------
+// Adds [entry] to be exported to [filename]. The entry's data is copied here,
+// so that it can be exported even if the entry is modified or removed while
+// the job is running
+// -----------------------------------------------------------------------------
+void ExportEntriesJob::addEntry(ArchiveEntry* entry, string_view filename)
+{
+	auto& item    = items_.emplace_back();
+	item.filename = filename;
+	item.name     = entry->name();
+
+	if (as_png_)
+	{
+		// The entry type and palette depend on the entry's archive, so get
+		// them now
+		if (entry->type() == EntryType::unknownType())
+			EntryType::detectEntryType(*entry);
+		if (auto palette = maineditor::currentPalette(entry))
+			item.palette = std::make_unique<Palette>(*palette);
+
+		// Some image formats need other entries in the archive to be loaded,
+		// so load those images now rather than in the background
+		if (strutil::startsWith(entry->type()->formatId(), "img_jaguar"))
+		{
+			item.image = std::make_unique<SImage>();
+			if (!misc::loadImageFromEntry(item.image.get(), entry))
+			{
+				addError(fmt::format("Error converting {}: {}", item.name, global::error));
+				items_.pop_back();
+			}
+			return;
+		}
+	}
+
+	item.entry = std::make_unique<ArchiveEntry>(*entry);
+}
+
+// -----------------------------------------------------------------------------
+// Adds all entries in [dir] (and its subdirs, recursively) to be exported to
+// the directory at [path], which is created if it doesn't exist
+// -----------------------------------------------------------------------------
+void ExportEntriesJob::addDir(ArchiveDir* dir, string_view path)
+{
+	// Create directory if needed
+	if (!std::filesystem::exists(path))
+		std::filesystem::create_directory(path);
+
+	// Add entries
+	for (auto& entry : dir->entries())
+	{
+		// Setup entry filename
+		strutil::Path fn(entry->name());
+		fn.setPath(path);
+
+		// Add file extension if it doesn't exist
+		if (as_png_)
+			fn.setExtension("png");
+		else if (!fn.hasExtension())
+			fn.setExtension(entry->type()->extension());
+
+		addEntry(entry.get(), fn.fullPath());
+	}
+
+	// Add subdirectories
+	for (auto& subdir : dir->subdirs())
+		addDir(subdir.get(), fmt::format("{}/{}", path, subdir->name()));
+}
+
+// -----------------------------------------------------------------------------
+// Exports the item at [index] to its file
+// -----------------------------------------------------------------------------
+void ExportEntriesJob::processItem(unsigned index)
+{
+	auto& item = items_[index];
+
+	if (!as_png_)
+	{
+		if (!item.entry->exportFile(item.filename))
+			addError(fmt::format("Unable to export {}: {}", item.name, global::error));
+	}
+	else
+	{
+		// Load image (if it wasn't already)
+		if (!item.image)
+		{
+			item.image = std::make_unique<SImage>();
+			if (!misc::loadImageFromEntry(item.image.get(), item.entry.get()))
+			{
+				addError(fmt::format("Error converting {}: {}", item.name, global::error));
+				item.image.reset();
+			}
+		}
+
+		// Write png data
+		if (item.image)
+		{
+			MemChunk png;
+			if (!SIFormat::getFormat("png")->saveImage(*item.image, png, item.palette.get()))
+				addError(fmt::format("Error converting {}", item.name));
+			else if (!png.exportFile(item.filename))
+				addError(fmt::format("Unable to export {}: {}", item.name, global::error));
+		}
+	}
+
+	// Free the item's copied data now it's done with
+	item.entry.reset();
+	item.image.reset();
+	item.palette.reset();
+}
@@ -0,0 +1,123 @@
+#pragma once
+
+#include "Archive/Archive.h"
+#include "Archive/EntryType/EntryType.h"
+#include "Graphics/Palette/Palette.h"
+#include <atomic>
+#include <future>
+#include <mutex>
+
+namespace slade
+{
+class SImage;
+class UndoManager;
+
+// A batch operation on many entries (eg. importing or exporting) that does
+// most of its work on the thread pool, so that the UI stays usable while it
+// runs. A job goes through three stages:
+// - Setup (main thread): the job is created and its items added, anything
+//   needed from an archive (eg. entry data) is copied here
+// - Process (thread pool): each item is processed. This must not access any
+//   archive, since the archive can be modified while the job is running
+// - Commit (main thread): the results are applied, eg. imported entries are
+//   added to their archive
+class EntryJob
+{
+public:
+	EntryJob(string_view title) : title_{ title } {}
+	virtual ~EntryJob();
+
+	EntryJob(const EntryJob&)            = delete;
+	EntryJob& operator=(const EntryJob&) = delete;
+
+	const string&  title() const { return title_; }
+	unsigned       numItems() const { return num_items_; }
+	unsigned       numProcessed() const { return num_processed_; }
+	bool           isCancelled() const { return cancelled_; }
+	bool           isProcessed() const;
+	vector<string> errors() const;
+
+	void start();
+	void cancel() { cancelled_ = true; }
+	void wait() const;
+	bool commit();
+
+protected:
+	virtual unsigned countItems() const         = 0;
+	virtual void     processItem(unsigned index) = 0;
+	virtual bool     commitItems() { return true; }
+	void             addError(string_view error);
+
+private:
+	string                title_;
+	unsigned              num_items_ = 0;
+	std::atomic<unsigned> num_processed_{ 0 };
+	std::atomic<bool>     cancelled_{ false };
+	std::future<void>     processing_;
+	mutable std::mutex    errors_mutex_;
+	vector<string>        errors_;
+};
+
+// Imports files into an archive. Files are read and their entry types detected
+// on the thread pool, then all new entries are added to the archive (as a
+// single undo level) when committed
+class ImportFilesJob : public EntryJob
+{
+public:
+	ImportFilesJob(const shared_ptr<Archive>& archive, ArchiveDir* dir, int index, UndoManager* undo_manager);
+	~ImportFilesJob() override;
+
+	void addFile(string_view filename, ArchiveEntry* replace = nullptr);
+
+protected:
+	unsigned countItems() const override { return items_.size(); }
+	void     processItem(unsigned index) override;
+	bool     commitItems() override;
+
+private:
+	struct Item
+	{
+		string                   filename;
+		shared_ptr<ArchiveEntry> entry;   // Imported entry (not in the archive until committed)
+		shared_ptr<ArchiveEntry> replace; // Existing entry to import the file into, if any
+	};
+
+	weak_ptr<Archive>        archive_;
+	shared_ptr<ArchiveDir>   dir_;
+	int                      index_        = -1;
+	UndoManager*             undo_manager_ = nullptr;
+	ArchiveFormat            format_;
+	EntryType::DetectContext context_;
+	vector<Item>             items_;
+};
+
+// Exports entries to files, optionally converting them to PNG images. Entry
+// data is copied when entries are added, and written (or converted and
+// written) on the thread pool
+class ExportEntriesJob : public EntryJob
+{
+public:
+	ExportEntriesJob(bool as_png = false);
+	~ExportEntriesJob() override;
+
+	void addEntry(ArchiveEntry* entry, string_view filename);
+	void addDir(ArchiveDir* dir, string_view path);
+
+protected:
+	unsigned countItems() const override { return items_.size(); }
+	void     processItem(unsigned index) override;
+
+private:
+	struct Item
+	{
+		string                   filename;
+		string                   name;
+		unique_ptr<ArchiveEntry> entry;   // Copy of the entry to export
+		unique_ptr<SImage>       image;   // Image to export, if it had to be loaded when the entry was added
+		unique_ptr<Palette>      palette; // Palette to convert the image with
+	};
+
+	bool         as_png_;
+	vector<Item> items_;
+};
+} // namespace slade
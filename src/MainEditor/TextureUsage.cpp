@@ -0,0 +1,428 @@
+
+// -----------------------------------------------------------------------------
+// SLADE - It's a Doom Editor
+// Copyright(C) 2008 - 2020 Simon Judd
+//
+// Email:       sirjuddington@gmail.com
+// Web:         http://slade.mancubus.net
+// Filename:    TextureUsage.cpp
+// Description: Functions to count how many times each texture and flat is used
+//              by the maps in an archive. Map lumps are read directly (and
+//              scanned concurrently) rather than opening the maps, and the
+//              results for each lump are cached until its data changes
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301, USA.
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+//
+// Includes
+//
+// -----------------------------------------------------------------------------
+#include "Main.h"
+#include "TextureUsage.h"
+#include "App.h"
+#include "Archive/Archive.h"
+#include "SLADEMap/MapFormat/DoomMapFormat.h"
+#include "Utility/StringUtils.h"
+#include "Utility/ThreadPool.h"
+
+using namespace slade;
+using namespace textureusage;
+
+
+// -----------------------------------------------------------------------------
+//
+// Variables
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+enum class UsageLump
+{
+	Unknown,
+	SideDefs,
+	Sectors,
+	TextMap
+};
+
+// Cached usage for scanned lumps, keyed by lump kind, size and content hash
+// (only accessed from the main thread)
+std::map<std::tuple<UsageLump, uint32_t, uint64_t>, shared_ptr<const Usage>> usage_cache;
+
+// The cache is cleared when it gets larger than this
+constexpr unsigned USAGE_CACHE_MAX = 4096;
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// Local Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// -----------------------------------------------------------------------------
+// Returns the kind of map lump [entry] is (for texture usage purposes)
+// -----------------------------------------------------------------------------
+UsageLump usageLumpKind(ArchiveEntry* entry)
+{
+	const auto& type_id = entry->type()->id();
+
+	// Doom64 sidedefs/sectors are a different size and use texture hashes
+	// rather than names, so they are (mostly) excluded by the size checks
+	if (type_id == "map_sidedefs" && entry->size() % sizeof(DoomMapFormat::SideDef) == 0)
+		return UsageLump::SideDefs;
+	if (type_id == "map_sectors" && entry->size() % sizeof(DoomMapFormat::Sector) == 0)
+		return UsageLump::Sectors;
+	if (type_id == "udmf_textmap")
+		return UsageLump::TextMap;
+
+	return UsageLump::Unknown;
+}
+
+// -----------------------------------------------------------------------------
+// Increments the count for texture name [name] in [counts]. [name] is
+// uppercased and truncated at the first null character
+// -----------------------------------------------------------------------------
+void addUsageName(std::map<string, unsigned>& counts, string_view name)
+{
+	auto end = name.find('\0');
+	if (end != string_view::npos)
+		name = name.substr(0, end);
+
+	string upper{ name };
+	strutil::upperIP(upper);
+	++counts[upper];
+}
+
+// -----------------------------------------------------------------------------
+// Returns the texture part UDMF property [key] refers to in [part], or false
+// if it isn't a texture property
+// -----------------------------------------------------------------------------
+bool udmfTexturePart(string_view key, Part& part)
+{
+	// Quick check, all texture keys are 10+ characters starting with 'texture'
+	if (key.size() < 10 || (key[0] | 0x20) != 't')
+		return false;
+
+	if (strutil::equalCI(key, "texturetop"))
+		part = Part::Upper;
+	else if (strutil::equalCI(key, "texturemiddle"))
+		part = Part::Middle;
+	else if (strutil::equalCI(key, "texturebottom"))
+		part = Part::Lower;
+	else if (strutil::equalCI(key, "texturefloor"))
+		part = Part::Floor;
+	else if (strutil::equalCI(key, "textureceiling"))
+		part = Part::Ceiling;
+	else
+		return false;
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Scans map lump [data] of [kind] and adds its texture usage to [usage]
+// -----------------------------------------------------------------------------
+void scanUsageLump(UsageLump kind, const MemChunk& data, Usage& usage)
+{
+	if (kind == UsageLump::SideDefs)
+	{
+		DoomMapFormat::SideDef side;
+		auto                   n_sides = data.size() / sizeof(DoomMapFormat::SideDef);
+		for (unsigned a = 0; a < n_sides; ++a)
+		{
+			memcpy(&side, data.data() + a * sizeof(DoomMapFormat::SideDef), sizeof(DoomMapFormat::SideDef));
+			addUsageName(usage.textures, { side.tex_upper, 8 });
+			addUsageName(usage.textures, { side.tex_middle, 8 });
+			addUsageName(usage.textures, { side.tex_lower, 8 });
+		}
+	}
+	else if (kind == UsageLump::Sectors)
+	{
+		DoomMapFormat::Sector sector;
+		auto                  n_sectors = data.size() / sizeof(DoomMapFormat::Sector);
+		for (unsigned a = 0; a < n_sectors; ++a)
+		{
+			memcpy(&sector, data.data() + a * sizeof(DoomMapFormat::Sector), sizeof(DoomMapFormat::Sector));
+			addUsageName(usage.flats, { sector.f_tex, 8 });
+			addUsageName(usage.flats, { sector.c_tex, 8 });
+		}
+	}
+	else if (kind == UsageLump::TextMap)
+	{
+		scanUDMF(
+			{ reinterpret_cast<const char*>(data.data()), data.size() },
+			[&usage](Part part, string_view value) {
+				if (part == Part::Floor || part == Part::Ceiling)
+					addUsageName(usage.flats, value);
+				else
+					addUsageName(usage.textures, value);
+			});
+	}
+
+	usage.n_lumps = 1;
+}
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// Usage Struct Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Returns the number of times texture [name] is used (case-insensitive)
+// -----------------------------------------------------------------------------
+unsigned Usage::textureCount(string_view name) const
+{
+	auto it = textures.find(strutil::upper(name));
+	return it != textures.end() ? it->second : 0;
+}
+
+// -----------------------------------------------------------------------------
+// Returns the number of times flat [name] is used (case-insensitive)
+// -----------------------------------------------------------------------------
+unsigned Usage::flatCount(string_view name) const
+{
+	auto it = flats.find(strutil::upper(name));
+	return it != flats.end() ? it->second : 0;
+}
+
+// -----------------------------------------------------------------------------
+// Adds the counts from [other] to this
+// -----------------------------------------------------------------------------
+void Usage::merge(const Usage& other)
+{
+	for (const auto& tex : other.textures)
+		textures[tex.first] += tex.second;
+	for (const auto& flat : other.flats)
+		flats[flat.first] += flat.second;
+	n_lumps += other.n_lumps;
+}
+
+
+// -----------------------------------------------------------------------------
+//
+// TextureUsage Namespace Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Scans UDMF [textmap] for texture properties (texturetop, texturefloor, etc.)
+// and calls [callback] with the part and value of each one found. The value
+// given to [callback] points into [textmap], so its position can be used to
+// modify the text. Comments and other string values are skipped
+// -----------------------------------------------------------------------------
+void textureusage::scanUDMF(string_view textmap, const std::function<void(Part, string_view)>& callback)
+{
+	auto p   = textmap.data();
+	auto end = p + textmap.size();
+
+	const auto skip_whitespace = [&p, end]() {
+		while (p < end && (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n'))
+			++p;
+	};
+
+	while (p < end)
+	{
+		auto c = *p;
+
+		// Line comment
+		if (c == '/' && p + 1 < end && p[1] == '/')
+		{
+			while (p < end && *p != '\n')
+				++p;
+			continue;
+		}
+
+		// Block comment
+		if (c == '/' && p + 1 < end && p[1] == '*')
+		{
+			p += 2;
+			while (p < end && !(*p == '*' && p + 1 < end && p[1] == '/'))
+				++p;
+			p = std::min(p + 2, end);
+			continue;
+		}
+
+		// String (not a texture value)
+		if (c == '"')
+		{
+			++p;
+			while (p < end && *p != '"')
+				p = std::min(p + (*p == '\\' ? 2 : 1), end);
+			p = std::min(p + 1, end);
+			continue;
+		}
+
+		// Number (skipped so exponents/hex digits aren't read as identifiers)
+		if (c >= '0' && c <= '9')
+		{
+			while (p < end && (isalnum(static_cast<unsigned char>(*p)) || *p == '.' || *p == '+' || *p == '-'))
+				++p;
+			continue;
+		}
+
+		// Identifier
+		if (isalpha(static_cast<unsigned char>(c)) || c == '_')
+		{
+			auto start = p;
+			while (p < end && (isalnum(static_cast<unsigned char>(*p)) || *p == '_'))
+				++p;
+
+			Part part;
+			if (!udmfTexturePart({ start, static_cast<size_t>(p - start) }, part))
+				continue;
+
+			// Check for = "value"
+			skip_whitespace();
+			if (p >= end || *p != '=')
+				continue;
+			++p;
+			skip_whitespace();
+			if (p >= end || *p != '"')
+				continue;
+
+			auto value_start = ++p;
+			while (p < end && *p != '"')
+				p = std::min(p + (*p == '\\' ? 2 : 1), end);
+
+			callback(part, { value_start, static_cast<size_t>(p - value_start) });
+			p = std::min(p + 1, end);
+			continue;
+		}
+
+		++p;
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Returns all map lumps in [archive] that can reference textures or flats
+// (SIDEDEFS, SECTORS and TEXTMAP)
+// -----------------------------------------------------------------------------
+vector<ArchiveEntry*> textureusage::mapLumps(Archive& archive)
+{
+	vector<ArchiveEntry*> lumps;
+
+	Archive::SearchOptions opt;
+	opt.match_type = EntryType::fromId("map_sidedefs");
+	for (auto entry : archive.findAll(opt))
+		lumps.push_back(entry);
+
+	opt.match_type = EntryType::fromId("map_sectors");
+	for (auto entry : archive.findAll(opt))
+		lumps.push_back(entry);
+
+	opt.match_name = "TEXTMAP";
+	opt.match_type = EntryType::fromId("udmf_textmap");
+	for (auto entry : archive.findAll(opt))
+		lumps.push_back(entry);
+
+	return lumps;
+}
+
+// -----------------------------------------------------------------------------
+// Returns the texture usage for each of the given map [lumps] (non-map lumps
+// give empty usage). Lumps that haven't changed since they were last scanned
+// are taken from the cache, the rest are scanned in parallel on the thread pool
+// -----------------------------------------------------------------------------
+vector<shared_ptr<const Usage>> textureusage::scanLumps(const vector<ArchiveEntry*>& lumps)
+{
+	vector<shared_ptr<const Usage>> results(lumps.size());
+	vector<UsageLump>               kinds(lumps.size());
+	vector<bool>                    was_loaded(lumps.size());
+	vector<unsigned>                to_scan;
+
+	// Get cached results where possible, and load data for the rest (entry
+	// data can only be loaded from the archive on this thread)
+	for (unsigned a = 0; a < lumps.size(); ++a)
+	{
+		kinds[a] = usageLumpKind(lumps[a]);
+		if (kinds[a] == UsageLump::Unknown)
+		{
+			results[a] = std::make_shared<Usage>();
+			continue;
+		}
+
+		if (lumps[a]->hasContentHash())
+		{
+			auto it = usage_cache.find({ kinds[a], lumps[a]->size(), lumps[a]->contentHash() });
+			if (it != usage_cache.end())
+			{
+				results[a] = it->second;
+				continue;
+			}
+		}
+
+		was_loaded[a] = lumps[a]->isLoaded();
+		lumps[a]->data();
+		to_scan.push_back(a);
+	}
+
+	// Hash and scan lumps
+	app::threadPool().parallelFor(
+		to_scan.size(),
+		[&](size_t i) {
+			auto index = to_scan[i];
+			auto usage = std::make_shared<Usage>();
+			lumps[index]->contentHash(false);
+			scanUsageLump(kinds[index], lumps[index]->data(false), *usage);
+			results[index] = usage;
+		},
+		1);
+
+	// Add results to the cache and unload data that wasn't loaded before
+	for (auto index : to_scan)
+	{
+		auto entry = lumps[index];
+		if (entry->hasContentHash())
+		{
+			if (usage_cache.size() >= USAGE_CACHE_MAX)
+				usage_cache.clear();
+			usage_cache[{ kinds[index], entry->size(), entry->contentHash() }] = results[index];
+		}
+
+		if (!was_loaded[index])
+			entry->unloadData();
+	}
+
+	return results;
+}
+
+// -----------------------------------------------------------------------------
+// Returns the combined texture usage of all maps in [archive]
+// -----------------------------------------------------------------------------
+Usage textureusage::scanArchive(Archive& archive)
+{
+	Usage usage;
+	for (const auto& lump_usage : scanLumps(mapLumps(archive)))
+		usage.merge(*lump_usage);
+
+	return usage;
+}
+
+// -----------------------------------------------------------------------------
+// Clears all cached lump usage
+// -----------------------------------------------------------------------------
+void textureusage::clearCache()
+{
+	usage_cache.clear();
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+namespace slade
+{
+class Archive;
+class ArchiveEntry;
+} // namespace slade
+
+namespace slade::textureusage
+{
+enum class Part
+{
+	Upper,
+	Middle,
+	Lower,
+	Floor,
+	Ceiling
+};
+
+// Number of times each texture and flat is used, names are uppercase
+struct Usage
+{
+	std::map<string, unsigned> textures;
+	std::map<string, unsigned> flats;
+	unsigned                   n_lumps = 0; // Number of map lumps scanned
+
+	unsigned textureCount(string_view name) const;
+	unsigned flatCount(string_view name) const;
+	void     merge(const Usage& other);
+};
+
+void scanUDMF(string_view textmap, const std::function<void(Part, string_view)>& callback);
+
+vector<ArchiveEntry*>           mapLumps(Archive& archive);
+vector<shared_ptr<const Usage>> scanLumps(const vector<ArchiveEntry*>& lumps);
+Usage                           scanArchive(Archive& archive);
+void                            clearCache();
+} // namespace slade::textureusage
@@ -1299,14 +1299,55 @@ void ArchiveManagerPanel::checkDirArchives()
 		if (VECTOR_EXISTS(checking_archives_, archive.get()))
 			continue;
 
+		// If the archive is being watched, only the paths reported by the
+		// watcher need to be checked (unless it lost track of changes)
+		auto dir_archive = dynamic_cast<DirArchive*>(archive.get());
+		if (dir_archive->isWatched())
+		{
+			vector<DirEntryChange> changes;
+			if (dir_archive->takeWatchedChanges(changes))
+			{
+				applyDirArchiveChanges(dir_archive, changes);
+				continue;
+			}
+		}
+
 		log::info(2, "Checking {} for external changes...", archive->filename());
 		checking_archives_.push_back(archive.get());
-		auto check = new DirArchiveCheck(this, dynamic_cast<DirArchive*>(archive.get()));
+		auto check = new DirArchiveCheck(this, dir_archive);
 		check->Create();
 		check->Run();
 	}
 }
 
+// -----------------------------------------------------------------------------
+// Applies [changes] found on the file system to directory [archive], either
+// automatically or via the change/update dialog depending on settings
+// -----------------------------------------------------------------------------
+void ArchiveManagerPanel::applyDirArchiveChanges(DirArchive* archive, vector<DirEntryChange>& changes)
+{
+	if (changes.empty())
+	{
+		log::info(2, "No changes");
+		return;
+	}
+
+	checked_dir_archive_changes_ = true;
+
+	// Auto apply if option set
+	if (dir_archive_change_action == 1)
+		archive->updateChangedEntries(changes);
+
+	// Otherwise show change/update dialog
+	else
+	{
+		DirArchiveUpdateDialog dlg(maineditor::windowWx(), archive, changes);
+		dlg.ShowModal();
+	}
+
+	checked_dir_archive_changes_ = false;
+}
+
 // -----------------------------------------------------------------------------
 // Creates a new archive of the given type and opens it in a tab
 // -----------------------------------------------------------------------------
@@ -2257,28 +2298,7 @@ void ArchiveManagerPanel::onDirArchiveCheckCompleted(wxThreadEvent& e)
 	if (app::archiveManager().archiveIndex(change_list.archive) >= 0)
 	{
 		log::info(2, wxString::Format("Finished checking %s for external changes", change_list.archive->filename()));
-
-		if (!change_list.changes.empty())
-		{
-			checked_dir_archive_changes_ = true;
-
-			auto archive = dynamic_cast<DirArchive*>(change_list.archive);
-
-			// Auto apply if option set
-			if (dir_archive_change_action == 1)
-				archive->updateChangedEntries(change_list.changes);
-
-			// Otherwise show change/update dialog
-			else
-			{
-				DirArchiveUpdateDialog dlg(maineditor::windowWx(), archive, change_list.changes);
-				dlg.ShowModal();
-			}
-
-			checked_dir_archive_changes_ = false;
-		}
-		else
-			log::info(2, "No changes");
+		applyDirArchiveChanges(dynamic_cast<DirArchive*>(change_list.archive), change_list.changes);
 	}
 
 	VECTOR_REMOVE(checking_archives_, change_list.archive);
@@ -2292,6 +2312,14 @@ void ArchiveManagerPanel::connectSignals()
 	signal_connections += signals.archive_added.connect([this](unsigned index) {
 		list_archives_->addItem(index, wxEmptyString);
 		updateOpenListItem(index);
+
+		// Check watched directory archives as soon as changes are picked up
+		// (if SLADE is active, otherwise they will be checked on activation)
+		if (auto dir_archive = dynamic_cast<DirArchive*>(app::archiveManager().getArchive(index).get()))
+			signal_connections += dir_archive->dirSignals().external_changes.connect([this](DirArchive&) {
+				if (wxTheApp->IsActive())
+					CallAfter(&ArchiveManagerPanel::checkDirArchives);
+			});
 	});
 	signal_connections += signals.archive_closed.connect([this](unsigned index) { list_archives_->DeleteItem(index); });
 	signal_connections += signals.archive_saved.connect([this](unsigned index) {
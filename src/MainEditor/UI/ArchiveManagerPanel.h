@@ -189,5 +189,6 @@ private:
 	ScopedConnectionList signal_connections;
 
 	void connectSignals();
+	void applyDirArchiveChanges(DirArchive* archive, vector<DirEntryChange>& changes);
 };
 } // namespace slade
@@ -35,6 +35,7 @@
 #include "ArchivePanel.h"
 #include "App.h"
 #include "Archive/ArchiveManager.h"
+#include "Audio/MIDIRenderer.h"
 #include "Archive/Formats/ZipArchive.h"
 #include "ArchiveManagerPanel.h"
 #include "EntryPanel/ANSIEntryPanel.h"
@@ -56,6 +57,7 @@
 #include "Graphics/Palette/PaletteManager.h"
 #include "MainEditor/ArchiveOperations.h"
 #include "MainEditor/Conversions.h"
+#include "MainEditor/EntryJob.h"
 #include "MainEditor/EntryOperations.h"
 #include "MainEditor/MainEditor.h"
 #include "MainEditor/UI/MainWindow.h"
@@ -64,6 +66,7 @@
 #include "Scripting/ScriptManager.h"
 #include "UI/Controls/PaletteChooser.h"
 #include "UI/Controls/SIconButton.h"
+#include "UI/Dialogs/EntryJobDialog.h"
 #include "UI/Dialogs/GfxColouriseDialog.h"
 #include "UI/Dialogs/GfxConvDialog.h"
 #include "UI/Dialogs/GfxTintDialog.h"
@@ -158,19 +161,20 @@ public:
 		bool     yes_to_all = false;
 		wxString caption    = (filenames.size() > 1) ? "Overwrite entries" : "Overwrite entry";
 
-		// Import all dragged files, inserting after the item they were dragged onto
-		list_->Freeze();
-		for (int a = filenames.size() - 1; a >= 0; a--)
+		// Import all dragged files (in the background), inserting after the item they were dragged onto
+		auto job = std::make_unique<ImportFilesJob>(
+			app::archiveManager().shareArchive(archive), dir, index, parent_->undoManager());
+		for (const auto& filename : filenames)
 		{
 			// Is this a directory?
-			if (wxDirExists(filenames[a]))
+			if (wxDirExists(filename))
 			{
 				// TODO: Handle folders with recursively importing all content
 				// and converting to namespaces if dropping in a treeless archive.
 			}
 			else
 			{
-				strutil::Path fn(filenames[a].ToStdString());
+				strutil::Path fn(filename.ToStdString());
 				ArchiveEntry* entry = nullptr;
 
 				// Find entry to replace if needed
@@ -197,16 +201,11 @@ public:
 					}
 				}
 
-				// Create new entry if needed
-				if (entry == nullptr)
-					entry = archive->addNewEntry(fn.fileName(), index, dir).get();
-
-				// Import the file to it
-				entry->importFile(filenames[a].ToStdString());
-				EntryType::detectEntryType(*entry);
+				// Import the file (to a new entry if not replacing one)
+				job->addFile(filename.ToStdString(), entry);
 			}
 		}
-		list_->Thaw();
+		EntryJobDialog::run(parent_, std::move(job));
 
 		return true;
 	}
@@ -921,43 +920,14 @@ bool ArchivePanel::importFiles()
 		else
 			index = -1; // If not add to the end of the list
 
-		// Begin recording undo level
-		undo_manager_->beginRecord("Import Files");
-
-		// Go through the list of files
-		bool ok = false;
-		entry_tree_->Freeze();
-		ui::showSplash("Importing Files...", true);
-		for (size_t a = 0; a < info.filenames.size(); a++)
-		{
-			// Get filename
-			wxString name = wxFileName(info.filenames[a]).GetFullName();
-
-			// Update splash window
-			ui::setSplashProgress(float(a) / float(info.filenames.size()));
-			ui::setSplashProgressMessage(name.ToStdString());
-
-			// Add the entry to the archive
-			auto new_entry = archive->addNewEntry(name.ToStdString(), index, dir);
-
-			// If the entry was created ok, load the file into it
-			if (new_entry)
-			{
-				new_entry->importFile(info.filenames[a]); // Import file to entry
-				EntryType::detectEntryType(*new_entry);   // Detect entry type
-				ok = true;
-			}
-
-			if (index > 0)
-				index++;
-		}
-		ui::hideSplash();
-		entry_tree_->Thaw();
+		// Import the files in the background (as a single undo level), the
+		// entries are added to the archive once all files have been read
+		auto job = std::make_unique<ImportFilesJob>(archive, dir, index, undo_manager_.get());
+		for (const auto& filename : info.filenames)
+			job->addFile(filename);
+		EntryJobDialog::run(this, std::move(job));
 
-		// End recording undo level
-		undo_manager_->endRecord(true);
-
-		return ok;
+		return true;
 	}
 	else // User cancelled, return false
 		return false;
@@ -1901,6 +1871,8 @@ bool ArchivePanel::exportEntry()
 		filedialog::FDInfo info;
 		if (filedialog::saveFiles(info, "Export Multiple Entries (Filename is ignored)", "Any File (*.*)|*.*", this))
 		{
+			auto job = std::make_unique<ExportEntriesJob>();
+
 			// Go through the selected entries
 			for (auto& entry : selection)
 			{
@@ -1912,13 +1884,15 @@ bool ArchivePanel::exportEntry()
 				if (!fn.HasExt())
 					fn.SetExt(entry->type()->extension());
 
-				// Do export
-				entry->exportFile(fn.GetFullPath().ToStdString());
+				job->addEntry(entry, fn.GetFullPath().ToStdString());
 			}
 
 			// Go through selected dirs
 			for (auto& dir : selected_dirs)
-				dir->exportTo(string{ info.path + "/" + dir->name() });
+				job->addDir(dir, info.path + "/" + dir->name());
+
+			// Do export (in the background)
+			EntryJobDialog::run(this, std::move(job));
 		}
 	}
 
@@ -2336,6 +2310,8 @@ bool ArchivePanel::gfxExportPNG()
 		if (filedialog::saveFiles(
 				info, "Export Entries as PNG (Filename will be ignored)", "PNG Files (*.png)|*.png", this))
 		{
+			auto job = std::make_unique<ExportEntriesJob>(true);
+
 			// Go through the selection
 			for (auto& entry : selection)
 			{
@@ -2344,9 +2320,11 @@ bool ArchivePanel::gfxExportPNG()
 				fn.SetPath(info.path);
 				fn.SetExt("png");
 
-				// Do export
-				entryoperations::exportAsPNG(entry, fn.GetFullPath());
+				job->addEntry(entry, fn.GetFullPath().ToStdString());
 			}
+
+			// Do export (in the background)
+			EntryJobDialog::run(this, std::move(job));
 		}
 	}
 
@@ -4442,3 +4420,130 @@ CONSOLE_COMMAND(cd, 1, true)
 		}
 	}
 }
+
+CONSOLE_COMMAND(convertgfx, 2, true)
+{
+	auto* archive = maineditor::currentArchive();
+	auto* panel   = maineditor::currentArchivePanel();
+	if (!archive || !panel)
+		return;
+
+	// Get target format
+	auto* format = SIFormat::getFormat(args[1]);
+	if (format == SIFormat::unknownFormat())
+	{
+		log::error("Unknown image format \"{}\"", args[1]);
+		return;
+	}
+
+	// Load images for matching entries (this needs to be done on the main thread)
+	auto                          entries = Console_SearchEntries(args[0]);
+	vector<SImage>                images(entries.size());
+	vector<SIFormat::ConvertItem> items;
+	vector<ArchiveEntry*>         item_entries;
+	for (unsigned a = 0; a < entries.size(); ++a)
+	{
+		if (!misc::loadImageFromEntry(&images[a], entries[a]) || images[a].format() == format)
+			continue;
+
+		auto& item           = items.emplace_back();
+		item.image           = &images[a];
+		item.opt.pal_current = maineditor::currentPalette(entries[a]);
+		item.opt.pal_target  = item.opt.pal_current;
+		item.opt.col_format  = format->canWriteType(SImage::Type::PalMask) ? SImage::Type::PalMask :
+																			  SImage::Type::RGBA;
+		item_entries.push_back(entries[a]);
+	}
+
+	// Convert all images in parallel
+	format->convertAllWritable(items);
+
+	// Write converted images back to their entries, in order
+	unsigned count = 0;
+	panel->undoManager()->beginRecord("Gfx Format Conversion");
+	for (unsigned a = 0; a < items.size(); ++a)
+	{
+		MemChunk mc;
+		if (!items[a].converted || !format->saveImage(*items[a].image, mc, items[a].opt.pal_target))
+		{
+			log::warning("Unable to convert {} to {}", item_entries[a]->name(), format->name());
+			continue;
+		}
+
+		panel->undoManager()->recordUndoStep(std::make_unique<EntryDataUS>(item_entries[a]));
+		item_entries[a]->importMemChunk(mc);
+		EntryType::detectEntryType(*item_entries[a]);
+		item_entries[a]->setExtensionByType();
+		++count;
+	}
+	panel->undoManager()->endRecord(count > 0);
+
+	log::info("Converted {} entr{} to {}", count, count == 1 ? "y" : "ies", format->name());
+}
+
+// Gets MIDI data from [entry] in [midi], converting it from other MIDI-like
+// formats if needed. Returns false if [entry] isn't a MIDI
+bool Console_EntryMidiData(ArchiveEntry* entry, MemChunk& midi)
+{
+	auto& format = entry->type()->formatId();
+	if (format == "midi_mus")
+		return conversion::musToMidi(entry->data(), midi);
+	if (format == "midi_xmi" || format == "midi_hmi" || format == "midi_hmp")
+		return conversion::zmusToMidi(entry->data(), midi);
+	if (format == "midi_gmid")
+		return conversion::gmidToMidi(entry->data(), midi);
+	if (format == "midi_rmid")
+		return conversion::rmidToMidi(entry->data(), midi);
+	if (format == "midi_smf")
+		return midi.importMem(entry->data());
+
+	return false;
+}
+
+CONSOLE_COMMAND(exportwav, 2, true)
+{
+	if (!audio::canRenderMIDI())
+	{
+		log::error("Unable to render MIDI, check the FluidSynth soundfont is set and loads correctly");
+		return;
+	}
+
+	if (!wxDirExists(args[1]))
+	{
+		log::error("Directory \"{}\" does not exist", args[1]);
+		return;
+	}
+
+	// Get MIDI data for matching entries (this needs to be done on the main thread)
+	auto                      entries = Console_SearchEntries(args[0]);
+	vector<MemChunk>          midis(entries.size());
+	vector<audio::MIDIRender> renders;
+	vector<ArchiveEntry*>     render_entries;
+	for (unsigned a = 0; a < entries.size(); ++a)
+	{
+		if (!Console_EntryMidiData(entries[a], midis[a]))
+			continue;
+
+		renders.emplace_back().midi = &midis[a];
+		render_entries.push_back(entries[a]);
+	}
+
+	// Render all MIDIs in parallel
+	audio::renderMIDIs(renders);
+
+	// Write rendered audio to files
+	unsigned count = 0;
+	for (unsigned a = 0; a < renders.size(); ++a)
+	{
+		auto filename = fmt::format("{}/{}.wav", args[1], render_entries[a]->nameNoExt());
+		if (!renders[a].rendered || !renders[a].wav.exportFile(filename))
+		{
+			log::warning("Unable to export {} as WAV", render_entries[a]->name());
+			continue;
+		}
+
+		++count;
+	}
+
+	log::info("Exported {} MIDI entr{} as WAV", count, count == 1 ? "y" : "ies");
+}
@@ -34,12 +34,14 @@
 #include "App.h"
 #include "Audio/AudioTags.h"
 #include "Audio/MIDIPlayer.h"
+#include "Audio/MIDIRenderer.h"
 #include "Audio/ModMusic.h"
 #include "Audio/Mp3Music.h"
 #include "MainEditor/Conversions.h"
 #include "UI/Controls/SIconButton.h"
 #include "UI/WxUtils.h"
 #include "Utility/StringUtils.h"
+#include "Utility/ThreadPool.h"
 
 using namespace slade;
 
@@ -53,6 +55,56 @@ using namespace slade;
 // -----------------------------------------------------------------------------
 CVAR(Int, snd_volume, 100, CVar::Flag::Save)
 CVAR(Bool, snd_autoplay, false, CVar::Flag::Save)
+CVAR(Bool, snd_midi_render, true, CVar::Flag::Save)
+CVAR(Int, snd_stream_min_length, 20, CVar::Flag::Save)
+
+
+// -----------------------------------------------------------------------------
+//
+// Local Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// Longest MIDI (in seconds) that will be rendered for preview, longer ones are
+// only played through the MIDIPlayer
+constexpr int MIDI_PREVIEW_RENDER_MAX_LENGTH = 180;
+
+// -----------------------------------------------------------------------------
+// Returns true if [audio] is long enough (snd_stream_min_length seconds or
+// more) that it should be streamed rather than decoded all at once
+// -----------------------------------------------------------------------------
+bool shouldStreamAudio(const MemChunk& audio)
+{
+#if SFML_VERSION_MAJOR > 2 || (SFML_VERSION_MAJOR == 2 && SFML_VERSION_MINOR >= 3)
+	// Only the header is read here, nothing is decoded
+	sf::InputSoundFile file;
+	if (!file.openFromMemory(audio.data(), audio.size()))
+		return false;
+
+	return file.getDuration().asSeconds() >= snd_stream_min_length;
+#else
+	return false;
+#endif
+}
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// AudioEntryPanel::MIDIRenderTask Struct
+//
+// -----------------------------------------------------------------------------
+
+// MIDI being rendered to audio on the thread pool. Once done, the rendered
+// audio is played in place of the MIDI so that it can be seeked
+struct AudioEntryPanel::MIDIRenderTask
+{
+	MemChunk          midi;
+	MemChunk          wav;
+	std::atomic<bool> cancelled{ false };
+	std::future<bool> rendered;
+};
 
 
 // -----------------------------------------------------------------------------
@@ -162,6 +214,7 @@ AudioEntryPanel::~AudioEntryPanel()
 	// Stop the timer to avoid crashes
 	timer_seek_->Stop();
 	resetStream();
+	cancelMidiRender();
 }
 
 // -----------------------------------------------------------------------------
@@ -179,6 +232,7 @@ bool AudioEntryPanel::loadEntry(ArchiveEntry* entry)
 	// Stop anything currently playing
 	stopStream();
 	resetStream();
+	cancelMidiRender();
 	opened_ = false;
 
 	// Enable all playback controls initially
@@ -358,8 +412,13 @@ bool AudioEntryPanel::openAudio(MemChunk& audio, const wxString& filename)
 	sound_buffer_ = std::make_unique<sf::SoundBuffer>();
 	audio_type_   = Invalid;
 
+	// Long audio is streamed via sf::Music, which decodes it in chunks as it
+	// plays. This means playback can start immediately, and the decoded audio
+	// doesn't need to be held in memory
+	bool stream = shouldStreamAudio(audio);
+
 	// Load into buffer
-	if (sound_buffer_->loadFromMemory((const char*)audio.data(), audio.size()))
+	if (!stream && sound_buffer_->loadFromMemory((const char*)audio.data(), audio.size()))
 	{
 		log::info(3, "opened as sound");
 		// Bind to sound
@@ -384,12 +443,14 @@ bool AudioEntryPanel::openAudio(MemChunk& audio, const wxString& filename)
 	else if (music_->openFromMemory((const char*)audio.data(), audio.size()))
 	{
 		log::info(3, "opened as music");
-		// Couldn't open the audio as a sf::SoundBuffer, try sf::Music instead
+		// Streaming, or couldn't open the audio as a sf::SoundBuffer, so use
+		// sf::Music instead
 		audio_type_ = Music;
 
 		// Enable play controls
 		setAudioDuration(music_->getDuration().asMilliseconds());
 		btn_play_->Enable();
+		btn_pause_->Enable();
 		btn_stop_->Enable();
 
 		return true;
@@ -409,6 +470,10 @@ bool AudioEntryPanel::openAudio(MemChunk& audio, const wxString& filename)
 // -----------------------------------------------------------------------------
 bool AudioEntryPanel::openMidi(MemChunk& data, const wxString& filename)
 {
+	// Stop if sound currently playing
+	resetStream();
+	cancelMidiRender();
+
 	audio_type_ = MIDI;
 
 	// Enable volume control
@@ -427,6 +492,9 @@ bool AudioEntryPanel::openMidi(MemChunk& data, const wxString& filename)
 			// Setup seekbar
 			setAudioDuration(audio::midiLength(data));
 
+			// Render to audio in the background, to allow seeking
+			startMidiRender(data);
+
 			return true;
 		}
 	}
@@ -434,6 +502,82 @@ bool AudioEntryPanel::openMidi(MemChunk& data, const wxString& filename)
 	return false;
 }
 
+// -----------------------------------------------------------------------------
+// Starts rendering the MIDI [data] to audio in the background (if enabled).
+// The fluidsynth MIDIPlayer can't seek, so the rendered audio is used instead
+// once it is ready (see switchToMidiRender)
+// -----------------------------------------------------------------------------
+void AudioEntryPanel::startMidiRender(const MemChunk& data)
+{
+	cancelMidiRender();
+
+	// Only render when playing via fluidsynth, otherwise the rendered audio
+	// would sound different and the soundfont would be loaded for nothing
+	if (!snd_midi_render || !audio::midiPlayer().isFluidSynth()
+		|| audio::midiLength(data) > MIDI_PREVIEW_RENDER_MAX_LENGTH * 1000 || !audio::canRenderMIDI())
+		return;
+
+	auto task = std::make_shared<MIDIRenderTask>();
+	task->midi.importMem(data);
+	task->rendered = app::threadPool().submit(
+		[task]() {
+			return audio::renderMIDI(task->midi, task->wav, &task->cancelled, MIDI_PREVIEW_RENDER_MAX_LENGTH);
+		});
+	midi_render_ = task;
+}
+
+// -----------------------------------------------------------------------------
+// Cancels the current background MIDI render, if any
+// -----------------------------------------------------------------------------
+void AudioEntryPanel::cancelMidiRender()
+{
+	if (!midi_render_)
+		return;
+
+	// The render task keeps its own reference, so no need to wait for it
+	midi_render_->cancelled = true;
+	midi_render_.reset();
+}
+
+// -----------------------------------------------------------------------------
+// Switches from the current MIDI to its rendered audio if the background
+// render has finished, continuing from the current position if it is playing.
+// Returns true if switched
+// -----------------------------------------------------------------------------
+bool AudioEntryPanel::switchToMidiRender()
+{
+	if (audio_type_ != MIDI || !midi_render_ || !audio::midiPlayer().isFluidSynth()
+		|| midi_render_->rendered.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+		return false;
+
+	auto task = std::move(midi_render_);
+	if (!task->rendered.get())
+		return false;
+
+	auto buffer = std::make_unique<sf::SoundBuffer>();
+	if (!buffer->loadFromMemory(task->wav.data(), task->wav.size()))
+		return false;
+
+	// Stop the MIDI
+	bool playing = audio::midiPlayer().isPlaying();
+	int  pos     = audio::midiPlayer().position();
+	audio::midiPlayer().stop();
+
+	// Switch to the rendered audio
+	sound_buffer_ = std::move(buffer);
+	sound_->setBuffer(*sound_buffer_);
+	sound_->setVolume(snd_volume);
+	audio_type_ = Sound;
+	btn_pause_->Enable();
+	if (playing)
+	{
+		sound_->play();
+		sound_->setPlayingOffset(sf::milliseconds(pos));
+	}
+
+	return true;
+}
+
 // -----------------------------------------------------------------------------
 // Opens a Module file for playback
 // -----------------------------------------------------------------------------
@@ -506,6 +650,8 @@ void AudioEntryPanel::startStream()
 	if (!opened_ && entry_.lock())
 		open(entry_.lock().get());
 
+	switchToMidiRender();
+
 	switch (audio_type_)
 	{
 	case Sound: sound_->play(); break;
@@ -753,6 +899,9 @@ void AudioEntryPanel::onTimer(wxTimerEvent& e)
 // -----------------------------------------------------------------------------
 void AudioEntryPanel::onSliderSeekChanged(wxCommandEvent& e)
 {
+	// MIDI can only be seeked once it has been rendered
+	switchToMidiRender();
+
 	switch (audio_type_)
 	{
 	case Sound: sound_->setPlayingOffset(sf::milliseconds(slider_seek_->GetValue())); break;
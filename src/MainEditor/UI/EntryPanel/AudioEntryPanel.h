@@ -68,11 +68,18 @@ private:
 	unique_ptr<audio::ModMusic> mod_;
 	unique_ptr<audio::Mp3Music> mp3_;
 
+	// Background render of the current MIDI to audio
+	struct MIDIRenderTask;
+	shared_ptr<MIDIRenderTask> midi_render_;
+
 	bool open(ArchiveEntry* entry);
 	bool openAudio(MemChunk& audio, const wxString& filename);
 	bool openMidi(MemChunk& data, const wxString& filename);
 	bool openMod(MemChunk& data);
 	bool openMp3(MemChunk& data);
+	void startMidiRender(const MemChunk& data);
+	void cancelMidiRender();
+	bool switchToMidiRender();
 	bool updateInfo(ArchiveEntry& entry) const;
 	void startStream();
 	void stopStream() const;
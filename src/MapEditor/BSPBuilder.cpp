@@ -0,0 +1,1284 @@
+
+// -----------------------------------------------------------------------------
+// SLADE - It's a Doom Editor
+// Copyright(C) 2008 - 2020 Simon Judd
+//
+// Email:       sirjuddington@gmail.com
+// Web:         http://slade.mancubus.net
+// Filename:    BSPBuilder.cpp
+// Description: BSPBuilder class - builds BSP nodes for a map directly from a
+//              SLADEMap, without needing an external node builder. Can write
+//              vanilla NODES/SEGS/SSECTORS, extended (XNOD/ZNOD) nodes and GL
+//              (XGL2/ZGL2) nodes, as well as a BLOCKMAP and empty REJECT.
+//              GL nodes go in ZNODES for UDMF maps, and in SSECTORS (with
+//              empty NODES and SEGS, as ZDBSP does) for binary format maps.
+//              Large subtrees are partitioned in parallel on a ThreadPool.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301, USA.
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+//
+// Includes
+//
+// -----------------------------------------------------------------------------
+#include "Main.h"
+#include "BSPBuilder.h"
+#include "Archive/Archive.h"
+#include "General/Defs.h"
+#include "SLADEMap/SLADEMap.h"
+#include "Utility/Compression.h"
+#include "Utility/MathStuff.h"
+#include "Utility/StringUtils.h"
+#include "Utility/ThreadPool.h"
+#include <unordered_set>
+
+using namespace slade;
+
+
+// -----------------------------------------------------------------------------
+//
+// Variables
+//
+// -----------------------------------------------------------------------------
+CVAR(Int, bsp_split_cost, 8, CVar::Flag::Save)
+CVAR(Int, bsp_max_candidates, 128, CVar::Flag::Save)
+CVAR(Int, bsp_parallel_segs, 2000, CVar::Flag::Save)
+namespace
+{
+// Distance from a line within which a point is considered to be on it
+constexpr double BSP_EPSILON = 0.001;
+
+// Tolerance used when matching segs to subsector edges for GL nodes
+constexpr double BSP_GL_EPSILON = 0.01;
+
+// Vanilla limits (most fields are signed shorts in the vanilla engine)
+constexpr unsigned BSP_VANILLA_MAX = 32767;
+
+// Flags subsector indices in the flattened node children
+constexpr unsigned BSP_SUBSECTOR_BIT = 0x80000000;
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// -----------------------------------------------------------------------------
+// Simple little-endian binary writer for node lumps
+// -----------------------------------------------------------------------------
+class NodeLumpWriter
+{
+public:
+	void writeU8(uint8_t val) { data_.push_back(val); }
+	void writeU16(uint16_t val)
+	{
+		writeU8(val & 0xFF);
+		writeU8(val >> 8);
+	}
+	void writeI16(int16_t val) { writeU16(static_cast<uint16_t>(val)); }
+	void writeU32(uint32_t val)
+	{
+		writeU16(val & 0xFFFF);
+		writeU16(val >> 16);
+	}
+	void writeI32(int32_t val) { writeU32(static_cast<uint32_t>(val)); }
+	void copyTo(MemChunk& mc) const { mc.importMem(data_.data(), data_.size()); }
+
+private:
+	vector<uint8_t> data_;
+};
+
+// -----------------------------------------------------------------------------
+// Returns the distance of [point] from the line [start]->[start+delta] of
+// [length]. Positive values are on the front (right) side of the line
+// -----------------------------------------------------------------------------
+double pointSide(const Vec2d& point, const Vec2d& start, const Vec2d& delta, double length)
+{
+	return ((point.x - start.x) * delta.y - (point.y - start.y) * delta.x) / length;
+}
+
+// -----------------------------------------------------------------------------
+// Returns the point where the seg [v1]->[v2] crosses a partition line, where
+// [d1] and [d2] are the distances of its ends from the line
+// -----------------------------------------------------------------------------
+Vec2d splitPoint(const Vec2d& v1, const Vec2d& v2, double d1, double d2)
+{
+	return v1 + (v2 - v1) * (d1 / (d1 - d2));
+}
+
+// -----------------------------------------------------------------------------
+// Checks if splitting the seg [v1]->[v2] at a partition line would only split
+// off a tiny sliver (which would end up as a degenerate zero-area subsector).
+// Returns 1 if the whole seg should go on the front of the partition instead,
+// -1 if it should go on the back, or 0 if it should be split normally
+// -----------------------------------------------------------------------------
+int sliverSide(const Vec2d& v1, const Vec2d& v2, double d1, double d2)
+{
+	auto split = splitPoint(v1, v2, d1, d2);
+	if (math::distance(v1, split) <= BSP_GL_EPSILON)
+		return d2 > 0 ? 1 : -1;
+	if (math::distance(v2, split) <= BSP_GL_EPSILON)
+		return d1 > 0 ? 1 : -1;
+
+	return 0;
+}
+
+// -----------------------------------------------------------------------------
+// Clips the convex polygon [poly] to the front side of the line
+// [start]->[start+delta] (or the back side if [front] is false)
+// -----------------------------------------------------------------------------
+vector<Vec2d> clipPolygon(const vector<Vec2d>& poly, const Vec2d& start, const Vec2d& delta, bool front)
+{
+	vector<Vec2d> out;
+	auto          length = delta.magnitude();
+	if (poly.empty() || length < BSP_EPSILON)
+		return poly;
+
+	auto n = poly.size();
+	for (unsigned a = 0; a < n; a++)
+	{
+		auto& cur   = poly[a];
+		auto& next  = poly[(a + 1) % n];
+		auto  d_cur = pointSide(cur, start, delta, length);
+		auto  d_nxt = pointSide(next, start, delta, length);
+		if (!front)
+		{
+			d_cur = -d_cur;
+			d_nxt = -d_nxt;
+		}
+
+		if (d_cur >= -BSP_EPSILON)
+			out.push_back(cur);
+
+		if ((d_cur > BSP_EPSILON && d_nxt < -BSP_EPSILON) || (d_cur < -BSP_EPSILON && d_nxt > BSP_EPSILON))
+		{
+			auto t = d_cur / (d_cur - d_nxt);
+			out.push_back(cur + (next - cur) * t);
+		}
+	}
+
+	// Remove any (near) duplicate points
+	vector<Vec2d> result;
+	for (auto& point : out)
+		if (result.empty() || math::distance(result.back(), point) > BSP_EPSILON)
+			result.push_back(point);
+	while (result.size() > 1 && math::distance(result.front(), result.back()) <= BSP_EPSILON)
+		result.pop_back();
+
+	return result;
+}
+
+// -----------------------------------------------------------------------------
+// Extends [bbox] to include [point], initialising it if [init] is false
+// -----------------------------------------------------------------------------
+void extendBBox(BBox& bbox, const Vec2d& point, bool& init)
+{
+	if (!init)
+	{
+		bbox.min = point;
+		bbox.max = point;
+		init     = true;
+		return;
+	}
+
+	bbox.min.x = std::min(bbox.min.x, point.x);
+	bbox.min.y = std::min(bbox.min.y, point.y);
+	bbox.max.x = std::max(bbox.max.x, point.x);
+	bbox.max.y = std::max(bbox.max.y, point.y);
+}
+
+// -----------------------------------------------------------------------------
+// Converts [value] to 16.16 fixed point
+// -----------------------------------------------------------------------------
+int32_t toFixed(double value)
+{
+	return static_cast<int32_t>(std::lround(value * 65536.));
+}
+
+// -----------------------------------------------------------------------------
+// Converts [value] to a (clamped) signed short
+// -----------------------------------------------------------------------------
+int16_t toShort(double value)
+{
+	return static_cast<int16_t>(math::clamp(std::round(value), -32768., 32767.));
+}
+
+// -----------------------------------------------------------------------------
+// Writes the bounding box [bbox] in node format (top, bottom, left, right)
+// -----------------------------------------------------------------------------
+void writeNodeBBox(NodeLumpWriter& out, const BBox& bbox)
+{
+	out.writeI16(toShort(std::ceil(bbox.max.y)));
+	out.writeI16(toShort(std::floor(bbox.min.y)));
+	out.writeI16(toShort(std::floor(bbox.min.x)));
+	out.writeI16(toShort(std::ceil(bbox.max.x)));
+}
+
+// -----------------------------------------------------------------------------
+// Writes [data] to [out] with [magic], compressing the data following the magic
+// (and using [magic_compressed]) if [compress] is true
+// -----------------------------------------------------------------------------
+void writeMagicLump(
+	MemChunk&             out,
+	const NodeLumpWriter& data,
+	const char*           magic,
+	const char*           magic_compressed,
+	bool                  compress)
+{
+	MemChunk body;
+	data.copyTo(body);
+
+	if (compress)
+	{
+		MemChunk zbody;
+		if (compression::zlibDeflate(body, zbody, 9))
+		{
+			out.clear();
+			out.write(magic_compressed, 4);
+			out.write(zbody.data(), zbody.size());
+			return;
+		}
+
+		log::warning("Failed to compress nodes, writing uncompressed");
+	}
+
+	out.clear();
+	out.write(magic, 4);
+	out.write(body.data(), body.size());
+}
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// BSPBuilder::BuildNode Struct
+//
+// -----------------------------------------------------------------------------
+struct BSPBuilder::BuildNode
+{
+	// Node
+	Vec2d                 part_start;
+	Vec2d                 part_delta;
+	unique_ptr<BuildNode> child[2]; // Front (right), back (left)
+
+	// Subsector
+	vector<Seg>   segs;
+	vector<GLSeg> gl_segs;
+
+	// Bounds of everything under this node
+	BBox bounds;
+
+	bool isLeaf() const { return !child[0]; }
+};
+
+
+// -----------------------------------------------------------------------------
+//
+// BSPBuilder Class Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// BSPBuilder class constructor
+// -----------------------------------------------------------------------------
+BSPBuilder::BSPBuilder(const SLADEMap& map, const Options& options) : map_{ map }, options_{ options } {}
+
+// -----------------------------------------------------------------------------
+// BSPBuilder class destructor
+// -----------------------------------------------------------------------------
+BSPBuilder::~BSPBuilder() = default;
+
+// -----------------------------------------------------------------------------
+// Builds nodes for the map. If [pool] is given, large subtrees (and partition
+// selection for large sets of segs) are processed in parallel on it.
+// Returns false if nodes couldn't be built for the map
+// -----------------------------------------------------------------------------
+bool BSPBuilder::build(ThreadPool* pool)
+{
+	sf::Clock clock;
+
+	auto format = map_.currentFormat();
+	if (format == MapFormat::Doom64)
+	{
+		log::warning("The built-in node builder doesn't support Doom 64 format maps");
+		return false;
+	}
+
+	pool_     = pool;
+	build_gl_ = options_.gl || format == MapFormat::UDMF;
+	root_.reset();
+	nodes_.clear();
+	subsectors_.clear();
+	segs_.clear();
+	gl_segs_.clear();
+	new_vertices_.clear();
+	new_vertex_map_.clear();
+	stats_ = {};
+
+	// Create initial segs from all line sides
+	vector<Seg> segs;
+	BBox        bounds;
+	bool        bounds_init = false;
+	fractional_             = false;
+	for (unsigned a = 0; a < map_.nLines(); a++)
+	{
+		auto line = map_.line(a);
+		auto p1   = line->v1()->position();
+		auto p2   = line->v2()->position();
+		if (math::distance(p1, p2) < BSP_EPSILON)
+			continue;
+
+		if (p1.x != std::floor(p1.x) || p1.y != std::floor(p1.y) || p2.x != std::floor(p2.x)
+			|| p2.y != std::floor(p2.y))
+			fractional_ = true;
+
+		extendBBox(bounds, p1, bounds_init);
+		extendBBox(bounds, p2, bounds_init);
+
+		VertexRef v1{ static_cast<int>(line->v1()->index()), p1 };
+		VertexRef v2{ static_cast<int>(line->v2()->index()), p2 };
+		for (int side = 0; side < 2; side++)
+		{
+			auto map_side = side == 0 ? line->s1() : line->s2();
+			if (!map_side || !map_side->sector())
+				continue;
+
+			Seg seg;
+			seg.line       = a;
+			seg.back       = side == 1;
+			seg.v1         = seg.back ? v2 : v1;
+			seg.v2         = seg.back ? v1 : v2;
+			seg.part_start = seg.v1.pos;
+			seg.part_delta = seg.v2.pos - seg.v1.pos;
+			segs.push_back(seg);
+		}
+	}
+
+	if (segs.empty())
+	{
+		log::warning("Unable to build nodes, the map has no lines with sides");
+		return false;
+	}
+
+	// Initial cell (clockwise, so the interior is on the right of each edge)
+	vector<Vec2d> cell;
+	if (build_gl_)
+	{
+		double x1 = bounds.min.x - 64., y1 = bounds.min.y - 64.;
+		double x2 = bounds.max.x + 64., y2 = bounds.max.y + 64.;
+		cell      = { { x1, y2 }, { x2, y2 }, { x2, y1 }, { x1, y1 } };
+	}
+
+	// Build the tree
+	root_ = buildNode(segs, cell);
+
+	// Flatten it to the output lists
+	flattenNode(*root_);
+	num_split_vertices_ = new_vertices_.size();
+	if (build_gl_)
+	{
+		unsigned subsector = 0;
+		flattenGLSegs(*root_, subsector);
+	}
+	root_.reset();
+
+	// Single subsector maps still need a node (vanilla crashes without one)
+	if (nodes_.empty())
+	{
+		OutNode node;
+		node.part_start = { bounds.min.x, bounds.min.y };
+		node.part_delta = { bounds.max.x - bounds.min.x, 0. };
+		node.bbox[0]    = bounds;
+		node.bbox[1]    = bounds;
+		node.child[0]   = BSP_SUBSECTOR_BIT;
+		node.child[1]   = BSP_SUBSECTOR_BIT;
+		nodes_.push_back(node);
+	}
+
+	// Check vanilla limits (GL nodes have no limits to exceed)
+	stats_.extended = options_.extended;
+	if (!stats_.extended && !build_gl_
+		&& (nodes_.size() > BSP_VANILLA_MAX || subsectors_.size() > BSP_VANILLA_MAX || segs_.size() > BSP_VANILLA_MAX
+			|| map_.nVertices() + num_split_vertices_ > BSP_VANILLA_MAX))
+	{
+		log::info("Nodes exceed vanilla limits, writing extended nodes");
+		stats_.extended = true;
+	}
+
+	stats_.nodes        = nodes_.size();
+	stats_.subsectors   = subsectors_.size();
+	stats_.segs         = segs_.size();
+	stats_.gl_segs      = gl_segs_.size();
+	stats_.new_vertices = new_vertices_.size();
+	stats_.build_ms     = clock.getElapsedTime().asMicroseconds() / 1000.;
+
+	log::info(
+		2,
+		"Built nodes in {:.1f}ms: {} nodes, {} subsectors, {} segs, {} splits",
+		stats_.build_ms,
+		stats_.nodes,
+		stats_.subsectors,
+		stats_.segs,
+		stats_.splits);
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Writes the built node lumps to [wad], which should contain the map's data
+// entries (as written by SLADEMap::writeMap). Existing node lumps are replaced
+// -----------------------------------------------------------------------------
+bool BSPBuilder::writeLumps(Archive& wad) const
+{
+	if (nodes_.empty())
+		return false;
+
+	// Sets the data of lump [name] to [data], adding it after [after] if needed
+	auto set_lump = [&wad](string_view name, MemChunk& data, string_view after) {
+		auto entry = wad.entry(name);
+		if (!entry)
+		{
+			auto     prev     = after.empty() ? nullptr : wad.entry(after);
+			unsigned position = prev ? wad.entryIndex(prev) + 1 : 0xFFFFFFFF;
+			entry             = wad.addNewEntry(name, position).get();
+		}
+		entry->importMemChunk(data);
+	};
+
+	// UDMF: GL nodes in ZNODES, before ENDMAP
+	if (map_.currentFormat() == MapFormat::UDMF)
+	{
+		MemChunk znodes;
+		writeGLNodes(znodes);
+
+		auto entry = wad.entry("ZNODES");
+		if (!entry)
+		{
+			auto     endmap   = wad.entry("ENDMAP");
+			unsigned position = endmap ? wad.entryIndex(endmap) : 0xFFFFFFFF;
+			entry             = wad.addNewEntry("ZNODES", position).get();
+		}
+		entry->importMemChunk(znodes);
+
+		return true;
+	}
+
+	MemChunk segs, ssectors, nodes;
+	if (build_gl_)
+	{
+		// Binary format GL nodes go in SSECTORS, with NODES and SEGS left
+		// empty (ZDoom only reads ZNODES for UDMF maps)
+		writeGLNodes(ssectors);
+	}
+	else if (stats_.extended)
+		writeExtendedNodes(nodes);
+	else
+	{
+		// Add split vertices to VERTEXES
+		auto vertexes = wad.entry("VERTEXES");
+		if (!vertexes || vertexes->size() != map_.nVertices() * 4)
+		{
+			log::error("Unable to write nodes, invalid VERTEXES lump");
+			return false;
+		}
+		NodeLumpWriter new_verts;
+		for (unsigned a = 0; a < num_split_vertices_; a++)
+		{
+			new_verts.writeI16(toShort(new_vertices_[a].x));
+			new_verts.writeI16(toShort(new_vertices_[a].y));
+		}
+		MemChunk vert_data;
+		vert_data.write(vertexes->rawData(true), vertexes->size());
+		MemChunk new_data;
+		new_verts.copyTo(new_data);
+		vert_data.write(new_data.data(), new_data.size());
+		vertexes->importMemChunk(vert_data);
+
+		writeVanillaNodes(segs, ssectors, nodes);
+	}
+
+	set_lump("SEGS", segs, "VERTEXES");
+	set_lump("SSECTORS", ssectors, "SEGS");
+	set_lump("NODES", nodes, "SSECTORS");
+
+	// REJECT and BLOCKMAP are left as they are if disabled
+	if (options_.reject)
+	{
+		MemChunk reject;
+		writeReject(reject);
+		set_lump("REJECT", reject, "SECTORS");
+	}
+	if (options_.blockmap)
+	{
+		MemChunk blockmap;
+		writeBlockmap(blockmap);
+		set_lump("BLOCKMAP", blockmap, "REJECT");
+	}
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Parses node builder [options] (as set in the node builder preferences) into
+// an Options struct
+// -----------------------------------------------------------------------------
+BSPBuilder::Options BSPBuilder::parseOptions(string_view options)
+{
+	Options opt;
+	for (const auto& option : strutil::splitV(options, ' '))
+	{
+		if (option == "--extended")
+			opt.extended = true;
+		else if (option == "--gl")
+			opt.gl = true;
+		else if (option == "--compress")
+			opt.compress = true;
+		else if (option == "--no-blockmap")
+			opt.blockmap = false;
+		else if (option == "--no-reject")
+			opt.reject = false;
+	}
+
+	return opt;
+}
+
+// -----------------------------------------------------------------------------
+// Recursively builds a node from [segs] (which will be cleared). [cell] is the
+// convex area covered by the node, only used for GL nodes
+// -----------------------------------------------------------------------------
+unique_ptr<BSPBuilder::BuildNode> BSPBuilder::buildNode(vector<Seg>& segs, const vector<Vec2d>& cell)
+{
+	auto node = std::make_unique<BuildNode>();
+
+	// Split the segs if they aren't convex
+	bool split_slivers = false;
+	auto part          = choosePartition(segs, split_slivers);
+	if (part >= 0)
+	{
+		auto partition = segs[part];
+		vector<Seg> child_segs[2];
+		splitSegs(segs, partition, child_segs[0], child_segs[1], split_slivers);
+
+		// Can't happen since partitionCost sorts segs the same way, but make a
+		// subsector rather than recursing forever if nothing was divided
+		if (child_segs[0].empty() || child_segs[1].empty())
+		{
+			log::warning("Node builder partition didn't divide {} segs", segs.size());
+			segs = child_segs[0].empty() ? std::move(child_segs[1]) : std::move(child_segs[0]);
+		}
+		else
+		{
+			segs.clear();
+			segs.shrink_to_fit();
+			node->part_start = partition.part_start;
+			node->part_delta = partition.part_delta;
+
+			vector<Vec2d> child_cells[2];
+			if (build_gl_)
+			{
+				child_cells[0] = clipPolygon(cell, partition.part_start, partition.part_delta, true);
+				child_cells[1] = clipPolygon(cell, partition.part_start, partition.part_delta, false);
+			}
+
+			// Build child nodes, in parallel if there are enough segs to make it worthwhile
+			auto build_child = [&](size_t index) {
+				node->child[index] = buildNode(child_segs[index], child_cells[index]);
+			};
+			auto min_segs = std::min(child_segs[0].size(), child_segs[1].size());
+			if (pool_ && bsp_parallel_segs > 0 && min_segs >= static_cast<size_t>(bsp_parallel_segs))
+				pool_->parallelFor(2, build_child);
+			else
+			{
+				build_child(0);
+				build_child(1);
+			}
+
+			node->bounds = node->child[0]->bounds;
+			node->bounds.extend(node->child[1]->bounds);
+
+			return node;
+		}
+	}
+
+	// Convex, create subsector
+	node->segs = std::move(segs);
+	if (build_gl_)
+		buildGLSegs(*node, cell);
+
+	bool init = false;
+	for (auto& seg : node->segs)
+	{
+		extendBBox(node->bounds, seg.v1.pos, init);
+		extendBBox(node->bounds, seg.v2.pos, init);
+	}
+	for (auto& seg : node->gl_segs)
+		extendBBox(node->bounds, seg.v1.pos, init);
+
+	return node;
+}
+
+// -----------------------------------------------------------------------------
+// Returns the index of the seg in [segs] that makes the best partition line,
+// or -1 if [segs] are convex (ie. no partition is needed).
+// Partitions that would only divide the segs by splitting off tiny slivers are
+// avoided if possible. If no other partition exists, [split_slivers] is set to
+// true and the slivers must be split when using the returned partition
+// -----------------------------------------------------------------------------
+int BSPBuilder::choosePartition(const vector<Seg>& segs, bool& split_slivers) const
+{
+	// Get unique partition lines (segs on the same side of the same line share one)
+	vector<unsigned>        candidates;
+	std::unordered_set<u64> seen;
+	for (unsigned a = 0; a < segs.size(); a++)
+		if (seen.insert(static_cast<u64>(segs[a].line) << 1 | (segs[a].back ? 1 : 0)).second)
+			candidates.push_back(a);
+
+	// Finds the lowest cost partition from [list]
+	split_slivers  = false;
+	auto find_best = [&](const vector<unsigned>& list) {
+		int best      = -1;
+		int best_cost = std::numeric_limits<int>::max();
+
+		if (pool_ && list.size() > 1 && segs.size() * list.size() >= 100000)
+		{
+			vector<int> costs(list.size());
+			pool_->parallelFor(
+				list.size(),
+				[&](size_t index) {
+					costs[index] = partitionCost(
+						segs, segs[list[index]], std::numeric_limits<int>::max(), split_slivers);
+				},
+				4);
+
+			for (unsigned a = 0; a < list.size(); a++)
+				if (costs[a] >= 0 && costs[a] < best_cost)
+				{
+					best      = list[a];
+					best_cost = costs[a];
+				}
+		}
+		else
+		{
+			for (auto index : list)
+			{
+				auto cost = partitionCost(segs, segs[index], best_cost, split_slivers);
+				if (cost >= 0 && cost < best_cost)
+				{
+					best      = index;
+					best_cost = cost;
+				}
+			}
+		}
+
+		return best;
+	};
+
+	// Only check a sample of candidates for large sets of segs
+	if (bsp_max_candidates > 0 && candidates.size() > static_cast<unsigned>(bsp_max_candidates))
+	{
+		vector<unsigned> sample;
+		double           step = static_cast<double>(candidates.size()) / bsp_max_candidates;
+		for (int a = 0; a < bsp_max_candidates; a++)
+			sample.push_back(candidates[static_cast<unsigned>(a * step)]);
+
+		auto best = find_best(sample);
+		if (best >= 0)
+			return best;
+	}
+
+	// Check all candidates
+	auto best = find_best(candidates);
+	if (best >= 0)
+		return best;
+
+	// No partition divides the segs without splitting off slivers. If one
+	// does when splitting them the segs still aren't convex, so the slivers
+	// have to be split, otherwise they're convex
+	split_slivers = true;
+	return find_best(candidates);
+}
+
+// -----------------------------------------------------------------------------
+// Returns the cost of splitting [segs] with [partition], or -1 if it doesn't
+// divide them at all. Stops early and returns [max_cost] if the cost is higher.
+// Segs are sorted the same way as splitSegs does with [split_slivers]
+// -----------------------------------------------------------------------------
+int BSPBuilder::partitionCost(const vector<Seg>& segs, const Seg& partition, int max_cost, bool split_slivers) const
+{
+	auto& p_start  = partition.part_start;
+	auto& p_delta  = partition.part_delta;
+	auto  p_length = p_delta.magnitude();
+	int   front = 0, back = 0, splits = 0;
+
+	for (auto& seg : segs)
+	{
+		auto d1 = pointSide(seg.v1.pos, p_start, p_delta, p_length);
+		auto d2 = pointSide(seg.v2.pos, p_start, p_delta, p_length);
+
+		if (std::fabs(d1) <= BSP_EPSILON && std::fabs(d2) <= BSP_EPSILON)
+		{
+			// Collinear, side depends on direction
+			auto dot = (seg.v2.pos - seg.v1.pos).dot(p_delta);
+			if (dot > 0)
+				front++;
+			else
+				back++;
+		}
+		else if (d1 >= -BSP_EPSILON && d2 >= -BSP_EPSILON)
+			front++;
+		else if (d1 <= BSP_EPSILON && d2 <= BSP_EPSILON)
+			back++;
+		else if (auto side = split_slivers ? 0 : sliverSide(seg.v1.pos, seg.v2.pos, d1, d2); side != 0)
+			(side > 0 ? front : back)++;
+		else
+		{
+			splits++;
+			if (splits * bsp_split_cost > max_cost)
+				return max_cost;
+		}
+	}
+
+	if (back + splits == 0 || front + splits == 0)
+		return -1;
+
+	return splits * bsp_split_cost + std::abs(front - back);
+}
+
+// -----------------------------------------------------------------------------
+// Sorts [segs] into [front] and [back] of [partition], splitting any that cross
+// it. Segs that would only have a tiny sliver split off are put entirely on
+// one side unless [split_slivers] is true
+// -----------------------------------------------------------------------------
+void BSPBuilder::splitSegs(
+	vector<Seg>& segs,
+	const Seg&   partition,
+	vector<Seg>& front,
+	vector<Seg>& back,
+	bool         split_slivers) const
+{
+	auto& p_start  = partition.part_start;
+	auto& p_delta  = partition.part_delta;
+	auto  p_length = p_delta.magnitude();
+	front.reserve(segs.size() / 2);
+	back.reserve(segs.size() / 2);
+
+	for (auto& seg : segs)
+	{
+		auto d1 = pointSide(seg.v1.pos, p_start, p_delta, p_length);
+		auto d2 = pointSide(seg.v2.pos, p_start, p_delta, p_length);
+
+		if (std::fabs(d1) <= BSP_EPSILON && std::fabs(d2) <= BSP_EPSILON)
+		{
+			auto dot = (seg.v2.pos - seg.v1.pos).dot(p_delta);
+			(dot > 0 ? front : back).push_back(seg);
+		}
+		else if (d1 >= -BSP_EPSILON && d2 >= -BSP_EPSILON)
+			front.push_back(seg);
+		else if (d1 <= BSP_EPSILON && d2 <= BSP_EPSILON)
+			back.push_back(seg);
+		else if (auto side = split_slivers ? 0 : sliverSide(seg.v1.pos, seg.v2.pos, d1, d2); side != 0)
+		{
+			// Don't split off a tiny sliver, put the whole seg on the side the
+			// rest of it is on
+			(side > 0 ? front : back).push_back(seg);
+		}
+		else
+		{
+			// Split at the intersection point
+			VertexRef split{ -1, splitPoint(seg.v1.pos, seg.v2.pos, d1, d2) };
+
+			auto seg1 = seg;
+			auto seg2 = seg;
+			seg1.v2   = split;
+			seg2.v1   = split;
+			seg2.offset += math::distance(seg.v1.pos, split.pos);
+
+			if (d1 > 0)
+			{
+				front.push_back(seg1);
+				back.push_back(seg2);
+			}
+			else
+			{
+				back.push_back(seg1);
+				front.push_back(seg2);
+			}
+		}
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Builds the GL segs for subsector [leaf], by clipping its [cell] to its segs
+// and walking the resulting convex polygon, filling any gaps with minisegs
+// -----------------------------------------------------------------------------
+void BSPBuilder::buildGLSegs(BuildNode& leaf, const vector<Vec2d>& cell) const
+{
+	auto& segs = leaf.segs;
+	auto  poly = cell;
+	for (auto& seg : segs)
+		poly = clipPolygon(poly, seg.v1.pos, seg.v2.pos - seg.v1.pos, true);
+
+	if (poly.size() < 3)
+	{
+		buildGLSegsSorted(leaf);
+		return;
+	}
+
+	// Returns a reference to the seg vertex at [point], or a new vertex if none
+	auto corner_ref = [&segs](const Vec2d& point) {
+		for (auto& seg : segs)
+		{
+			if (math::distance(seg.v1.pos, point) <= BSP_GL_EPSILON)
+				return seg.v1;
+			if (math::distance(seg.v2.pos, point) <= BSP_GL_EPSILON)
+				return seg.v2;
+		}
+		return VertexRef{ -1, point };
+	};
+
+	vector<bool> used(segs.size(), false);
+	auto         n = poly.size();
+	for (unsigned a = 0; a < n; a++)
+	{
+		auto& p1     = poly[a];
+		auto& p2     = poly[(a + 1) % n];
+		auto  delta  = p2 - p1;
+		auto  length = delta.magnitude();
+		if (length < BSP_GL_EPSILON)
+			continue;
+
+		// Find segs on this edge, ordered by distance along it
+		vector<std::pair<double, unsigned>> edge_segs;
+		for (unsigned s = 0; s < segs.size(); s++)
+		{
+			auto& seg = segs[s];
+			if (used[s] || std::fabs(pointSide(seg.v1.pos, p1, delta, length)) > BSP_GL_EPSILON
+				|| std::fabs(pointSide(seg.v2.pos, p1, delta, length)) > BSP_GL_EPSILON)
+				continue;
+
+			auto dot = (seg.v2.pos - seg.v1.pos).dot(delta);
+			if (dot <= 0)
+				continue;
+
+			auto t = (seg.v1.pos - p1).dot(delta) / length;
+			edge_segs.emplace_back(t, s);
+		}
+		std::sort(edge_segs.begin(), edge_segs.end());
+
+		// Add segs along the edge, with minisegs for any gaps
+		auto   cursor   = corner_ref(p1);
+		double cursor_t = 0.;
+		for (auto& edge_seg : edge_segs)
+		{
+			auto& seg = segs[edge_seg.second];
+			if (edge_seg.first - cursor_t > BSP_GL_EPSILON)
+				leaf.gl_segs.push_back({ cursor, -1, false });
+
+			leaf.gl_segs.push_back({ seg.v1, static_cast<int>(seg.line), seg.back });
+			used[edge_seg.second] = true;
+
+			cursor   = seg.v2;
+			cursor_t = (seg.v2.pos - p1).dot(delta) / length;
+		}
+		if (length - cursor_t > BSP_GL_EPSILON)
+			leaf.gl_segs.push_back({ cursor, -1, false });
+	}
+
+	// Fall back to sorting if any segs weren't on the polygon edges
+	for (auto seg_used : used)
+		if (!seg_used)
+		{
+			leaf.gl_segs.clear();
+			buildGLSegsSorted(leaf);
+			return;
+		}
+}
+
+// -----------------------------------------------------------------------------
+// Builds the GL segs for subsector [leaf] by sorting its segs clockwise around
+// their centre and joining any gaps with minisegs. Only used if the subsector
+// shape couldn't be determined from its cell
+// -----------------------------------------------------------------------------
+void BSPBuilder::buildGLSegsSorted(BuildNode& leaf) const
+{
+	auto& segs = leaf.segs;
+
+	Vec2d mid;
+	for (auto& seg : segs)
+	{
+		mid.x += (seg.v1.pos.x + seg.v2.pos.x) * 0.5;
+		mid.y += (seg.v1.pos.y + seg.v2.pos.y) * 0.5;
+	}
+	mid.x /= segs.size();
+	mid.y /= segs.size();
+
+	vector<std::pair<double, unsigned>> sorted;
+	for (unsigned a = 0; a < segs.size(); a++)
+		sorted.emplace_back(-std::atan2(segs[a].v1.pos.y - mid.y, segs[a].v1.pos.x - mid.x), a);
+	std::sort(sorted.begin(), sorted.end());
+
+	for (unsigned a = 0; a < sorted.size(); a++)
+	{
+		auto& seg  = segs[sorted[a].second];
+		auto& next = segs[sorted[(a + 1) % sorted.size()].second];
+		leaf.gl_segs.push_back({ seg.v1, static_cast<int>(seg.line), seg.back });
+		if (math::distance(seg.v2.pos, next.v1.pos) > BSP_GL_EPSILON)
+			leaf.gl_segs.push_back({ seg.v2, -1, false });
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Adds [node] and all its children to the output lists (children first, so the
+// root node ends up last). Returns the node index, or the subsector index with
+// BSP_SUBSECTOR_BIT set if [node] is a leaf
+// -----------------------------------------------------------------------------
+unsigned BSPBuilder::flattenNode(BuildNode& node)
+{
+	if (node.isLeaf())
+	{
+		OutSubsector ssector;
+		ssector.first_seg = segs_.size();
+		for (auto& seg : node.segs)
+		{
+			auto angle = std::atan2(seg.part_delta.y, seg.part_delta.x);
+			segs_.push_back({ vertexIndex(seg.v1), vertexIndex(seg.v2), seg.line, seg.back, angle, seg.offset });
+			if (seg.v1.index < 0)
+				stats_.splits++;
+		}
+		ssector.num_segs = node.segs.size();
+		subsectors_.push_back(ssector);
+
+		return (subsectors_.size() - 1) | BSP_SUBSECTOR_BIT;
+	}
+
+	OutNode out;
+	out.part_start = node.part_start;
+	out.part_delta = node.part_delta;
+	out.bbox[0]    = node.child[0]->bounds;
+	out.bbox[1]    = node.child[1]->bounds;
+	out.child[0]   = flattenNode(*node.child[0]);
+	out.child[1]   = flattenNode(*node.child[1]);
+	nodes_.push_back(out);
+
+	return nodes_.size() - 1;
+}
+
+// -----------------------------------------------------------------------------
+// Adds the GL segs of all subsectors under [node] to the output list.
+// Subsectors are visited in the same order as flattenNode, [subsector] is the
+// index of the next one
+// -----------------------------------------------------------------------------
+void BSPBuilder::flattenGLSegs(BuildNode& node, unsigned& subsector)
+{
+	if (!node.isLeaf())
+	{
+		flattenGLSegs(*node.child[0], subsector);
+		flattenGLSegs(*node.child[1], subsector);
+		return;
+	}
+
+	auto& ssector        = subsectors_[subsector++];
+	ssector.first_gl_seg = gl_segs_.size();
+	for (auto& seg : node.gl_segs)
+		gl_segs_.push_back({ vertexIndex(seg.v1),
+							 seg.line < 0 ? 0xFFFFFFFF : static_cast<unsigned>(seg.line),
+							 seg.back });
+	ssector.num_gl_segs = node.gl_segs.size();
+}
+
+// -----------------------------------------------------------------------------
+// Returns the output index of [vertex], adding a new vertex if needed
+// -----------------------------------------------------------------------------
+unsigned BSPBuilder::vertexIndex(const VertexRef& vertex)
+{
+	if (vertex.index >= 0)
+		return vertex.index;
+
+	auto key = static_cast<u64>(static_cast<uint32_t>(toFixed(vertex.pos.x))) << 32
+			   | static_cast<uint32_t>(toFixed(vertex.pos.y));
+	auto existing = new_vertex_map_.find(key);
+	if (existing != new_vertex_map_.end())
+		return existing->second;
+
+	unsigned index = map_.nVertices() + new_vertices_.size();
+	new_vertices_.push_back(vertex.pos);
+	new_vertex_map_[key] = index;
+
+	return index;
+}
+
+// -----------------------------------------------------------------------------
+// Writes vanilla format SEGS, SSECTORS and NODES lumps
+// -----------------------------------------------------------------------------
+void BSPBuilder::writeVanillaNodes(MemChunk& segs, MemChunk& ssectors, MemChunk& nodes) const
+{
+	NodeLumpWriter w_segs;
+	for (auto& seg : segs_)
+	{
+		w_segs.writeU16(seg.v1);
+		w_segs.writeU16(seg.v2);
+		w_segs.writeU16(static_cast<uint16_t>(std::lround(seg.angle * 32768. / math::PI)));
+		w_segs.writeU16(seg.line);
+		w_segs.writeU16(seg.back ? 1 : 0);
+		w_segs.writeI16(toShort(seg.offset));
+	}
+	w_segs.copyTo(segs);
+
+	NodeLumpWriter w_ssectors;
+	for (auto& ssector : subsectors_)
+	{
+		w_ssectors.writeU16(ssector.num_segs);
+		w_ssectors.writeU16(ssector.first_seg);
+	}
+	w_ssectors.copyTo(ssectors);
+
+	NodeLumpWriter w_nodes;
+	for (auto& node : nodes_)
+	{
+		w_nodes.writeI16(toShort(node.part_start.x));
+		w_nodes.writeI16(toShort(node.part_start.y));
+		w_nodes.writeI16(toShort(node.part_delta.x));
+		w_nodes.writeI16(toShort(node.part_delta.y));
+		writeNodeBBox(w_nodes, node.bbox[0]);
+		writeNodeBBox(w_nodes, node.bbox[1]);
+		for (auto child : node.child)
+			w_nodes.writeU16(child & BSP_SUBSECTOR_BIT ? (child & 0x7FFF) | 0x8000 : child);
+	}
+	w_nodes.copyTo(nodes);
+}
+
+// -----------------------------------------------------------------------------
+// Writes extended (XNOD, or ZNOD if compressed) nodes to [out]
+// -----------------------------------------------------------------------------
+void BSPBuilder::writeExtendedNodes(MemChunk& out) const
+{
+	NodeLumpWriter w;
+
+	// Vertices
+	w.writeU32(map_.nVertices());
+	w.writeU32(num_split_vertices_);
+	for (unsigned a = 0; a < num_split_vertices_; a++)
+	{
+		w.writeI32(toFixed(new_vertices_[a].x));
+		w.writeI32(toFixed(new_vertices_[a].y));
+	}
+
+	// Subsectors
+	w.writeU32(subsectors_.size());
+	for (auto& ssector : subsectors_)
+		w.writeU32(ssector.num_segs);
+
+	// Segs
+	w.writeU32(segs_.size());
+	for (auto& seg : segs_)
+	{
+		w.writeU32(seg.v1);
+		w.writeU32(seg.v2);
+		w.writeU16(seg.line);
+		w.writeU8(seg.back ? 1 : 0);
+	}
+
+	// Nodes
+	w.writeU32(nodes_.size());
+	for (auto& node : nodes_)
+	{
+		w.writeI16(toShort(node.part_start.x));
+		w.writeI16(toShort(node.part_start.y));
+		w.writeI16(toShort(node.part_delta.x));
+		w.writeI16(toShort(node.part_delta.y));
+		writeNodeBBox(w, node.bbox[0]);
+		writeNodeBBox(w, node.bbox[1]);
+		w.writeU32(node.child[0]);
+		w.writeU32(node.child[1]);
+	}
+
+	writeMagicLump(out, w, "XNOD", "ZNOD", options_.compress);
+}
+
+// -----------------------------------------------------------------------------
+// Writes GL (XGL2, or ZGL2 if compressed) nodes to [out]. If the map has
+// fractional vertex positions, XGL3/ZGL3 is used for fixed point partitions
+// -----------------------------------------------------------------------------
+void BSPBuilder::writeGLNodes(MemChunk& out) const
+{
+	NodeLumpWriter w;
+
+	// Vertices
+	w.writeU32(map_.nVertices());
+	w.writeU32(new_vertices_.size());
+	for (auto& vertex : new_vertices_)
+	{
+		w.writeI32(toFixed(vertex.x));
+		w.writeI32(toFixed(vertex.y));
+	}
+
+	// Subsectors
+	w.writeU32(subsectors_.size());
+	for (auto& ssector : subsectors_)
+		w.writeU32(ssector.num_gl_segs);
+
+	// Segs
+	w.writeU32(gl_segs_.size());
+	for (auto& seg : gl_segs_)
+	{
+		w.writeU32(seg.v1);
+		w.writeU32(0xFFFFFFFF); // No partner seg
+		w.writeU32(seg.line);
+		w.writeU8(seg.back ? 1 : 0);
+	}
+
+	// Nodes
+	w.writeU32(nodes_.size());
+	for (auto& node : nodes_)
+	{
+		if (fractional_)
+		{
+			w.writeI32(toFixed(node.part_start.x));
+			w.writeI32(toFixed(node.part_start.y));
+			w.writeI32(toFixed(node.part_delta.x));
+			w.writeI32(toFixed(node.part_delta.y));
+		}
+		else
+		{
+			w.writeI16(toShort(node.part_start.x));
+			w.writeI16(toShort(node.part_start.y));
+			w.writeI16(toShort(node.part_delta.x));
+			w.writeI16(toShort(node.part_delta.y));
+		}
+		writeNodeBBox(w, node.bbox[0]);
+		writeNodeBBox(w, node.bbox[1]);
+		w.writeU32(node.child[0]);
+		w.writeU32(node.child[1]);
+	}
+
+	if (fractional_)
+		writeMagicLump(out, w, "XGL3", "ZGL3", options_.compress);
+	else
+		writeMagicLump(out, w, "XGL2", "ZGL2", options_.compress);
+}
+
+// -----------------------------------------------------------------------------
+// Writes a BLOCKMAP lump for the map to [out]. If the map is too large for a
+// vanilla blockmap, [out] is left empty (ZDoom will build its own)
+// -----------------------------------------------------------------------------
+void BSPBuilder::writeBlockmap(MemChunk& out) const
+{
+	out.clear();
+	if (map_.nLines() == 0 || map_.nLines() > 0xFFFE)
+		return;
+
+	// Get map bounds
+	BBox bounds;
+	bool init = false;
+	for (auto line : map_.lines())
+	{
+		extendBBox(bounds, line->v1()->position(), init);
+		extendBBox(bounds, line->v2()->position(), init);
+	}
+
+	int origin_x = static_cast<int>(std::floor(bounds.min.x)) - 8;
+	int origin_y = static_cast<int>(std::floor(bounds.min.y)) - 8;
+	int cols     = (static_cast<int>(std::ceil(bounds.max.x)) - origin_x) / 128 + 1;
+	int rows     = (static_cast<int>(std::ceil(bounds.max.y)) - origin_y) / 128 + 1;
+
+	// Add lines to the blocks they pass through
+	vector<vector<uint16_t>> blocks(cols * rows);
+	for (unsigned a = 0; a < map_.nLines(); a++)
+	{
+		auto p1 = map_.line(a)->v1()->position();
+		auto p2 = map_.line(a)->v2()->position();
+		if (p1.x > p2.x)
+			std::swap(p1, p2);
+
+		int col1 = std::clamp(static_cast<int>(std::floor((p1.x - origin_x) / 128.)), 0, cols - 1);
+		int col2 = std::clamp(static_cast<int>(std::floor((p2.x - origin_x) / 128.)), 0, cols - 1);
+		for (int col = col1; col <= col2; col++)
+		{
+			// Get the y range of the line within this column
+			double y1 = p1.y, y2 = p2.y;
+			if (p2.x != p1.x)
+			{
+				double x1 = std::max(p1.x, static_cast<double>(origin_x + col * 128));
+				double x2 = std::min(p2.x, static_cast<double>(origin_x + col * 128 + 128));
+				y1        = p1.y + (x1 - p1.x) * (p2.y - p1.y) / (p2.x - p1.x);
+				y2        = p1.y + (x2 - p1.x) * (p2.y - p1.y) / (p2.x - p1.x);
+			}
+			if (y1 > y2)
+				std::swap(y1, y2);
+
+			int row1 = std::clamp(static_cast<int>(std::floor((y1 - origin_y) / 128.)), 0, rows - 1);
+			int row2 = std::clamp(static_cast<int>(std::floor((y2 - origin_y) / 128.)), 0, rows - 1);
+			for (int row = row1; row <= row2; row++)
+				blocks[row * cols + col].push_back(a);
+		}
+	}
+
+	// Write header and block lists (identical lists are shared)
+	NodeLumpWriter                     w;
+	vector<uint16_t>                   lists;
+	vector<uint32_t>                   offsets;
+	std::map<vector<uint16_t>, size_t> list_offsets;
+	size_t                             list_start = 4 + blocks.size();
+	for (auto& block : blocks)
+	{
+		auto existing = list_offsets.find(block);
+		if (existing != list_offsets.end())
+		{
+			offsets.push_back(existing->second);
+			continue;
+		}
+
+		auto offset = list_start + lists.size();
+		list_offsets[block] = offset;
+		offsets.push_back(offset);
+		lists.push_back(0);
+		lists.insert(lists.end(), block.begin(), block.end());
+		lists.push_back(0xFFFF);
+	}
+
+	if (list_start + lists.size() > 0xFFFF)
+	{
+		log::warning("Map is too large for a vanilla BLOCKMAP, writing an empty one");
+		return;
+	}
+
+	w.writeI16(origin_x);
+	w.writeI16(origin_y);
+	w.writeU16(cols);
+	w.writeU16(rows);
+	for (auto offset : offsets)
+		w.writeU16(offset);
+	for (auto value : lists)
+		w.writeU16(value);
+
+	w.copyTo(out);
+}
+
+// -----------------------------------------------------------------------------
+// Writes an empty (zero-filled) REJECT lump for the map to [out]
+// -----------------------------------------------------------------------------
+void BSPBuilder::writeReject(MemChunk& out) const
+{
+	auto n_sectors = map_.nSectors();
+	out.clear();
+	out.reSize((n_sectors * n_sectors + 7) / 8, false);
+	out.fillData(0);
+}
@@ -0,0 +1,145 @@
+#pragma once
+
+namespace slade
+{
+// Forward declarations
+class Archive;
+class SLADEMap;
+class ThreadPool;
+
+class BSPBuilder
+{
+public:
+	struct Options
+	{
+		bool extended = false; // Write extended (XNOD) nodes even if within vanilla limits
+		bool gl       = false; // Write GL (XGL2) nodes to SSECTORS, always done (to ZNODES) for UDMF maps
+		bool compress = false; // Compress extended/GL nodes (ZNOD/ZGL2)
+		bool blockmap = true;  // Write BLOCKMAP, otherwise any existing BLOCKMAP is kept (binary formats only)
+		bool reject   = true;  // Write an empty (zero-filled) REJECT, otherwise any existing REJECT is kept
+	};
+
+	struct Stats
+	{
+		unsigned nodes        = 0;
+		unsigned subsectors   = 0;
+		unsigned segs         = 0;
+		unsigned gl_segs      = 0;
+		unsigned splits       = 0;
+		unsigned new_vertices = 0;
+		bool     extended     = false;
+		double   build_ms     = 0.;
+	};
+
+	BSPBuilder(const SLADEMap& map, const Options& options);
+	~BSPBuilder();
+
+	const Stats& stats() const { return stats_; }
+
+	bool build(ThreadPool* pool = nullptr);
+	bool writeLumps(Archive& wad) const;
+
+	static Options parseOptions(string_view options);
+
+private:
+	// A reference to either a map vertex ([index] >= 0) or a new vertex created
+	// by the builder at [pos]
+	struct VertexRef
+	{
+		int   index = -1;
+		Vec2d pos;
+	};
+
+	struct Seg
+	{
+		VertexRef v1;
+		VertexRef v2;
+		unsigned  line   = 0;
+		bool      back   = false;
+		double    offset = 0.; // Distance from the start of the line (from its side)
+		Vec2d     part_start;  // The full line this seg is on, used as a partition
+		Vec2d     part_delta;
+	};
+
+	struct GLSeg
+	{
+		VertexRef v1;
+		int       line = -1; // -1 = miniseg
+		bool      back = false;
+	};
+
+	struct BuildNode;
+
+	struct OutSeg
+	{
+		unsigned v1;
+		unsigned v2;
+		unsigned line;
+		bool     back;
+		double   angle;
+		double   offset;
+	};
+
+	struct OutGLSeg
+	{
+		unsigned v1;
+		unsigned line; // 0xFFFFFFFF = miniseg
+		bool     back;
+	};
+
+	struct OutNode
+	{
+		Vec2d    part_start;
+		Vec2d    part_delta;
+		BBox     bbox[2];
+		unsigned child[2]; // High bit set = subsector
+	};
+
+	struct OutSubsector
+	{
+		unsigned first_seg    = 0;
+		unsigned num_segs     = 0;
+		unsigned first_gl_seg = 0;
+		unsigned num_gl_segs  = 0;
+	};
+
+	const SLADEMap&       map_;
+	Options               options_;
+	bool                  build_gl_   = false;
+	bool                  fractional_ = false; // True if any map vertex has a fractional position
+	ThreadPool*           pool_       = nullptr;
+	unique_ptr<BuildNode> root_;
+	Stats                 stats_;
+
+	// Flattened output
+	vector<OutNode>                   nodes_;
+	vector<OutSubsector>              subsectors_;
+	vector<OutSeg>                    segs_;
+	vector<OutGLSeg>                  gl_segs_;
+	vector<Vec2d>                     new_vertices_;
+	unsigned                          num_split_vertices_ = 0; // New vertices used by (non-GL) segs
+	std::unordered_map<u64, unsigned> new_vertex_map_;
+
+	unique_ptr<BuildNode> buildNode(vector<Seg>& segs, const vector<Vec2d>& cell);
+	int                   choosePartition(const vector<Seg>& segs, bool& split_slivers) const;
+	int  partitionCost(const vector<Seg>& segs, const Seg& partition, int max_cost, bool split_slivers) const;
+	void splitSegs(
+		vector<Seg>& segs,
+		const Seg&   partition,
+		vector<Seg>& front,
+		vector<Seg>& back,
+		bool         split_slivers) const;
+	void buildGLSegs(BuildNode& leaf, const vector<Vec2d>& cell) const;
+	void buildGLSegsSorted(BuildNode& leaf) const;
+
+	unsigned flattenNode(BuildNode& node);
+	void     flattenGLSegs(BuildNode& node, unsigned& subsector);
+	unsigned vertexIndex(const VertexRef& vertex);
+
+	void writeVanillaNodes(MemChunk& segs, MemChunk& ssectors, MemChunk& nodes) const;
+	void writeExtendedNodes(MemChunk& out) const;
+	void writeGLNodes(MemChunk& out) const;
+	void writeBlockmap(MemChunk& out) const;
+	void writeReject(MemChunk& out) const;
+};
+} // namespace slade
@@ -34,6 +34,7 @@
 #include "Main.h"
 #include "MapEditContext.h"
 #include "App.h"
+#include "Archive/Formats/WadArchive.h"
 #include "Game/Configuration.h"
 #include "General/Clipboard.h"
 #include "General/Console.h"
@@ -47,6 +48,7 @@
 #include "MapEditor/UI/Dialogs/SectorSpecialDialog.h"
 #include "MapEditor/UI/Dialogs/ShowItemDialog.h"
 #include "MapTextureManager.h"
+#include "NodeBuilders.h"
 #include "UI/MapCanvas.h"
 #include "UI/MapEditorWindow.h"
 #include "UndoSteps.h"
@@ -80,6 +82,7 @@ CVAR(Bool, hilight_smooth, true, CVar::Flag::Save)
 // -----------------------------------------------------------------------------
 EXTERN_CVAR(Int, flat_drawtype)
 EXTERN_CVAR(Bool, thing_preview_lights)
+EXTERN_CVAR(String, nodebuilder_id)
 
 
 // -----------------------------------------------------------------------------
@@ -2558,3 +2561,41 @@ CONSOLE_COMMAND(mobj_info, 1, false)
 		log::console(bak.props_internal.toString());
 	}
 }
+
+CONSOLE_COMMAND(m_bench_nodes, 0, false)
+{
+	auto   window      = mapeditor::window();
+	auto   runs        = args.empty() ? 1 : std::max(1, strutil::asInt(args[0]));
+	string external_id = args.size() > 1 ? args[1] : "zdbsp";
+
+	// Times saving the map [runs] times with nodes built by [builder_id]
+	// ("none" to time the map export alone)
+	auto bench = [window, runs](string_view builder_id) {
+		string prev_id = nodebuilder_id;
+		nodebuilder_id = builder_id;
+
+		sf::Clock clock;
+		for (int a = 0; a < runs; a++)
+		{
+			WadArchive wad;
+			window->writeMap(wad);
+		}
+		double ms = clock.getElapsedTime().asMicroseconds() / 1000. / runs;
+
+		nodebuilder_id = prev_id;
+		return ms;
+	};
+
+	auto export_ms  = bench("none");
+	auto builtin_ms = bench("slade");
+	log::console(fmt::format("Map export only: {:.1f}ms", export_ms));
+	log::console(fmt::format("Built-in node builder: {:.1f}ms", builtin_ms));
+
+	// Only run the external builder if it's set up, otherwise the save would
+	// fall back to the built-in builder
+	auto& external = nodebuilders::builder(external_id);
+	if (external.id == "invalid" || external.builtin || !wxFileExists(external.path))
+		log::console(fmt::format("Node builder \"{}\" is not set up, skipping", external_id));
+	else
+		log::console(fmt::format("{}: {:.1f}ms", external.name, bench(external_id)));
+}
@@ -0,0 +1,972 @@
+
+// -----------------------------------------------------------------------------
+// SLADE - It's a Doom Editor
+// Copyright(C) 2008 - 2020 Simon Judd
+//
+// Email:       sirjuddington@gmail.com
+// Web:         http://slade.mancubus.net
+// Filename:    MapPreview.cpp
+// Description: MapPreview class - reads the basic geometry (vertices, lines and
+//              things) of a map for previews, and renders it to an image in
+//              software. Doesn't need OpenGL, so map images can be generated
+//              on worker threads (and without a GL context at all)
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301, USA.
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+//
+// Includes
+//
+// -----------------------------------------------------------------------------
+#include "Main.h"
+#include "MapPreview.h"
+#include "App.h"
+#include "Archive/Formats/WadArchive.h"
+#include "General/ColourConfiguration.h"
+#include "General/Misc.h"
+#include "SLADEMap/MapFormat/Doom64MapFormat.h"
+#include "SLADEMap/MapFormat/DoomMapFormat.h"
+#include "SLADEMap/MapFormat/HexenMapFormat.h"
+#include "Utility/ThreadPool.h"
+#include "Utility/Tokenizer.h"
+#include <mutex>
+
+using namespace slade;
+
+
+// -----------------------------------------------------------------------------
+//
+// Variables
+//
+// -----------------------------------------------------------------------------
+CVAR(Float, map_image_thickness, 1.5, CVar::Flag::Save)
+
+namespace
+{
+constexpr uint64_t MP_HASH_START     = 0;   // Starting value when combining hashes with mpHash
+constexpr size_t   MP_CACHE_MAX_SIZE = 128; // Max number of images kept in the cache
+
+std::mutex                 mp_cache_mutex;
+std::map<uint64_t, SImage> mp_image_cache; // Rendered map images by lump content + options hash
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// External Variables
+//
+// -----------------------------------------------------------------------------
+EXTERN_CVAR(Int, map_image_width)
+EXTERN_CVAR(Int, map_image_height)
+
+
+// -----------------------------------------------------------------------------
+//
+// Local Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// -----------------------------------------------------------------------------
+// Adds [size] bytes of [data] to [hash]. The data is hashed with misc::hash64
+// and the result combined with [hash]
+// -----------------------------------------------------------------------------
+uint64_t mpHash(uint64_t hash, const void* data, size_t size)
+{
+	auto data_hash = misc::hash64(static_cast<const uint8_t*>(data), size);
+	return hash ^ (data_hash + 0x9e3779b97f4a7c15ULL + (hash << 6) + (hash >> 2));
+}
+
+uint64_t mpHashLump(uint64_t hash, const vector<uint8_t>& lump)
+{
+	return mpHash(hash, lump.data(), lump.size());
+}
+
+uint64_t mpHashColour(uint64_t hash, const ColRGBA& colour)
+{
+	uint8_t rgba[4] = { colour.r, colour.g, colour.b, colour.a };
+	return mpHash(hash, rgba, 4);
+}
+
+// -----------------------------------------------------------------------------
+// Copies the data of [entry] to [data]
+// -----------------------------------------------------------------------------
+void mpCopyLump(ArchiveEntry* entry, vector<uint8_t>& data)
+{
+	auto& mc = entry->data();
+	data.assign(mc.data(), mc.data() + mc.size());
+}
+
+// -----------------------------------------------------------------------------
+// Simple RGBA pixel buffer for rendering map images in software.
+// Pixels are blended the same way as OpenGL with
+// glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA), including alpha
+// -----------------------------------------------------------------------------
+struct MapPreviewRaster
+{
+	int             width;
+	int             height;
+	vector<uint8_t> pixels;
+
+	MapPreviewRaster(int width, int height, const ColRGBA& background) :
+		width{ width },
+		height{ height },
+		pixels(width * height * 4)
+	{
+		for (int a = 0; a < width * height; ++a)
+		{
+			pixels[a * 4]     = background.r;
+			pixels[a * 4 + 1] = background.g;
+			pixels[a * 4 + 2] = background.b;
+			pixels[a * 4 + 3] = background.a;
+		}
+	}
+
+	void blend(int x, int y, const ColRGBA& colour, double coverage)
+	{
+		double alpha = colour.fa() * std::min(coverage, 1.);
+		double inv   = 1. - alpha;
+		auto   pixel = &pixels[(y * width + x) * 4];
+		pixel[0]     = static_cast<uint8_t>(colour.r * alpha + pixel[0] * inv + 0.5);
+		pixel[1]     = static_cast<uint8_t>(colour.g * alpha + pixel[1] * inv + 0.5);
+		pixel[2]     = static_cast<uint8_t>(colour.b * alpha + pixel[2] * inv + 0.5);
+		pixel[3]     = static_cast<uint8_t>(colour.a * alpha + pixel[3] * inv + 0.5);
+	}
+
+	// Draws an antialiased line from [x1,y1] to [x2,y2], [thickness] pixels
+	// wide. Coverage of each pixel is based on the distance from its centre
+	// to the line, and only pixels near the line along its major axis are
+	// checked
+	void drawLine(double x1, double y1, double x2, double y2, double thickness, const ColRGBA& colour)
+	{
+		double hw     = std::max(thickness, 1.) * 0.5;
+		double dx     = x2 - x1;
+		double dy     = y2 - y1;
+		double len_sq = dx * dx + dy * dy;
+		bool   steep  = std::abs(dy) > std::abs(dx);
+
+		// Get start/end on the major (a) and minor (b) axes
+		double a1 = steep ? y1 : x1;
+		double b1 = steep ? x1 : y1;
+		double a2 = steep ? y2 : x2;
+		double b2 = steep ? x2 : y2;
+		if (a1 > a2)
+		{
+			std::swap(a1, a2);
+			std::swap(b1, b2);
+		}
+		double slope = a2 > a1 ? (b2 - b1) / (a2 - a1) : 0.;
+		double span  = hw * std::sqrt(1. + slope * slope) + 1.;
+
+		int max_a   = steep ? height - 1 : width - 1;
+		int max_b   = steep ? width - 1 : height - 1;
+		int a_start = std::max(static_cast<int>(std::floor(a1 - hw)), 0);
+		int a_end   = std::min(static_cast<int>(std::ceil(a2 + hw)), max_a);
+		for (int a = a_start; a <= a_end; ++a)
+		{
+			double bc      = b1 + (std::clamp(a + 0.5, a1, a2) - a1) * slope;
+			int    b_start = std::max(static_cast<int>(std::floor(bc - span)), 0);
+			int    b_end   = std::min(static_cast<int>(std::ceil(bc + span)), max_b);
+			for (int b = b_start; b <= b_end; ++b)
+			{
+				int x = steep ? b : a;
+				int y = steep ? a : b;
+
+				// Get distance from pixel centre to the line
+				double cx = x + 0.5;
+				double cy = y + 0.5;
+				double t  = len_sq > 0. ? std::clamp(((cx - x1) * dx + (cy - y1) * dy) / len_sq, 0., 1.) : 0.;
+				double ex = x1 + dx * t - cx;
+				double ey = y1 + dy * t - cy;
+
+				double coverage = hw + 0.5 - std::sqrt(ex * ex + ey * ey);
+				if (coverage > 0.)
+					blend(x, y, colour, coverage);
+			}
+		}
+	}
+
+	// Draws an antialiased filled circle of [radius] at [x,y]
+	void drawDisc(double x, double y, double radius, const ColRGBA& colour)
+	{
+		int x_start = std::max(static_cast<int>(std::floor(x - radius - 1.)), 0);
+		int x_end   = std::min(static_cast<int>(std::ceil(x + radius + 1.)), width - 1);
+		int y_start = std::max(static_cast<int>(std::floor(y - radius - 1.)), 0);
+		int y_end   = std::min(static_cast<int>(std::ceil(y + radius + 1.)), height - 1);
+		for (int py = y_start; py <= y_end; ++py)
+			for (int px = x_start; px <= x_end; ++px)
+			{
+				double ex       = px + 0.5 - x;
+				double ey       = py + 0.5 - y;
+				double coverage = radius + 0.5 - std::sqrt(ex * ex + ey * ey);
+				if (coverage > 0.)
+					blend(px, py, colour, coverage);
+			}
+	}
+};
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// MapPreview::Lumps Struct Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Returns a hash of the lump contents (not including the map name)
+// -----------------------------------------------------------------------------
+uint64_t MapPreview::Lumps::hash() const
+{
+	auto fmt = static_cast<int>(format);
+	auto h   = mpHash(MP_HASH_START, &fmt, sizeof(fmt));
+	h        = mpHashLump(h, vertexes);
+	h        = mpHashLump(h, linedefs);
+	h        = mpHashLump(h, things);
+	return mpHashLump(h, textmap);
+}
+
+
+// -----------------------------------------------------------------------------
+//
+// MapPreview::ImageOptions Struct Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Returns a hash of the image options
+// -----------------------------------------------------------------------------
+uint64_t MapPreview::ImageOptions::hash() const
+{
+	auto h = mpHash(MP_HASH_START, &width, sizeof(width));
+	h      = mpHash(h, &height, sizeof(height));
+	h      = mpHash(h, &thickness, sizeof(thickness));
+	h      = mpHash(h, &things, sizeof(things));
+	h      = mpHashColour(h, col_background);
+	h      = mpHashColour(h, col_line_1s);
+	h      = mpHashColour(h, col_line_2s);
+	h      = mpHashColour(h, col_line_special);
+	h      = mpHashColour(h, col_line_macro);
+	return mpHashColour(h, col_thing);
+}
+
+
+// -----------------------------------------------------------------------------
+//
+// MapPreview Class Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Returns the number of (attached) vertices in the map
+// -----------------------------------------------------------------------------
+unsigned MapPreview::nVertices() const
+{
+	// Get list of used vertices
+	vector<bool> v_used(verts_.size(), false);
+	for (auto& line : lines_)
+	{
+		if (line.v1 < verts_.size())
+			v_used[line.v1] = true;
+		if (line.v2 < verts_.size())
+			v_used[line.v2] = true;
+	}
+
+	// Get count of used vertices
+	unsigned count = 0;
+	for (auto&& a : v_used)
+	{
+		if (a)
+			count++;
+	}
+
+	return count;
+}
+
+// -----------------------------------------------------------------------------
+// Returns the width (in map units) of the map
+// -----------------------------------------------------------------------------
+unsigned MapPreview::width() const
+{
+	auto bbox = bounds();
+	return static_cast<int>(bbox.br.x) - static_cast<int>(bbox.tl.x);
+}
+
+// -----------------------------------------------------------------------------
+// Returns the height (in map units) of the map
+// -----------------------------------------------------------------------------
+unsigned MapPreview::height() const
+{
+	auto bbox = bounds();
+	return static_cast<int>(bbox.br.y) - static_cast<int>(bbox.tl.y);
+}
+
+// -----------------------------------------------------------------------------
+// Returns the bounding box of all vertices in the map
+// -----------------------------------------------------------------------------
+Rectd MapPreview::bounds() const
+{
+	if (verts_.empty())
+		return {};
+
+	Rectd bbox{ verts_[0].x, verts_[0].y, verts_[0].x, verts_[0].y };
+	for (auto& vert : verts_)
+	{
+		bbox.tl.x = std::min(bbox.tl.x, vert.x);
+		bbox.tl.y = std::min(bbox.tl.y, vert.y);
+		bbox.br.x = std::max(bbox.br.x, vert.x);
+		bbox.br.y = std::max(bbox.br.y, vert.y);
+	}
+
+	return bbox;
+}
+
+// -----------------------------------------------------------------------------
+// Clears map data
+// -----------------------------------------------------------------------------
+void MapPreview::clear()
+{
+	verts_.clear();
+	lines_.clear();
+	things_.clear();
+	n_sides_   = 0;
+	n_sectors_ = 0;
+}
+
+// -----------------------------------------------------------------------------
+// Reads the preview data for [map].
+// Returns false if the map is invalid
+// -----------------------------------------------------------------------------
+bool MapPreview::open(const Archive::MapDesc& map)
+{
+	Lumps lumps;
+	if (!readLumps(map, lumps))
+		return false;
+
+	return parse(lumps);
+}
+
+// -----------------------------------------------------------------------------
+// Parses the preview data from [lumps].
+// Returns false if the map data is invalid
+// -----------------------------------------------------------------------------
+bool MapPreview::parse(const Lumps& lumps)
+{
+	clear();
+
+	// Parse UDMF map
+	if (lumps.format == MapFormat::UDMF)
+		return parseUDMF(lumps);
+
+	// Can't open a map without vertices or linedefs
+	if (lumps.vertexes.empty() || lumps.linedefs.empty())
+		return false;
+
+	readVertices(lumps.vertexes, lumps.format);
+	readLines(lumps.linedefs, lumps.format);
+	readThings(lumps.things, lumps.format);
+
+	// Sides & sectors (count only)
+	if (lumps.format != MapFormat::Doom64)
+	{
+		// Doom/Hexen map
+		n_sides_   = lumps.sidedefs_size / 30;
+		n_sectors_ = lumps.sectors_size / 26;
+	}
+	else
+	{
+		// Doom64 map
+		n_sides_   = lumps.sidedefs_size / 12;
+		n_sectors_ = lumps.sectors_size / 16;
+	}
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Renders the map lines (and things if enabled in [options]) to [image], with
+// antialiasing. Returns false if there is nothing to render
+// -----------------------------------------------------------------------------
+bool MapPreview::createImage(SImage& image, const ImageOptions& options) const
+{
+	// Find extents of map
+	if (verts_.empty())
+		return false;
+	auto   bbox      = bounds();
+	double mapwidth  = bbox.width();
+	double mapheight = bbox.height();
+
+	// Determine image size
+	int width  = options.width;
+	int height = options.height;
+	if (width == 0)
+		width = -5;
+	if (height == 0)
+		height = -5;
+	if (width < 0)
+		width = mapwidth / abs(width);
+	if (height < 0)
+		height = mapheight / abs(height);
+	if (width <= 0 || height <= 0)
+		return false;
+
+	// Zoom/offset to show full map
+	Vec2d  offset  = { bbox.tl.x + (mapwidth * 0.5), bbox.tl.y + (mapheight * 0.5) };
+	double x_scale = mapwidth > 0. ? width / mapwidth : 1.;
+	double y_scale = mapheight > 0. ? height / mapheight : 1.;
+	double zoom    = std::min<double>(x_scale, y_scale) * 0.95;
+
+	// Map -> image coordinates (y is flipped, map y is up)
+	double mid_x = width >> 1;
+	double mid_y = height >> 1;
+	auto   toImage = [&](double x, double y) {
+		return Vec2d{ mid_x + (x - offset.x) * zoom, height - (mid_y + (y - offset.y) * zoom) };
+	};
+
+	MapPreviewRaster raster(width, height, options.col_background);
+
+	// Draw lines (2-sided first, then 1-sided over them)
+	for (int pass = 0; pass < 2; ++pass)
+	{
+		for (auto& line : lines_)
+		{
+			if (line.twosided != (pass == 0))
+				continue;
+
+			// Check ends
+			if (line.v1 >= verts_.size() || line.v2 >= verts_.size())
+				continue;
+
+			// Get colour
+			ColRGBA colour;
+			if (line.special)
+				colour = options.col_line_special;
+			else if (line.macro)
+				colour = options.col_line_macro;
+			else if (line.twosided)
+				colour = options.col_line_2s;
+			else
+				colour = options.col_line_1s;
+
+			// Draw line
+			auto p1 = toImage(verts_[line.v1].x, verts_[line.v1].y);
+			auto p2 = toImage(verts_[line.v2].x, verts_[line.v2].y);
+			raster.drawLine(p1.x, p1.y, p2.x, p2.y, options.thickness, colour);
+		}
+	}
+
+	// Draw things
+	if (options.things)
+	{
+		double radius = std::max(20. * zoom, 1.);
+		for (auto& thing : things_)
+		{
+			auto pos = toImage(thing.x, thing.y);
+			raster.drawDisc(pos.x, pos.y, radius, options.col_thing);
+		}
+	}
+
+	return image.setImageData(raster.pixels, width, height, SImage::Type::RGBA);
+}
+
+// -----------------------------------------------------------------------------
+// Parses UDMF map data from the TEXTMAP lump in [lumps]
+// -----------------------------------------------------------------------------
+bool MapPreview::parseUDMF(const Lumps& lumps)
+{
+	if (lumps.textmap.empty())
+		return false;
+
+	// Start parsing
+	Tokenizer tz;
+	tz.openMem(reinterpret_cast<const char*>(lumps.textmap.data()), lumps.textmap.size(), lumps.name);
+
+	// Get first token
+	wxString token       = tz.getToken();
+	size_t   vertcounter = 0, linecounter = 0, thingcounter = 0;
+	while (!token.IsEmpty())
+	{
+		if (!token.CmpNoCase("namespace"))
+		{
+			//  skip till we reach the ';'
+			do
+			{
+				token = tz.getToken();
+			} while (token.Cmp(";") && !token.empty());
+		}
+		else if (!token.CmpNoCase("vertex"))
+		{
+			// Get X and Y properties
+			bool   gotx = false;
+			bool   goty = false;
+			double x    = 0.;
+			double y    = 0.;
+			do
+			{
+				token = tz.getToken();
+				if (!token.CmpNoCase("x") || !token.CmpNoCase("y"))
+				{
+					bool isx = !token.CmpNoCase("x");
+					token    = tz.getToken();
+					if (token.Cmp("="))
+					{
+						log::error("Bad syntax for vertex {} in UDMF map data", vertcounter);
+						return false;
+					}
+					if (isx)
+						x = tz.getDouble(), gotx = true;
+					else
+						y = tz.getDouble(), goty = true;
+					// skip to end of declaration after each key
+					do
+					{
+						token = tz.getToken();
+					} while (token.Cmp(";") && !token.empty());
+				}
+			} while (token.Cmp("}") && !token.empty());
+			if (gotx && goty)
+				verts_.push_back({ x, y });
+			else
+			{
+				log::error("Wrong vertex {} in UDMF map data", vertcounter);
+				return false;
+			}
+			vertcounter++;
+		}
+		else if (!token.CmpNoCase("linedef"))
+		{
+			bool   special  = false;
+			bool   twosided = false;
+			bool   gotv1 = false, gotv2 = false;
+			size_t v1 = 0, v2 = 0;
+			do
+			{
+				token = tz.getToken();
+				if (!token.CmpNoCase("v1") || !token.CmpNoCase("v2"))
+				{
+					bool isv1 = !token.CmpNoCase("v1");
+					token     = tz.getToken();
+					if (token.Cmp("="))
+					{
+						log::error("Bad syntax for linedef {} in UDMF map data", linecounter);
+						return false;
+					}
+					if (isv1)
+						v1 = tz.getInteger(), gotv1 = true;
+					else
+						v2 = tz.getInteger(), gotv2 = true;
+					// skip to end of declaration after each key
+					do
+					{
+						token = tz.getToken();
+					} while (token.Cmp(";") && !token.empty());
+				}
+				else if (!token.CmpNoCase("special"))
+				{
+					special = true;
+					// skip to end of declaration after each key
+					do
+					{
+						token = tz.getToken();
+					} while (token.Cmp(";") && !token.empty());
+				}
+				else if (!token.CmpNoCase("sideback"))
+				{
+					twosided = true;
+					// skip to end of declaration after each key
+					do
+					{
+						token = tz.getToken();
+					} while (token.Cmp(";") && !token.empty());
+				}
+			} while (token.Cmp("}") && !token.empty());
+			if (gotv1 && gotv2)
+				lines_.push_back({ static_cast<unsigned>(v1), static_cast<unsigned>(v2), twosided, special });
+			else
+			{
+				log::error("Wrong line {} in UDMF map data", linecounter);
+				return false;
+			}
+			linecounter++;
+		}
+		else if (S_CMPNOCASE(token, "thing"))
+		{
+			// Get X and Y properties
+			bool   gotx = false;
+			bool   goty = false;
+			double x    = 0.;
+			double y    = 0.;
+			do
+			{
+				token = tz.getToken();
+				if (!token.CmpNoCase("x") || !token.CmpNoCase("y"))
+				{
+					bool isx = !token.CmpNoCase("x");
+					token    = tz.getToken();
+					if (token.Cmp("="))
+					{
+						log::error("Bad syntax for thing {} in UDMF map data", thingcounter);
+						return false;
+					}
+					if (isx)
+						x = tz.getDouble(), gotx = true;
+					else
+						y = tz.getDouble(), goty = true;
+					// skip to end of declaration after each key
+					do
+					{
+						token = tz.getToken();
+					} while (token.Cmp(";") && !token.empty());
+				}
+			} while (token.Cmp("}") && !token.empty());
+			if (gotx && goty)
+				things_.push_back({ x, y });
+			else
+			{
+				log::error("Wrong thing {} in UDMF map data", thingcounter);
+				return false;
+			}
+			thingcounter++;
+		}
+		else
+		{
+			// Check for side or sector definition (increase counts)
+			if (S_CMPNOCASE(token, "sidedef"))
+				n_sides_++;
+			else if (S_CMPNOCASE(token, "sector"))
+				n_sectors_++;
+
+			// map preview ignores sidedefs, sectors, comments,
+			// unknown fields, etc. so skip to end of block
+			do
+			{
+				token = tz.getToken();
+			} while (token.Cmp("}") && !token.empty());
+		}
+		// Iterate to next token
+		token = tz.getToken();
+	}
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Reads non-UDMF vertex data
+// -----------------------------------------------------------------------------
+void MapPreview::readVertices(const vector<uint8_t>& data, MapFormat format)
+{
+	if (format == MapFormat::Doom64)
+	{
+		auto     vert_data = reinterpret_cast<const Doom64MapFormat::Vertex*>(data.data());
+		unsigned nv        = data.size() / sizeof(Doom64MapFormat::Vertex);
+		for (unsigned a = 0; a < nv; a++)
+			verts_.push_back({ (double)vert_data[a].x / 65536, (double)vert_data[a].y / 65536 });
+	}
+	else
+	{
+		auto     vert_data = reinterpret_cast<const DoomMapFormat::Vertex*>(data.data());
+		unsigned nv        = data.size() / sizeof(DoomMapFormat::Vertex);
+		for (unsigned a = 0; a < nv; a++)
+			verts_.push_back({ (double)vert_data[a].x, (double)vert_data[a].y });
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Reads non-UDMF line data
+// -----------------------------------------------------------------------------
+void MapPreview::readLines(const vector<uint8_t>& data, MapFormat format)
+{
+	if (format == MapFormat::Doom)
+	{
+		auto     line_data = reinterpret_cast<const DoomMapFormat::LineDef*>(data.data());
+		unsigned nl        = data.size() / sizeof(DoomMapFormat::LineDef);
+		for (unsigned a = 0; a < nl; a++)
+		{
+			auto& l = line_data[a];
+			lines_.push_back({ l.vertex1, l.vertex2, l.side2 != 0xFFFF, l.type > 0 });
+		}
+	}
+	else if (format == MapFormat::Doom64)
+	{
+		auto     line_data = reinterpret_cast<const Doom64MapFormat::LineDef*>(data.data());
+		unsigned nl        = data.size() / sizeof(Doom64MapFormat::LineDef);
+		for (unsigned a = 0; a < nl; a++)
+		{
+			auto& l = line_data[a];
+
+			// Check properties
+			bool macro   = false;
+			bool special = false;
+			if (l.type > 0)
+			{
+				if (l.type & 0x100)
+					macro = true;
+				else
+					special = true;
+			}
+
+			lines_.push_back({ l.vertex1, l.vertex2, l.side2 != 0xFFFF, special, macro });
+		}
+	}
+	else if (format == MapFormat::Hexen)
+	{
+		auto     line_data = reinterpret_cast<const HexenMapFormat::LineDef*>(data.data());
+		unsigned nl        = data.size() / sizeof(HexenMapFormat::LineDef);
+		for (unsigned a = 0; a < nl; a++)
+		{
+			auto& l = line_data[a];
+			lines_.push_back({ l.vertex1, l.vertex2, l.side2 != 0xFFFF, l.type > 0 });
+		}
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Reads non-UDMF thing data
+// -----------------------------------------------------------------------------
+void MapPreview::readThings(const vector<uint8_t>& data, MapFormat format)
+{
+	if (format == MapFormat::Doom)
+	{
+		auto     thng_data = reinterpret_cast<const DoomMapFormat::Thing*>(data.data());
+		unsigned nt        = data.size() / sizeof(DoomMapFormat::Thing);
+		for (size_t a = 0; a < nt; a++)
+			things_.push_back({ (double)thng_data[a].x, (double)thng_data[a].y });
+	}
+	else if (format == MapFormat::Doom64)
+	{
+		auto     thng_data = reinterpret_cast<const Doom64MapFormat::Thing*>(data.data());
+		unsigned nt        = data.size() / sizeof(Doom64MapFormat::Thing);
+		for (size_t a = 0; a < nt; a++)
+			things_.push_back({ (double)thng_data[a].x, (double)thng_data[a].y });
+	}
+	else if (format == MapFormat::Hexen)
+	{
+		auto     thng_data = reinterpret_cast<const HexenMapFormat::Thing*>(data.data());
+		unsigned nt        = data.size() / sizeof(HexenMapFormat::Thing);
+		for (size_t a = 0; a < nt; a++)
+			things_.push_back({ (double)thng_data[a].x, (double)thng_data[a].y });
+	}
+}
+
+
+// -----------------------------------------------------------------------------
+//
+// MapPreview Class Static Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Copies the map lumps needed for a preview of [map] to [lumps].
+// This must be done on the main thread, but parsing and rendering the copied
+// lumps can then be done on any thread.
+// Returns false if the map is invalid
+// -----------------------------------------------------------------------------
+bool MapPreview::readLumps(const Archive::MapDesc& map, Lumps& lumps)
+{
+	auto m_head = map.head.lock();
+	if (!m_head)
+		return false;
+
+	// All errors = invalid map
+	global::error = "Invalid map";
+
+	lumps.name   = map.name;
+	lumps.format = map.format;
+
+	// Check if this map is a pk3 map
+	unique_ptr<Archive> temp_archive;
+	auto                m_end = map.end.lock();
+	if (map.archive)
+	{
+		// Attempt to open entry as wad archive
+		temp_archive = std::make_unique<WadArchive>();
+		if (!temp_archive->open(m_head->data()))
+			return false;
+
+		// Detect maps
+		auto maps = temp_archive->detectMaps();
+		if (maps.empty())
+			return false;
+
+		// Use the first map in the archive
+		m_head       = maps[0].head.lock();
+		m_end        = maps[0].end.lock();
+		lumps.format = maps[0].format;
+		if (!m_head)
+			return false;
+	}
+
+	// Copy map lumps
+	auto entry = m_head.get();
+	while (entry)
+	{
+		// Check entry type
+		auto& type = entry->type()->id();
+		if (type == "udmf_textmap")
+			mpCopyLump(entry, lumps.textmap);
+		else if (type == "map_vertexes")
+			mpCopyLump(entry, lumps.vertexes);
+		else if (type == "map_linedefs")
+			mpCopyLump(entry, lumps.linedefs);
+		else if (type == "map_things")
+			mpCopyLump(entry, lumps.things);
+		else if (type == "map_sidedefs")
+			lumps.sidedefs_size = entry->size();
+		else if (type == "map_sectors")
+			lumps.sectors_size = entry->size();
+
+		// Exit loop if we've reached the end of the map entries
+		if (entry == m_end.get())
+			break;
+		else
+			entry = entry->nextEntry();
+	}
+
+	if (lumps.format == MapFormat::UDMF)
+		return !lumps.textmap.empty();
+
+	return !lumps.vertexes.empty() && !lumps.linedefs.empty();
+}
+
+// -----------------------------------------------------------------------------
+// Returns image options for a map image of [width]x[height], with colours
+// from the current colour configuration
+// -----------------------------------------------------------------------------
+MapPreview::ImageOptions MapPreview::imageOptions(int width, int height)
+{
+	ImageOptions options;
+	options.width            = width;
+	options.height           = height;
+	options.thickness        = map_image_thickness;
+	options.col_background   = colourconfig::colour("map_image_background");
+	options.col_line_1s      = colourconfig::colour("map_image_line_1s");
+	options.col_line_2s      = colourconfig::colour("map_image_line_2s");
+	options.col_line_special = colourconfig::colour("map_image_line_special");
+	options.col_line_macro   = colourconfig::colour("map_image_line_macro");
+	options.col_thing        = colourconfig::colour("map_view_thing");
+
+	return options;
+}
+
+// -----------------------------------------------------------------------------
+// Renders images of all maps in [archive] with [options], in parallel on
+// [pool] (or the app thread pool if not given).
+// Images are cached by map lump content, so unchanged maps aren't rendered
+// again. Maps that couldn't be rendered have an invalid image in the result
+// -----------------------------------------------------------------------------
+vector<MapPreview::MapImage> MapPreview::createImages(Archive& archive, const ImageOptions& options, ThreadPool* pool)
+{
+	auto             maps = archive.detectMaps();
+	vector<MapImage> images(maps.size());
+	vector<Lumps>    lumps(maps.size());
+	vector<uint64_t> keys(maps.size());
+	vector<size_t>   to_render;
+	auto             options_hash = options.hash();
+
+	// Read map lumps and check cache
+	for (unsigned a = 0; a < maps.size(); ++a)
+	{
+		images[a].name = maps[a].name;
+		if (!readLumps(maps[a], lumps[a]))
+			continue;
+
+		keys[a] = mpHash(lumps[a].hash(), &options_hash, sizeof(options_hash));
+
+		std::lock_guard lock(mp_cache_mutex);
+		if (auto i = mp_image_cache.find(keys[a]); i != mp_image_cache.end())
+		{
+			images[a].image.copyImage(&i->second);
+			images[a].cached = true;
+		}
+		else
+			to_render.push_back(a);
+	}
+
+	// Render the rest
+	if (!pool)
+		pool = &app::threadPool();
+	pool->parallelFor(to_render.size(), [&](size_t a) {
+		auto       index = to_render[a];
+		MapPreview preview;
+		if (!preview.parse(lumps[index]) || !preview.createImage(images[index].image, options))
+			return;
+
+		std::lock_guard lock(mp_cache_mutex);
+		if (mp_image_cache.size() >= MP_CACHE_MAX_SIZE)
+			mp_image_cache.clear();
+		mp_image_cache[keys[index]].copyImage(&images[index].image);
+	});
+
+	return images;
+}
+
+// -----------------------------------------------------------------------------
+// Clears all cached map images
+// -----------------------------------------------------------------------------
+void MapPreview::clearImageCache()
+{
+	std::lock_guard lock(mp_cache_mutex);
+	mp_image_cache.clear();
+}
+
+
+// -----------------------------------------------------------------------------
+//
+// Console Commands
+//
+// -----------------------------------------------------------------------------
+#include "General/Console.h"
+#include "Graphics/SImage/SIFormat.h"
+#include "MainEditor/MainEditor.h"
+#include <chrono>
+
+// Saves PNG images of all maps in the current archive to the given directory
+CONSOLE_COMMAND(map_images, 1, true)
+{
+	auto archive = maineditor::currentArchive();
+	if (!archive)
+		return;
+
+	auto start  = std::chrono::steady_clock::now();
+	auto images = MapPreview::createImages(*archive, MapPreview::imageOptions(map_image_width, map_image_height));
+	auto ms     = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+	unsigned saved = 0, cached = 0;
+	for (auto& image : images)
+	{
+		if (!image.image.isValid())
+		{
+			log::warning("Unable to create image for map {}", image.name);
+			continue;
+		}
+
+		MemChunk mc;
+		if (!SIFormat::getFormat("png")->saveImage(image.image, mc)
+			|| !mc.exportFile(fmt::format("{}/{}.png", args[0], image.name)))
+			continue;
+
+		++saved;
+		if (image.cached)
+			++cached;
+	}
+
+	log::console(fmt::format("Saved {} map images ({} cached) in {:.1f}ms", saved, cached, ms));
+}
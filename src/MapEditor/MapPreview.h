@@ -0,0 +1,115 @@
+#pragma once
+
+#include "Archive/Archive.h"
+#include "Graphics/SImage/SImage.h"
+
+namespace slade
+{
+class ThreadPool;
+
+class MapPreview
+{
+public:
+	// Basic map features
+	struct Vertex
+	{
+		double x;
+		double y;
+	};
+
+	struct Line
+	{
+		unsigned v1       = 0;
+		unsigned v2       = 0;
+		bool     twosided = false;
+		bool     special  = false;
+		bool     macro    = false;
+	};
+
+	struct Thing
+	{
+		double x;
+		double y;
+	};
+
+	// The map lump data needed for a preview, copied out of the archive so it
+	// can be parsed (and rendered) on any thread
+	struct Lumps
+	{
+		string          name;
+		MapFormat       format = MapFormat::Unknown;
+		vector<uint8_t> vertexes;
+		vector<uint8_t> linedefs;
+		vector<uint8_t> things;
+		vector<uint8_t> textmap;
+		unsigned        sidedefs_size = 0;
+		unsigned        sectors_size  = 0;
+
+		uint64_t hash() const;
+	};
+
+	// Image rendering options. A negative [width] or [height] means 1 pixel
+	// per that many map units
+	struct ImageOptions
+	{
+		int     width     = -5;
+		int     height    = -5;
+		double  thickness = 1.5;
+		bool    things    = false;
+		ColRGBA col_background;
+		ColRGBA col_line_1s;
+		ColRGBA col_line_2s;
+		ColRGBA col_line_special;
+		ColRGBA col_line_macro;
+		ColRGBA col_thing;
+
+		uint64_t hash() const;
+	};
+
+	// Result of rendering a map with createImages
+	struct MapImage
+	{
+		string name;
+		SImage image;
+		bool   cached = false;
+	};
+
+	MapPreview()  = default;
+	~MapPreview() = default;
+
+	const vector<Vertex>& vertices() const { return verts_; }
+	const vector<Line>&   lines() const { return lines_; }
+	const vector<Thing>&  things() const { return things_; }
+
+	unsigned nVertices() const;
+	unsigned nSides() const { return n_sides_; }
+	unsigned nLines() const { return lines_.size(); }
+	unsigned nSectors() const { return n_sectors_; }
+	unsigned nThings() const { return things_.size(); }
+	unsigned width() const;
+	unsigned height() const;
+	Rectd    bounds() const;
+
+	void clear();
+	bool open(const Archive::MapDesc& map);
+	bool parse(const Lumps& lumps);
+	bool createImage(SImage& image, const ImageOptions& options) const;
+
+	static bool             readLumps(const Archive::MapDesc& map, Lumps& lumps);
+	static ImageOptions     imageOptions(int width, int height);
+	static vector<MapImage> createImages(Archive& archive, const ImageOptions& options, ThreadPool* pool = nullptr);
+	static void             clearImageCache();
+
+private:
+	vector<Vertex> verts_;
+	vector<Line>   lines_;
+	vector<Thing>  things_;
+	unsigned       n_sides_   = 0;
+	unsigned       n_sectors_ = 0;
+
+	bool parseUDMF(const Lumps& lumps);
+	void readVertices(const vector<uint8_t>& data, MapFormat format);
+	void readLines(const vector<uint8_t>& data, MapFormat format);
+	void readThings(const vector<uint8_t>& data, MapFormat format);
+};
+} // namespace slade
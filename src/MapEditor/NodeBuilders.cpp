@@ -118,6 +118,10 @@ void nodebuilders::init()
 			// Builder executable
 			else if (strutil::equalCI(node->name(), "executable"))
 				builder.exe = node->stringValue();
+
+			// Built-in
+			else if (strutil::equalCI(node->name(), "builtin"))
+				builder.builtin = node->boolValue();
 		}
 		builders.push_back(builder);
 	}
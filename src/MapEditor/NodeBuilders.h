@@ -11,6 +11,7 @@ struct Builder
 	string         exe;
 	vector<string> options;
 	vector<string> option_desc;
+	bool           builtin = false; // Built into SLADE (see BSPBuilder), no executable needed
 };
 
 void     init();
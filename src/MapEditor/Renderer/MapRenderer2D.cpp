@@ -43,6 +43,7 @@
 #include "OpenGL/GLTexture.h"
 #include "OpenGL/OpenGL.h"
 #include "SLADEMap/SLADEMap.h"
+#include "Utility/MathStuff.h"
 #include "Utility/Polygon2D.h"
 
 using namespace slade;
@@ -73,6 +74,7 @@ CVAR(Bool, map_animate_tagged, true, CVar::Flag::Save)
 CVAR(Float, arrow_alpha, 1.0f, CVar::Flag::Save)
 CVAR(Bool, arrow_colour, false, CVar::Flag::Save)
 CVAR(Bool, flats_use_vbo, true, CVar::Flag::Save)
+CVAR(Bool, things_use_vbo, true, CVar::Flag::Save)
 CVAR(Int, halo_width, 5, CVar::Flag::Save)
 CVAR(Float, arrowhead_angle, 0.7854f, CVar::Flag::Save)
 CVAR(Float, arrowhead_length, 25.f, CVar::Flag::Save)
@@ -84,9 +86,75 @@ namespace
 {
 // Texture coordinates for rendering square things (since we can't just rotate these)
 float sq_thing_tc[] = { 0.0f, 1.0f, 0.0f, 0.0f, 1.0f, 0.0f, 1.0f, 1.0f };
+
+// Things VBO passes, each pass is drawn after the previous one
+enum class ThingVBOPass
+{
+	Shadows,
+	Things,
+	SquareSprites,
+	Arrows
+};
 } // namespace
 
 
+// -----------------------------------------------------------------------------
+//
+// Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// -----------------------------------------------------------------------------
+// Sorts [indices] and calls [func] with the first index and length of each run
+// of consecutive indices below [count] (ignoring duplicates)
+// -----------------------------------------------------------------------------
+template<typename F> void forEachIndexRun(vector<unsigned>& indices, unsigned count, F func)
+{
+	std::sort(indices.begin(), indices.end());
+	indices.erase(std::unique(indices.begin(), indices.end()), indices.end());
+
+	unsigned a = 0;
+	while (a < indices.size() && indices[a] < count)
+	{
+		auto first = indices[a];
+		auto last  = first;
+		while (a + 1 < indices.size() && indices[a + 1] == last + 1 && indices[a + 1] < count)
+		{
+			++a;
+			++last;
+		}
+
+		func(first, last - first + 1);
+		++a;
+	}
+}
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// MapRenderer2D::ThingBatchBuilder Struct
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Collects thing quads while building the things VBO, grouped by pass and
+// texture (or atlas page)
+// -----------------------------------------------------------------------------
+struct MapRenderer2D::ThingBatchBuilder
+{
+	gl::TextureAtlas* atlas     = nullptr;
+	ThingVBOPass      pass      = ThingVBOPass::Shadows;
+	unsigned          thing     = 0;
+	float             colour[4] = { 1.f, 1.f, 1.f, 1.f };
+	vector<unsigned>  fallback; // Things that couldn't be batched
+
+	std::map<std::pair<ThingVBOPass, unsigned>, vector<ThingVBOVert>> quads;
+};
+
+
 // -----------------------------------------------------------------------------
 //
 // External Variables
@@ -113,6 +181,8 @@ MapRenderer2D::~MapRenderer2D()
 		glDeleteBuffers(1, &vbo_lines_);
 	if (vbo_flats_ > 0)
 		glDeleteBuffers(1, &vbo_flats_);
+	if (vbo_things_ > 0)
+		glDeleteBuffers(1, &vbo_things_);
 	if (list_vertices_ > 0)
 		glDeleteLists(list_vertices_, 1);
 	if (list_lines_ > 0)
@@ -250,7 +320,7 @@ void MapRenderer2D::renderVerticesVBO()
 		return;
 
 	// Update vertices VBO if required
-	if (vbo_vertices_ == 0 || map_->nVertices() != n_vertices_ || map_->geometryUpdated() > vertices_updated_)
+	if (vbo_vertices_ == 0 || map_->nVertices() != n_vertices_ || !patchVerticesVBO())
 		updateVerticesVBO();
 
 	// Set VBO arrays to use
@@ -466,9 +536,7 @@ void MapRenderer2D::renderLinesVBO(bool show_direction, float alpha)
 		return;
 
 	// Update lines VBO if required
-	if (vbo_lines_ == 0 || show_direction != lines_dirs_ || map_->nLines() != n_lines_
-		|| map_->geometryUpdated() > lines_updated_
-		|| map_->mapData().modifiedSince(lines_updated_, MapObject::Type::Line))
+	if (vbo_lines_ == 0 || show_direction != lines_dirs_ || map_->nLines() != n_lines_ || !patchLinesVBO())
 		updateLinesVBO(show_direction, alpha);
 
 	// Disable any blending
@@ -797,22 +865,7 @@ void MapRenderer2D::renderRoundThing(
 	bool     rotate = false;
 
 	// Set colour
-	if (type.pointLight().empty())
-		glColor4f(type.colour().fr(), type.colour().fg(), type.colour().fb(), alpha);
-	else if (type.pointLight() == "zdoom")
-		glColor4f(
-			static_cast<float>(args[0]) / 255.f,
-			static_cast<float>(args[1]) / 255.f,
-			static_cast<float>(args[2]) / 255.f,
-			alpha);
-	else if (type.pointLight() == "vavoom")
-		glColor4f(
-			static_cast<float>(args[1]) / 255.f,
-			static_cast<float>(args[2]) / 255.f,
-			static_cast<float>(args[3]) / 255.f,
-			alpha);
-	else
-		glColor4f(1.f, 1.f, 1.f, alpha);
+	setThingTypeColour(type, args, alpha);
 
 	// Check for custom thing icon
 	if (!type.icon().empty() && !thing_force_dir && !things_angles_)
@@ -845,36 +898,11 @@ void MapRenderer2D::renderRoundThing(
 		return;
 	}
 
-	// Bind texture
-	gl::Texture::bind(tex, false);
-
-	// Rotate if needed
-	if (rotate)
-	{
-		glPushMatrix();
-		glTranslated(x, y, 0);
-		glRotated(angle, 0, 0, 1);
-		x = y = 0;
-	}
-
-	// Draw thing
+	// Draw thing (rotated if needed)
 	double radius = type.radius() * radius_mult;
 	if (type.shrinkOnZoom())
 		radius = scaledRadius(radius);
-	glBegin(GL_QUADS);
-	glTexCoord2f(0.0f, 1.0f);
-	glVertex2d(x - radius, y - radius);
-	glTexCoord2f(0.0f, 0.0f);
-	glVertex2d(x - radius, y + radius);
-	glTexCoord2f(1.0f, 0.0f);
-	glVertex2d(x + radius, y + radius);
-	glTexCoord2f(1.0f, 1.0f);
-	glVertex2d(x + radius, y - radius);
-	glEnd();
-
-	// Restore previous matrix if rotated
-	if (rotate)
-		glPopMatrix();
+	drawThingQuad(tex, x - radius, y - radius, x + radius, y + radius, 0, rotate ? angle : 0.);
 }
 
 // -----------------------------------------------------------------------------
@@ -929,9 +957,6 @@ bool MapRenderer2D::renderSpriteThing(
 	if (type.angled() || thing_force_dir || things_angles_)
 		show_angle = true;
 
-	// Bind texture
-	gl::Texture::bind(tex, false);
-
 	// Draw thing
 	auto&  tex_info = gl::Texture::info(tex);
 	double hw       = tex_info.size.x * 0.5;
@@ -951,41 +976,13 @@ bool MapRenderer2D::renderSpriteThing(
 		double sz = (min(hw, hh)) * 0.1;
 		if (sz < 1)
 			sz = 1;
-		glColor4f(0.0f, 0.0f, 0.0f, alpha * (thing_shadow * 0.7));
-		glBegin(GL_QUADS);
-		glTexCoord2f(0.0f, 1.0f);
-		glVertex2d(x - hw - sz, y - hh - sz);
-		glTexCoord2f(0.0f, 0.0f);
-		glVertex2d(x - hw - sz, y + hh + sz);
-		glTexCoord2f(1.0f, 0.0f);
-		glVertex2d(x + hw + sz, y + hh + sz);
-		glTexCoord2f(1.0f, 1.0f);
-		glVertex2d(x + hw + sz, y - hh - sz);
-		glEnd();
-		glBegin(GL_QUADS);
-		glTexCoord2f(0.0f, 1.0f);
-		glVertex2d(x - hw - sz, y - hh - sz - sz);
-		glTexCoord2f(0.0f, 0.0f);
-		glVertex2d(x - hw - sz, y + hh + sz);
-		glTexCoord2f(1.0f, 0.0f);
-		glVertex2d(x + hw + sz + sz, y + hh + sz);
-		glTexCoord2f(1.0f, 1.0f);
-		glVertex2d(x + hw + sz + sz, y - hh - sz - sz);
-		glEnd();
+		setThingColour(0.0f, 0.0f, 0.0f, alpha * (thing_shadow * 0.7));
+		drawThingQuad(tex, x - hw - sz, y - hh - sz, x + hw + sz, y + hh + sz);
+		drawThingQuad(tex, x - hw - sz, y - hh - sz - sz, x + hw + sz + sz, y + hh + sz);
 	}
 	// Draw thing
-	glColor4f(1.0f, 1.0f, 1.0f, alpha);
-	glBegin(GL_QUADS);
-	glTexCoord2f(0.0f, 1.0f);
-	glVertex2d(x - hw, y - hh);
-	glTexCoord2f(0.0f, 0.0f);
-	glVertex2d(x - hw, y + hh);
-	glTexCoord2f(1.0f, 0.0f);
-	glVertex2d(x + hw, y + hh);
-	glTexCoord2f(1.0f, 1.0f);
-	glVertex2d(x + hw, y - hh);
-	glEnd();
-
+	setThingColour(1.0f, 1.0f, 1.0f, alpha);
+	drawThingQuad(tex, x - hw, y - hh, x + hw, y + hh);
 
 	return show_angle;
 }
@@ -1007,22 +1004,7 @@ bool MapRenderer2D::renderSquareThing(
 	unsigned tex = 0;
 
 	// Set colour
-	if (type.pointLight().empty())
-		glColor4f(type.colour().fr(), type.colour().fg(), type.colour().fb(), alpha);
-	else if (type.pointLight() == "zdoom")
-		glColor4f(
-			static_cast<float>(args[0]) / 255.f,
-			static_cast<float>(args[1]) / 255.f,
-			static_cast<float>(args[2]) / 255.f,
-			alpha);
-	else if (type.pointLight() == "vavoom")
-		glColor4f(
-			static_cast<float>(args[1]) / 255.f,
-			static_cast<float>(args[2]) / 255.f,
-			static_cast<float>(args[3]) / 255.f,
-			alpha);
-	else
-		glColor4f(1.f, 1.f, 1.f, alpha);
+	setThingTypeColour(type, args, alpha);
 
 	// Show icon anyway if no sprite set
 	if (type.sprite().empty())
@@ -1092,33 +1074,11 @@ bool MapRenderer2D::renderSquareThing(
 		return false;
 	}
 
-	// Bind texture
-	gl::Texture::bind(tex, false);
-
 	// Draw thing
 	double radius = type.radius();
 	if (type.shrinkOnZoom())
 		radius = scaledRadius(radius);
-	glBegin(GL_QUADS);
-	int tc = tc_start;
-	glTexCoord2f(sq_thing_tc[tc], sq_thing_tc[tc + 1]);
-	tc += 2;
-	if (tc == 8)
-		tc = 0;
-	glVertex2d(x - radius, y - radius);
-	glTexCoord2f(sq_thing_tc[tc], sq_thing_tc[tc + 1]);
-	tc += 2;
-	if (tc == 8)
-		tc = 0;
-	glVertex2d(x - radius, y + radius);
-	glTexCoord2f(sq_thing_tc[tc], sq_thing_tc[tc + 1]);
-	tc += 2;
-	if (tc == 8)
-		tc = 0;
-	glVertex2d(x + radius, y + radius);
-	glTexCoord2f(sq_thing_tc[tc], sq_thing_tc[tc + 1]);
-	glVertex2d(x + radius, y - radius);
-	glEnd();
+	drawThingQuad(tex, x - radius, y - radius, x + radius, y + radius, tc_start);
 
 	return ((type.angled() || thing_force_dir || things_angles_) && !showicon);
 }
@@ -1134,6 +1094,13 @@ void MapRenderer2D::renderSimpleSquareThing(
 	const MapObject::ArgSet& args,
 	float                    alpha) const
 {
+	// Can't be batched, will be drawn in immediate mode after the things VBO
+	if (thing_batch_build_)
+	{
+		thing_batch_build_->fallback.push_back(thing_batch_build_->thing);
+		return;
+	}
+
 	// Get thing info
 	double radius = type.radius();
 	if (type.shrinkOnZoom())
@@ -1154,22 +1121,7 @@ void MapRenderer2D::renderSimpleSquareThing(
 	glEnd();
 
 	// Set colour
-	if (type.pointLight().empty())
-		glColor4f(type.colour().fr(), type.colour().fg(), type.colour().fb(), alpha);
-	else if (type.pointLight() == "zdoom")
-		glColor4f(
-			static_cast<float>(args[0]) / 255.f,
-			static_cast<float>(args[1]) / 255.f,
-			static_cast<float>(args[2]) / 255.f,
-			alpha);
-	else if (type.pointLight() == "vavoom")
-		glColor4f(
-			static_cast<float>(args[1]) / 255.f,
-			static_cast<float>(args[2]) / 255.f,
-			static_cast<float>(args[3]) / 255.f,
-			alpha);
-	else
-		glColor4f(1.f, 1.f, 1.f, alpha);
+	setThingTypeColour(type, args, alpha);
 
 	// Draw base
 	glBegin(GL_QUADS);
@@ -1194,6 +1146,121 @@ void MapRenderer2D::renderSimpleSquareThing(
 	glPopMatrix();
 }
 
+// -----------------------------------------------------------------------------
+// Sets the colour for following thing quads to [r,g,b,a]
+// -----------------------------------------------------------------------------
+void MapRenderer2D::setThingColour(float r, float g, float b, float a) const
+{
+	if (thing_batch_build_)
+	{
+		auto& colour = thing_batch_build_->colour;
+		colour[0]    = r;
+		colour[1]    = g;
+		colour[2]    = b;
+		colour[3]    = a;
+	}
+	else
+		glColor4f(r, g, b, a);
+}
+
+// -----------------------------------------------------------------------------
+// Sets the colour for following thing quads to the colour of thing [type]
+// (or its light colour from [args] if it is a point light)
+// -----------------------------------------------------------------------------
+void MapRenderer2D::setThingTypeColour(const game::ThingType& type, const MapObject::ArgSet& args, float alpha) const
+{
+	if (type.pointLight().empty())
+		setThingColour(type.colour().fr(), type.colour().fg(), type.colour().fb(), alpha);
+	else if (type.pointLight() == "zdoom")
+		setThingColour(
+			static_cast<float>(args[0]) / 255.f,
+			static_cast<float>(args[1]) / 255.f,
+			static_cast<float>(args[2]) / 255.f,
+			alpha);
+	else if (type.pointLight() == "vavoom")
+		setThingColour(
+			static_cast<float>(args[1]) / 255.f,
+			static_cast<float>(args[2]) / 255.f,
+			static_cast<float>(args[3]) / 255.f,
+			alpha);
+	else
+		setThingColour(1.f, 1.f, 1.f, alpha);
+}
+
+// -----------------------------------------------------------------------------
+// Draws a thing quad from [x1,y1] to [x2,y2] with texture [tex], rotated by
+// [angle] around its centre. [tc_start] is the first texture coordinate to use
+// (see sq_thing_tc).
+// If the things VBO is being built the quad is added to it instead
+// -----------------------------------------------------------------------------
+void MapRenderer2D::drawThingQuad(
+	unsigned tex,
+	double   x1,
+	double   y1,
+	double   x2,
+	double   y2,
+	int      tc_start,
+	double   angle) const
+{
+	// Determine corners
+	double px[4] = { x1, x1, x2, x2 };
+	double py[4] = { y1, y2, y2, y1 };
+	if (angle != 0.)
+	{
+		auto cx = (x1 + x2) * 0.5;
+		auto cy = (y1 + y2) * 0.5;
+		auto ca = cos(math::degToRad(angle));
+		auto sa = sin(math::degToRad(angle));
+		for (unsigned a = 0; a < 4; a++)
+		{
+			auto dx = px[a] - cx;
+			auto dy = py[a] - cy;
+			px[a]   = cx + dx * ca - dy * sa;
+			py[a]   = cy + dx * sa + dy * ca;
+		}
+	}
+
+	// Immediate mode
+	if (!thing_batch_build_)
+	{
+		gl::Texture::bind(tex, false);
+		glBegin(GL_QUADS);
+		for (unsigned a = 0; a < 4; a++)
+		{
+			auto tc = (tc_start + a * 2) % 8;
+			glTexCoord2f(sq_thing_tc[tc], sq_thing_tc[tc + 1]);
+			glVertex2d(px[a], py[a]);
+		}
+		glEnd();
+		return;
+	}
+
+	// Add to the things VBO, in the texture's atlas page if it could be added
+	auto& build  = *thing_batch_build_;
+	auto  region = build.atlas->region(tex);
+	auto& quads  = build.quads[{ build.pass, region ? region->page : tex }];
+	for (unsigned a = 0; a < 4; a++)
+	{
+		auto tc = (tc_start + a * 2) % 8;
+		auto u  = sq_thing_tc[tc];
+		auto v  = sq_thing_tc[tc + 1];
+		if (region)
+		{
+			u = region->tl.x + u * (region->br.x - region->tl.x);
+			v = region->tl.y + v * (region->br.y - region->tl.y);
+		}
+
+		quads.push_back({ static_cast<float>(px[a]),
+						  static_cast<float>(py[a]),
+						  u,
+						  v,
+						  build.colour[0],
+						  build.colour[1],
+						  build.colour[2],
+						  build.colour[3] });
+	}
+}
+
 // -----------------------------------------------------------------------------
 // Renders map things
 // -----------------------------------------------------------------------------
@@ -1204,7 +1271,10 @@ void MapRenderer2D::renderThings(float alpha, bool force_dir)
 		return;
 
 	things_angles_ = force_dir;
-	renderThingsImmediate(alpha);
+	if (gl::vboSupport() && things_use_vbo)
+		renderThingsVBO(alpha);
+	else
+		renderThingsImmediate(alpha);
 }
 
 // -----------------------------------------------------------------------------
@@ -1281,16 +1351,7 @@ void MapRenderer2D::renderThingsImmediate(float alpha)
 					// Textured quad
 					if (point)
 						glDisable(GL_POINT_SPRITE);
-					glBegin(GL_QUADS);
-					glTexCoord2f(0.0f, 1.0f);
-					glVertex2d(x - radius, y - radius);
-					glTexCoord2f(0.0f, 0.0f);
-					glVertex2d(x - radius, y + radius);
-					glTexCoord2f(1.0f, 0.0f);
-					glVertex2d(x + radius, y + radius);
-					glTexCoord2f(1.0f, 1.0f);
-					glVertex2d(x + radius, y - radius);
-					glEnd();
+					drawThingQuad(tex_shadow, x - radius, y - radius, x + radius, y + radius);
 					if (point)
 						glEnable(GL_POINT_SPRITE);
 				}
@@ -1409,22 +1470,7 @@ void MapRenderer2D::renderThingsImmediate(float alpha)
 				x = thing->xPos();
 				y = thing->yPos();
 
-				glPushMatrix();
-				glTranslated(x, y, 0);
-				glRotated(thing->angle(), 0, 0, 1);
-
-				glBegin(GL_QUADS);
-				glTexCoord2f(0.0f, 1.0f);
-				glVertex2d(-32, -32);
-				glTexCoord2f(0.0f, 0.0f);
-				glVertex2d(-32, 32);
-				glTexCoord2f(1.0f, 0.0f);
-				glVertex2d(32, 32);
-				glTexCoord2f(1.0f, 1.0f);
-				glVertex2d(32, -32);
-				glEnd();
-
-				glPopMatrix();
+				drawThingQuad(tex_arrow, x - 32, y - 32, x + 32, y + 32, 0, thing->angle());
 			}
 		}
 	}
@@ -1433,6 +1479,68 @@ void MapRenderer2D::renderThingsImmediate(float alpha)
 	glDisable(GL_TEXTURE_2D);
 }
 
+// -----------------------------------------------------------------------------
+// Renders map things using an OpenGL Vertex Buffer Object, drawing all things
+// with the same texture (or texture atlas page) at once
+// -----------------------------------------------------------------------------
+void MapRenderer2D::renderThingsVBO(float alpha)
+{
+	// Do nothing if there are no things in the map
+	if (map_->nThings() == 0)
+		return;
+
+	// Update things VBO if required
+	if (vbo_things_ == 0 || map_->nThings() != n_things_ || map_->thingsUpdated() > things_updated_
+		|| map_->things().changeCount() != vbo_things_changes_ || !(thingVBOState(alpha) == thing_vbo_state_))
+		updateThingsVBO(alpha);
+
+	// Enable textures
+	glEnable(GL_TEXTURE_2D);
+	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+	// Set VBO arrays to use
+	glEnableClientState(GL_VERTEX_ARRAY);
+	glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+	glEnableClientState(GL_COLOR_ARRAY);
+
+	// Setup VBO pointers
+	glBindBuffer(GL_ARRAY_BUFFER, vbo_things_);
+	glVertexPointer(2, GL_FLOAT, sizeof(ThingVBOVert), nullptr);
+	glTexCoordPointer(2, GL_FLOAT, sizeof(ThingVBOVert), ((char*)nullptr + 8));
+	glColorPointer(4, GL_FLOAT, sizeof(ThingVBOVert), ((char*)nullptr + 16));
+
+	// Render the VBO, one batch per texture
+	for (const auto& batch : thing_batches_)
+	{
+		gl::Texture::bind(batch.texture, false);
+		glDrawArrays(GL_QUADS, batch.first, batch.count);
+	}
+
+	// Clean state
+	glDisableClientState(GL_VERTEX_ARRAY);
+	glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+	glDisableClientState(GL_COLOR_ARRAY);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	glDisable(GL_TEXTURE_2D);
+
+	// Draw any things that couldn't be added to the VBO
+	for (auto index : thing_batch_fallback_)
+	{
+		auto thing = map_->thing(index);
+		if (!thing)
+			continue;
+
+		auto& tt = game::configuration().thingType(thing->type());
+		renderSimpleSquareThing(
+			thing->xPos(),
+			thing->yPos(),
+			thing->angle(),
+			tt,
+			thing->args(),
+			thing->isFiltered() ? alpha * 0.25f : alpha);
+	}
+}
+
 // -----------------------------------------------------------------------------
 // Renders the thing hilight overlay for thing [index]
 // -----------------------------------------------------------------------------
@@ -2109,8 +2217,6 @@ void MapRenderer2D::renderFlatsVBO(int type, bool texture, float alpha)
 	using game::Feature;
 	using game::UDMFFeature;
 
-	bool vbo_updated = false;
-
 	if (flat_ignore_light)
 		glColor4f(flat_brightness, flat_brightness, flat_brightness, alpha);
 
@@ -2131,23 +2237,9 @@ void MapRenderer2D::renderFlatsVBO(int type, bool texture, float alpha)
 		last_flat_type_ = type;
 	}
 
-	// First, check if any polygon vertex data has changed (in this case we need to refresh the entire vbo)
-	for (unsigned a = 0; a < map_->nSectors(); a++)
-	{
-		auto poly = map_->sector(a)->polygon();
-		if (poly && poly->vboUpdate() > 1)
-		{
-			updateFlatsVBO();
-			vbo_updated = true;
-		}
-	}
-
-	// Create VBO if necessary
-	if (!vbo_updated && vbo_flats_ == 0)
-	{
+	// Update VBO if required
+	if (vbo_flats_ == 0 || flat_vbo_spans_.size() != map_->nSectors() || !patchFlatsVBO())
 		updateFlatsVBO();
-		vbo_updated = true;
-	}
 
 	// Setup opengl state
 	if (texture)
@@ -3031,8 +3123,43 @@ void MapRenderer2D::updateVerticesVBO()
 	// Clean up
 	glBindBuffer(GL_ARRAY_BUFFER, 0);
 
-	n_vertices_       = map_->nVertices();
+	n_vertices_           = map_->nVertices();
+	vertices_updated_     = app::runTimer();
+	vbo_vertices_changes_ = map_->vertices().changeCount();
+}
+
+// -----------------------------------------------------------------------------
+// Updates the map vertices VBO data for any vertices changed since the last
+// update. Returns false if the changes aren't known and a full update is needed
+// -----------------------------------------------------------------------------
+bool MapRenderer2D::patchVerticesVBO()
+{
+	// Get vertices changed since last update
+	vector<unsigned> changed;
+	if (!map_->vertices().changesSince(vbo_vertices_changes_, changed))
+		return false;
+	vbo_vertices_changes_ = map_->vertices().changeCount();
+	if (changed.empty())
+		return true;
+
+	// Write changed vertices
+	vector<GLfloat> verts;
+	glBindBuffer(GL_ARRAY_BUFFER, vbo_vertices_);
+	forEachIndexRun(changed, n_vertices_, [&](unsigned first, unsigned count) {
+		verts.resize(count * 2);
+		for (unsigned a = 0; a < count; a++)
+		{
+			verts[a * 2]     = map_->vertex(first + a)->xPos();
+			verts[a * 2 + 1] = map_->vertex(first + a)->yPos();
+		}
+		glBufferSubData(GL_ARRAY_BUFFER, sizeof(GLfloat) * first * 2, sizeof(GLfloat) * count * 2, verts.data());
+	});
+
+	// Clean up
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
 	vertices_updated_ = app::runTimer();
+	return true;
 }
 
 // -----------------------------------------------------------------------------
@@ -3054,57 +3181,107 @@ void MapRenderer2D::updateLinesVBO(bool show_direction, float base_alpha)
 	// Fill lines VBO
 	int            nverts = map_->nLines() * vpl;
 	vector<GLVert> lines(nverts);
-	unsigned       v = 0;
-	ColRGBA        col;
-	float          alpha;
 	for (unsigned a = 0; a < map_->nLines(); a++)
-	{
-		auto line = map_->line(a);
+		setLineVBOVerts(map_->line(a), lines.data() + a * vpl, show_direction, base_alpha);
+	glBindBuffer(GL_ARRAY_BUFFER, vbo_lines_);
+	glBufferData(GL_ARRAY_BUFFER, sizeof(GLVert) * nverts, lines.data(), GL_STATIC_DRAW);
 
-		// Get line colour
-		col   = lineColour(line);
-		alpha = base_alpha * col.fa();
-
-		// Set line vertices
-		lines[v].x     = line->v1()->xPos();
-		lines[v].y     = line->v1()->yPos();
-		lines[v + 1].x = line->v2()->xPos();
-		lines[v + 1].y = line->v2()->yPos();
-
-		// Set line colour(s)
-		lines[v].r = lines[v + 1].r = col.fr();
-		lines[v].g = lines[v + 1].g = col.fg();
-		lines[v].b = lines[v + 1].b = col.fb();
-		lines[v].a = lines[v + 1].a = alpha;
-
-		// Direction tab if needed
-		if (show_direction)
-		{
-			auto mid       = line->getPoint(MapObject::Point::Mid);
-			auto tab       = line->dirTabPoint();
-			lines[v + 2].x = mid.x;
-			lines[v + 2].y = mid.y;
-			lines[v + 3].x = tab.x;
-			lines[v + 3].y = tab.y;
-
-			// Colours
-			lines[v + 2].r = lines[v + 3].r = col.fr();
-			lines[v + 2].g = lines[v + 3].g = col.fg();
-			lines[v + 2].b = lines[v + 3].b = col.fb();
-			lines[v + 2].a = lines[v + 3].a = alpha * 0.6f;
-		}
+	// Clean up
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
 
-		// Next line
-		v += vpl;
-	}
+	n_lines_                = map_->nLines();
+	lines_updated_          = app::runTimer();
+	vbo_lines_alpha_        = base_alpha;
+	vbo_lines_changes_      = map_->lines().changeCount();
+	vbo_lines_vert_changes_ = map_->vertices().changeCount();
+	vbo_lines_side_changes_ = map_->sides().changeCount();
+}
+
+// -----------------------------------------------------------------------------
+// Updates the map lines VBO data for any lines changed since the last update,
+// including lines whose vertices or sides changed. Returns false if the changes
+// aren't known and a full update is needed
+// -----------------------------------------------------------------------------
+bool MapRenderer2D::patchLinesVBO()
+{
+	// Get lines, vertices and sides changed since last update
+	vector<unsigned> changed, changed_verts, changed_sides;
+	if (!map_->lines().changesSince(vbo_lines_changes_, changed)
+		|| !map_->vertices().changesSince(vbo_lines_vert_changes_, changed_verts)
+		|| !map_->sides().changesSince(vbo_lines_side_changes_, changed_sides))
+		return false;
+	vbo_lines_changes_      = map_->lines().changeCount();
+	vbo_lines_vert_changes_ = map_->vertices().changeCount();
+	vbo_lines_side_changes_ = map_->sides().changeCount();
+
+	// Add lines attached to changed vertices/sides
+	for (auto index : changed_verts)
+		if (auto vertex = map_->vertex(index))
+			for (auto line : vertex->connectedLines())
+				changed.push_back(line->index());
+	for (auto index : changed_sides)
+		if (auto side = map_->side(index); side && side->parentLine())
+			changed.push_back(side->parentLine()->index());
+
+	if (changed.empty())
+		return true;
+
+	// Write changed lines
+	int            vpl = lines_dirs_ ? 4 : 2;
+	vector<GLVert> verts;
 	glBindBuffer(GL_ARRAY_BUFFER, vbo_lines_);
-	glBufferData(GL_ARRAY_BUFFER, sizeof(GLVert) * nverts, lines.data(), GL_STATIC_DRAW);
+	forEachIndexRun(changed, n_lines_, [&](unsigned first, unsigned count) {
+		verts.resize(count * vpl);
+		for (unsigned a = 0; a < count; a++)
+			setLineVBOVerts(map_->line(first + a), verts.data() + a * vpl, lines_dirs_, vbo_lines_alpha_);
+		glBufferSubData(GL_ARRAY_BUFFER, sizeof(GLVert) * first * vpl, sizeof(GLVert) * count * vpl, verts.data());
+	});
 
 	// Clean up
 	glBindBuffer(GL_ARRAY_BUFFER, 0);
 
-	n_lines_       = map_->nLines();
 	lines_updated_ = app::runTimer();
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Writes the VBO vertices for [line] to [verts] (4 if [show_direction] is true,
+// otherwise 2)
+// -----------------------------------------------------------------------------
+void MapRenderer2D::setLineVBOVerts(MapLine* line, GLVert* verts, bool show_direction, float base_alpha) const
+{
+	// Get line colour
+	auto col   = lineColour(line);
+	auto alpha = base_alpha * col.fa();
+
+	// Set line vertices
+	verts[0].x = line->v1()->xPos();
+	verts[0].y = line->v1()->yPos();
+	verts[1].x = line->v2()->xPos();
+	verts[1].y = line->v2()->yPos();
+
+	// Set line colour(s)
+	verts[0].r = verts[1].r = col.fr();
+	verts[0].g = verts[1].g = col.fg();
+	verts[0].b = verts[1].b = col.fb();
+	verts[0].a = verts[1].a = alpha;
+
+	// Direction tab if needed
+	if (show_direction)
+	{
+		auto mid   = line->getPoint(MapObject::Point::Mid);
+		auto tab   = line->dirTabPoint();
+		verts[2].x = mid.x;
+		verts[2].y = mid.y;
+		verts[3].x = tab.x;
+		verts[3].y = tab.y;
+
+		// Colours
+		verts[2].r = verts[3].r = col.fr();
+		verts[2].g = verts[3].g = col.fg();
+		verts[2].b = verts[3].b = col.fb();
+		verts[2].a = verts[3].a = alpha * 0.6f;
+	}
 }
 
 // -----------------------------------------------------------------------------
@@ -3134,17 +3311,272 @@ void MapRenderer2D::updateFlatsVBO()
 	// Write polygon data to VBO
 	unsigned offset = 0;
 	unsigned index  = 0;
+	flat_vbo_spans_.resize(map_->nSectors());
 	for (unsigned a = 0; a < map_->nSectors(); a++)
 	{
-		auto poly = map_->sector(a)->polygon();
-		offset    = poly->writeToVBO(offset, index);
+		auto poly                 = map_->sector(a)->polygon();
+		flat_vbo_spans_[a].offset = offset;
+		flat_vbo_spans_[a].index  = index;
+		flat_vbo_spans_[a].size   = poly->vboDataSize();
+		offset                    = poly->writeToVBO(offset, index);
 		index += poly->totalVertices();
 	}
 
 	// Clean up
 	glBindBuffer(GL_ARRAY_BUFFER, 0);
 
-	flats_updated_ = app::runTimer();
+	flats_updated_     = app::runTimer();
+	vbo_flats_changes_ = map_->sectors().changeCount();
+}
+
+// -----------------------------------------------------------------------------
+// Rewrites the flats VBO data for sectors changed since the last update whose
+// polygons were rebuilt, in place. Returns false if the changes aren't known or
+// a rebuilt polygon no longer fits in its space in the VBO, in which case a
+// full update is needed
+// -----------------------------------------------------------------------------
+bool MapRenderer2D::patchFlatsVBO()
+{
+	// Get sectors changed since last update
+	vector<unsigned> changed;
+	if (!map_->sectors().changesSince(vbo_flats_changes_, changed))
+		return false;
+	if (changed.empty())
+		return true;
+
+	std::sort(changed.begin(), changed.end());
+	changed.erase(std::unique(changed.begin(), changed.end()), changed.end());
+
+	// Write rebuilt polygons (any other changes to polygon data are updated
+	// in place when rendering)
+	bool fits = true;
+	glBindBuffer(GL_ARRAY_BUFFER, vbo_flats_);
+	for (auto index : changed)
+	{
+		auto sector = map_->sector(index);
+		if (!sector)
+			continue;
+
+		auto poly = sector->polygon();
+		if (poly->vboUpdate() < 2)
+			continue;
+
+		auto& span = flat_vbo_spans_[index];
+		if (poly->vboDataSize() > span.size)
+		{
+			fits = false;
+			break;
+		}
+
+		poly->writeToVBO(span.offset, span.index);
+	}
+
+	// Clean up
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	// Update change count (polygon() can't add any more changes)
+	vbo_flats_changes_ = map_->sectors().changeCount();
+
+	return fits;
+}
+
+// -----------------------------------------------------------------------------
+// (Re)builds the map things VBO, drawn with [alpha]
+// -----------------------------------------------------------------------------
+void MapRenderer2D::updateThingsVBO(float alpha)
+{
+	log::info(3, "Updating things VBO");
+
+	// Setup builder, thing drawing functions will add quads to it rather than
+	// drawing them
+	ThingBatchBuilder builder;
+	builder.atlas      = &thing_atlas_;
+	thing_batch_build_ = &builder;
+	thing_vbo_zoom_    = false;
+
+	// Refresh sprites list if needed
+	if (thing_sprites_.size() != map_->nThings())
+		thing_sprites_.assign(map_->nThings(), 0);
+
+	// Thing shadows
+	bool square = thing_drawtype == ThingDrawType::Square || thing_drawtype == ThingDrawType::SquareSprite
+				  || thing_drawtype == ThingDrawType::FramedSprite;
+	if (thing_shadow > 0.01f && thing_drawtype != ThingDrawType::Sprite)
+	{
+		auto tex_shadow = mapeditor::textureManager().editorImage(square ? "thing/square/shadow" : "thing/shadow").gl_id;
+		if (tex_shadow)
+		{
+			builder.pass = ThingVBOPass::Shadows;
+			setThingColour(0.0f, 0.0f, 0.0f, alpha * thing_shadow);
+			for (unsigned a = 0; a < map_->nThings(); a++)
+			{
+				// No shadow if filtered
+				auto thing = map_->thing(a);
+				if (thing->isFiltered())
+					continue;
+
+				auto&  tt     = game::configuration().thingType(thing->type());
+				double radius = (tt.radius() + 1);
+				if (tt.shrinkOnZoom())
+					radius = scaledRadius(radius);
+				radius *= 1.3;
+				drawThingQuad(
+					tex_shadow,
+					thing->xPos() - radius,
+					thing->yPos() - radius,
+					thing->xPos() + radius,
+					thing->yPos() + radius);
+			}
+		}
+	}
+
+	// Things
+	vector<unsigned> things_arrows;
+	long             last_update = thing_sprites_updated_;
+	builder.pass                 = ThingVBOPass::Things;
+	for (unsigned a = 0; a < map_->nThings(); a++)
+	{
+		auto   thing  = map_->thing(a);
+		auto&  tt     = game::configuration().thingType(thing->type());
+		double x      = thing->xPos();
+		double y      = thing->yPos();
+		double angle  = thing->angle();
+		float  talpha = thing->isFiltered() ? alpha * 0.25f : alpha;
+		builder.thing = a;
+
+		if (tt.shrinkOnZoom())
+			thing_vbo_zoom_ = true;
+
+		// Reset thing sprite if modified
+		if (thing->modifiedTime() > last_update)
+			thing_sprites_[a] = 0;
+
+		// Add thing depending on 'things_drawtype' cvar
+		if (thing_drawtype == ThingDrawType::Sprite)
+		{
+			if (renderSpriteThing(x, y, angle, tt, thing->args(), a, talpha))
+				things_arrows.push_back(a);
+		}
+		else if (thing_drawtype == ThingDrawType::Round)
+			renderRoundThing(x, y, angle, tt, thing->args(), talpha);
+		else if (renderSquareThing(
+					 x,
+					 y,
+					 angle,
+					 tt,
+					 thing->args(),
+					 talpha,
+					 (thing_drawtype < ThingDrawType::SquareSprite),
+					 (thing_drawtype == ThingDrawType::FramedSprite)))
+			things_arrows.push_back(a);
+	}
+
+	// Thing sprites within squares if that drawtype is set
+	if (thing_drawtype > ThingDrawType::Sprite)
+	{
+		builder.pass = ThingVBOPass::SquareSprites;
+		for (unsigned a = 0; a < map_->nThings(); a++)
+		{
+			auto  thing = map_->thing(a);
+			auto& tt    = game::configuration().thingType(thing->type());
+			if (thing_drawtype == ThingDrawType::SquareSprite && tt.sprite().empty())
+				continue;
+
+			builder.thing = a;
+			renderSpriteThing(
+				thing->xPos(),
+				thing->yPos(),
+				thing->angle(),
+				tt,
+				thing->args(),
+				a,
+				thing->isFiltered() ? alpha * 0.25f : alpha,
+				true);
+		}
+	}
+
+	// Thing direction arrows
+	auto tex_arrow = mapeditor::textureManager().editorImage("arrow").gl_id;
+	if (tex_arrow && !things_arrows.empty())
+	{
+		builder.pass = ThingVBOPass::Arrows;
+		setThingColour(1.0f, 1.0f, 1.0f, alpha * arrow_alpha);
+		for (auto index : things_arrows)
+		{
+			auto thing = map_->thing(index);
+			if (arrow_colour)
+			{
+				auto& tt = game::configuration().thingType(thing->type());
+				if (tt.defined())
+					setThingColour(tt.colour().fr(), tt.colour().fg(), tt.colour().fb(), alpha * arrow_alpha);
+			}
+
+			auto x = thing->xPos();
+			auto y = thing->yPos();
+			drawThingQuad(tex_arrow, x - 32, y - 32, x + 32, y + 32, 0, thing->angle());
+		}
+	}
+
+	thing_batch_build_ = nullptr;
+
+	// Upload any textures added to the atlas
+	thing_atlas_.updatePages();
+
+	// Put quads together, in pass then texture order
+	vector<ThingVBOVert> verts;
+	thing_batches_.clear();
+	for (auto& [key, quads] : builder.quads)
+	{
+		ThingBatch batch;
+		batch.texture = key.second;
+		batch.first   = verts.size();
+		batch.count   = quads.size();
+		thing_batches_.push_back(batch);
+		verts.insert(verts.end(), quads.begin(), quads.end());
+	}
+	thing_batch_fallback_ = std::move(builder.fallback);
+	std::sort(thing_batch_fallback_.begin(), thing_batch_fallback_.end());
+	thing_batch_fallback_.erase(
+		std::unique(thing_batch_fallback_.begin(), thing_batch_fallback_.end()), thing_batch_fallback_.end());
+
+	// Create VBO if needed
+	if (vbo_things_ == 0)
+		glGenBuffers(1, &vbo_things_);
+
+	// Write to VBO
+	glBindBuffer(GL_ARRAY_BUFFER, vbo_things_);
+	glBufferData(GL_ARRAY_BUFFER, sizeof(ThingVBOVert) * verts.size(), verts.data(), GL_STATIC_DRAW);
+
+	// Clean up
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	n_things_           = map_->nThings();
+	things_updated_     = app::runTimer();
+	vbo_things_changes_ = map_->things().changeCount();
+	thing_vbo_state_    = thingVBOState(alpha);
+}
+
+// -----------------------------------------------------------------------------
+// Returns the current settings that affect the things VBO, for things drawn
+// with [alpha]
+// -----------------------------------------------------------------------------
+MapRenderer2D::ThingVBOState MapRenderer2D::thingVBOState(float alpha) const
+{
+	ThingVBOState state;
+	state.alpha        = alpha;
+	state.angles       = things_angles_;
+	state.drawtype     = thing_drawtype;
+	state.shadow       = thing_shadow;
+	state.force_dir    = thing_force_dir;
+	state.zeth_icons   = use_zeth_icons;
+	state.arrow_colour = arrow_colour;
+	state.arrow_alpha  = arrow_alpha;
+
+	// Things that shrink on zoom only change size when zoomed in past 1:1
+	if (thing_vbo_zoom_)
+		state.zoom_scale = std::max(view_scale_, 1.0);
+
+	return state;
 }
 
 // -----------------------------------------------------------------------------
@@ -3220,6 +3652,14 @@ void MapRenderer2D::forceUpdate(float line_alpha)
 	thing_sprites_.clear();
 	thing_paths_.clear();
 
+	// Clear the things VBO and atlas, the textures used may have changed
+	thing_atlas_.clear();
+	if (vbo_things_ > 0)
+	{
+		glDeleteBuffers(1, &vbo_things_);
+		vbo_things_ = 0;
+	}
+
 	if (gl::vboSupport())
 	{
 		updateVerticesVBO();
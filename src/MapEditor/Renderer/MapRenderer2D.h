@@ -1,6 +1,7 @@
 #pragma once
 
 #include "MapEditor/MapEditor.h"
+#include "OpenGL/TextureAtlas.h"
 #include "SLADEMap/MapObject/MapObject.h"
 #include "Utility/Colour.h"
 
@@ -90,6 +91,7 @@ public:
 		bool                     framed   = false) const;
 	void renderThings(float alpha = 1.0f, bool force_dir = false);
 	void renderThingsImmediate(float alpha);
+	void renderThingsVBO(float alpha);
 	void renderThingHilight(int index, float fade) const;
 	void renderThingSelection(const ItemSelection& selection, float fade = 1.0f) const;
 	void renderTaggedThings(vector<MapThing*>& things, float fade) const;
@@ -119,8 +121,12 @@ public:
 
 	// VBOs
 	void updateVerticesVBO();
+	bool patchVerticesVBO();
 	void updateLinesVBO(bool show_direction, float base_alpha);
+	bool patchLinesVBO();
 	void updateFlatsVBO();
+	bool patchFlatsVBO();
+	void updateThingsVBO(float alpha);
 
 	// Misc
 	void setScale(double scale)
@@ -140,11 +146,22 @@ private:
 	long vertices_updated_ = 0;
 	long lines_updated_    = 0;
 	long flats_updated_    = 0;
+	long things_updated_   = 0;
 
 	// VBOs etc
 	unsigned vbo_vertices_ = 0;
 	unsigned vbo_lines_    = 0;
 	unsigned vbo_flats_    = 0;
+	unsigned vbo_things_   = 0;
+
+	// Map object change counts at the last VBO update (see MapObjectList::changeCount)
+	unsigned long vbo_vertices_changes_   = 0;
+	unsigned long vbo_lines_changes_      = 0;
+	unsigned long vbo_lines_vert_changes_ = 0;
+	unsigned long vbo_lines_side_changes_ = 0;
+	unsigned long vbo_flats_changes_      = 0;
+	unsigned long vbo_things_changes_     = 0;
+	float         vbo_lines_alpha_        = 1.f;
 
 	// Display lists
 	unsigned list_vertices_ = 0;
@@ -175,6 +192,47 @@ private:
 		GLVert v1, v2;   // The line itself
 		GLVert dv1, dv2; // Direction tab
 	};
+	struct FlatVBOSpan
+	{
+		unsigned offset = 0; // Byte offset in the flats VBO
+		unsigned index  = 0; // First vertex index
+		unsigned size   = 0; // Size in bytes
+	};
+	struct ThingVBOVert
+	{
+		float x, y;
+		float u, v;
+		float r, g, b, a;
+	};
+	struct ThingBatch
+	{
+		unsigned texture = 0;
+		unsigned first   = 0; // First vertex index in the things VBO
+		unsigned count   = 0; // Number of vertices
+	};
+	struct ThingBatchBuilder;
+
+	// Settings the things VBO was built with, it needs a rebuild if any change
+	struct ThingVBOState
+	{
+		float  alpha        = 0.f;
+		bool   angles       = false;
+		int    drawtype     = -1;
+		double shadow       = 0.;
+		bool   force_dir    = false;
+		bool   zeth_icons   = false;
+		bool   arrow_colour = false;
+		double arrow_alpha  = 0.;
+		double zoom_scale   = 0.; // View scale, if any things shrink on zoom
+
+		bool operator==(const ThingVBOState& other) const
+		{
+			return alpha == other.alpha && angles == other.angles && drawtype == other.drawtype
+				   && shadow == other.shadow && force_dir == other.force_dir && zeth_icons == other.zeth_icons
+				   && arrow_colour == other.arrow_colour && arrow_alpha == other.arrow_alpha
+				   && zoom_scale == other.zoom_scale;
+		}
+	};
 
 	// Other
 	bool     lines_dirs_     = false;
@@ -190,6 +248,17 @@ private:
 	vector<unsigned> thing_sprites_;
 	long             thing_sprites_updated_ = 0;
 
+	// Location of each sector's polygon data in the flats VBO
+	vector<FlatVBOSpan> flat_vbo_spans_;
+
+	// Things VBO batches, one per texture (atlas page) per pass
+	vector<ThingBatch> thing_batches_;
+	vector<unsigned>   thing_batch_fallback_; // Things that can't be batched, drawn in immediate mode
+	ThingVBOState      thing_vbo_state_;
+	bool               thing_vbo_zoom_    = false;   // True if any things in the VBO shrink on zoom
+	ThingBatchBuilder* thing_batch_build_ = nullptr; // Set while building the things VBO
+	gl::TextureAtlas   thing_atlas_;
+
 	// Thing paths
 	enum class PathType
 	{
@@ -206,5 +275,12 @@ private:
 	};
 	vector<ThingPath> thing_paths_;
 	long              thing_paths_updated_ = 0;
+
+	void setLineVBOVerts(MapLine* line, GLVert* verts, bool show_direction, float base_alpha) const;
+	void setThingColour(float r, float g, float b, float a) const;
+	void setThingTypeColour(const game::ThingType& type, const MapObject::ArgSet& args, float alpha) const;
+	void drawThingQuad(unsigned tex, double x1, double y1, double x2, double y2, int tc_start = 0, double angle = 0.)
+		const;
+	ThingVBOState thingVBOState(float alpha) const;
 };
 } // namespace slade
@@ -72,6 +72,8 @@ CVAR(Bool, mlook_invert_y, false, CVar::Flag::Save)
 CVAR(Float, camera_3d_sensitivity_x, 1.0f, CVar::Flag::Save)
 CVAR(Float, camera_3d_sensitivity_y, 1.0f, CVar::Flag::Save)
 CVAR(Int, render_fov, 90, CVar::Flag::Save)
+CVAR(Bool, render_3d_portal_vis, true, CVar::Flag::Save)
+CVAR(Bool, render_3d_portal_closed, false, CVar::Flag::Save)
 
 
 // -----------------------------------------------------------------------------
@@ -93,7 +95,7 @@ EXTERN_CVAR(Bool, use_zeth_icons)
 // -----------------------------------------------------------------------------
 // MapRenderer3D class constructor
 // -----------------------------------------------------------------------------
-MapRenderer3D::MapRenderer3D(SLADEMap* map) : map_{ map }
+MapRenderer3D::MapRenderer3D(SLADEMap* map) : map_{ map }, portal_vis_{ map }
 {
 	// Build skybox circle
 	buildSkyCircle();
@@ -147,6 +149,7 @@ void MapRenderer3D::refresh()
 {
 	// Clear any existing map data
 	dist_sectors_.clear();
+	portal_vis_.invalidate();
 	if (quads_)
 	{
 		delete[] quads_;
@@ -474,6 +477,7 @@ void MapRenderer3D::setupView(int width, int height)
 	// Calculate aspect ratio
 	float aspect = (1.6f / 1.333333f) * ((float)width / (float)height);
 	float fovy   = 2 * math::radToDeg(atan(tan(math::degToRad(render_fov) / 2) / aspect));
+	fov_v_half_  = math::degToRad(fovy) * 0.5;
 
 	// Setup projection
 	glMatrixMode(GL_PROJECTION);
@@ -942,6 +946,8 @@ void MapRenderer3D::updateSector(unsigned index)
 	if (index >= map_->nSectors())
 		return;
 
+	pick_updated_.push_back(lines_.size() + index);
+
 	// Update floor
 	bool  mix_tex_flats      = game::configuration().featureSupported(game::Feature::MixTexFlats);
 	auto  sector             = map_->sector(index);
@@ -1307,6 +1313,7 @@ void MapRenderer3D::updateLine(unsigned index)
 
 	// Clear current line data
 	lines_[index].quads.clear();
+	pick_updated_.push_back(index);
 
 	// Skip invalid line
 	auto line = map_->line(index);
@@ -2127,6 +2134,8 @@ void MapRenderer3D::updateThing(unsigned index, MapThing* thing)
 	if (index >= things_.size() || !thing)
 		return;
 
+	pick_updated_.push_back(lines_.size() + floors_.size() + index);
+
 	// Setup thing info
 	things_[index].type   = &(game::configuration().thingType(thing->type()));
 	things_[index].sector = map_->sectors().atPos(thing->position());
@@ -2600,7 +2609,8 @@ void MapRenderer3D::updateWallsVBO() const {}
 
 // -----------------------------------------------------------------------------
 // Runs a quick check of all sector bounding boxes against the current view to
-// hide any that are outside it
+// hide any that are outside it. If enabled, sectors that can't be seen through
+// any portals (two-sided lines) from the camera's sector are also hidden
 // -----------------------------------------------------------------------------
 void MapRenderer3D::quickVisDiscard()
 {
@@ -2608,12 +2618,38 @@ void MapRenderer3D::quickVisDiscard()
 	if (dist_sectors_.size() != map_->nSectors())
 		dist_sectors_.resize(map_->nSectors());
 
+	// Determine sectors visible through portals
+	bool portal_vis = false;
+	if (render_3d_portal_vis)
+	{
+		// The horizontal view angle widens towards the top/bottom of the
+		// screen when looking up or down
+		auto   pitch = std::fabs(cam_pitch_);
+		double h_fov = math::degToRad(render_fov) * 0.5;
+		double denom = std::cos(pitch) - std::sin(pitch) * std::tan(fov_v_half_);
+
+		SectorVisibility::View view;
+		view.position    = cam_position_.get2d();
+		view.direction   = cam_direction_;
+		view.half_fov    = denom > 0.05 ? std::atan(std::tan(h_fov) / denom) + 0.05 : 0.;
+		view.max_dist    = render_max_dist;
+		view.stop_closed = render_3d_portal_closed;
+		portal_vis       = portal_vis_.update(view);
+	}
+
 	// Go through all sectors
 	auto   cam = cam_position_.get2d();
 	double min_dist, dist;
 	Seg2d  strafe(cam, cam + cam_strafe_.get2d());
 	for (unsigned a = 0; a < map_->nSectors(); a++)
 	{
+		// Check portal visibility
+		if (portal_vis && !portal_vis_.sectorVisible(a))
+		{
+			dist_sectors_[a] = -1.0f;
+			continue;
+		}
+
 		// Get sector bbox
 		auto bbox = map_->sector(a)->boundingBox();
 
@@ -2657,13 +2693,13 @@ void MapRenderer3D::quickVisDiscard()
 		}
 	}
 
-	// Set all lines that are part of invisible sectors to invisible
+	// Set all lines that aren't part of any visible sectors to invisible
+	for (auto& line : lines_)
+		line.visible = false;
 	for (unsigned a = 0; a < map_->nSides(); a++)
 	{
 		dist = dist_sectors_[map_->side(a)->sector()->index()];
-		if (dist < 0 || (render_max_dist > 0 && dist > render_max_dist))
-			lines_[map_->side(a)->parentLine()->index()].visible = false;
-		else
+		if (dist >= 0 && (render_max_dist <= 0 || dist <= render_max_dist))
 			lines_[map_->side(a)->parentLine()->index()].visible = true;
 	}
 }
@@ -2830,46 +2866,127 @@ void MapRenderer3D::checkVisibleFlats()
 }
 
 // -----------------------------------------------------------------------------
-// Finds the closest wall/flat/thing to the camera along the view vector
+// Returns the bounding box of picking primitive [index] (see pickHitTest),
+// from its current cached rendering data
 // -----------------------------------------------------------------------------
-mapeditor::Item MapRenderer3D::determineHilight()
+BVH::Box MapRenderer3D::pickBox(unsigned index) const
 {
-	// Init
-	double          min_dist = 9999999;
-	mapeditor::Item current;
-	Seg2d           strafe(cam_position_.get2d(), (cam_position_ + cam_strafe_).get2d());
+	BVH::Box box;
 
-	// Check for required map structures
-	if (!map_ || lines_.size() != map_->nLines() || floors_.size() != map_->nSectors()
-		|| things_.size() != map_->nThings())
-		return current;
+	// Line, bounds of all its quads
+	if (index < pick_n_lines_)
+	{
+		for (auto& quad : lines_[index].quads)
+			for (auto& point : quad.points)
+				box.extend(Vec3d(point.x, point.y, point.z));
+
+		return box;
+	}
+
+	// Sector, bounds of the floor and ceiling planes across the sector
+	index -= pick_n_lines_;
+	if (index < pick_n_sectors_)
+	{
+		auto sector = floors_[index].sector;
+		if (!sector)
+			return box;
+
+		auto bbox = sector->boundingBox();
+		for (auto& corner : { bbox.min, bbox.max, Vec2d(bbox.min.x, bbox.max.y), Vec2d(bbox.max.x, bbox.min.y) })
+		{
+			box.extend(Vec3d(corner, floors_[index].plane.heightAt(corner)));
+			box.extend(Vec3d(corner, ceilings_[index].plane.heightAt(corner)));
+		}
 
-	// Check lines
-	double height, dist;
-	for (unsigned a = 0; a < map_->nLines(); a++)
+		return box;
+	}
+
+	// Thing, a box around its sprite at any angle
+	index -= pick_n_sectors_;
+	if (index < pick_n_things_ && things_[index].sprite)
+	{
+		auto& tex_info  = gl::Texture::info(things_[index].sprite);
+		auto  halfwidth = tex_info.size.x * 0.5;
+		auto  height    = static_cast<double>(tex_info.size.y);
+		if (things_[index].flags & ICON)
+		{
+			halfwidth = render_thing_icon_size * 0.5;
+			height    = render_thing_icon_size;
+		}
+
+		auto pos = map_->thing(index)->position();
+		box.extend(Vec3d(pos.x - halfwidth, pos.y - halfwidth, things_[index].z));
+		box.extend(Vec3d(pos.x + halfwidth, pos.y + halfwidth, things_[index].z + height));
+	}
+
+	return box;
+}
+
+// -----------------------------------------------------------------------------
+// Updates the picking BVH for any changes to the cached rendering data.
+// The BVH is fully rebuilt if the number of objects changed or many of them
+// were updated, otherwise only the boxes of updated objects are recalculated
+// and the BVH is refitted to them
+// -----------------------------------------------------------------------------
+void MapRenderer3D::updatePickBVH()
+{
+	auto total = lines_.size() + floors_.size() + things_.size();
+	if (pick_n_lines_ != lines_.size() || pick_n_sectors_ != floors_.size() || pick_n_things_ != things_.size()
+		|| pick_bvh_.nPrimitives() != total || pick_updated_.size() > total / 4)
+	{
+		pick_n_lines_   = lines_.size();
+		pick_n_sectors_ = floors_.size();
+		pick_n_things_  = things_.size();
+
+		pick_boxes_.resize(total);
+		for (unsigned a = 0; a < total; a++)
+			pick_boxes_[a] = pickBox(a);
+
+		pick_bvh_.build(pick_boxes_);
+		pick_updated_.clear();
+		return;
+	}
+
+	if (pick_updated_.empty())
+		return;
+
+	for (auto index : pick_updated_)
+		if (index < total)
+			pick_boxes_[index] = pickBox(index);
+
+	pick_bvh_.refit(pick_boxes_);
+	pick_updated_.clear();
+}
+
+// -----------------------------------------------------------------------------
+// Tests picking primitive [index] against the ray from [origin] along [dir].
+// Returns the distance along the ray to the hit (setting [item] to the part
+// hit), or a negative value if it wasn't hit
+// -----------------------------------------------------------------------------
+double MapRenderer3D::pickHitTest(unsigned index, const Vec3d& origin, const Vec3d& dir, mapeditor::Item& item) const
+{
+	// Line
+	if (index < pick_n_lines_)
 	{
 		// Ignore if not visible
-		if (!lines_[a].visible)
-			continue;
+		if (!lines_[index].visible)
+			return -1.;
 
-		auto line = map_->line(a);
+		auto line = map_->line(index);
 
 		// Find (2d) distance to line
-		dist = math::distanceRayLine(
-			cam_position_.get2d(), (cam_position_ + cam_dir3d_).get2d(), line->start(), line->end());
-
-		// Ignore if no intersection or something was closer
-		if (dist < 0 || dist >= min_dist)
-			continue;
+		auto dist = math::distanceRayLine(origin.get2d(), (origin + dir).get2d(), line->start(), line->end());
+		if (dist < 0)
+			return -1.;
 
 		// Find quad intersect if any
-		auto intersection = cam_position_ + cam_dir3d_ * dist;
-		for (auto& quad : lines_[a].quads)
+		auto intersection = origin + dir * dist;
+		bool hit          = false;
+		for (auto& quad : lines_[index].quads)
 		{
 			// Check side of camera
 			if (math::lineSide(
-					cam_position_.get2d(),
-					Seg2d(quad.points[0].x, quad.points[0].y, quad.points[2].x, quad.points[2].y))
+					origin.get2d(), Seg2d(quad.points[0].x, quad.points[0].y, quad.points[2].x, quad.points[2].y))
 				< 0)
 				continue;
 
@@ -2888,123 +3005,171 @@ mapeditor::Item MapRenderer3D::determineHilight()
 
 				// Side index
 				if (quad.flags & BACK)
-					current.index = line->s2Index();
+					item.index = line->s2Index();
 				else
-					current.index = line->s1Index();
+					item.index = line->s1Index();
 
 				// Side part
 				if (quad.flags & UPPER)
-					current.type = mapeditor::ItemType::WallTop;
+					item.type = mapeditor::ItemType::WallTop;
 				else if (quad.flags & LOWER)
-					current.type = mapeditor::ItemType::WallBottom;
+					item.type = mapeditor::ItemType::WallBottom;
 				else
-					current.type = mapeditor::ItemType::WallMiddle;
+					item.type = mapeditor::ItemType::WallMiddle;
 
-				min_dist = dist;
+				hit = true;
 			}
 		}
+
+		return hit ? dist : -1.;
 	}
 
-	// Check sectors
-	for (unsigned a = 0; a < map_->nSectors(); a++)
+	// Sector
+	index -= pick_n_lines_;
+	if (index < pick_n_sectors_)
 	{
 		// Ignore if not visible
-		if (dist_sectors_[a] < 0)
-			continue;
+		if (index >= dist_sectors_.size() || dist_sectors_[index] < 0)
+			return -1.;
+
+		auto sector   = map_->sector(index);
+		auto min_dist = -1.;
 
 		// Check distance to floor plane
-		dist = math::distanceRayPlane(cam_position_, cam_dir3d_, floors_[a].plane);
-		if (dist >= 0 && dist < min_dist)
+		auto dist = math::distanceRayPlane(origin, dir, floors_[index].plane);
+		if (dist >= 0)
 		{
-			// Check if on the correct side of the plane
-			if (cam_position_.z > floors_[a].plane.heightAt(cam_position_.x, cam_position_.y))
+			// Check if on the correct side of the plane and the intersection
+			// is within the sector
+			if (origin.z > floors_[index].plane.heightAt(origin.x, origin.y)
+				&& sector->containsPoint((origin + dir * dist).get2d()))
 			{
-				// Check if intersection is within sector
-				if (map_->sector(a)->containsPoint((cam_position_ + cam_dir3d_ * dist).get2d()))
-				{
-					current.index = a;
-					current.type  = mapeditor::ItemType::Floor;
-					min_dist      = dist;
-				}
+				item.index = index;
+				item.type  = mapeditor::ItemType::Floor;
+				min_dist   = dist;
 			}
 		}
 
 		// Check distance to ceiling plane
-		dist = math::distanceRayPlane(cam_position_, cam_dir3d_, ceilings_[a].plane);
-		if (dist >= 0 && dist < min_dist)
+		dist = math::distanceRayPlane(origin, dir, ceilings_[index].plane);
+		if (dist >= 0 && (min_dist < 0 || dist < min_dist))
 		{
-			// Check if on the correct side of the plane
-			if (cam_position_.z < ceilings_[a].plane.heightAt(cam_position_.x, cam_position_.y))
+			if (origin.z < ceilings_[index].plane.heightAt(origin.x, origin.y)
+				&& sector->containsPoint((origin + dir * dist).get2d()))
 			{
-				// Check if intersection is within sector
-				if (map_->sector(a)->containsPoint((cam_position_ + cam_dir3d_ * dist).get2d()))
-				{
-					current.index = a;
-					current.type  = mapeditor::ItemType::Ceiling;
-					min_dist      = dist;
-				}
+				item.index = index;
+				item.type  = mapeditor::ItemType::Ceiling;
+				min_dist   = dist;
 			}
 		}
+
+		return min_dist;
 	}
 
-	// Update item distance
-	if (min_dist >= 9999999 || min_dist < 0)
-		item_dist_ = -1;
-	else
-		item_dist_ = math::round(min_dist);
+	// Thing (if visible)
+	index -= pick_n_sectors_;
+	if (index >= pick_n_things_ || render_3d_things == 0)
+		return -1.;
 
-	// Check things (if visible)
-	if (render_3d_things == 0)
-		return current;
-	double halfwidth, theight;
-	for (unsigned a = 0; a < map_->nThings(); a++)
-	{
-		// Ignore if no sprite
-		if (!things_[a].sprite)
-			continue;
+	// Ignore if no sprite
+	if (!things_[index].sprite)
+		return -1.;
+
+	// Ignore if not visible
+	auto  thing = map_->thing(index);
+	Seg2d strafe(origin.get2d(), (origin + cam_strafe_).get2d());
+	if (math::lineSide(thing->position(), strafe) > 0)
+		return -1.;
+
+	// Ignore if not shown
+	if (!things_[index].type->decoration() && render_3d_things == 2)
+		return -1.;
+
+	// Find distance to thing sprite
+	auto& tex_info  = gl::Texture::info(things_[index].sprite);
+	auto  halfwidth = tex_info.size.x * 0.5;
+	if (things_[index].flags & ICON)
+		halfwidth = render_thing_icon_size * 0.5;
+	auto dist = math::distanceRayLine(
+		origin.get2d(),
+		(origin + dir).get2d(),
+		thing->position() - cam_strafe_.get2d() * halfwidth,
+		thing->position() + cam_strafe_.get2d() * halfwidth);
+	if (dist < 0)
+		return -1.;
+
+	// Check intersection height
+	double theight = tex_info.size.y;
+	double height  = origin.z + dir.z * dist;
+	if (things_[index].flags & ICON)
+		theight = render_thing_icon_size;
+	if (height >= things_[index].z && height <= things_[index].z + theight)
+	{
+		item.index = index;
+		item.type  = mapeditor::ItemType::Thing;
+		return dist;
+	}
+
+	return -1.;
+}
 
-		// Ignore if not visible
-		auto thing = map_->thing(a);
-		if (math::lineSide(thing->position(), strafe) > 0)
-			continue;
+// -----------------------------------------------------------------------------
+// Finds the closest wall/flat/thing hit by the ray from [origin] along [dir]
+// (which should be normalized). If [hit_dist] is given, it is set to the
+// distance along the ray to the item hit, or -1 if nothing was hit
+// -----------------------------------------------------------------------------
+mapeditor::Item MapRenderer3D::pickItem(const Vec3d& origin, const Vec3d& dir, double* hit_dist)
+{
+	mapeditor::Item current;
+	if (hit_dist)
+		*hit_dist = -1.;
 
-		// Ignore if not shown
-		if (!things_[a].type->decoration() && render_3d_things == 2)
-			continue;
+	// Check for required map structures
+	if (!map_ || lines_.size() != map_->nLines() || floors_.size() != map_->nSectors()
+		|| things_.size() != map_->nThings())
+		return current;
 
-		// Find distance to thing sprite
-		auto& tex_info = gl::Texture::info(things_[a].sprite);
-		halfwidth      = tex_info.size.x * 0.5;
-		if (things_[a].flags & ICON)
-			halfwidth = render_thing_icon_size * 0.5;
-		dist = math::distanceRayLine(
-			cam_position_.get2d(),
-			(cam_position_ + cam_dir3d_).get2d(),
-			thing->position() - cam_strafe_.get2d() * halfwidth,
-			thing->position() + cam_strafe_.get2d() * halfwidth);
-
-		// Ignore if no intersection or something was closer
-		if (dist < 0 || dist >= min_dist)
-			continue;
+	// Update BVH if needed
+	updatePickBVH();
 
-		// Check intersection height
-		theight = tex_info.size.y;
-		height  = cam_position_.z + cam_dir3d_.z * dist;
-		if (things_[a].flags & ICON)
-			theight = render_thing_icon_size;
-		if (height >= things_[a].z && height <= things_[a].z + theight)
+	// Find nearest hit
+	mapeditor::Item hit_item;
+	auto            min_dist = 9999999.;
+	auto            hit_test = [&](unsigned prim) {
+		mapeditor::Item item;
+		auto            dist = pickHitTest(prim, origin, dir, item);
+		if (dist >= 0 && dist < min_dist)
 		{
-			current.index = a;
-			current.type  = mapeditor::ItemType::Thing;
-			min_dist      = dist;
+			min_dist = dist;
+			hit_item = item;
 		}
-	}
+		return dist;
+	};
+	int  index;
+	auto dist = pick_bvh_.nearestHit(origin, dir, hit_test, index, min_dist);
+
+	if (index < 0 || dist < 0)
+		return current;
+
+	if (hit_dist)
+		*hit_dist = dist;
+
+	return hit_item;
+}
+
+// -----------------------------------------------------------------------------
+// Finds the closest wall/flat/thing to the camera along the view vector
+// -----------------------------------------------------------------------------
+mapeditor::Item MapRenderer3D::determineHilight()
+{
+	double dist;
+	auto   current = pickItem(cam_position_, cam_dir3d_, &dist);
 
 	// Update item distance
-	if (min_dist >= 9999999 || min_dist < 0)
+	if (dist < 0)
 		item_dist_ = -1;
 	else
-		item_dist_ = math::round(min_dist);
+		item_dist_ = math::round(dist);
 
 	return current;
 }
@@ -2,6 +2,8 @@
 
 #include "MapEditor/Edit/Edit3D.h"
 #include "SLADEMap/SLADEMap.h"
+#include "SectorVisibility.h"
+#include "Utility/BVH.h"
 
 namespace slade
 {
@@ -122,6 +124,7 @@ public:
 	double camPitch() const { return cam_pitch_; }
 	Vec3d  camPosition() const { return cam_position_; }
 	Vec2d  camDirection() const { return cam_direction_; }
+	Vec3d  camDirection3d() const { return cam_dir3d_; }
 
 	// -- Rendering --
 	void setupView(int width, int height);
@@ -180,6 +183,7 @@ public:
 	void  checkVisibleFlats();
 
 	// Hilight
+	mapeditor::Item pickItem(const Vec3d& origin, const Vec3d& dir, double* hit_dist = nullptr);
 	mapeditor::Item determineHilight();
 	void            renderHilight(mapeditor::Item hilight, float alpha = 1.0f);
 
@@ -196,7 +200,16 @@ private:
 	float     fog_depth_last_ = 0.f;
 
 	// Visibility
-	vector<float> dist_sectors_;
+	vector<float>    dist_sectors_;
+	SectorVisibility portal_vis_;
+
+	// Picking (primitives are lines, then sectors, then things)
+	BVH              pick_bvh_;
+	vector<BVH::Box> pick_boxes_;
+	vector<unsigned> pick_updated_; // Primitives updated since the BVH was last refitted
+	unsigned         pick_n_lines_   = 0;
+	unsigned         pick_n_sectors_ = 0;
+	unsigned         pick_n_things_  = 0;
 
 	// Camera
 	Vec3d  cam_position_;
@@ -205,8 +218,9 @@ private:
 	double cam_angle_ = 0.;
 	Vec3d  cam_dir3d_;
 	Vec3d  cam_strafe_;
-	double gravity_   = 0.5;
-	int    item_dist_ = 0;
+	double gravity_    = 0.5;
+	int    item_dist_  = 0;
+	double fov_v_half_ = 0.; // Vertical half field of view (radians), set in setupView
 
 	// Map Structures
 	vector<Line>  lines_;
@@ -238,5 +252,9 @@ private:
 	// Signal connections
 	sigslot::scoped_connection sc_resources_updated_;
 	sigslot::scoped_connection sc_palette_changed_;
+
+	BVH::Box pickBox(unsigned index) const;
+	void     updatePickBVH();
+	double   pickHitTest(unsigned index, const Vec3d& origin, const Vec3d& dir, mapeditor::Item& item) const;
 };
 } // namespace slade
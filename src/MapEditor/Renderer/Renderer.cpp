@@ -356,25 +356,19 @@ void Renderer::drawGrid() const
 	// Draw regular grid if it's not too small
 	if (gridsize > grid_hidelevel)
 	{
+		drawing::beginBatch();
+
 		// Vertical
 		int ofs = start_x % gridsize;
 		for (int x = start_x - ofs; x <= end_x; x += gridsize)
-		{
-			glBegin(GL_LINES);
-			glVertex2d(x, start_y);
-			glVertex2d(x, end_y);
-			glEnd();
-		}
+			drawing::drawLine(x, start_y, x, end_y);
 
 		// Horizontal
 		ofs = start_y % gridsize;
 		for (int y = start_y - ofs; y <= end_y; y += gridsize)
-		{
-			glBegin(GL_LINES);
-			glVertex2d(start_x, y);
-			glVertex2d(end_x, y);
-			glEnd();
-		}
+			drawing::drawLine(start_x, y, end_x, y);
+
+		drawing::endBatch();
 	}
 
 	// Draw origin grid lines
@@ -406,60 +400,51 @@ void Renderer::drawGrid() const
 			cross_size = gridsize;
 
 		colourconfig::setGLColour("map_64grid");
+		drawing::beginBatch();
 
 		// Vertical
 		int ofs = start_x % 64;
 		for (int x = start_x - ofs; x <= end_x; x += 64)
 		{
-			glBegin(GL_LINES);
-
 			if (grid_64_style > 1)
 			{
 				// Cross style
 				int y = start_y - (start_y % 64);
 				while (y < end_y)
 				{
-					glVertex2d(x, y - cross_size);
-					glVertex2d(x, y + cross_size);
+					drawing::drawLine(x, y - cross_size, x, y + cross_size);
 					y += 64;
 				}
 			}
 			else
 			{
 				// Full style
-				glVertex2d(x, start_y);
-				glVertex2d(x, end_y);
+				drawing::drawLine(x, start_y, x, end_y);
 			}
-
-			glEnd();
 		}
 
 		// Horizontal
 		ofs = start_y % 64;
 		for (int y = start_y - ofs; y <= end_y; y += 64)
 		{
-			glBegin(GL_LINES);
-
 			if (grid_64_style > 1)
 			{
 				// Cross style
 				int x = start_x - (start_x % 64);
 				while (x < end_x)
 				{
-					glVertex2d(x - cross_size, y);
-					glVertex2d(x + cross_size, y);
+					drawing::drawLine(x - cross_size, y, x + cross_size, y);
 					x += 64;
 				}
 			}
 			else
 			{
 				// Full style
-				glVertex2d(start_x, y);
-				glVertex2d(end_x, y);
+				drawing::drawLine(start_x, y, end_x, y);
 			}
-
-			glEnd();
 		}
+
+		drawing::endBatch();
 	}
 
 	glDisable(GL_LINE_STIPPLE);
@@ -1222,6 +1207,8 @@ void Renderer::drawMap3d()
 // -----------------------------------------------------------------------------
 void Renderer::draw()
 {
+	drawing::beginFrame();
+
 	// Setup the viewport
 	glViewport(0, 0, view_.size().x, view_.size().y);
 
@@ -1319,21 +1306,17 @@ void Renderer::draw()
 	}
 
 	// FPS counter
-	/*if (map_showfps)
+	if (map_showfps)
 	{
+		auto& stats = drawing::frameStats();
 		glEnable(GL_TEXTURE_2D);
-		if (frametime_last > 0)
-		{
-			int fps = MathStuff::round(1.0 / (frametime_last / 1000.0));
-			fps_avg.push_back(fps);
-			if (fps_avg.size() > 20) fps_avg.erase(fps_avg.begin());
-		}
-		int afps = 0;
-		for (unsigned a = 0; a < fps_avg.size(); a++)
-			afps += fps_avg[a];
-		if (fps_avg.size() > 0) afps /= fps_avg.size();
-		Drawing::drawText(fmt::format("FPS: {}", afps));
-	}*/
+		drawing::drawText(fmt::format(
+			"FPS: {:.0f} ({:.2f}ms) - {} draw calls ({} batched)",
+			stats.fps(),
+			stats.frame_time,
+			stats.draw_calls,
+			stats.batched_calls));
+	}
 
 	// test
 	// Drawing::drawText(fmt::format("Render distance: {:1.2f}", (double)render_max_dist), 0, 100);
@@ -1343,6 +1326,8 @@ void Renderer::draw()
 
 	// Help text
 	drawFeatureHelpText();
+
+	drawing::endFrame();
 }
 
 namespace
@@ -0,0 +1,427 @@
+
+// -----------------------------------------------------------------------------
+// SLADE - It's a Doom Editor
+// Copyright(C) 2008 - 2020 Simon Judd
+//
+// Email:       sirjuddington@gmail.com
+// Web:         http://slade.mancubus.net
+// Filename:    SectorVisibility.cpp
+// Description: SectorVisibility class - determines which sectors are visible
+//              from the 3d mode camera by walking from the camera's sector
+//              through two-sided lines (portals), narrowing the view through
+//              each opening
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301, USA.
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+//
+// Includes
+//
+// -----------------------------------------------------------------------------
+#include "Main.h"
+#include "SectorVisibility.h"
+#include "App.h"
+#include "SLADEMap/SLADEMap.h"
+#include "Utility/MathStuff.h"
+
+using namespace slade;
+
+
+// -----------------------------------------------------------------------------
+//
+// Variables
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// Portals closer than this to the camera are passed through without narrowing
+// the view, since the camera is more or less within the opening
+constexpr double PORTAL_NEAR_DIST = 1.;
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// -----------------------------------------------------------------------------
+// Clips the segment [a]->[b] to the side of a line where [fa] and [fb] (the
+// signed distances of [a] and [b] from the line) are positive.
+// Returns false if the segment is entirely on the negative side
+// -----------------------------------------------------------------------------
+bool clipSegToSide(Vec2d& a, Vec2d& b, double fa, double fb)
+{
+	if (fa < 0 && fb < 0)
+		return false;
+
+	if (fa < 0)
+		a = a + (b - a) * (fa / (fa - fb));
+	else if (fb < 0)
+		b = b + (a - b) * (fb / (fb - fa));
+
+	return true;
+}
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// SectorVisibility Class Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Determines which sectors are visible from [view].
+// Returns false if visibility couldn't be determined (eg. the camera is
+// outside the map), in which case all sectors should be considered visible
+// -----------------------------------------------------------------------------
+bool SectorVisibility::update(const View& view)
+{
+	if (!map_ || map_->nSectors() == 0)
+	{
+		valid_ = false;
+		return false;
+	}
+
+	// Rebuild portals if the map geometry has changed
+	bool rebuilt = false;
+	if (portalsOutdated())
+	{
+		buildPortals();
+		rebuilt = true;
+	}
+
+	// Check if the camera is still in the same sector
+	auto cam_sector = findCameraSector(view.position);
+
+	// Nothing to do if nothing has changed since the last update
+	if (!rebuilt && vis_time_ >= 0 && cam_sector == cam_sector_ && view == last_view_ && !closedSectorsModified())
+		return valid_;
+
+	cam_sector_ = cam_sector;
+	last_view_  = view;
+	vis_time_   = app::runTimer();
+	closed_sectors_.clear();
+
+	// Can't do anything if the camera isn't within a sector
+	if (cam_sector_ < 0)
+	{
+		valid_ = false;
+		return false;
+	}
+
+	// Reset (only what was touched by the last update, if possible)
+	if (visible_.size() != map_->nSectors())
+	{
+		visible_.assign(map_->nSectors(), 0);
+		entries_.clear();
+		entries_.resize(map_->nSectors());
+	}
+	else
+	{
+		for (auto index : visible_list_)
+		{
+			visible_[index] = 0;
+			entries_[index].clear();
+		}
+	}
+	visible_list_.clear();
+	steps_     = 0;
+	max_steps_ = std::max<unsigned>(50000, map_->nLines() * 16);
+
+	// Setup initial window from the view direction
+	Window window;
+	if (view.half_fov <= 0 || view.half_fov >= math::PI * 0.5 - 0.01)
+		window.full = true;
+	else
+	{
+		auto  c      = std::cos(view.half_fov);
+		auto  s      = std::sin(view.half_fov);
+		auto& d      = view.direction;
+		window.left  = { d.x * c - d.y * s, d.x * s + d.y * c };
+		window.right = { d.x * c + d.y * s, -d.x * s + d.y * c };
+	}
+
+	// Walk portals from the camera sector
+	valid_ = walk(cam_sector_, window);
+	if (!valid_)
+		log::warning(2, "Portal visibility check gave up after {} steps", steps_);
+
+	return valid_;
+}
+
+// -----------------------------------------------------------------------------
+// Clears all cached portal and visibility info
+// -----------------------------------------------------------------------------
+void SectorVisibility::invalidate()
+{
+	portals_.clear();
+	portals_time_ = -1;
+	visible_.clear();
+	visible_list_.clear();
+	entries_.clear();
+	closed_sectors_.clear();
+	valid_      = false;
+	cam_sector_ = -1;
+	vis_time_   = -1;
+}
+
+// -----------------------------------------------------------------------------
+// Returns true if any lines or sides have been added, removed or modified
+// since the portals were last built
+// -----------------------------------------------------------------------------
+bool SectorVisibility::portalsOutdated() const
+{
+	// Any line, side or vertex change (including adding/removing them) changes
+	// its list's change count (see MapObjectList::changeCount), so there's no
+	// need to check each object
+	return portals_time_ < 0 || map_->geometryUpdated() >= portals_time_
+		   || map_->lines().changeCount() != portals_lines_changes_
+		   || map_->sides().changeCount() != portals_sides_changes_
+		   || map_->vertices().changeCount() != portals_vertices_changes_ || map_->nSectors() != portals_sectors_;
+}
+
+// -----------------------------------------------------------------------------
+// Builds the list of portals (two-sided lines) for each sector
+// -----------------------------------------------------------------------------
+void SectorVisibility::buildPortals()
+{
+	portals_.clear();
+	portals_.resize(map_->nSectors());
+
+	for (unsigned a = 0; a < map_->nLines(); a++)
+	{
+		auto line  = map_->line(a);
+		auto front = line->frontSector();
+		auto back  = line->backSector();
+		if (!front || !back || front == back)
+			continue;
+
+		auto fi = front->index();
+		auto bi = back->index();
+		portals_[fi].push_back({ a, line->start(), line->end(), bi });
+		portals_[bi].push_back({ a, line->end(), line->start(), fi });
+	}
+
+	portals_time_             = app::runTimer();
+	portals_lines_changes_    = map_->lines().changeCount();
+	portals_sides_changes_    = map_->sides().changeCount();
+	portals_vertices_changes_ = map_->vertices().changeCount();
+	portals_sectors_          = map_->nSectors();
+	vis_time_        = -1;
+}
+
+// -----------------------------------------------------------------------------
+// Returns true if any sectors either side of a closed portal that stopped the
+// last update have been modified since (eg. a door was opened)
+// -----------------------------------------------------------------------------
+bool SectorVisibility::closedSectorsModified() const
+{
+	for (auto index : closed_sectors_)
+	{
+		auto sector = map_->sector(index);
+		if (!sector || sector->modifiedTime() >= vis_time_ || sector->geometryUpdatedTime() >= vis_time_)
+			return true;
+	}
+
+	return false;
+}
+
+// -----------------------------------------------------------------------------
+// Returns true if there is no vertical opening between [sector] and the
+// sector on the other side of [portal]
+// -----------------------------------------------------------------------------
+bool SectorVisibility::portalClosed(const Portal& portal, unsigned sector) const
+{
+	auto s1 = map_->sector(sector);
+	auto s2 = map_->sector(portal.sector);
+
+	auto opening = [s1, s2](Vec2d point) {
+		auto ceiling = std::min(s1->ceiling().plane.heightAt(point), s2->ceiling().plane.heightAt(point));
+		auto floor   = std::max(s1->floor().plane.heightAt(point), s2->floor().plane.heightAt(point));
+		return ceiling - floor;
+	};
+
+	return opening(portal.start) <= 0 && opening(portal.end) <= 0;
+}
+
+// -----------------------------------------------------------------------------
+// Returns the index of the sector containing [position], or -1 if none.
+// Checks the previous camera sector and its neighbours first since the
+// camera usually doesn't move far between updates
+// -----------------------------------------------------------------------------
+int SectorVisibility::findCameraSector(Vec2d position) const
+{
+	if (cam_sector_ >= 0 && static_cast<unsigned>(cam_sector_) < portals_.size())
+	{
+		if (map_->sector(cam_sector_)->containsPoint(position))
+			return cam_sector_;
+
+		for (auto& portal : portals_[cam_sector_])
+			if (map_->sector(portal.sector)->containsPoint(position))
+				return portal.sector;
+	}
+
+	auto sector = map_->sectors().atPos(position);
+	return sector ? static_cast<int>(sector->index()) : -1;
+}
+
+// -----------------------------------------------------------------------------
+// Returns true if [sector] was already entered through [line] (or through any
+// near portal) with a window containing [window]. If [line] is -1 only near
+// portal entries are checked
+// -----------------------------------------------------------------------------
+bool SectorVisibility::windowEntered(unsigned sector, const Window& window, int line) const
+{
+	for (auto& entry : entries_[sector])
+	{
+		if (!entry.via_near && static_cast<int>(entry.line) != line)
+			continue;
+
+		if (entry.window.full
+			|| (entry.window.right.cross(window.right) >= 0 && window.left.cross(entry.window.left) >= 0))
+			return true;
+	}
+
+	return false;
+}
+
+// -----------------------------------------------------------------------------
+// Marks all sectors visible from [start_sector] through [window] (and any
+// portals within it, recursively).
+// Returns false if the walk took too many steps and was abandoned
+// -----------------------------------------------------------------------------
+bool SectorVisibility::walk(unsigned start_sector, const Window& start_window)
+{
+	struct Step
+	{
+		unsigned sector;
+		Window   window;
+		int      from_line;
+	};
+	vector<Step> stack;
+	stack.push_back({ start_sector, start_window, -1 });
+
+	auto cam = last_view_.position;
+	while (!stack.empty())
+	{
+		auto step = stack.back();
+		stack.pop_back();
+
+		if (++steps_ > max_steps_)
+			return false;
+
+		// Mark sector visible
+		if (!visible_[step.sector])
+		{
+			visible_[step.sector] = 1;
+			visible_list_.push_back(step.sector);
+		}
+
+		auto& window = step.window;
+		for (auto& portal : portals_[step.sector])
+		{
+			// Don't go straight back through the portal we came in through
+			if (static_cast<int>(portal.line) == step.from_line)
+				continue;
+
+			// Check distance
+			Seg2d seg{ portal.start, portal.end };
+			auto  dist = math::distanceToLine(cam, seg);
+			if (last_view_.max_dist > 0 && dist > last_view_.max_dist)
+				continue;
+
+			// Check if closed
+			if (last_view_.stop_closed && portalClosed(portal, step.sector))
+			{
+				closed_sectors_.push_back(step.sector);
+				closed_sectors_.push_back(portal.sector);
+				continue;
+			}
+
+			// If the camera is (more or less) within the portal, pass through
+			// it without narrowing the view
+			if (dist <= PORTAL_NEAR_DIST)
+			{
+				Window next = window;
+				next.clip   = false;
+
+				// Skip if the sector was already entered through a near portal
+				// with a window containing this one (through any line, since
+				// the window isn't clipped to the portal). This stops the walk
+				// going round in circles between sectors around the camera
+				if (windowEntered(portal.sector, next, -1))
+					continue;
+
+				entries_[portal.sector].push_back({ portal.line, next, true });
+				stack.push_back({ portal.sector, next, static_cast<int>(portal.line) });
+				continue;
+			}
+
+			// Check the portal faces the camera
+			auto delta = portal.end - portal.start;
+			if ((cam - portal.start).cross(delta) <= 0)
+				continue;
+
+			// Clip the portal to the current window. From the camera, the start
+			// of the portal is on the left and the end on the right
+			auto left  = portal.start;
+			auto right = portal.end;
+			if (!window.full)
+			{
+				if (!clipSegToSide(left, right, window.right.cross(left - cam), window.right.cross(right - cam)))
+					continue;
+				if (!clipSegToSide(left, right, (left - cam).cross(window.left), (right - cam).cross(window.left)))
+					continue;
+			}
+			if (window.clip)
+			{
+				auto clip_delta = window.clip_end - window.clip_start;
+				if (!clipSegToSide(
+						left,
+						right,
+						clip_delta.cross(left - window.clip_start),
+						clip_delta.cross(right - window.clip_start)))
+					continue;
+			}
+
+			// Setup the window through the (clipped) portal
+			Window next;
+			next.left       = left - cam;
+			next.right      = right - cam;
+			next.clip       = true;
+			next.clip_start = portal.start;
+			next.clip_end   = portal.end;
+			if (next.right.cross(next.left) <= 0.)
+				continue;
+
+			// Skip if the sector was already entered through this portal with a
+			// window containing this one
+			if (windowEntered(portal.sector, next, static_cast<int>(portal.line)))
+				continue;
+
+			entries_[portal.sector].push_back({ portal.line, next });
+			stack.push_back({ portal.sector, next, static_cast<int>(portal.line) });
+		}
+	}
+
+	return true;
+}
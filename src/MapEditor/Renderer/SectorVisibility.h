@@ -0,0 +1,101 @@
+#pragma once
+
+namespace slade
+{
+// Forward declarations
+class SLADEMap;
+class MapSector;
+
+class SectorVisibility
+{
+public:
+	struct View
+	{
+		Vec2d  position;
+		Vec2d  direction;
+		double half_fov    = 0.;    // Horizontal half field of view (radians), <= 0 = all directions
+		double max_dist    = 0.;    // <= 0 = no limit
+		bool   stop_closed = false; // Treat closed two-sided lines (eg. doors) as solid walls
+
+		bool operator==(const View& other) const
+		{
+			return position == other.position && direction == other.direction && half_fov == other.half_fov
+				   && max_dist == other.max_dist && stop_closed == other.stop_closed;
+		}
+	};
+
+	SectorVisibility(SLADEMap* map) : map_{ map } {}
+	~SectorVisibility() = default;
+
+	bool     valid() const { return valid_; }
+	unsigned nVisibleSectors() const { return visible_list_.size(); }
+	bool     sectorVisible(unsigned index) const { return !valid_ || (index < visible_.size() && visible_[index]); }
+
+	bool update(const View& view);
+	void invalidate();
+
+private:
+	// A two-sided line as seen from one of its sectors, oriented so that
+	// sector is on its right (front) side
+	struct Portal
+	{
+		unsigned line;
+		Vec2d    start;
+		Vec2d    end;
+		unsigned sector; // The sector on the other side
+	};
+
+	// The angular range between two rays from the camera, [right] to [left]
+	// counter-clockwise (less than 180 degrees), unless [full] is set.
+	// If [clip] is set, only things beyond the portal [clip_start]->[clip_end]
+	// (the portal the window came through) are within it
+	struct Window
+	{
+		Vec2d left;
+		Vec2d right;
+		bool  full = false;
+		bool  clip = false;
+		Vec2d clip_start;
+		Vec2d clip_end;
+	};
+
+	// A window a sector was entered with, through [line]. If [via_near] is set
+	// it was entered through a portal near the camera, with an unclipped window
+	struct Entry
+	{
+		unsigned line;
+		Window   window;
+		bool     via_near = false;
+	};
+
+	SLADEMap* map_;
+
+	// Portal graph, per sector
+	vector<vector<Portal>> portals_;
+	long                   portals_time_             = -1;
+	unsigned long          portals_lines_changes_    = 0; // See MapObjectList::changeCount
+	unsigned long          portals_sides_changes_    = 0;
+	unsigned long          portals_vertices_changes_ = 0;
+	unsigned               portals_sectors_          = 0;
+
+	// Visibility from the last update
+	vector<uint8_t>       visible_;
+	vector<unsigned>      visible_list_;
+	vector<vector<Entry>> entries_;
+	bool                  valid_      = false;
+	int                   cam_sector_ = -1;
+	View                  last_view_;
+	long                  vis_time_ = -1;
+	vector<unsigned>      closed_sectors_; // Sectors either side of closed portals that stopped the last update
+	unsigned              steps_     = 0;
+	unsigned              max_steps_ = 0;
+
+	bool portalsOutdated() const;
+	void buildPortals();
+	bool closedSectorsModified() const;
+	bool portalClosed(const Portal& portal, unsigned sector) const;
+	int  findCameraSector(Vec2d position) const;
+	bool windowEntered(unsigned sector, const Window& window, int line) const;
+	bool walk(unsigned start_sector, const Window& start_window);
+};
+} // namespace slade
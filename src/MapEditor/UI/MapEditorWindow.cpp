@@ -38,6 +38,7 @@
 #include "General/Misc.h"
 #include "General/UI.h"
 #include "MainEditor/MainEditor.h"
+#include "MapEditor/BSPBuilder.h"
 #include "MapEditor/MapBackupManager.h"
 #include "MapEditor/MapEditContext.h"
 #include "MapEditor/MapEditor.h"
@@ -78,6 +79,7 @@ bool nb_warned = false;
 CVAR(Bool, mew_maximized, true, CVar::Flag::Save);
 CVAR(String, nodebuilder_id, "zdbsp", CVar::Flag::Save);
 CVAR(String, nodebuilder_options, "", CVar::Flag::Save);
+CVAR(Bool, nodebuilder_builtin_fallback, false, CVar::Flag::Save);
 CVAR(Bool, save_archive_with_map, true, CVar::Flag::Save);
 
 
@@ -731,10 +733,6 @@ void MapEditorWindow::loadMapScripts(Archive::MapDesc map)
 // -----------------------------------------------------------------------------
 void MapEditorWindow::buildNodes(Archive* wad)
 {
-	// Save wad to disk
-	auto filename = app::path("sladetemp.wad", app::Dir::Temp);
-	wad->save(filename);
-
 	// Get current nodebuilder
 	auto     builder = nodebuilders::builder(nodebuilder_id);
 	wxString command = builder.command;
@@ -744,8 +742,8 @@ void MapEditorWindow::buildNodes(Archive* wad)
 	if (builder.id == "none")
 		return;
 
-	// Switch to ZDBSP if UDMF
-	if (mapeditor::editContext().mapDesc().format == MapFormat::UDMF && nodebuilder_id != "zdbsp")
+	// Switch to ZDBSP if UDMF (the built-in builder supports UDMF)
+	if (mapeditor::editContext().mapDesc().format == MapFormat::UDMF && nodebuilder_id != "zdbsp" && !builder.builtin)
 	{
 		wxMessageBox("Nodebuilder switched to ZDBSP for UDMF format", "Save Map", wxICON_INFORMATION);
 		builder = nodebuilders::builder("zdbsp");
@@ -753,7 +751,7 @@ void MapEditorWindow::buildNodes(Archive* wad)
 	}
 
 	// Check for undefined path
-	if (!wxFileExists(builder.path) && !nb_warned)
+	if (!builder.builtin && !wxFileExists(builder.path) && !nb_warned)
 	{
 		// Open nodebuilder preferences
 		PreferencesDialog::openPreferences(this, "Node Builders");
@@ -761,41 +759,71 @@ void MapEditorWindow::buildNodes(Archive* wad)
 		// Get new builder if one was selected
 		builder = nodebuilders::builder(nodebuilder_id);
 		command = builder.command;
+		options = nodebuilder_options;
 
 		// Check again
-		if (!wxFileExists(builder.path))
+		if (!builder.builtin && !wxFileExists(builder.path))
 		{
 			wxMessageBox(
-				"No valid Node Builder is currently configured, nodes will not be built!", "Warning", wxICON_WARNING);
+				nodebuilder_builtin_fallback ?
+					"No valid Node Builder is currently configured, the built-in node builder will be used instead" :
+					"No valid Node Builder is currently configured, nodes will not be built!",
+				"Warning",
+				wxICON_WARNING);
 			nb_warned = true;
 		}
 	}
 
+	// Check the external node builder is set up, otherwise use the built-in one
+	// if enabled (the selected builder's options don't apply in that case)
+	if (!builder.builtin && !wxFileExists(builder.path))
+	{
+		if (!nodebuilder_builtin_fallback)
+		{
+			log::warning("Nodebuilder {} is not set up, nodes were not built", builder.name);
+			return;
+		}
+
+		log::warning("Nodebuilder {} is not set up, using the built-in node builder instead", builder.name);
+		mapeditor::editContext().addEditorMessage("Node builder not set up, using the built-in node builder");
+		builder.builtin = true;
+		options.clear();
+	}
+
+	// Use the built-in node builder if selected
+	if (builder.builtin)
+	{
+		BSPBuilder bsp(mapeditor::editContext().map(), BSPBuilder::parseOptions(options.ToStdString()));
+		if (!bsp.build(&app::threadPool()) || !bsp.writeLumps(*wad))
+			log::error("Failed to build nodes");
+
+		return;
+	}
+
+	// Save wad to disk
+	auto filename = app::path("sladetemp.wad", app::Dir::Temp);
+	wad->save(filename);
+
 	// Build command line
 	command.Replace("$f", wxString::Format("\"%s\"", filename));
 	command.Replace("$o", wxString(options));
 
 	// Run nodebuilder
-	if (wxFileExists(builder.path))
-	{
-		wxArrayString out;
-		log::info(wxString::Format("execute \"%s %s\"", builder.path, command));
-		wxGetApp().SetTopWindow(this);
-		auto focus = wxWindow::FindFocus();
-		wxExecute(wxString::Format("\"%s\" %s", builder.path, command), out, wxEXEC_HIDE_CONSOLE);
-		wxGetApp().SetTopWindow(maineditor::windowWx());
-		if (focus)
-			focus->SetFocusFromKbd();
-		log::info(1, "Nodebuilder output:");
-		for (const auto& line : out)
-			log::info(line);
-
-		// Re-load wad
-		wad->close();
-		wad->open(filename);
-	}
-	else if (nb_warned)
-		log::info(1, "Nodebuilder path not set up, no nodes were built");
+	wxArrayString out;
+	log::info(wxString::Format("execute \"%s %s\"", builder.path, command));
+	wxGetApp().SetTopWindow(this);
+	auto focus = wxWindow::FindFocus();
+	wxExecute(wxString::Format("\"%s\" %s", builder.path, command), out, wxEXEC_HIDE_CONSOLE);
+	wxGetApp().SetTopWindow(maineditor::windowWx());
+	if (focus)
+		focus->SetFocusFromKbd();
+	log::info(1, "Nodebuilder output:");
+	for (const auto& line : out)
+		log::info(line);
+
+	// Re-load wad
+	wad->close();
+	wad->open(filename);
 }
 
 // -----------------------------------------------------------------------------
@@ -234,7 +234,7 @@ MultiMapObjectPropertyChangeUS::MultiMapObjectPropertyChangeUS()
 		}
 	}
 
-	if (log::verbosity() >= 2)
+	if (log::enabled(2))
 	{
 		string msg = "Modified ids: ";
 		for (auto& backup : backups_)
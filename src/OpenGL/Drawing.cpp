@@ -36,8 +36,10 @@
 #include "General/Misc.h"
 #include "General/UI.h"
 #include "OpenGL.h"
+#include "PrimitiveBatch.h"
 #include "Utility/MathStuff.h"
 #include "Utility/StringUtils.h"
+#include <chrono>
 
 #ifdef __WXGTK3__
 #include <gtk-3.0/gtk/gtk.h>
@@ -65,6 +67,12 @@ namespace slade::drawing
 {
 double  text_outline_width = 0;
 ColRGBA outline_colour     = ColRGBA::BLACK;
+
+using FrameClock = std::chrono::steady_clock;
+FrameStats             frame_stats;
+FrameClock::time_point frame_start;
+unsigned               frame_draw_calls  = 0; // Immediate mode draw calls made this frame
+unsigned               frame_batch_calls = 0; // Batch draw call count at the start of the frame
 }; // namespace slade::drawing
 
 
@@ -83,15 +91,77 @@ int drawing::fontSize()
 	return ui::scalePx(gl_font_size);
 }
 
+// -----------------------------------------------------------------------------
+// Begins batching primitives drawn with the drawing functions (lines, rects,
+// ellipses and textures), so they can be drawn with fewer draw calls.
+// Colours set via gl::setColour are kept, but any other OpenGL state changes
+// made while batching must call flushBatch first
+// -----------------------------------------------------------------------------
+void drawing::beginBatch()
+{
+	gl::primitiveBatch().begin();
+}
+
+// -----------------------------------------------------------------------------
+// Ends batching, drawing anything batched since beginBatch
+// -----------------------------------------------------------------------------
+void drawing::endBatch()
+{
+	gl::primitiveBatch().end();
+}
+
+// -----------------------------------------------------------------------------
+// Draws anything batched so far (eg. before changing the line width)
+// -----------------------------------------------------------------------------
+void drawing::flushBatch()
+{
+	gl::primitiveBatch().flush();
+}
+
+// -----------------------------------------------------------------------------
+// Starts counting draw calls and time for a new frame
+// -----------------------------------------------------------------------------
+void drawing::beginFrame()
+{
+	auto now = FrameClock::now();
+	if (frame_start != FrameClock::time_point{})
+	{
+		double interval = std::chrono::duration<double, std::milli>(now - frame_start).count();
+		frame_stats.frame_interval = frame_stats.frame_interval * 0.9 + interval * 0.1;
+	}
+
+	frame_start       = now;
+	frame_draw_calls  = 0;
+	frame_batch_calls = gl::primitiveBatch().drawCalls();
+}
+
+// -----------------------------------------------------------------------------
+// Finishes the current frame and updates the frame stats
+// -----------------------------------------------------------------------------
+void drawing::endFrame()
+{
+	gl::primitiveBatch().flush();
+
+	double time               = std::chrono::duration<double, std::milli>(FrameClock::now() - frame_start).count();
+	frame_stats.frame_time    = frame_stats.frame_time * 0.9 + time * 0.1;
+	frame_stats.batched_calls = gl::primitiveBatch().drawCalls() - frame_batch_calls;
+	frame_stats.draw_calls    = frame_draw_calls + frame_stats.batched_calls;
+}
+
+// -----------------------------------------------------------------------------
+// Returns the stats for the last frame drawn (between beginFrame and endFrame)
+// -----------------------------------------------------------------------------
+const drawing::FrameStats& drawing::frameStats()
+{
+	return frame_stats;
+}
+
 // -----------------------------------------------------------------------------
 // Draws a line from [start] to [end]
 // -----------------------------------------------------------------------------
 void drawing::drawLine(Vec2d start, Vec2d end)
 {
-	glBegin(GL_LINES);
-	glVertex2d(start.x, start.y);
-	glVertex2d(end.x, end.y);
-	glEnd();
+	drawLine(start.x, start.y, end.x, end.y);
 }
 
 // -----------------------------------------------------------------------------
@@ -99,10 +169,17 @@ void drawing::drawLine(Vec2d start, Vec2d end)
 // -----------------------------------------------------------------------------
 void drawing::drawLine(double x1, double y1, double x2, double y2)
 {
+	if (auto& batch = gl::primitiveBatch(); batch.active())
+	{
+		batch.addLine(x1, y1, x2, y2);
+		return;
+	}
+
 	glBegin(GL_LINES);
 	glVertex2d(x1, y1);
 	glVertex2d(x2, y2);
 	glEnd();
+	++frame_draw_calls;
 }
 
 // -----------------------------------------------------------------------------
@@ -110,12 +187,6 @@ void drawing::drawLine(double x1, double y1, double x2, double y2)
 // -----------------------------------------------------------------------------
 void drawing::drawLineTabbed(Vec2d start, Vec2d end, double tab, double tab_max)
 {
-	// Draw line
-	glBegin(GL_LINES);
-	glVertex2d(start.x, start.y);
-	glVertex2d(end.x, end.y);
-	glEnd();
-
 	// Calculate midpoint
 	Vec2d mid;
 	mid.x = start.x + ((end.x - start.x) * 0.5);
@@ -132,11 +203,22 @@ void drawing::drawLineTabbed(Vec2d start, Vec2d end, double tab, double tab_max)
 	Vec2d invdir(-(end.y - start.y), end.x - start.x);
 	invdir.normalize();
 
-	// Draw tab
+	// Add to batch if batching
+	if (auto& batch = gl::primitiveBatch(); batch.active())
+	{
+		batch.addLine(start.x, start.y, end.x, end.y);
+		batch.addLine(mid.x, mid.y, mid.x - invdir.x * tablen, mid.y - invdir.y * tablen);
+		return;
+	}
+
+	// Draw line and tab
 	glBegin(GL_LINES);
+	glVertex2d(start.x, start.y);
+	glVertex2d(end.x, end.y);
 	glVertex2d(mid.x, mid.y);
 	glVertex2d(mid.x - invdir.x * tablen, mid.y - invdir.y * tablen);
 	glEnd();
+	++frame_draw_calls;
 }
 
 // -----------------------------------------------------------------------------
@@ -164,6 +246,21 @@ void drawing::drawArrow(Vec2d p1, Vec2d p2, const ColRGBA& color, bool twoway, d
 		a2r.y -= arrowhead_length * cos(angle + arrowhead_angle);
 	}
 	gl::setColour(color);
+
+	// Add to batch if batching
+	if (auto& batch = gl::primitiveBatch(); batch.active())
+	{
+		batch.addLine(p1.x, p1.y, p2.x, p2.y);
+		batch.addLine(p1.x, p1.y, a1l.x, a1l.y);
+		batch.addLine(p1.x, p1.y, a1r.x, a1r.y);
+		if (twoway)
+		{
+			batch.addLine(p2.x, p2.y, a2l.x, a2l.y);
+			batch.addLine(p2.x, p2.y, a2r.x, a2r.y);
+		}
+		return;
+	}
+
 	glBegin(GL_LINES);
 	glVertex2d(p1.x, p1.y);
 	glVertex2d(p2.x, p2.y);
@@ -171,18 +268,15 @@ void drawing::drawArrow(Vec2d p1, Vec2d p2, const ColRGBA& color, bool twoway, d
 	glVertex2d(a1l.x, a1l.y);
 	glVertex2d(p1.x, p1.y);
 	glVertex2d(a1r.x, a1r.y);
-	glEnd();
 	if (twoway)
 	{
-		glBegin(GL_LINES);
 		glVertex2d(p2.x, p2.y);
 		glVertex2d(a2l.x, a2l.y);
-		glEnd();
-		glBegin(GL_LINES);
 		glVertex2d(p2.x, p2.y);
 		glVertex2d(a2r.x, a2r.y);
-		glEnd();
 	}
+	glEnd();
+	++frame_draw_calls;
 }
 
 // -----------------------------------------------------------------------------
@@ -190,12 +284,7 @@ void drawing::drawArrow(Vec2d p1, Vec2d p2, const ColRGBA& color, bool twoway, d
 // -----------------------------------------------------------------------------
 void drawing::drawRect(Vec2d tl, Vec2d br)
 {
-	glBegin(GL_LINE_LOOP);
-	glVertex2d(tl.x, tl.y);
-	glVertex2d(tl.x, br.y);
-	glVertex2d(br.x, br.y);
-	glVertex2d(br.x, tl.y);
-	glEnd();
+	drawRect(tl.x, tl.y, br.x, br.y);
 }
 
 // -----------------------------------------------------------------------------
@@ -203,12 +292,23 @@ void drawing::drawRect(Vec2d tl, Vec2d br)
 // -----------------------------------------------------------------------------
 void drawing::drawRect(double x1, double y1, double x2, double y2)
 {
+	// Add to batch as separate lines if batching
+	if (auto& batch = gl::primitiveBatch(); batch.active())
+	{
+		batch.addLine(x1, y1, x1, y2);
+		batch.addLine(x1, y2, x2, y2);
+		batch.addLine(x2, y2, x2, y1);
+		batch.addLine(x2, y1, x1, y1);
+		return;
+	}
+
 	glBegin(GL_LINE_LOOP);
 	glVertex2d(x1, y1);
 	glVertex2d(x1, y2);
 	glVertex2d(x2, y2);
 	glVertex2d(x2, y1);
 	glEnd();
+	++frame_draw_calls;
 }
 
 // -----------------------------------------------------------------------------
@@ -216,12 +316,7 @@ void drawing::drawRect(double x1, double y1, double x2, double y2)
 // -----------------------------------------------------------------------------
 void drawing::drawFilledRect(Vec2d tl, Vec2d br)
 {
-	glBegin(GL_QUADS);
-	glVertex2d(tl.x, tl.y);
-	glVertex2d(tl.x, br.y);
-	glVertex2d(br.x, br.y);
-	glVertex2d(br.x, tl.y);
-	glEnd();
+	drawFilledRect(tl.x, tl.y, br.x, br.y);
 }
 
 // -----------------------------------------------------------------------------
@@ -229,12 +324,19 @@ void drawing::drawFilledRect(Vec2d tl, Vec2d br)
 // -----------------------------------------------------------------------------
 void drawing::drawFilledRect(double x1, double y1, double x2, double y2)
 {
+	if (auto& batch = gl::primitiveBatch(); batch.active())
+	{
+		batch.addQuad(x1, y1, x2, y2);
+		return;
+	}
+
 	glBegin(GL_QUADS);
 	glVertex2d(x1, y1);
 	glVertex2d(x1, y2);
 	glVertex2d(x2, y2);
 	glVertex2d(x2, y1);
 	glEnd();
+	++frame_draw_calls;
 }
 
 // -----------------------------------------------------------------------------
@@ -258,21 +360,11 @@ void drawing::drawBorderedRect(
 {
 	// Rect
 	gl::setColour(colour);
-	glBegin(GL_QUADS);
-	glVertex2d(x1, y1);
-	glVertex2d(x1, y2);
-	glVertex2d(x2, y2);
-	glVertex2d(x2, y1);
-	glEnd();
+	drawFilledRect(x1, y1, x2, y2);
 
 	// Border
 	gl::setColour(border_colour);
-	glBegin(GL_LINE_LOOP);
-	glVertex2d(x1, y1);
-	glVertex2d(x1, y2 - 1);
-	glVertex2d(x2 - 1, y2 - 1);
-	glVertex2d(x2 - 1, y1);
-	glEnd();
+	drawRect(x1, y1, x2 - 1, y2 - 1);
 }
 
 // -----------------------------------------------------------------------------
@@ -283,15 +375,33 @@ void drawing::drawEllipse(Vec2d mid, double radius_x, double radius_y, int sides
 	// Set colour
 	gl::setColour(colour);
 
+	// Add to batch as separate lines if batching
+	double step = (3.1415926535897932384626433832795 * 2) / (double)sides;
+	if (auto& batch = gl::primitiveBatch(); batch.active())
+	{
+		double rot = 0;
+		for (int a = 0; a < sides; a++)
+		{
+			batch.addLine(
+				mid.x + sin(rot) * radius_x,
+				mid.y - cos(rot) * radius_y,
+				mid.x + sin(rot - step) * radius_x,
+				mid.y - cos(rot - step) * radius_y);
+			rot -= step;
+		}
+		return;
+	}
+
 	// Draw circle as line loop
 	glBegin(GL_LINE_LOOP);
 	double rot = 0;
 	for (int a = 0; a < sides; a++)
 	{
 		glVertex2d(mid.x + sin(rot) * radius_x, mid.y - cos(rot) * radius_y);
-		rot -= (3.1415926535897932384626433832795 * 2) / (double)sides;
+		rot -= step;
 	}
 	glEnd();
+	++frame_draw_calls;
 }
 
 // -----------------------------------------------------------------------------
@@ -302,6 +412,24 @@ void drawing::drawFilledEllipse(Vec2d mid, double radius_x, double radius_y, int
 	// Set colour
 	gl::setColour(colour);
 
+	// Add to batch as separate triangles if batching
+	double step = (3.1415926535897932384626433832795 * 2) / (double)sides;
+	if (auto& batch = gl::primitiveBatch(); batch.active())
+	{
+		using Primitive = gl::PrimitiveBatch::Primitive;
+
+		double rot = 0;
+		for (int a = 0; a < sides; a++)
+		{
+			batch.addVertex(Primitive::Triangles, mid.x, mid.y);
+			batch.addVertex(Primitive::Triangles, mid.x + sin(rot) * radius_x, mid.y - cos(rot) * radius_y);
+			batch.addVertex(
+				Primitive::Triangles, mid.x + sin(rot - step) * radius_x, mid.y - cos(rot - step) * radius_y);
+			rot -= step;
+		}
+		return;
+	}
+
 	// Draw circle as triangle fan
 	glBegin(GL_TRIANGLE_FAN);
 	glVertex2d(mid.x, mid.y);
@@ -309,9 +437,10 @@ void drawing::drawFilledEllipse(Vec2d mid, double radius_x, double radius_y, int
 	for (int a = 0; a < sides + 1; a++)
 	{
 		glVertex2d(mid.x + sin(rot) * radius_x, mid.y - cos(rot) * radius_y);
-		rot -= (3.1415926535897932384626433832795 * 2) / (double)sides;
+		rot -= step;
 	}
 	glEnd();
+	++frame_draw_calls;
 }
 
 // -----------------------------------------------------------------------------
@@ -330,9 +459,6 @@ void drawing::drawTexture(unsigned id, double x, double y, bool flipx, bool flip
 	if (flipy)
 		y += tex_info.size.y;
 
-	// Bind the texture
-	gl::Texture::bind(id);
-
 	// Setup metrics
 	double h = (double)tex_info.size.x;
 	double v = (double)tex_info.size.y;
@@ -341,6 +467,16 @@ void drawing::drawTexture(unsigned id, double x, double y, bool flipx, bool flip
 	if (flipy)
 		v = -v;
 
+	// Add to batch if batching
+	if (auto& batch = gl::primitiveBatch(); batch.active())
+	{
+		batch.addTexturedQuad(id, x, y, x + h, y + v);
+		return;
+	}
+
+	// Bind the texture
+	gl::Texture::bind(id);
+
 	// Translate to position
 	glPushMatrix();
 	glTranslated(x, y, 0);
@@ -356,6 +492,7 @@ void drawing::drawTexture(unsigned id, double x, double y, bool flipx, bool flip
 	glTexCoord2d(1, 0);
 	glVertex2d(h, 0);
 	glEnd();
+	++frame_draw_calls;
 
 	glPopMatrix();
 }
@@ -369,14 +506,21 @@ void drawing::drawTextureTiled(unsigned id, uint32_t width, uint32_t height)
 	if (!gl::Texture::isLoaded(id))
 		return;
 
-	// Bind the texture
-	gl::Texture::bind(id);
-
 	// Calculate texture coordinates
 	auto&  tex_info = gl::Texture::info(id);
 	double tex_x    = (double)width / (double)tex_info.size.x;
 	double tex_y    = (double)height / (double)tex_info.size.y;
 
+	// Add to batch if batching
+	if (auto& batch = gl::primitiveBatch(); batch.active())
+	{
+		batch.addTexturedQuad(id, 0, 0, width, height, 0.f, 0.f, tex_x, tex_y);
+		return;
+	}
+
+	// Bind the texture
+	gl::Texture::bind(id);
+
 	// Draw
 	glBegin(GL_QUADS);
 	glTexCoord2d(0, 0);
@@ -388,6 +532,7 @@ void drawing::drawTextureTiled(unsigned id, uint32_t width, uint32_t height)
 	glTexCoord2d(tex_x, 0);
 	glVertex2d(width, 0);
 	glEnd();
+	++frame_draw_calls;
 }
 
 // -----------------------------------------------------------------------------
@@ -472,6 +617,17 @@ void drawing::drawTextureWithin(
 	if (scale > max_scale)
 		scale = max_scale;
 
+	// Add to batch if batching
+	if (auto& batch = gl::primitiveBatch(); batch.active())
+	{
+		double mid_x = x1 + width * 0.5;
+		double mid_y = y1 + height * 0.5;
+		double hw    = x_dim * scale * 0.5;
+		double hh    = y_dim * scale * 0.5;
+		batch.addTexturedQuad(id, mid_x - hw, mid_y - hh, mid_x + hw, mid_y + hh);
+		return;
+	}
+
 	// Now draw the texture
 	gl::Texture::bind(id);
 	glPushMatrix();
@@ -488,6 +644,7 @@ void drawing::drawTextureWithin(
 	glTexCoord2d(1, 0);
 	glVertex2d(x_dim, 0);
 	glEnd();
+	++frame_draw_calls;
 	glPopMatrix();
 }
 
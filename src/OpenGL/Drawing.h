@@ -28,6 +28,17 @@ namespace drawing
 		Center
 	};
 
+	// Draw stats for a frame (see beginFrame/endFrame)
+	struct FrameStats
+	{
+		double   frame_time     = 0.; // Time taken to draw a frame (ms, averaged)
+		double   frame_interval = 0.; // Time between frame starts (ms, averaged)
+		unsigned draw_calls     = 0;  // Draw calls made by the drawing functions in the last frame
+		unsigned batched_calls  = 0;  // How many of those were from the primitive batch
+
+		double fps() const { return frame_interval > 0. ? 1000. / frame_interval : 0.; }
+	};
+
 	// Initialisation
 	int initFonts();
 
@@ -37,6 +48,16 @@ namespace drawing
 	// Info
 	int fontSize();
 
+	// Batching
+	void beginBatch();
+	void endBatch();
+	void flushBatch();
+
+	// Frame stats
+	void              beginFrame();
+	void              endFrame();
+	const FrameStats& frameStats();
+
 	// Basic drawing
 	void drawLine(Vec2d start, Vec2d end);
 	void drawLine(double x1, double y1, double x2, double y2);
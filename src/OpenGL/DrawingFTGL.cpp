@@ -36,6 +36,7 @@
 #include "Archive/ArchiveManager.h"
 #include "Drawing.h"
 #include "MapEditor/UI/MapCanvas.h"
+#include "PrimitiveBatch.h"
 #include "Utility/MathStuff.h"
 #include <FTGL/ftgl.h>
 
@@ -259,6 +260,9 @@ FTFont* getFont(Font font)
 // -----------------------------------------------------------------------------
 void drawing::drawText(const string& text, int x, int y, ColRGBA colour, Font font, Align alignment, Rectd* bounds)
 {
+	// Draw anything batched first, text isn't batched
+	gl::primitiveBatch().flush();
+
 	// Get desired font
 	auto ftgl_font = getFont(font);
 
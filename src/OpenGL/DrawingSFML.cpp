@@ -36,6 +36,7 @@
 #include "Archive/ArchiveManager.h"
 #include "Drawing.h"
 #include "MapEditor/UI/MapCanvas.h"
+#include "PrimitiveBatch.h"
 #include "Utility/MathStuff.h"
 
 using namespace slade;
@@ -151,6 +152,9 @@ void drawing::cleanupFonts()
 // -----------------------------------------------------------------------------
 void drawing::drawText(const string& text, int x, int y, ColRGBA colour, Font font, Align alignment, Rectd* bounds)
 {
+	// Draw anything batched first, text isn't batched
+	gl::primitiveBatch().flush();
+
 	// Setup SFML string
 	sf::Text sf_str;
 	sf_str.setString(text);
@@ -32,6 +32,7 @@
 #include "Main.h"
 #include "OpenGL.h"
 #include "General/ColourConfiguration.h"
+#include "PrimitiveBatch.h"
 #include "Utility/Colour.h"
 #include "Utility/StringUtils.h"
 
@@ -269,10 +270,13 @@ void gl::setColour(const ColRGBA& col, Blend blend)
 {
 	// Colour
 	glColor4ub(col.r, col.g, col.b, col.a);
+	if (primitiveBatch().active())
+		primitiveBatch().setColour(col);
 
 	// Blend
 	if (blend != Blend::Ignore && blend != last_blend)
 	{
+		primitiveBatch().flush();
 		if (blend == Blend::Normal)
 			glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 		else if (blend == Blend::Additive)
@@ -290,10 +294,13 @@ void gl::setColour(uint8_t r, uint8_t g, uint8_t b, uint8_t a, Blend blend)
 {
 	// Colour
 	glColor4ub(r, g, b, a);
+	if (primitiveBatch().active())
+		primitiveBatch().setColour({ r, g, b, a });
 
 	// Blend
 	if (blend != Blend::Ignore && blend != last_blend)
 	{
+		primitiveBatch().flush();
 		if (blend == Blend::Normal)
 			glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 		else if (blend == Blend::Additive)
@@ -310,6 +317,7 @@ void gl::setBlend(Blend blend)
 {
 	if (blend != Blend::Ignore && blend != last_blend)
 	{
+		primitiveBatch().flush();
 		if (blend == Blend::Normal)
 			glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 		else if (blend == Blend::Additive)
@@ -324,6 +332,7 @@ void gl::setBlend(Blend blend)
 // -----------------------------------------------------------------------------
 void gl::resetBlend()
 {
+	primitiveBatch().flush();
 	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 	last_blend = Blend::Normal;
 }
@@ -0,0 +1,252 @@
+
+// -----------------------------------------------------------------------------
+// SLADE - It's a Doom Editor
+// Copyright(C) 2008 - 2020 Simon Judd
+//
+// Email:       sirjuddington@gmail.com
+// Web:         http://slade.mancubus.net
+// Filename:    PrimitiveBatch.cpp
+// Description: PrimitiveBatch class - gathers simple 2d primitives into a
+//              streaming vertex buffer so they can be drawn together, rather
+//              than with a glBegin/glEnd each
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301, USA.
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+//
+// Includes
+//
+// -----------------------------------------------------------------------------
+#include "Main.h"
+#include "PrimitiveBatch.h"
+#include "GLTexture.h"
+#include "OpenGL.h"
+
+using namespace slade;
+using namespace gl;
+
+
+// -----------------------------------------------------------------------------
+//
+// Variables
+//
+// -----------------------------------------------------------------------------
+CVAR(Bool, gl_batch_primitives, true, CVar::Flag::Save)
+
+namespace
+{
+// Flush automatically once this many vertices are waiting
+constexpr unsigned BATCH_MAX_VERTICES = 65536;
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// PrimitiveBatch Class Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Begins batching. Batches can be nested, primitives are drawn when the
+// outermost batch ends (or the batch is flushed).
+// Does nothing if primitive batching is disabled (gl_batch_primitives cvar)
+// -----------------------------------------------------------------------------
+void PrimitiveBatch::begin()
+{
+	if (!gl_batch_primitives)
+		return;
+
+	// Start with the current OpenGL colour
+	if (depth_ == 0)
+	{
+		GLfloat col[4];
+		glGetFloatv(GL_CURRENT_COLOR, col);
+		colour_.set(col[0] * 255, col[1] * 255, col[2] * 255, col[3] * 255);
+	}
+
+	++depth_;
+}
+
+// -----------------------------------------------------------------------------
+// Ends batching, drawing everything in the batch if this is the outermost one
+// -----------------------------------------------------------------------------
+void PrimitiveBatch::end()
+{
+	if (depth_ == 0)
+		return;
+
+	if (--depth_ == 0)
+		flush();
+}
+
+// -----------------------------------------------------------------------------
+// Draws everything in the batch and clears it
+// -----------------------------------------------------------------------------
+void PrimitiveBatch::flush()
+{
+	if (vertices_.empty())
+		return;
+
+	// Upload vertices to the VBO, or use them directly if VBOs aren't supported
+	const char* data = reinterpret_cast<const char*>(vertices_.data());
+	if (vboSupport())
+	{
+		if (vbo_ == 0)
+			glGenBuffers(1, &vbo_);
+
+		glBindBuffer(GL_ARRAY_BUFFER, vbo_);
+		glBufferData(GL_ARRAY_BUFFER, sizeof(Vertex) * vertices_.size(), vertices_.data(), GL_STREAM_DRAW);
+		data = nullptr;
+	}
+
+	// Setup arrays
+	glEnableClientState(GL_VERTEX_ARRAY);
+	glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+	glEnableClientState(GL_COLOR_ARRAY);
+	glVertexPointer(2, GL_FLOAT, sizeof(Vertex), data);
+	glTexCoordPointer(2, GL_FLOAT, sizeof(Vertex), data + 8);
+	glColorPointer(4, GL_UNSIGNED_BYTE, sizeof(Vertex), data + 16);
+
+	// Draw
+	bool textured = glIsEnabled(GL_TEXTURE_2D);
+	bool tex_on   = textured;
+	for (const auto& draw : draws_)
+	{
+		if (draw.texture > 0)
+		{
+			if (!tex_on)
+				glEnable(GL_TEXTURE_2D);
+			Texture::bind(draw.texture, false);
+			tex_on = true;
+		}
+		else if (tex_on)
+		{
+			glDisable(GL_TEXTURE_2D);
+			tex_on = false;
+		}
+
+		GLenum mode = GL_LINES;
+		if (draw.primitive == Primitive::Triangles)
+			mode = GL_TRIANGLES;
+		else if (draw.primitive == Primitive::Quads)
+			mode = GL_QUADS;
+
+		glDrawArrays(mode, draw.first, draw.count);
+		++draw_calls_;
+	}
+
+	// Restore state
+	if (tex_on != textured)
+	{
+		if (textured)
+			glEnable(GL_TEXTURE_2D);
+		else
+			glDisable(GL_TEXTURE_2D);
+	}
+	glDisableClientState(GL_VERTEX_ARRAY);
+	glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+	glDisableClientState(GL_COLOR_ARRAY);
+	if (vboSupport())
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+	glColor4ub(colour_.r, colour_.g, colour_.b, colour_.a);
+
+	vertices_.clear();
+	draws_.clear();
+}
+
+// -----------------------------------------------------------------------------
+// Adds a vertex at [x,y] to the batch for [primitive], in the current colour.
+// If [texture] is not 0, the vertex is textured with it at [u,v]
+// -----------------------------------------------------------------------------
+void PrimitiveBatch::addVertex(Primitive primitive, double x, double y, unsigned texture, float u, float v)
+{
+	// Start a new draw if the primitive or texture changed
+	if (draws_.empty() || draws_.back().primitive != primitive || draws_.back().texture != texture)
+		draws_.push_back({ primitive, texture, static_cast<unsigned>(vertices_.size()), 0 });
+
+	vertices_.push_back(
+		{ static_cast<float>(x), static_cast<float>(y), u, v, colour_.r, colour_.g, colour_.b, colour_.a });
+	++draws_.back().count;
+}
+
+// -----------------------------------------------------------------------------
+// Adds a line from [x1,y1] to [x2,y2] to the batch
+// -----------------------------------------------------------------------------
+void PrimitiveBatch::addLine(double x1, double y1, double x2, double y2)
+{
+	if (vertices_.size() >= BATCH_MAX_VERTICES)
+		flush();
+
+	addVertex(Primitive::Lines, x1, y1);
+	addVertex(Primitive::Lines, x2, y2);
+}
+
+// -----------------------------------------------------------------------------
+// Adds a filled rectangle from [x1,y1] to [x2,y2] to the batch
+// -----------------------------------------------------------------------------
+void PrimitiveBatch::addQuad(double x1, double y1, double x2, double y2)
+{
+	if (vertices_.size() >= BATCH_MAX_VERTICES)
+		flush();
+
+	addVertex(Primitive::Quads, x1, y1);
+	addVertex(Primitive::Quads, x1, y2);
+	addVertex(Primitive::Quads, x2, y2);
+	addVertex(Primitive::Quads, x2, y1);
+}
+
+// -----------------------------------------------------------------------------
+// Adds a rectangle from [x1,y1] to [x2,y2] textured with [texture] to the
+// batch, with texture coordinates [u1,v1] to [u2,v2]
+// -----------------------------------------------------------------------------
+void PrimitiveBatch::addTexturedQuad(
+	unsigned texture,
+	double   x1,
+	double   y1,
+	double   x2,
+	double   y2,
+	float    u1,
+	float    v1,
+	float    u2,
+	float    v2)
+{
+	if (vertices_.size() >= BATCH_MAX_VERTICES)
+		flush();
+
+	addVertex(Primitive::Quads, x1, y1, texture, u1, v1);
+	addVertex(Primitive::Quads, x1, y2, texture, u1, v2);
+	addVertex(Primitive::Quads, x2, y2, texture, u2, v2);
+	addVertex(Primitive::Quads, x2, y1, texture, u2, v1);
+}
+
+
+// -----------------------------------------------------------------------------
+//
+// GL Namespace Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Returns the primitive batch used by the drawing functions
+// -----------------------------------------------------------------------------
+PrimitiveBatch& gl::primitiveBatch()
+{
+	static PrimitiveBatch batch;
+	return batch;
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include "Utility/Colour.h"
+
+namespace slade::gl
+{
+// Gathers lines, triangles and quads (optionally textured) into a streaming
+// vertex buffer, so they can be drawn with as few draw calls as possible.
+// Primitives are drawn in the order they were added, a new draw call is only
+// needed when the primitive type or texture changes.
+//
+// While a batch is active, anything that changes OpenGL state affecting the
+// batched primitives (line width, matrices, etc.) must call flush() first.
+// Colours set with gl::setColour are tracked by the batch
+class PrimitiveBatch
+{
+public:
+	enum class Primitive
+	{
+		Lines,
+		Triangles,
+		Quads
+	};
+
+	PrimitiveBatch() = default;
+	~PrimitiveBatch() = default;
+
+	bool     active() const { return depth_ > 0; }
+	unsigned nVertices() const { return vertices_.size(); }
+	unsigned drawCalls() const { return draw_calls_; }
+
+	void begin();
+	void end();
+	void flush();
+	void setColour(const ColRGBA& colour) { colour_ = colour; }
+
+	void addVertex(Primitive primitive, double x, double y, unsigned texture = 0, float u = 0.f, float v = 0.f);
+	void addLine(double x1, double y1, double x2, double y2);
+	void addQuad(double x1, double y1, double x2, double y2);
+	void addTexturedQuad(
+		unsigned texture,
+		double   x1,
+		double   y1,
+		double   x2,
+		double   y2,
+		float    u1 = 0.f,
+		float    v1 = 0.f,
+		float    u2 = 1.f,
+		float    v2 = 1.f);
+
+private:
+	struct Vertex
+	{
+		float   x, y;
+		float   u, v;
+		uint8_t r, g, b, a;
+	};
+
+	// A run of vertices with the same primitive type and texture
+	struct Draw
+	{
+		Primitive primitive;
+		unsigned  texture;
+		unsigned  first;
+		unsigned  count;
+	};
+
+	vector<Vertex> vertices_;
+	vector<Draw>   draws_;
+	ColRGBA        colour_     = ColRGBA::WHITE;
+	unsigned       vbo_        = 0;
+	int            depth_      = 0;
+	unsigned       draw_calls_ = 0; // Total number of draw calls made by the batch
+};
+
+PrimitiveBatch& primitiveBatch();
+} // namespace slade::gl
@@ -0,0 +1,232 @@
+
+// -----------------------------------------------------------------------------
+// SLADE - It's a Doom Editor
+// Copyright(C) 2008 - 2020 Simon Judd
+//
+// Email:       sirjuddington@gmail.com
+// Web:         http://slade.mancubus.net
+// Filename:    TextureAtlas.cpp
+// Description: TextureAtlas class - packs many small OpenGL textures into
+//              larger 'page' textures, so things drawn with different
+//              textures can be drawn together without rebinding
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301, USA.
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+//
+// Includes
+//
+// -----------------------------------------------------------------------------
+#include "Main.h"
+#include "TextureAtlas.h"
+#include "GLTexture.h"
+#include "OpenGL.h"
+
+using namespace slade;
+using namespace gl;
+
+
+// -----------------------------------------------------------------------------
+//
+// Variables
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// Size of the border added around each texture in the atlas, so filtering
+// (and mipmapping) near the edges doesn't pick up neighbouring textures
+constexpr unsigned ATLAS_BORDER = 2;
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// TextureAtlas Class Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Returns the atlas region for [texture], adding it to the atlas if needed.
+// Returns nullptr if the texture can't be added (too large, not loaded, etc.).
+// Note that newly added textures won't show up on the page until updatePages
+// is called
+// -----------------------------------------------------------------------------
+const TextureAtlas::Region* TextureAtlas::region(unsigned texture)
+{
+	if (!Texture::isLoaded(texture))
+		return nullptr;
+
+	auto& tex_info = Texture::info(texture);
+
+	// Check if already added. If the size or filter doesn't match the texture
+	// has been replaced since, so it needs to be added again (the old space is
+	// wasted until the atlas is cleared)
+	if (auto i = regions_.find(texture); i != regions_.end())
+	{
+		if (i->second.size == tex_info.size && i->second.filter == tex_info.filter)
+			return &i->second;
+
+		regions_.erase(i);
+	}
+	if (auto i = rejected_.find(texture); i != rejected_.end() && i->second == tex_info.size)
+		return nullptr;
+
+	// Check size
+	unsigned width  = tex_info.size.x;
+	unsigned height = tex_info.size.y;
+	if (width > max_item_size_ || height > max_item_size_)
+	{
+		rejected_[texture] = tex_info.size;
+		return nullptr;
+	}
+
+	// Find space for the texture (plus border)
+	unsigned p_width  = width + ATLAS_BORDER * 2;
+	unsigned p_height = height + ATLAS_BORDER * 2;
+	unsigned x, y;
+	auto     page = allocate(p_width, p_height, tex_info.filter, x, y);
+	if (!page)
+	{
+		rejected_[texture] = tex_info.size;
+		return nullptr;
+	}
+
+	// Get texture pixels
+	vector<uint8_t> pixels(width * height * 4);
+	Texture::bind(texture);
+	glGetTexImage(GL_TEXTURE_2D, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+
+	// Write to page, with the border repeating the edge pixels
+	int border = ATLAS_BORDER;
+	for (int py = 0; py < static_cast<int>(p_height); py++)
+	{
+		auto sy  = std::clamp(py - border, 0, static_cast<int>(height) - 1);
+		auto row = &page->pixels[((y + py) * page_size_ + x) * 4];
+		for (int px = 0; px < static_cast<int>(p_width); px++)
+		{
+			auto sx = std::clamp(px - border, 0, static_cast<int>(width) - 1);
+			memcpy(row + px * 4, &pixels[(sy * width + sx) * 4], 4);
+		}
+	}
+	page->modified = true;
+
+	// Add region
+	auto& region  = regions_[texture];
+	auto  scale   = 1.f / static_cast<float>(page_size_);
+	region.page   = page->texture;
+	region.tl     = { (x + ATLAS_BORDER) * scale, (y + ATLAS_BORDER) * scale };
+	region.br     = { (x + ATLAS_BORDER + width) * scale, (y + ATLAS_BORDER + height) * scale };
+	region.size   = tex_info.size;
+	region.filter = tex_info.filter;
+
+	return &region;
+}
+
+// -----------------------------------------------------------------------------
+// Uploads any pages that have had textures added since the last update
+// -----------------------------------------------------------------------------
+void TextureAtlas::updatePages()
+{
+	for (auto& page : pages_)
+	{
+		if (!page.modified)
+			continue;
+
+		Texture::loadData(page.texture, page.pixels.data(), page_size_, page_size_);
+		page.modified = false;
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Clears the atlas, deleting all page textures
+// -----------------------------------------------------------------------------
+void TextureAtlas::clear()
+{
+	for (auto& page : pages_)
+		Texture::clear(page.texture);
+
+	pages_.clear();
+	regions_.clear();
+	rejected_.clear();
+}
+
+// -----------------------------------------------------------------------------
+// Finds space for an item of [width]x[height] in the last page with [filter],
+// adding a new page if needed. Sets [x] and [y] to the location found and
+// returns the page, or returns nullptr if no space could be found
+// -----------------------------------------------------------------------------
+TextureAtlas::Page* TextureAtlas::allocate(unsigned width, unsigned height, TexFilter filter, unsigned& x, unsigned& y)
+{
+	// Check page size
+	page_size_ = std::min(page_size_, gl::maxTextureSize());
+	if (width > page_size_ || height > page_size_)
+		return nullptr;
+
+	// Find last page with the filter
+	Page* page = nullptr;
+	for (auto& p : pages_)
+		if (p.filter == filter)
+			page = &p;
+	if (!page)
+		page = addPage(filter);
+	if (!page)
+		return nullptr;
+
+	// Start a new shelf if the item doesn't fit on the current one
+	if (page->shelf_x + width > page_size_)
+	{
+		page->shelf_y += page->shelf_height;
+		page->shelf_x      = 0;
+		page->shelf_height = 0;
+	}
+
+	// Start a new page if the item doesn't fit on the page
+	if (page->shelf_y + height > page_size_)
+	{
+		page = addPage(filter);
+		if (!page)
+			return nullptr;
+	}
+
+	// Add to shelf
+	x = page->shelf_x;
+	y = page->shelf_y;
+	page->shelf_x += width;
+	page->shelf_height = std::max(page->shelf_height, height);
+
+	return page;
+}
+
+// -----------------------------------------------------------------------------
+// Adds a new (empty) page with [filter] to the atlas and returns it, or
+// returns nullptr if the page texture couldn't be created
+// -----------------------------------------------------------------------------
+TextureAtlas::Page* TextureAtlas::addPage(TexFilter filter)
+{
+	auto id = Texture::create(filter, false);
+	if (!id)
+		return nullptr;
+
+	auto& page    = pages_.emplace_back();
+	page.texture  = id;
+	page.filter   = filter;
+	page.modified = true;
+	page.pixels.resize(page_size_ * page_size_ * 4);
+
+	return &page;
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include "GLTexture.h"
+
+namespace slade::gl
+{
+class TextureAtlas
+{
+public:
+	// Where a texture is in the atlas, [page] is the atlas page texture and
+	// [tl]/[br] are the texture coordinates of its top-left/bottom-right
+	struct Region
+	{
+		unsigned  page = 0;
+		Vec2f     tl;
+		Vec2f     br;
+		Vec2i     size;                       // Size of the source texture when it was added
+		TexFilter filter = TexFilter::Linear; // Filter of the source texture when it was added
+	};
+
+	TextureAtlas(unsigned page_size = 1024, unsigned max_item_size = 256) :
+		page_size_{ page_size },
+		max_item_size_{ max_item_size }
+	{
+	}
+	~TextureAtlas() { clear(); }
+
+	unsigned nPages() const { return pages_.size(); }
+
+	const Region* region(unsigned texture);
+	void          updatePages();
+	void          clear();
+
+private:
+	// Each page is filled with rows ('shelves') of textures, left to right.
+	// Only textures with the same filter as the page can be added to it
+	struct Page
+	{
+		unsigned        texture      = 0;
+		TexFilter       filter       = TexFilter::Linear;
+		unsigned        shelf_y      = 0;
+		unsigned        shelf_height = 0;
+		unsigned        shelf_x      = 0;
+		vector<uint8_t> pixels;
+		bool            modified = false;
+	};
+
+	unsigned                   page_size_;
+	unsigned                   max_item_size_;
+	vector<Page>               pages_;
+	std::map<unsigned, Region> regions_;
+	std::map<unsigned, Vec2i>  rejected_; // Textures that can't go in the atlas (and their size)
+
+	Page* allocate(unsigned width, unsigned height, TexFilter filter, unsigned& x, unsigned& y);
+	Page* addPage(TexFilter filter);
+};
+} // namespace slade::gl
@@ -158,7 +158,7 @@ bool DoomMapFormat::readVERTEXES(ArchiveEntry* entry, MapObjectCollection& map_d
 	for (size_t a = 0; a < nv; a++)
 	{
 		ui::setSplashProgress(p + ((float)a / nv) * 0.2f);
-		map_data.addVertex(std::make_unique<MapVertex>(Vec2d{ (double)vert_data[a].x, (double)vert_data[a].y }));
+		map_data.addVertex(Vec2d{ (double)vert_data[a].x, (double)vert_data[a].y });
 	}
 
 	log::info(3, "Read {} vertices", map_data.vertices().size());
@@ -193,12 +193,12 @@ bool DoomMapFormat::readSIDEDEFS(ArchiveEntry* entry, MapObjectCollection& map_d
 		ui::setSplashProgress(p + ((float)a / ns) * 0.2f);
 
 		// Add side
-		map_data.addSide(std::make_unique<MapSide>(
+		map_data.addSide(
 			map_data.sectors().at(side_data[a].sector),
 			strutil::viewFromChars(side_data[a].tex_upper, 8),
 			strutil::viewFromChars(side_data[a].tex_middle, 8),
 			strutil::viewFromChars(side_data[a].tex_lower, 8),
-			Vec2i{ side_data[a].x_offset, side_data[a].y_offset }));
+			Vec2i{ side_data[a].x_offset, side_data[a].y_offset });
 	}
 
 	log::info(3, "Read {} sides", map_data.sides().size());
@@ -255,8 +255,8 @@ bool DoomMapFormat::readLINEDEFS(ArchiveEntry* entry, MapObjectCollection& map_d
 		}
 
 		// Create line
-		auto line = map_data.addLine(std::make_unique<MapLine>(
-			v1, v2, map_data.sides().at(s1_index), map_data.sides().at(s2_index), data.type, data.flags));
+		auto line = map_data.addLine(
+			v1, v2, map_data.sides().at(s1_index), map_data.sides().at(s2_index), data.type, data.flags);
 
 		// Set properties
 		line->setArg(0, data.sector_tag);
@@ -296,14 +296,14 @@ bool DoomMapFormat::readSECTORS(ArchiveEntry* entry, MapObjectCollection& map_da
 		const auto& data = sect_data[a];
 
 		// Add sector
-		map_data.addSector(std::make_unique<MapSector>(
+		map_data.addSector(
 			data.f_height,
 			strutil::viewFromChars(data.f_tex, 8),
 			data.c_height,
 			strutil::viewFromChars(data.c_tex, 8),
 			data.light,
 			data.special,
-			data.tag));
+			data.tag);
 	}
 
 	log::info(3, "Read {} sectors", map_data.sectors().size());
@@ -336,11 +336,11 @@ bool DoomMapFormat::readTHINGS(ArchiveEntry* entry, MapObjectCollection& map_dat
 	for (size_t a = 0; a < nt; a++)
 	{
 		ui::setSplashProgress(p + ((float)a / nt) * 0.2f);
-		map_data.addThing(std::make_unique<MapThing>(
+		map_data.addThing(
 			Vec3d{ (double)thng_data[a].x, (double)thng_data[a].y, 0. },
 			thng_data[a].type,
 			thng_data[a].angle,
-			thng_data[a].flags));
+			thng_data[a].flags);
 	}
 
 	log::info(3, "Read {} things", map_data.things().size());
@@ -105,7 +105,7 @@ bool HexenMapFormat::readLINEDEFS(ArchiveEntry* entry, MapObjectCollection& map_
 			s2 = map_data.duplicateSide(s2);
 
 		// Create line
-		auto line = map_data.addLine(std::make_unique<MapLine>(v1, v2, s1, s2, data.type, data.flags));
+		auto line = map_data.addLine(v1, v2, s1, s2, data.type, data.flags);
 
 		// Set properties
 		for (unsigned i = 0; i < 5; ++i)
@@ -162,14 +162,14 @@ bool HexenMapFormat::readTHINGS(ArchiveEntry* entry, MapObjectCollection& map_da
 			args[i] = data.args[i];
 
 		// Create thing
-		map_data.addThing(std::make_unique<MapThing>(
+		map_data.addThing(
 			Vec3d{ (double)data.x, (double)data.y, (double)data.z },
 			data.type,
 			data.angle,
 			data.flags,
 			args,
 			data.tid,
-			data.special));
+			data.special);
 	}
 
 	log::info(3, "Read {} things", map_data.things().size());
@@ -130,14 +130,11 @@ bool UniversalDoomMapFormat::readMap(Archive::MapDesc map, MapObjectCollection&
 	{
 		ui::setSplashProgress(((float)a / defs_vertices.size()) * 0.2f);
 
-		auto vertex = createVertex(defs_vertices[a]);
-		if (!vertex)
+		if (!createVertex(defs_vertices[a], map_data))
 		{
 			log::warning("Invalid UDMF vertex definition {}, not added", a);
 			continue;
 		}
-
-		map_data.addVertex(std::move(vertex));
 	}
 
 	// Create sectors from parsed data
@@ -146,14 +143,11 @@ bool UniversalDoomMapFormat::readMap(Archive::MapDesc map, MapObjectCollection&
 	{
 		ui::setSplashProgress(0.2f + ((float)a / defs_sectors.size()) * 0.2f);
 
-		auto sector = createSector(defs_sectors[a]);
-		if (!sector)
+		if (!createSector(defs_sectors[a], map_data))
 		{
 			log::warning("Invalid UDMF sector definition {}, not added", a);
 			continue;
 		}
-
-		map_data.addSector(std::move(sector));
 	}
 
 	// Create sides from parsed data
@@ -162,14 +156,11 @@ bool UniversalDoomMapFormat::readMap(Archive::MapDesc map, MapObjectCollection&
 	{
 		ui::setSplashProgress(0.4f + ((float)a / defs_sides.size()) * 0.2f);
 
-		auto side = createSide(defs_sides[a], map_data);
-		if (!side)
+		if (!createSide(defs_sides[a], map_data))
 		{
 			log::warning("Invalid UDMF side definition {}, not added", a);
 			continue;
 		}
-
-		map_data.addSide(std::move(side));
 	}
 
 	// Create lines from parsed data
@@ -178,14 +169,11 @@ bool UniversalDoomMapFormat::readMap(Archive::MapDesc map, MapObjectCollection&
 	{
 		ui::setSplashProgress(0.6f + ((float)a / defs_lines.size()) * 0.2f);
 
-		auto line = createLine(defs_lines[a], map_data);
-		if (!line)
+		if (!createLine(defs_lines[a], map_data))
 		{
 			log::warning("Invalid UDMF line definition {}, not added", a);
 			continue;
 		}
-
-		map_data.addLine(std::move(line));
 	}
 
 	// Create things from parsed data
@@ -194,14 +182,11 @@ bool UniversalDoomMapFormat::readMap(Archive::MapDesc map, MapObjectCollection&
 	{
 		ui::setSplashProgress(0.8f + ((float)a / defs_things.size()) * 0.2f);
 
-		auto thing = createThing(defs_things[a]);
-		if (!thing)
+		if (!createThing(defs_things[a], map_data))
 		{
 			log::warning("Invalid UDMF thing definition {}, not added", a);
 			continue;
 		}
-
-		map_data.addThing(std::move(thing));
 	}
 
 	// Keep map-scope values
@@ -326,9 +311,10 @@ vector<unique_ptr<ArchiveEntry>> UniversalDoomMapFormat::writeMap(
 }
 
 // -----------------------------------------------------------------------------
-// Creates and returns a vertex from parsed UDMF definition [def]
+// Creates a vertex from parsed UDMF definition [def] and adds it to [map_data].
+// Returns the new vertex, or null if [def] is invalid
 // -----------------------------------------------------------------------------
-unique_ptr<MapVertex> UniversalDoomMapFormat::createVertex(ParseTreeNode* def) const
+MapVertex* UniversalDoomMapFormat::createVertex(ParseTreeNode* def, MapObjectCollection& map_data) const
 {
 	// Check for required properties
 	auto prop_x = def->childPTN("x");
@@ -337,13 +323,14 @@ unique_ptr<MapVertex> UniversalDoomMapFormat::createVertex(ParseTreeNode* def) c
 		return nullptr;
 
 	// Create vertex
-	return std::make_unique<MapVertex>(Vec2d{ prop_x->floatValue(), prop_y->floatValue() }, def);
+	return map_data.addVertex(Vec2d{ prop_x->floatValue(), prop_y->floatValue() }, def);
 }
 
 // -----------------------------------------------------------------------------
-// Creates and returns a sector from parsed UDMF definition [def]
+// Creates a sector from parsed UDMF definition [def] and adds it to [map_data].
+// Returns the new sector, or null if [def] is invalid
 // -----------------------------------------------------------------------------
-unique_ptr<MapSector> UniversalDoomMapFormat::createSector(ParseTreeNode* def) const
+MapSector* UniversalDoomMapFormat::createSector(ParseTreeNode* def, MapObjectCollection& map_data) const
 {
 	// Check for required properties
 	auto prop_ftex = def->childPTN("texturefloor");
@@ -352,13 +339,14 @@ unique_ptr<MapSector> UniversalDoomMapFormat::createSector(ParseTreeNode* def) c
 		return nullptr;
 
 	// Create sector
-	return std::make_unique<MapSector>(prop_ftex->stringValue(), prop_ctex->stringValue(), def);
+	return map_data.addSector(prop_ftex->stringValue(), prop_ctex->stringValue(), def);
 }
 
 // -----------------------------------------------------------------------------
-// Creates and returns a side from parsed UDMF definition [def]
+// Creates a side from parsed UDMF definition [def] and adds it to [map_data].
+// Returns the new side, or null if [def] is invalid
 // -----------------------------------------------------------------------------
-unique_ptr<MapSide> UniversalDoomMapFormat::createSide(ParseTreeNode* def, const MapObjectCollection& map_data) const
+MapSide* UniversalDoomMapFormat::createSide(ParseTreeNode* def, MapObjectCollection& map_data) const
 {
 	// Check for required properties
 	auto prop_sector = def->childPTN("sector");
@@ -371,13 +359,14 @@ unique_ptr<MapSide> UniversalDoomMapFormat::createSide(ParseTreeNode* def, const
 		return nullptr;
 
 	// Create side
-	return std::make_unique<MapSide>(sector, def);
+	return map_data.addSide(sector, def);
 }
 
 // -----------------------------------------------------------------------------
-// Creates and returns a line from parsed UDMF definition [def]
+// Creates a line from parsed UDMF definition [def] and adds it to [map_data].
+// Returns the new line, or null if [def] is invalid
 // -----------------------------------------------------------------------------
-unique_ptr<MapLine> UniversalDoomMapFormat::createLine(ParseTreeNode* def, const MapObjectCollection& map_data) const
+MapLine* UniversalDoomMapFormat::createLine(ParseTreeNode* def, MapObjectCollection& map_data) const
 {
 	// Check for required properties
 	auto prop_v1 = def->childPTN(MapLine::PROP_V1);
@@ -398,13 +387,14 @@ unique_ptr<MapLine> UniversalDoomMapFormat::createLine(ParseTreeNode* def, const
 	auto s2 = prop_s2 ? map_data.sides().at(prop_s2->intValue()) : nullptr;
 
 	// Create line
-	return std::make_unique<MapLine>(v1, v2, s1, s2, def);
+	return map_data.addLine(v1, v2, s1, s2, def);
 }
 
 // -----------------------------------------------------------------------------
-// Creates and returns a thing from parsed UDMF definition [def]
+// Creates a thing from parsed UDMF definition [def] and adds it to [map_data].
+// Returns the new thing, or null if [def] is invalid
 // -----------------------------------------------------------------------------
-unique_ptr<MapThing> UniversalDoomMapFormat::createThing(ParseTreeNode* def) const
+MapThing* UniversalDoomMapFormat::createThing(ParseTreeNode* def, MapObjectCollection& map_data) const
 {
 	// Check for required properties
 	auto prop_x    = def->childPTN(MapThing::PROP_X);
@@ -414,6 +404,5 @@ unique_ptr<MapThing> UniversalDoomMapFormat::createThing(ParseTreeNode* def) con
 		return nullptr;
 
 	// Create thing
-	return std::make_unique<MapThing>(
-		Vec3d{ prop_x->floatValue(), prop_y->floatValue(), 0. }, prop_type->intValue(), def);
+	return map_data.addThing(Vec3d{ prop_x->floatValue(), prop_y->floatValue(), 0. }, prop_type->intValue(), def);
 }
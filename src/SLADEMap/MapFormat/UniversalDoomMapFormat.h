@@ -25,10 +25,10 @@ public:
 private:
 	string udmf_namespace_;
 
-	unique_ptr<MapVertex> createVertex(ParseTreeNode* def) const;
-	unique_ptr<MapSector> createSector(ParseTreeNode* def) const;
-	unique_ptr<MapSide>   createSide(ParseTreeNode* def, const MapObjectCollection& map_data) const;
-	unique_ptr<MapLine>   createLine(ParseTreeNode* def, const MapObjectCollection& map_data) const;
-	unique_ptr<MapThing>  createThing(ParseTreeNode* def) const;
+	MapVertex* createVertex(ParseTreeNode* def, MapObjectCollection& map_data) const;
+	MapSector* createSector(ParseTreeNode* def, MapObjectCollection& map_data) const;
+	MapSide*   createSide(ParseTreeNode* def, MapObjectCollection& map_data) const;
+	MapLine*   createLine(ParseTreeNode* def, MapObjectCollection& map_data) const;
+	MapThing*  createThing(ParseTreeNode* def, MapObjectCollection& map_data) const;
 };
 } // namespace slade
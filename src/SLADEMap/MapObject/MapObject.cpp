@@ -104,6 +104,25 @@ void MapObject::setModified()
 	}
 
 	modified_time_ = app::runTimer();
+
+	// Record change in the parent map
+	if (parent_map_)
+		parent_map_->mapData().recordChange(this);
+}
+
+// -----------------------------------------------------------------------------
+// Sets the object's filtered state to [f]. This doesn't modify the object but
+// is recorded as a change in the parent map, since it affects how the object
+// is displayed
+// -----------------------------------------------------------------------------
+void MapObject::filter(bool f)
+{
+	if (filtered_ == f)
+		return;
+
+	filtered_ = f;
+	if (parent_map_)
+		parent_map_->mapData().recordChange(this);
 }
 
 // -----------------------------------------------------------------------------
@@ -86,7 +86,7 @@ public:
 
 	virtual Vec2d getPoint(Point point) { return { 0, 0 }; }
 
-	void filter(bool f = true) { filtered_ = f; }
+	void filter(bool f = true);
 
 	virtual void copy(MapObject* c);
 
@@ -402,6 +402,18 @@ Polygon2D* MapSector::polygon()
 	return &polygon_;
 }
 
+// -----------------------------------------------------------------------------
+// Flags the sector polygon for rebuilding next time it is accessed
+// -----------------------------------------------------------------------------
+void MapSector::resetPolygon()
+{
+	poly_needsupdate_ = true;
+
+	// Record change so the polygon gets updated wherever it is cached
+	if (parent_map_)
+		parent_map_->mapData().recordChange(this);
+}
+
 // -----------------------------------------------------------------------------
 // Returns true if the given [point] is inside the sector
 // -----------------------------------------------------------------------------
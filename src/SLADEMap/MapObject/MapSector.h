@@ -86,7 +86,7 @@ public:
 	void              resetBBox() { bbox_.reset(); }
 	BBox              boundingBox();
 	vector<MapSide*>& connectedSides() { return connected_sides_; }
-	void              resetPolygon() { poly_needsupdate_ = true; }
+	void              resetPolygon();
 	Polygon2D*        polygon();
 	bool              containsPoint(Vec2d point);
 	double            distanceTo(Vec2d point, double maxdist = -1);
@@ -52,11 +52,11 @@ MapObjectCollection::MapObjectCollection(SLADEMap* parent_map) : parent_map_{ pa
 // -----------------------------------------------------------------------------
 // Adds [object] to the map objects list
 // -----------------------------------------------------------------------------
-void MapObjectCollection::addMapObject(unique_ptr<MapObject> object)
+void MapObjectCollection::addMapObject(MapObject* object)
 {
 	object->obj_id_     = objects_.size();
 	object->parent_map_ = parent_map_;
-	objects_.emplace_back(std::move(object), true);
+	objects_.emplace_back(object, true);
 }
 
 // -----------------------------------------------------------------------------
@@ -117,7 +117,7 @@ void MapObjectCollection::restoreObjectIdList(MapObject::Type type, vector<unsig
 		for (auto id : list)
 		{
 			objects_[id].in_map = true;
-			vertices_.add(dynamic_cast<MapVertex*>(objects_[id].object.get()));
+			vertices_.add(dynamic_cast<MapVertex*>(objects_[id].object));
 			vertices_.last()->index_ = vertices_.size() - 1;
 		}
 	}
@@ -132,7 +132,7 @@ void MapObjectCollection::restoreObjectIdList(MapObject::Type type, vector<unsig
 		for (auto id : list)
 		{
 			objects_[id].in_map = true;
-			lines_.add(dynamic_cast<MapLine*>(objects_[id].object.get()));
+			lines_.add(dynamic_cast<MapLine*>(objects_[id].object));
 			lines_.back()->index_ = lines_.size() - 1;
 		}
 	}
@@ -147,7 +147,7 @@ void MapObjectCollection::restoreObjectIdList(MapObject::Type type, vector<unsig
 		for (auto id : list)
 		{
 			objects_[id].in_map = true;
-			sides_.add(dynamic_cast<MapSide*>(objects_[id].object.get()));
+			sides_.add(dynamic_cast<MapSide*>(objects_[id].object));
 			sides_.back()->index_ = sides_.size() - 1;
 		}
 	}
@@ -162,7 +162,7 @@ void MapObjectCollection::restoreObjectIdList(MapObject::Type type, vector<unsig
 		for (auto id : list)
 		{
 			objects_[id].in_map = true;
-			sectors_.add(dynamic_cast<MapSector*>(objects_[id].object.get()));
+			sectors_.add(dynamic_cast<MapSector*>(objects_[id].object));
 			sectors_.back()->index_ = sectors_.size() - 1;
 		}
 	}
@@ -177,7 +177,7 @@ void MapObjectCollection::restoreObjectIdList(MapObject::Type type, vector<unsig
 		for (auto id : list)
 		{
 			objects_[id].in_map = true;
-			things_.add(dynamic_cast<MapThing*>(objects_[id].object.get()));
+			things_.add(dynamic_cast<MapThing*>(objects_[id].object));
 			things_.back()->index_ = things_.size() - 1;
 		}
 	}
@@ -223,6 +223,11 @@ void MapObjectCollection::clear()
 
 	// Clear map objects
 	objects_.clear();
+	vertex_pool_.clear();
+	side_pool_.clear();
+	line_pool_.clear();
+	sector_pool_.clear();
+	thing_pool_.clear();
 
 	// Object id 0 is always null
 	objects_.emplace_back(nullptr, false);
@@ -478,61 +483,6 @@ bool MapObjectCollection::removeThing(unsigned index)
 	return true;
 }
 
-// -----------------------------------------------------------------------------
-// Adds [vertex] to the map
-// -----------------------------------------------------------------------------
-MapVertex* MapObjectCollection::addVertex(unique_ptr<MapVertex> vertex)
-{
-	vertex->index_ = vertices_.size();
-	vertices_.add(vertex.get());
-	addMapObject(std::move(vertex));
-	return vertices_.back();
-}
-
-// -----------------------------------------------------------------------------
-// Adds [side] to the map
-// -----------------------------------------------------------------------------
-MapSide* MapObjectCollection::addSide(unique_ptr<MapSide> side)
-{
-	side->index_ = sides_.size();
-	sides_.add(side.get());
-	addMapObject(std::move(side));
-	return sides_.back();
-}
-
-// -----------------------------------------------------------------------------
-// Adds [line] to the map
-// -----------------------------------------------------------------------------
-MapLine* MapObjectCollection::addLine(unique_ptr<MapLine> line)
-{
-	line->index_ = lines_.size();
-	lines_.add(line.get());
-	addMapObject(std::move(line));
-	return lines_.back();
-}
-
-// -----------------------------------------------------------------------------
-// Adds [sector] to the map
-// -----------------------------------------------------------------------------
-MapSector* MapObjectCollection::addSector(unique_ptr<MapSector> sector)
-{
-	sector->index_ = sectors_.size();
-	sectors_.add(sector.get());
-	addMapObject(std::move(sector));
-	return sectors_.back();
-}
-
-// -----------------------------------------------------------------------------
-// Adds [thing] to the map
-// -----------------------------------------------------------------------------
-MapThing* MapObjectCollection::addThing(unique_ptr<MapThing> thing)
-{
-	thing->index_ = things_.size();
-	things_.add(thing.get());
-	addMapObject(std::move(thing));
-	return things_.back();
-}
-
 // -----------------------------------------------------------------------------
 // Creates and adds a new side duplicated from the given [side] and returns it
 // -----------------------------------------------------------------------------
@@ -541,10 +491,9 @@ MapSide* MapObjectCollection::duplicateSide(MapSide* side)
 	if (!side)
 		return nullptr;
 
-	auto ns = std::make_unique<MapSide>(side->sector());
+	auto ns = addSide(side->sector());
 	ns->copy(side);
-	addSide(std::move(ns));
-	return sides_.back();
+	return ns;
 }
 
 // -----------------------------------------------------------------------------
@@ -579,7 +528,7 @@ vector<MapObject*> MapObjectCollection::allModifiedObjects(long since) const
 	for (auto& holder : objects_)
 	{
 		if (holder.object && holder.object->modified_time_ >= since)
-			modified_objects.push_back(holder.object.get());
+			modified_objects.push_back(holder.object);
 	}
 
 	return modified_objects;
@@ -618,6 +567,22 @@ bool MapObjectCollection::modifiedSince(long since, MapObject::Type type) const
 	}
 }
 
+// -----------------------------------------------------------------------------
+// Records a change to [object] in its object list (see MapObjectList::addChange)
+// -----------------------------------------------------------------------------
+void MapObjectCollection::recordChange(const MapObject* object) const
+{
+	switch (object->objType())
+	{
+	case MapObject::Type::Vertex: vertices_.addChange(object->index()); break;
+	case MapObject::Type::Line: lines_.addChange(object->index()); break;
+	case MapObject::Type::Side: sides_.addChange(object->index()); break;
+	case MapObject::Type::Sector: sectors_.addChange(object->index()); break;
+	case MapObject::Type::Thing: things_.addChange(object->index()); break;
+	default: break;
+	}
+}
+
 // -----------------------------------------------------------------------------
 // Removes any vertices not attached to any lines. Returns the number of
 // vertices removed
@@ -6,6 +6,7 @@
 #include "MapObjectList/SideList.h"
 #include "MapObjectList/ThingList.h"
 #include "MapObjectList/VertexList.h"
+#include "MapObjectPool.h"
 
 namespace slade
 {
@@ -29,21 +30,35 @@ public:
 	void setParentMap(SLADEMap* map) { parent_map_ = map; }
 
 	// MapObject id stuff (used for undo/redo)
-	void       addMapObject(unique_ptr<MapObject> object);
 	void       removeMapObject(MapObject* object);
-	MapObject* getObjectById(unsigned id) const { return objects_[id].object.get(); }
+	MapObject* getObjectById(unsigned id) const { return objects_[id].object; }
 	void       putObjectIdList(MapObject::Type type, vector<unsigned>& list) const;
 	void       restoreObjectIdList(MapObject::Type type, vector<unsigned>& list);
 
 	void refreshIndices();
 	void clear();
 
-	// Object add
-	MapVertex* addVertex(unique_ptr<MapVertex> vertex);
-	MapSide*   addSide(unique_ptr<MapSide> side);
-	MapLine*   addLine(unique_ptr<MapLine> line);
-	MapSector* addSector(unique_ptr<MapSector> sector);
-	MapThing*  addThing(unique_ptr<MapThing> thing);
+	// Object add (constructs a new object from [args])
+	template<typename... Args> MapVertex* addVertex(Args&&... args)
+	{
+		return addObject(vertex_pool_.create(std::forward<Args>(args)...), vertices_);
+	}
+	template<typename... Args> MapSide* addSide(Args&&... args)
+	{
+		return addObject(side_pool_.create(std::forward<Args>(args)...), sides_);
+	}
+	template<typename... Args> MapLine* addLine(Args&&... args)
+	{
+		return addObject(line_pool_.create(std::forward<Args>(args)...), lines_);
+	}
+	template<typename... Args> MapSector* addSector(Args&&... args)
+	{
+		return addObject(sector_pool_.create(std::forward<Args>(args)...), sectors_);
+	}
+	template<typename... Args> MapThing* addThing(Args&&... args)
+	{
+		return addObject(thing_pool_.create(std::forward<Args>(args)...), things_);
+	}
 
 	// Object duplicate
 	MapSide* duplicateSide(MapSide* side);
@@ -65,6 +80,7 @@ public:
 	vector<MapObject*> allModifiedObjects(long since) const;
 	long               lastModifiedTime() const;
 	bool               modifiedSince(long since, MapObject::Type type) const;
+	void               recordChange(const MapObject* object) const;
 
 	// Checks
 	int removeDetachedVertices();
@@ -80,12 +96,19 @@ public:
 private:
 	struct MapObjectHolder
 	{
-		unique_ptr<MapObject> object;
-		bool                  in_map;
+		MapObject* object;
+		bool       in_map;
 
-		MapObjectHolder(unique_ptr<MapObject> object, bool in_map) : object{ std::move(object) }, in_map{ in_map } {}
+		MapObjectHolder(MapObject* object, bool in_map) : object{ object }, in_map{ in_map } {}
 	};
 
+	// Object storage
+	MapObjectPool<MapVertex> vertex_pool_;
+	MapObjectPool<MapSide>   side_pool_;
+	MapObjectPool<MapLine>   line_pool_;
+	MapObjectPool<MapSector> sector_pool_;
+	MapObjectPool<MapThing>  thing_pool_;
+
 	SLADEMap*               parent_map_ = nullptr;
 	vector<MapObjectHolder> objects_;
 	VertexList              vertices_;
@@ -93,5 +116,16 @@ private:
 	LineList                lines_;
 	SectorList              sectors_;
 	ThingList               things_;
+
+	void addMapObject(MapObject* object);
+
+	// Adds [object] (from one of the pools) to the map and to [list]
+	template<class T, class L> T* addObject(T* object, L& list)
+	{
+		object->index_ = list.size();
+		list.add(object);
+		addMapObject(object);
+		return object;
+	}
 };
 } // namespace slade
@@ -26,6 +26,7 @@ public:
 	{
 		objects_.clear();
 		count_ = 0;
+		resetChanges();
 	}
 	T*   back() { return objects_.back(); }
 	bool empty() const { return count_ == 0; }
@@ -40,6 +41,7 @@ public:
 	{
 		objects_.push_back(object);
 		++count_;
+		resetChanges();
 	}
 	virtual void remove(unsigned index)
 	{
@@ -49,12 +51,14 @@ public:
 			objects_[index]->setIndex(index);
 			objects_.pop_back();
 			--count_;
+			resetChanges();
 		}
 	}
 	virtual void removeLast()
 	{
 		objects_.pop_back();
 		--count_;
+		resetChanges();
 	}
 
 	// Misc
@@ -73,8 +77,51 @@ public:
 		return false;
 	}
 
+	// Change tracking
+	//
+	// Indices of objects changed in-place (see MapObject::setModified) are
+	// recorded in order, so that anything caching per-object data (eg. the 2d
+	// renderer's VBOs) can find exactly what changed since it last checked,
+	// rather than scanning every object. Adding or removing objects (which can
+	// move other objects to different indices) resets the record
+	unsigned long changeCount() const { return changes_base_ + changes_.size(); }
+	void          addChange(unsigned index) const
+	{
+		// Ignore repeated changes to the same object
+		if (!changes_.empty() && changes_.back() == index)
+			return;
+
+		// Reset if the record is getting large, a full update will be
+		// quicker than going through it anyway
+		if (changes_.size() >= std::max<unsigned>(1024, count_ * 2))
+			resetChanges();
+
+		changes_.push_back(index);
+	}
+	bool changesSince(unsigned long since, vector<unsigned>& indices) const
+	{
+		// Check changes since [since] are still recorded
+		if (since < changes_base_ || since > changeCount())
+			return false;
+
+		indices.insert(indices.end(), changes_.begin() + (since - changes_base_), changes_.end());
+		return true;
+	}
+
 protected:
 	vector<T*> objects_;
 	unsigned   count_ = 0;
+
+	// Change tracking
+	mutable vector<unsigned> changes_;
+	mutable unsigned long    changes_base_ = 0;
+
+	// Clears the change record, anything that last checked for changes before
+	// now will need to do a full update
+	void resetChanges() const
+	{
+		changes_base_ += changes_.size() + 1;
+		changes_.clear();
+	}
 };
 } // namespace slade
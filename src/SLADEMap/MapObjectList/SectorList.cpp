@@ -33,8 +33,10 @@
 // -----------------------------------------------------------------------------
 #include "Main.h"
 #include "SectorList.h"
+#include "App.h"
 #include "General/UI.h"
 #include "Utility/StringUtils.h"
+#include "Utility/ThreadPool.h"
 
 using namespace slade;
 
@@ -130,17 +132,23 @@ BBox SectorList::allSectorBounds() const
 }
 
 // -----------------------------------------------------------------------------
-// Forces building of polygons for all sectors in the list
+// Forces building of polygons for all sectors in the list.
+// Sector polygons are independent of each other, so they are built in
+// parallel on the thread pool (in chunks, to keep the splash progress updated)
 // -----------------------------------------------------------------------------
 void SectorList::initPolygons()
 {
 	ui::setSplashProgressMessage("Building sector polygons");
 	ui::setSplashProgress(0.0f);
-	for (unsigned i = 0; i < count_; ++i)
+
+	const unsigned chunk_size = 1024;
+	for (unsigned start = 0; start < count_; start += chunk_size)
 	{
-		ui::setSplashProgress((float)i / (float)count_);
-		objects_[i]->polygon();
+		ui::setSplashProgress((float)start / (float)count_);
+		unsigned count = std::min(chunk_size, count_ - start);
+		app::threadPool().parallelFor(count, [this, start](size_t i) { objects_[start + i]->polygon(); }, 16);
 	}
+
 	ui::setSplashProgress(1.0f);
 }
 
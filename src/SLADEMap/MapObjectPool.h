@@ -0,0 +1,68 @@
+#pragma once
+
+namespace slade
+{
+// Allocates map objects of type [T] from contiguous blocks ('slabs') of memory
+// rather than individually on the heap, so that objects created together (eg.
+// when loading a map) are stored together in memory.
+// Objects are never freed individually - they stay valid until the pool is
+// cleared or destroyed (removed map objects are kept around for undo anyway)
+template<class T> class MapObjectPool
+{
+public:
+	MapObjectPool() = default;
+	~MapObjectPool() { clear(); }
+
+	MapObjectPool(const MapObjectPool&)            = delete;
+	MapObjectPool& operator=(const MapObjectPool&) = delete;
+
+	unsigned size() const { return count_; }
+
+	// Constructs a new object in the pool from [args] and returns it
+	template<typename... Args> T* create(Args&&... args)
+	{
+		// Add a new slab if the current one is full, each slab is twice the
+		// size of the previous (up to a limit)
+		if (slabs_.empty() || slab_used_ == slab_size_)
+		{
+			slab_size_ = slabs_.empty() ? MIN_SLAB_SIZE : std::min(slab_size_ * 2, MAX_SLAB_SIZE);
+			slabs_.emplace_back(new Storage[slab_size_]);
+			slab_used_ = 0;
+		}
+
+		auto object = new (&slabs_.back()[slab_used_]) T(std::forward<Args>(args)...);
+		++slab_used_;
+		++count_;
+		return object;
+	}
+
+	// Destroys all objects in the pool and frees its memory
+	void clear()
+	{
+		for (unsigned s = 0; s < slabs_.size(); ++s)
+		{
+			auto n_objects = s == slabs_.size() - 1 ? slab_used_ : slabSize(s);
+			for (unsigned a = 0; a < n_objects; ++a)
+				std::launder(reinterpret_cast<T*>(&slabs_[s][a]))->~T();
+		}
+
+		slabs_.clear();
+		slab_size_ = 0;
+		slab_used_ = 0;
+		count_     = 0;
+	}
+
+private:
+	using Storage = std::aligned_storage_t<sizeof(T), alignof(T)>;
+
+	static constexpr unsigned MIN_SLAB_SIZE = 256;
+	static constexpr unsigned MAX_SLAB_SIZE = 8192;
+
+	vector<unique_ptr<Storage[]>> slabs_;
+	unsigned                      slab_size_ = 0; // Size of the last slab
+	unsigned                      slab_used_ = 0; // Number of objects in the last slab
+	unsigned                      count_     = 0;
+
+	static unsigned slabSize(unsigned index) { return std::min(MIN_SLAB_SIZE << std::min(index, 5u), MAX_SLAB_SIZE); }
+};
+} // namespace slade
@@ -0,0 +1,361 @@
+
+// -----------------------------------------------------------------------------
+// SLADE - It's a Doom Editor
+// Copyright(C) 2008 - 2020 Simon Judd
+//
+// Email:       sirjuddington@gmail.com
+// Web:         http://slade.mancubus.net
+// Filename:    MergeArchTest.cpp
+// Description: Regression check for SLADEMap::mergeArch. Builds a set of
+//              awkward layouts (collinear overlaps, vertices exactly on lines,
+//              crossing lines, huge sectors) and compares the results of
+//              mergeArch against a reference implementation that checks every
+//              line and vertex in the map, as mergeArch used to
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301, USA.
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+//
+// Includes
+//
+// -----------------------------------------------------------------------------
+#include "Main.h"
+#include "General/Console.h"
+#include "MapObject/MapLine.h"
+#include "MapObject/MapSector.h"
+#include "MapObject/MapVertex.h"
+#include "SLADEMap.h"
+#include "Utility/MathStuff.h"
+
+using namespace slade;
+
+
+// -----------------------------------------------------------------------------
+//
+// Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// -----------------------------------------------------------------------------
+// Merges architecture connected to [vertices] in [map] the way mergeArch did
+// before it used a grid: every split and intersection check goes through all
+// lines and vertices in the map, and overlapping lines are found by comparing
+// every pair of connected lines. Used as the expected result for mergeArch
+// -----------------------------------------------------------------------------
+bool mergeArchReference(SLADEMap& map, const vector<MapVertex*>& vertices)
+{
+	// Check any map architecture exists
+	if (map.nVertices() == 0 || map.nLines() == 0)
+		return false;
+
+	const unsigned n_vertices  = map.nVertices();
+	const unsigned n_lines     = map.nLines();
+	auto*          last_vertex = map.vertices().last();
+	auto*          last_line   = map.lines().last();
+
+	// Merge vertices
+	vector<MapVertex*> merged_vertices;
+	for (const auto* vertex : vertices)
+		if (auto* v = map.mergeVerticesPoint(vertex->position()))
+			VECTOR_ADD_UNIQUE(merged_vertices, v);
+
+	// Get all connected lines
+	vector<MapLine*> connected_lines;
+	for (const auto* vertex : merged_vertices)
+		for (auto* connected_line : vertex->connectedLines())
+			VECTOR_ADD_UNIQUE(connected_lines, connected_line);
+
+	// Split existing lines that vertices moved onto
+	const double split_dist = 0.1;
+	for (auto* merged : merged_vertices)
+		map.splitLinesAt(merged, split_dist);
+
+	// Split lines that moved onto existing vertices
+	for (unsigned a = 0; a < connected_lines.size(); a++)
+	{
+		const unsigned nvertices = map.nVertices();
+		for (unsigned b = 0; b < nvertices; b++)
+		{
+			auto* vertex = map.vertex(b);
+			if (connected_lines[a]->v1() == vertex || connected_lines[a]->v2() == vertex)
+				continue;
+
+			if (connected_lines[a]->distanceTo(vertex->position()) < split_dist)
+			{
+				connected_lines.push_back(map.splitLine(connected_lines[a], vertex));
+				VECTOR_ADD_UNIQUE(merged_vertices, vertex);
+			}
+		}
+	}
+
+	// Split lines (by lines)
+	for (unsigned a = 0; a < connected_lines.size(); a++)
+	{
+		auto* line1 = connected_lines[a];
+		auto  seg1  = line1->seg();
+
+		const unsigned count = map.nLines();
+		for (unsigned b = 0; b < count; b++)
+		{
+			auto* line2 = map.line(b);
+			if (line1->v1() == line2->v1() || line1->v1() == line2->v2() || line2->v1() == line1->v2()
+				|| line2->v2() == line1->v2())
+				continue;
+
+			Vec2d intersection;
+			if (math::linesIntersect(seg1, line2->seg(), intersection))
+			{
+				auto* nv = map.createVertex(intersection);
+				merged_vertices.push_back(nv);
+				connected_lines.push_back(map.splitLine(line1, nv));
+				connected_lines.push_back(map.splitLine(line2, nv));
+				a--;
+				break;
+			}
+		}
+	}
+
+	// Refresh connected lines
+	connected_lines.clear();
+	for (const auto* vertex : merged_vertices)
+		for (auto* connected_line : vertex->connectedLines())
+			VECTOR_ADD_UNIQUE(connected_lines, connected_line);
+
+	// Find overlapping lines
+	vector<MapLine*> remove_lines;
+	for (unsigned a = 0; a < connected_lines.size(); a++)
+	{
+		auto* line1 = connected_lines[a];
+		if (VECTOR_EXISTS(remove_lines, line1))
+			continue;
+
+		for (unsigned l = a + 1; l < connected_lines.size(); l++)
+		{
+			auto* line2 = connected_lines[l];
+			if (VECTOR_EXISTS(remove_lines, line2))
+				continue;
+
+			if (line1->v1() == line2->v1() && line1->v2() == line2->v2()
+				|| line1->v1() == line2->v2() && line1->v2() == line2->v1())
+			{
+				auto* remove_line = map.mergeOverlappingLines(line2, line1);
+				VECTOR_ADD_UNIQUE(remove_lines, remove_line);
+				if (remove_line == line1)
+					break;
+			}
+		}
+	}
+
+	// Remove overlapping lines
+	for (auto* remove_line : remove_lines)
+		map.removeLine(remove_line);
+	for (unsigned a = 0; a < connected_lines.size(); a++)
+	{
+		if (VECTOR_EXISTS(remove_lines, connected_lines[a]))
+		{
+			connected_lines[a] = connected_lines.back();
+			connected_lines.pop_back();
+			a--;
+		}
+	}
+
+	// Check if anything was actually merged
+	const bool merged = map.nVertices() != n_vertices || map.nLines() != n_lines
+						|| map.vertices().last() != last_vertex || map.lines().last() != last_line
+						|| !remove_lines.empty();
+
+	// Correct sector references and flip any one-sided lines that only have a
+	// side 2
+	map.correctSectors(connected_lines, true);
+	for (auto* connected_line : connected_lines)
+		if (connected_line->s2() && !connected_line->s1())
+			connected_line->flip();
+
+	return merged;
+}
+
+// -----------------------------------------------------------------------------
+// Creates a closed loop of lines through [points] in [map], with front sides in
+// a new sector
+// -----------------------------------------------------------------------------
+void mergeTestAddSector(SLADEMap& map, const vector<Vec2d>& points)
+{
+	auto* sector = map.createSector();
+	for (unsigned a = 0; a < points.size(); a++)
+	{
+		auto* line = map.createLine(points[a], points[(a + 1) % points.size()]);
+		map.setLineSide(line, map.createSide(sector), true);
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Creates lines through [points] in [map] (a closed loop in a new sector if
+// [sector] is true) away from the existing map, then moves them onto [points]
+// as if they had been dragged there in the editor. Returns the moved vertices
+// -----------------------------------------------------------------------------
+vector<MapVertex*> mergeTestAddMoved(SLADEMap& map, const vector<Vec2d>& points, bool sector)
+{
+	// Far enough away from everything in the test layouts
+	const double offset = 1000000.;
+
+	vector<MapVertex*> moved;
+	for (const auto& point : points)
+		moved.push_back(map.createVertex({ point.x, point.y + offset }));
+
+	auto*          new_sector = sector ? map.createSector() : nullptr;
+	const unsigned n_lines    = sector ? points.size() : points.size() - 1;
+	for (unsigned a = 0; a < n_lines; a++)
+	{
+		auto* line = map.createLine(moved[a], moved[(a + 1) % moved.size()]);
+		if (new_sector)
+			map.setLineSide(line, map.createSide(new_sector), true);
+	}
+
+	for (unsigned a = 0; a < points.size(); a++)
+		moved[a]->move(points[a].x, points[a].y);
+
+	return moved;
+}
+
+// -----------------------------------------------------------------------------
+// Returns a description of all vertices, lines and sectors in [map], in index
+// order
+// -----------------------------------------------------------------------------
+vector<string> mergeTestDescribe(const SLADEMap& map)
+{
+	auto sector_index = [](const MapSector* sector) { return sector ? static_cast<int>(sector->index()) : -1; };
+
+	vector<string> desc;
+	desc.push_back(fmt::format(
+		"{} vertices, {} lines, {} sides, {} sectors", map.nVertices(), map.nLines(), map.nSides(), map.nSectors()));
+	for (auto* vertex : map.vertices())
+		desc.push_back(fmt::format("Vertex {}: ({},{})", vertex->index(), vertex->xPos(), vertex->yPos()));
+	for (auto* line : map.lines())
+		desc.push_back(fmt::format(
+			"Line {}: {} -> {}, front sector {}, back sector {}",
+			line->index(),
+			line->v1()->index(),
+			line->v2()->index(),
+			sector_index(line->frontSector()),
+			sector_index(line->backSector())));
+
+	return desc;
+}
+
+// -----------------------------------------------------------------------------
+// Layout builders for the mergeArch test. Each builds a map and returns the
+// vertices to merge
+// -----------------------------------------------------------------------------
+using MergeTestLayout = std::function<vector<MapVertex*>(SLADEMap&)>;
+
+const vector<std::pair<string, MergeTestLayout>> merge_test_layouts = {
+	// A sector dragged over half of another, so its top and bottom lines are
+	// collinear with (and partially overlap) the existing sector's
+	{ "Collinear overlap",
+	  [](SLADEMap& map) {
+		  mergeTestAddSector(map, { { 0, 0 }, { 0, 256 }, { 256, 256 }, { 256, 0 } });
+		  return mergeTestAddMoved(map, { { 128, 0 }, { 128, 256 }, { 384, 256 }, { 384, 0 } }, true);
+	  } },
+
+	// A copy of a sector dragged exactly onto the original
+	{ "Exact overlap",
+	  [](SLADEMap& map) {
+		  mergeTestAddSector(map, { { 0, 0 }, { 0, 256 }, { 256, 256 }, { 256, 0 } });
+		  return mergeTestAddMoved(map, { { 0, 0 }, { 0, 256 }, { 256, 256 }, { 256, 0 } }, true);
+	  } },
+
+	// A line with its ends exactly on a sector line and a diagonal line
+	{ "Vertex on line",
+	  [](SLADEMap& map) {
+		  mergeTestAddSector(map, { { 0, 0 }, { 0, 256 }, { 256, 256 }, { 256, 0 } });
+		  map.createLine(Vec2d{ 0, -256 }, Vec2d{ 256, 0 });
+		  return mergeTestAddMoved(map, { { 128, 0 }, { 128, -128 } }, false);
+	  } },
+
+	// Lines crossing a sector, one through the middle of two lines and one
+	// diagonally through two of its vertices
+	{ "Crossing lines",
+	  [](SLADEMap& map) {
+		  mergeTestAddSector(map, { { 0, 0 }, { 0, 256 }, { 256, 256 }, { 256, 0 } });
+		  auto moved = mergeTestAddMoved(map, { { -64, 128 }, { 320, 128 } }, false);
+		  for (auto* vertex : mergeTestAddMoved(map, { { -64, -64 }, { 320, 320 } }, false))
+			  moved.push_back(vertex);
+		  return moved;
+	  } },
+
+	// A huge sector full of small sectors, with a line across the whole map and
+	// a line overlapping part of the huge sector's edge
+	{ "Huge sector",
+	  [](SLADEMap& map) {
+		  mergeTestAddSector(map, { { -32768, -32768 }, { -32768, 32767 }, { 32767, 32767 }, { 32767, -32768 } });
+		  for (double x = -30000; x < 30000; x += 2048)
+			  for (double y = -30000; y < 30000; y += 2048)
+				  mergeTestAddSector(map, { { x, y }, { x, y + 256 }, { x + 256, y + 256 }, { x + 256, y } });
+
+		  auto moved = mergeTestAddMoved(map, { { -40000, -29872 }, { 40000, -29872 } }, false);
+		  for (auto* vertex : mergeTestAddMoved(map, { { -40000, -32768 }, { 0, -32768 } }, false))
+			  moved.push_back(vertex);
+		  return moved;
+	  } },
+};
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// Console Commands
+//
+// -----------------------------------------------------------------------------
+
+CONSOLE_COMMAND(m_test_merge_arch, 0, false)
+{
+	unsigned failed = 0;
+	for (const auto& [name, layout] : merge_test_layouts)
+	{
+		SLADEMap map;
+		SLADEMap expected_map;
+		auto     merged          = map.mergeArch(layout(map));
+		auto     expected_merged = mergeArchReference(expected_map, layout(expected_map));
+
+		auto desc     = mergeTestDescribe(map);
+		auto expected = mergeTestDescribe(expected_map);
+
+		if (merged != expected_merged)
+		{
+			log::console(fmt::format("{}: FAILED, mergeArch returned {}, expected {}", name, merged, expected_merged));
+			failed++;
+			continue;
+		}
+
+		auto mismatch = std::mismatch(desc.begin(), desc.end(), expected.begin(), expected.end());
+		if (mismatch.first != desc.end() || mismatch.second != expected.end())
+		{
+			log::console(fmt::format(
+				"{}: FAILED, got \"{}\", expected \"{}\"",
+				name,
+				mismatch.first != desc.end() ? *mismatch.first : "<end>",
+				mismatch.second != expected.end() ? *mismatch.second : "<end>"));
+			failed++;
+			continue;
+		}
+
+		log::console(fmt::format("{}: passed ({})", name, desc[0]));
+	}
+
+	log::console(fmt::format("{} of {} mergeArch tests failed", failed, merge_test_layouts.size()));
+}
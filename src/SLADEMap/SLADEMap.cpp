@@ -37,6 +37,7 @@
 #include "MapEditor/SectorBuilder.h"
 #include "MapFormat/MapFormatHandler.h"
 #include "Utility/MathStuff.h"
+#include <unordered_set>
 
 using namespace slade;
 
@@ -47,6 +48,100 @@ using namespace slade;
 //
 // -----------------------------------------------------------------------------
 CVAR(Bool, map_split_auto_offset, true, CVar::Flag::Save)
+namespace
+{
+// A uniform grid of the lines and vertices in a map, used by SLADEMap::mergeArch
+// to only check lines and vertices near the architecture being merged for
+// splits and intersections, rather than every line and vertex in the map
+class MergeArchGrid
+{
+public:
+	MergeArchGrid(const LineList& lines, const VertexList& vertices)
+	{
+		// Size cells to around twice the average line length, so that most
+		// lines only cover a few cells
+		double total_length = 0.;
+		for (auto* line : lines)
+			total_length += line->length();
+		if (!lines.empty())
+			cell_size_ = std::clamp(2. * total_length / lines.size(), 64., 2048.);
+
+		for (auto* line : lines)
+			forEachCell(line->start(), line->end(), 0., [&](int64_t key) { line_cells_[key].push_back(line); });
+		for (auto* vertex : vertices)
+			vertex_cells_[cellKey(cellCoord(vertex->xPos()), cellCoord(vertex->yPos()))].push_back(vertex);
+	}
+
+	// Adds [line] to all cells its bbox covers that it isn't already in.
+	// Should be called again for any line whose vertices changed (a line can
+	// be in a cell it no longer covers, but must be in all cells it does)
+	void addLine(MapLine* line)
+	{
+		forEachCell(line->start(), line->end(), 0., [&](int64_t key) {
+			auto& cell = line_cells_[key];
+			if (std::find(cell.begin(), cell.end(), line) == cell.end())
+				cell.push_back(line);
+		});
+	}
+
+	// Returns all lines in cells within [dist] of [line]'s bbox, in index order
+	vector<MapLine*> linesNear(const MapLine* line, double dist) const
+	{
+		return objectsNear(line_cells_, line->start(), line->end(), dist);
+	}
+
+	// Returns all lines in cells within [dist] of [pos], in index order
+	vector<MapLine*> linesNear(Vec2d pos, double dist) const { return objectsNear(line_cells_, pos, pos, dist); }
+
+	// Returns all vertices in cells within [dist] of [line]'s bbox, in index
+	// order
+	vector<MapVertex*> verticesNear(const MapLine* line, double dist) const
+	{
+		return objectsNear(vertex_cells_, line->start(), line->end(), dist);
+	}
+
+private:
+	double                                          cell_size_ = 128.;
+	std::unordered_map<int64_t, vector<MapLine*>>   line_cells_;
+	std::unordered_map<int64_t, vector<MapVertex*>> vertex_cells_;
+
+	int            cellCoord(double pos) const { return static_cast<int>(std::floor(pos / cell_size_)); }
+	static int64_t cellKey(int x, int y) { return (static_cast<int64_t>(x) << 32) | static_cast<uint32_t>(y); }
+
+	template<typename F> void forEachCell(Vec2d p1, Vec2d p2, double dist, F&& func) const
+	{
+		const int x1 = cellCoord(std::min(p1.x, p2.x) - dist);
+		const int x2 = cellCoord(std::max(p1.x, p2.x) + dist);
+		const int y1 = cellCoord(std::min(p1.y, p2.y) - dist);
+		const int y2 = cellCoord(std::max(p1.y, p2.y) + dist);
+		for (int x = x1; x <= x2; ++x)
+			for (int y = y1; y <= y2; ++y)
+				func(cellKey(x, y));
+	}
+
+	template<typename T>
+	vector<T*> objectsNear(
+		const std::unordered_map<int64_t, vector<T*>>& cells,
+		Vec2d                                          p1,
+		Vec2d                                          p2,
+		double                                         dist) const
+	{
+		vector<T*> objects;
+		forEachCell(p1, p2, dist, [&](int64_t key) {
+			if (auto i = cells.find(key); i != cells.end())
+				objects.insert(objects.end(), i->second.begin(), i->second.end());
+		});
+
+		// Sort by index so objects are checked in the same order as they
+		// would be when going through the whole map, and remove duplicates
+		// (objects covering multiple cells)
+		std::sort(objects.begin(), objects.end(), [](T* a, T* b) { return a->index() < b->index(); });
+		objects.erase(std::unique(objects.begin(), objects.end()), objects.end());
+
+		return objects;
+	}
+};
+} // namespace
 
 
 // -----------------------------------------------------------------------------
@@ -541,7 +636,7 @@ MapVertex* SLADEMap::createVertex(Vec2d pos, double split_dist)
 		return overlap;
 
 	// Create the vertex
-	auto* nv = data_.addVertex(std::make_unique<MapVertex>(pos));
+	auto* nv = data_.addVertex(pos);
 
 	// Check if this vertex splits any lines (if needed)
 	if (split_dist >= 0)
@@ -616,7 +711,7 @@ MapLine* SLADEMap::createLine(MapVertex* vertex1, MapVertex* vertex2, bool force
 			return existing;
 
 	// Create new line between vertices
-	auto* nl = data_.addLine(std::make_unique<MapLine>(vertex1, vertex2, nullptr, nullptr));
+	auto* nl = data_.addLine(vertex1, vertex2, nullptr, nullptr);
 
 	// Connect line to vertices
 	vertex1->connectLine(nl);
@@ -634,7 +729,7 @@ MapLine* SLADEMap::createLine(MapVertex* vertex1, MapVertex* vertex2, bool force
 MapThing* SLADEMap::createThing(Vec2d pos, int type)
 {
 	// Create the thing
-	return data_.addThing(std::make_unique<MapThing>(pos, type));
+	return data_.addThing(pos, type);
 }
 
 // -----------------------------------------------------------------------------
@@ -642,7 +737,7 @@ MapThing* SLADEMap::createThing(Vec2d pos, int type)
 // -----------------------------------------------------------------------------
 MapSector* SLADEMap::createSector()
 {
-	return data_.addSector(std::make_unique<MapSector>());
+	return data_.addSector();
 }
 
 // -----------------------------------------------------------------------------
@@ -654,7 +749,7 @@ MapSide* SLADEMap::createSide(MapSector* sector)
 	if (!sector)
 		return nullptr;
 
-	return data_.addSide(std::make_unique<MapSide>(sector));
+	return data_.addSide(sector);
 }
 
 // -----------------------------------------------------------------------------
@@ -781,7 +876,7 @@ MapLine* SLADEMap::splitLine(MapLine* line, MapVertex* vertex)
 	}
 
 	// Create and add new line
-	auto* nl = data_.addLine(std::make_unique<MapLine>(vertex, v2, s1, s2));
+	auto* nl = data_.addLine(vertex, v2, s1, s2);
 	nl->copy(line);
 	nl->setModified();
 
@@ -999,32 +1094,82 @@ bool SLADEMap::mergeArch(const vector<MapVertex*>& vertices)
 	auto*          last_vertex = this->vertices().last();
 	auto*          last_line   = lines().last();
 
-	// Merge vertices
-	vector<MapVertex*> merged_vertices;
+	// Merge vertices. All vertices at each position are merged into the one with
+	// the lowest index (as mergeVerticesPoint does), but the vertices at every
+	// position are found in a single pass through the map
+	std::map<std::pair<double, double>, vector<MapVertex*>> vertices_at;
+	vector<std::pair<double, double>>                       positions;
 	for (const auto* vertex : vertices)
-		if (auto* v = mergeVerticesPoint(vertex->position_))
-			VECTOR_ADD_UNIQUE(merged_vertices, v);
+	{
+		positions.emplace_back(vertex->position_.x, vertex->position_.y);
+		vertices_at[positions.back()];
+	}
+	for (auto* vertex : this->vertices())
+		if (auto i = vertices_at.find({ vertex->position_.x, vertex->position_.y }); i != vertices_at.end())
+			i->second.push_back(vertex);
+
+	vector<MapVertex*>             merged_vertices;
+	std::unordered_set<MapVertex*> merged_set;
+	for (const auto& position : positions)
+	{
+		auto& at_pos = vertices_at[position];
+		if (at_pos.empty())
+			continue;
+
+		// Indices change as vertices are removed, so get them at each merge
+		for (unsigned a = 1; a < at_pos.size(); a++)
+			mergeVertices(at_pos[0]->index_, at_pos[a]->index_);
+		at_pos.resize(1);
+
+		if (merged_set.insert(at_pos[0]).second)
+			merged_vertices.push_back(at_pos[0]);
+	}
+	geometry_updated_ = app::runTimer();
 
 	// Get all connected lines
-	vector<MapLine*> connected_lines;
+	vector<MapLine*>             connected_lines;
+	std::unordered_set<MapLine*> connected_set;
 	for (const auto* vertex : merged_vertices)
 		for (auto* connected_line : vertex->connected_lines_)
-			VECTOR_ADD_UNIQUE(connected_lines, connected_line);
+			if (connected_set.insert(connected_line).second)
+				connected_lines.push_back(connected_line);
+
+	// Nothing is removed from the map while splitting, so lines and vertices
+	// can be looked up in a grid rather than checking the whole map each time.
+	// Any lines created or changed by a split are (re)added to it
+	MergeArchGrid grid(lines(), this->vertices());
 
 	// Split lines (by vertices)
 	const double split_dist = 0.1;
 	// Split existing lines that vertices moved onto
 	for (auto* merged : merged_vertices)
-		splitLinesAt(merged, split_dist);
+	{
+		for (auto* line : grid.linesNear(merged->position_, split_dist))
+		{
+			// Skip line if it shares the vertex
+			if (line->v1() == merged || line->v2() == merged)
+				continue;
+
+			if (line->distanceTo(merged->position_) < split_dist)
+			{
+				log::info(
+					2,
+					"Vertex {} at ({:1.2f},{:1.2f}) splits line {}",
+					merged->index_,
+					merged->position_.x,
+					merged->position_.y,
+					line->index_);
+				grid.addLine(splitLine(line, merged));
+				grid.addLine(line);
+			}
+		}
+	}
 
 	// Split lines that moved onto existing vertices
 	for (unsigned a = 0; a < connected_lines.size(); a++)
 	{
-		const unsigned nvertices = nVertices();
-		for (unsigned b = 0; b < nvertices; b++)
+		for (auto* vertex : grid.verticesNear(connected_lines[a], split_dist))
 		{
-			auto* vertex = this->vertex(b);
-
 			// Skip line if it shares the vertex
 			if (connected_lines[a]->v1() == vertex || connected_lines[a]->v2() == vertex)
 				continue;
@@ -1032,7 +1177,10 @@ bool SLADEMap::mergeArch(const vector<MapVertex*>& vertices)
 			if (connected_lines[a]->distanceTo(vertex->position()) < split_dist)
 			{
 				connected_lines.push_back(splitLine(connected_lines[a], vertex));
-				VECTOR_ADD_UNIQUE(merged_vertices, vertex);
+				grid.addLine(connected_lines.back());
+				grid.addLine(connected_lines[a]);
+				if (merged_set.insert(vertex).second)
+					merged_vertices.push_back(vertex);
 			}
 		}
 	}
@@ -1044,11 +1192,8 @@ bool SLADEMap::mergeArch(const vector<MapVertex*>& vertices)
 		auto* line1 = connected_lines[a];
 		seg1        = line1->seg();
 
-		const unsigned count = nLines();
-		for (unsigned b = 0; b < count; b++)
+		for (auto* line2 : grid.linesNear(line1, split_dist))
 		{
-			auto* line2 = line(b);
-
 			// Can't intersect if they share a vertex
 			if (line1->vertex1_ == line2->vertex1_ || line1->vertex1_ == line2->vertex2_
 				|| line2->vertex1_ == line1->vertex2_ || line2->vertex2_ == line1->vertex2_)
@@ -1063,10 +1208,12 @@ bool SLADEMap::mergeArch(const vector<MapVertex*>& vertices)
 				merged_vertices.push_back(nv);
 
 				// Split lines
-				splitLine(line1, nv);
-				connected_lines.push_back(lines().last());
-				splitLine(line2, nv);
-				connected_lines.push_back(lines().last());
+				connected_lines.push_back(splitLine(line1, nv));
+				grid.addLine(connected_lines.back());
+				grid.addLine(line1);
+				connected_lines.push_back(splitLine(line2, nv));
+				grid.addLine(connected_lines.back());
+				grid.addLine(line2);
 
 				LOG_DEBUG("Lines", line1, "and", line2, "intersect");
 
@@ -1078,38 +1225,43 @@ bool SLADEMap::mergeArch(const vector<MapVertex*>& vertices)
 
 	// Refresh connected lines
 	connected_lines.clear();
+	connected_set.clear();
 	for (const auto* vertex : merged_vertices)
 		for (auto* connected_line : vertex->connected_lines_)
-			VECTOR_ADD_UNIQUE(connected_lines, connected_line);
+			if (connected_set.insert(connected_line).second)
+				connected_lines.push_back(connected_line);
 
-	// Find overlapping lines
-	vector<MapLine*> remove_lines;
+	// Find overlapping lines. Only lines between the same two vertices can
+	// overlap, so group them by vertices first
+	std::map<std::pair<MapVertex*, MapVertex*>, vector<unsigned>> lines_between;
+	for (unsigned a = 0; a < connected_lines.size(); a++)
+		lines_between[std::minmax(connected_lines[a]->vertex1_, connected_lines[a]->vertex2_)].push_back(a);
+
+	vector<MapLine*>             remove_lines;
+	std::unordered_set<MapLine*> remove_set;
 	for (unsigned a = 0; a < connected_lines.size(); a++)
 	{
 		auto* line1 = connected_lines[a];
 
 		// Skip if removing already
-		if (VECTOR_EXISTS(remove_lines, line1))
+		if (remove_set.count(line1) > 0)
 			continue;
 
-		for (unsigned l = a + 1; l < connected_lines.size(); l++)
+		for (auto l : lines_between[std::minmax(line1->vertex1_, line1->vertex2_)])
 		{
 			auto* line2 = connected_lines[l];
 
-			// Skip if removing already
-			if (VECTOR_EXISTS(remove_lines, line2))
+			// Skip if not after line1, or removing already
+			if (l <= a || remove_set.count(line2) > 0)
 				continue;
 
-			if (line1->vertex1_ == line2->vertex1_ && line1->vertex2_ == line2->vertex2_
-				|| line1->vertex1_ == line2->vertex2_ && line1->vertex2_ == line2->vertex1_)
-			{
-				auto* remove_line = mergeOverlappingLines(line2, line1);
-				VECTOR_ADD_UNIQUE(remove_lines, remove_line);
+			auto* remove_line = mergeOverlappingLines(line2, line1);
+			if (remove_set.insert(remove_line).second)
+				remove_lines.push_back(remove_line);
 
-				// Don't check against any more lines if we just decided to remove this one
-				if (remove_line == line1)
-					break;
-			}
+			// Don't check against any more lines if we just decided to remove this one
+			if (remove_line == line1)
+				break;
 		}
 	}
 
@@ -1121,7 +1273,7 @@ bool SLADEMap::mergeArch(const vector<MapVertex*>& vertices)
 	}
 	for (unsigned a = 0; a < connected_lines.size(); a++)
 	{
-		if (VECTOR_EXISTS(remove_lines, connected_lines[a]))
+		if (remove_set.count(connected_lines[a]) > 0)
 		{
 			connected_lines[a] = connected_lines.back();
 			connected_lines.pop_back();
@@ -126,6 +126,22 @@ shared_ptr<ArchiveEntry> archiveFindLast(Archive& self, Archive::SearchOptions&
 	return found ? found->getShared() : nullptr;
 }
 
+// -----------------------------------------------------------------------------
+// Wrapper for Archive::findDuplicateEntries that returns shared pointers
+// -----------------------------------------------------------------------------
+vector<vector<shared_ptr<ArchiveEntry>>> archiveFindDuplicateEntries(Archive& self)
+{
+	vector<vector<shared_ptr<ArchiveEntry>>> groups;
+	for (const auto& group : self.findDuplicateEntries())
+	{
+		auto& shared = groups.emplace_back();
+		for (const auto& entry : group)
+			shared.push_back(entry->getShared());
+	}
+
+	return groups;
+}
+
 // -----------------------------------------------------------------------------
 // Wrapper for Archive::findAll that returns shared pointers
 // -----------------------------------------------------------------------------
@@ -206,9 +222,10 @@ void registerArchive(sol::state& lua)
 	lua_archive["Save"]                   = sol::overload(
         [](Archive& self) { return std::make_tuple(self.save(), global::error); },
         [](Archive& self, const string& filename) { return std::make_tuple(self.save(filename), global::error); });
-	lua_archive["FindFirst"] = &archiveFindFirst;
-	lua_archive["FindLast"]  = &archiveFindLast;
-	lua_archive["FindAll"]   = &archiveFindAll;
+	lua_archive["FindFirst"]            = &archiveFindFirst;
+	lua_archive["FindLast"]             = &archiveFindLast;
+	lua_archive["FindAll"]              = &archiveFindAll;
+	lua_archive["FindDuplicateEntries"] = &archiveFindDuplicateEntries;
 
 	// Register all subclasses
 	// (perhaps it'd be a good idea to make Archive not abstract and handle
@@ -286,6 +303,14 @@ shared_ptr<ArchiveDir> entryDir(ArchiveEntry& self)
 	return nullptr;
 }
 
+// -----------------------------------------------------------------------------
+// Returns the content hash of [self] as a hex string
+// -----------------------------------------------------------------------------
+string entryContentHash(ArchiveEntry& self)
+{
+	return fmt::format("{:016x}", self.contentHash());
+}
+
 // -----------------------------------------------------------------------------
 // Registers the ArchiveEntry type with lua
 // -----------------------------------------------------------------------------
@@ -303,6 +328,7 @@ void registerArchiveEntry(sol::state& lua)
 	lua_entry["index"] = sol::property(&ArchiveEntry::index);
 	lua_entry["crc32"] = sol::property([](ArchiveEntry& self) { return misc::crc(self.rawData(), self.size()); });
 	lua_entry["data"]  = sol::property([](ArchiveEntry& self) { return &self.data(); });
+	lua_entry["contentHash"]   = sol::property(&entryContentHash);
 	lua_entry["parentArchive"] = sol::property(&entryParent);
 	lua_entry["parentDir"]     = sol::property(&entryDir);
 
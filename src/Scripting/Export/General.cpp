@@ -31,6 +31,7 @@
 //
 // -----------------------------------------------------------------------------
 #include "Main.h"
+#include "App.h"
 #include "Archive/Archive.h"
 #include "Graphics/Palette/Palette.h"
 #include "MainEditor/MainEditor.h"
@@ -282,6 +283,7 @@ void registerAppNamespace(sol::state& lua)
 	app["ShowArchive"]    = &showArchive;
 	app["ShowEntry"]      = &maineditor::openEntry;
 	app["MapEditor"]      = &mapeditor::editContext;
+	app["RunTime"]        = &slade::app::runTimer;
 }
 
 } // namespace slade::lua
@@ -78,6 +78,27 @@ void registerImageConvertOptionsType(sol::state& lua)
 	lua_copt["pixelFormat"]    = &SIFormat::ConvertOptions::col_format;
 }
 
+// -----------------------------------------------------------------------------
+// Converts all images in [images] to be writable as [format] with [opt] (in
+// parallel), returns a table of booleans indicating which images were converted
+// -----------------------------------------------------------------------------
+sol::table imageFormatConvertAllWritable(SIFormat& format, sol::table images, const SIFormat::ConvertOptions& opt)
+{
+	vector<SIFormat::ConvertItem> items(images.size());
+	for (unsigned a = 0; a < items.size(); ++a)
+	{
+		items[a].image = images.get<sol::optional<SImage*>>(a + 1).value_or(nullptr);
+		items[a].opt   = opt;
+	}
+
+	format.convertAllWritable(items);
+
+	auto converted = lua::state().create_table();
+	for (unsigned a = 0; a < items.size(); ++a)
+		converted[a + 1] = items[a].converted;
+	return converted;
+}
+
 // -----------------------------------------------------------------------------
 // Registers the ImageFormat (SIFormat) type with lua
 // -----------------------------------------------------------------------------
@@ -103,6 +124,7 @@ void registerImageFormatType(sol::state& lua)
 	lua_iformat["CanWrite"]            = &SIFormat::canWrite;
 	lua_iformat["CanWritePixelFormat"] = &SIFormat::canWriteType;
 	lua_iformat["ConvertWritable"]     = &SIFormat::convertWritable;
+	lua_iformat["ConvertAllWritable"]  = &imageFormatConvertAllWritable;
 	lua_iformat["LoadImage"]           = sol::overload(
         &SIFormat::loadImage, [](SIFormat& self, SImage& image, MemChunk& data) { self.loadImage(image, data); });
 	lua_iformat["SaveImage"] = sol::overload(
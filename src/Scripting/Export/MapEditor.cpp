@@ -95,6 +95,150 @@ void objectSetStringProperty(MapObject& self, string_view key, string_view value
 		log::warning("{} string property \"{}\" can not be modified via script", self.typeName(), key);
 }
 
+// -----------------------------------------------------------------------------
+// A lightweight view of one of a map's object lists (vertices, lines etc.),
+// exported to lua in place of a table of the list's objects. Objects are
+// looked up from the list as they are accessed rather than copied up-front, so
+// the view is cheap to get and always reflects the current state of the map
+// -----------------------------------------------------------------------------
+template<class T> struct MapObjectListView
+{
+	const MapObjectList<T>* list;
+
+	T*       at(int index) const { return index > 0 ? list->at(index - 1) : nullptr; }
+	unsigned size() const { return list->size(); }
+};
+
+// -----------------------------------------------------------------------------
+// Returns a view of the map object [list]
+// -----------------------------------------------------------------------------
+template<class T> MapObjectListView<T> mapObjectListView(const MapObjectList<T>& list)
+{
+	return { &list };
+}
+
+// -----------------------------------------------------------------------------
+// Returns the next index and object after [key] in [view], for lua's pairs
+// -----------------------------------------------------------------------------
+template<class T>
+std::tuple<sol::object, sol::object> mapObjectListNext(
+	const MapObjectListView<T>& view,
+	sol::optional<int>          key,
+	sol::this_state             s)
+{
+	int index = key ? *key + 1 : 1;
+	if (index < 1 || index > static_cast<int>(view.size()))
+		return { sol::lua_nil, sol::lua_nil };
+
+	return { sol::make_object(s, index), sol::make_object(s, view.at(index)) };
+}
+
+// -----------------------------------------------------------------------------
+// Returns a table of the [key] property values of all objects in [view], as
+// read by the MapObject [get] function
+// -----------------------------------------------------------------------------
+template<class T, typename V>
+sol::table mapObjectListProperties(
+	const MapObjectListView<T>& view,
+	string_view                 key,
+	V (MapObject::*get)(string_view))
+{
+	auto n_objects = view.size();
+	auto values    = lua::state().create_table(n_objects, 0);
+	for (unsigned a = 0; a < n_objects; ++a)
+		values[a + 1] = ((*view.list)[a]->*get)(key);
+
+	return values;
+}
+
+// -----------------------------------------------------------------------------
+// Sets the [key] property on all objects in [view] via the MapObject [set]
+// function. If [value] is a table, each object is set to the value at its
+// index in the table (objects with no value in the table are left unchanged),
+// otherwise all objects are set to [value].
+// Whether the property can be modified by scripts is only checked once, since
+// all objects in the list are of the same type
+// -----------------------------------------------------------------------------
+template<class T, typename V>
+void mapObjectListSetProperties(
+	const MapObjectListView<T>& view,
+	string_view                 key,
+	const sol::object&          value,
+	void (MapObject::*set)(string_view, V),
+	string_view type_name)
+{
+	if (view.size() == 0)
+		return;
+
+	if (!view.list->first()->scriptCanModifyProp(key))
+	{
+		log::warning(
+			"{} {} property \"{}\" can not be modified via script", view.list->first()->typeName(), type_name, key);
+		return;
+	}
+
+	if (value.get_type() == sol::type::table)
+	{
+		auto values = value.as<sol::table>();
+		for (unsigned a = 0; a < view.size(); ++a)
+			if (auto v = values.get<sol::optional<V>>(a + 1))
+				((*view.list)[a]->*set)(key, *v);
+	}
+	else
+	{
+		auto v = value.as<V>();
+		for (auto* object : *view.list)
+			(object->*set)(key, v);
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Registers the list view type for map objects of type [T] with lua as [name]
+// -----------------------------------------------------------------------------
+template<class T> void registerMapObjectListView(sol::state& lua, const char* name)
+{
+	using View = MapObjectListView<T>;
+
+	auto lua_view = lua.new_usertype<View>(name, "new", sol::no_constructor);
+
+	// Meta functions (#list, list[index], pairs/ipairs)
+	// -------------------------------------------------------------------------
+	lua_view[sol::meta_function::length] = &View::size;
+	lua_view[sol::meta_function::index]  = [](const View& self, const sol::object& key) -> T* {
+		return key.is<int>() ? self.at(key.as<int>()) : nullptr;
+	};
+	lua_view[sol::meta_function::pairs] = [](const View& self) {
+		return std::make_tuple(&mapObjectListNext<T>, self, sol::lua_nil);
+	};
+
+	// Bulk property access
+	// -------------------------------------------------------------------------
+	lua_view["BoolProperties"] = [](const View& self, string_view key) {
+		return mapObjectListProperties(self, key, &MapObject::boolProperty);
+	};
+	lua_view["IntProperties"] = [](const View& self, string_view key) {
+		return mapObjectListProperties(self, key, &MapObject::intProperty);
+	};
+	lua_view["FloatProperties"] = [](const View& self, string_view key) {
+		return mapObjectListProperties(self, key, &MapObject::floatProperty);
+	};
+	lua_view["StringProperties"] = [](const View& self, string_view key) {
+		return mapObjectListProperties(self, key, &MapObject::stringProperty);
+	};
+	lua_view["SetBoolProperties"] = [](const View& self, string_view key, const sol::object& value) {
+		mapObjectListSetProperties(self, key, value, &MapObject::setBoolProperty, "boolean");
+	};
+	lua_view["SetIntProperties"] = [](const View& self, string_view key, const sol::object& value) {
+		mapObjectListSetProperties(self, key, value, &MapObject::setIntProperty, "integer");
+	};
+	lua_view["SetFloatProperties"] = [](const View& self, string_view key, const sol::object& value) {
+		mapObjectListSetProperties(self, key, value, &MapObject::setFloatProperty, "float");
+	};
+	lua_view["SetStringProperties"] = [](const View& self, string_view key, const sol::object& value) {
+		mapObjectListSetProperties(self, key, value, &MapObject::setStringProperty, "string");
+	};
+}
+
 // -----------------------------------------------------------------------------
 // Registers the Map type with lua
 // -----------------------------------------------------------------------------
@@ -107,11 +251,11 @@ void registerSLADEMap(sol::state& lua)
 	// -------------------------------------------------------------------------
 	lua_map["name"]          = sol::property(&SLADEMap::mapName);
 	lua_map["udmfNamespace"] = sol::property(&SLADEMap::udmfNamespace);
-	lua_map["vertices"]      = sol::property([](SLADEMap& self) { return self.vertices().all(); });
-	lua_map["linedefs"]      = sol::property([](SLADEMap& self) { return self.lines().all(); });
-	lua_map["sidedefs"]      = sol::property([](SLADEMap& self) { return self.sides().all(); });
-	lua_map["sectors"]       = sol::property([](SLADEMap& self) { return self.sectors().all(); });
-	lua_map["things"]        = sol::property([](SLADEMap& self) { return self.things().all(); });
+	lua_map["vertices"]      = sol::property([](SLADEMap& self) { return mapObjectListView(self.vertices()); });
+	lua_map["linedefs"]      = sol::property([](SLADEMap& self) { return mapObjectListView(self.lines()); });
+	lua_map["sidedefs"]      = sol::property([](SLADEMap& self) { return mapObjectListView(self.sides()); });
+	lua_map["sectors"]       = sol::property([](SLADEMap& self) { return mapObjectListView(self.sectors()); });
+	lua_map["things"]        = sol::property([](SLADEMap& self) { return mapObjectListView(self.things()); });
 }
 
 // -----------------------------------------------------------------------------
@@ -396,6 +540,11 @@ void registerMapEditorTypes(sol::state& lua)
 	registerMapSide(lua);
 	registerMapSector(lua);
 	registerMapThing(lua);
+	registerMapObjectListView<MapVertex>(lua, "MapVertexList");
+	registerMapObjectListView<MapLine>(lua, "MapLineList");
+	registerMapObjectListView<MapSide>(lua, "MapSideList");
+	registerMapObjectListView<MapSector>(lua, "MapSectorList");
+	registerMapObjectListView<MapThing>(lua, "MapThingList");
 }
 
 } // namespace slade::lua
@@ -208,8 +208,8 @@ void lua::showErrorDialog(wxWindow* parent, string_view title, string_view messa
 	// Get script log messages since the last script was started
 	auto   log = log::since(script_start_time, log::MessageType::Script);
 	string output;
-	for (auto msg : log)
-		output += msg->formattedMessageLine() + "\n";
+	for (const auto& msg : log)
+		output += msg.formattedMessageLine() + "\n";
 
 	ExtMessageDialog dlg(parent ? parent : current_window, wxutil::strFromView(title));
 	dlg.setMessage(wxutil::strFromView(message));
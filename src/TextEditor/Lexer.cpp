@@ -46,6 +46,80 @@ using namespace slade;
 CVAR(Bool, debug_lexer, false, CVar::Flag::Secret)
 
 
+// -----------------------------------------------------------------------------
+//
+// Local Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// -----------------------------------------------------------------------------
+// Starts styling text in [editor] from [pos]
+// -----------------------------------------------------------------------------
+void lexerStartStyling(TextEditorCtrl* editor, int pos)
+{
+#if wxMAJOR_VERSION < 3 || (wxMAJOR_VERSION == 3 && wxMINOR_VERSION < 1) \
+	|| (wxMAJOR_VERSION == 3 && wxMINOR_VERSION == 1 && wxRELEASE_NUMBER == 0)
+	editor->StartStyling(pos, 31);
+#else
+	editor->StartStyling(pos);
+#endif
+}
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// Lexer::LineInfo Struct Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Returns the info for [line] in [editor]. Line state bits are:
+// 0-3:   comment_start
+// 4-7:   comment_end
+// 8:     lexed
+// 9:     has_word
+// 10-19: fold_increment (signed)
+// 20-31: fold_depth
+// -----------------------------------------------------------------------------
+Lexer::LineInfo Lexer::LineInfo::get(const TextEditorCtrl* editor, int line)
+{
+	auto value = static_cast<u32>(editor->GetLineState(line));
+
+	LineInfo info;
+	info.comment_start  = value & 0xF;
+	info.comment_end    = (value >> 4) & 0xF;
+	info.lexed          = value & (1 << 8);
+	info.has_word       = value & (1 << 9);
+	info.fold_increment = (value >> 10) & 0x3FF;
+	info.fold_depth     = value >> 20;
+
+	if (info.fold_increment & 0x200)
+		info.fold_increment -= 0x400;
+
+	return info;
+}
+
+// -----------------------------------------------------------------------------
+// Sets the info for [line] in [editor]
+// -----------------------------------------------------------------------------
+void Lexer::LineInfo::set(TextEditorCtrl* editor, int line) const
+{
+	auto increment = static_cast<u32>(std::clamp(fold_increment, -0x200, 0x1FF));
+	auto depth     = static_cast<u32>(std::clamp(fold_depth, 0, 0xFFF));
+
+	u32 value = (comment_start & 0xF) | (comment_end & 0xF) << 4 | (increment & 0x3FF) << 10 | depth << 20;
+	if (lexed)
+		value |= 1 << 8;
+	if (has_word)
+		value |= 1 << 9;
+
+	editor->SetLineState(line, static_cast<int>(value));
+}
+
+
 // -----------------------------------------------------------------------------
 //
 // Lexer Class Functions
@@ -57,7 +131,6 @@ CVAR(Bool, debug_lexer, false, CVar::Flag::Secret)
 // Lexer class constructor
 // -----------------------------------------------------------------------------
 Lexer::Lexer() :
-	whitespace_chars_{ { ' ', '\n', '\r', '\t' } },
 	re_int1_{ "^[+-]?[0-9]+[0-9]*$", wxRE_DEFAULT | wxRE_NOSUB },
 	re_int2_{ "^0[0-9]+$", wxRE_DEFAULT | wxRE_NOSUB },
 	re_int3_{ "^0x[0-9A-Fa-f]+$", wxRE_DEFAULT | wxRE_NOSUB },
@@ -77,7 +150,9 @@ void Lexer::loadLanguage(TextLanguage* language)
 {
 	language_ = language;
 	clearWords();
-	comment_blocks_.clear();
+	fold_words_.clear();
+	pp_fold_words_.clear();
+	updateCharClasses();
 
 	if (!language)
 		return;
@@ -94,140 +169,119 @@ void Lexer::loadLanguage(TextLanguage* language)
 	for (const auto& word : language->wordListSorted(TextLanguage::WordType::Keyword))
 		addWord(word, Lexer::Style::Keyword);
 
+	// Load folding words (block begin takes priority if a word is in both)
+	for (const auto& word : language->wordBlockBegin())
+		fold_words_.emplace(word, 1);
+	for (const auto& word : language->wordBlockEnd())
+		fold_words_.emplace(word, -1);
+	for (const auto& word : language->ppBlockBegin())
+		pp_fold_words_.emplace(word, 1);
+	for (const auto& word : language->ppBlockEnd())
+		pp_fold_words_.emplace(word, -1);
+
 	// Load language info
 	preprocessor_char_ = language->preprocessor().empty() ? (char)0 : (char)language->preprocessor()[0];
 }
 
 // -----------------------------------------------------------------------------
-// Performs text styling on [editor], for characters from [start] to [end].
-// Returns true if the next line needs to be styled (eg. for multi-line
-// comments)
-// ----------------------------------------------------------------------------
-void Lexer::doStyling(TextEditorCtrl* editor, int start, int end)
+// Performs text styling on [editor], for lines [line_start] to [line_end].
+// Lines that haven't been modified since they were last styled, and start in
+// the same state (ie. within the same block comment or not), are skipped -
+// so after an edit only the lines up to where the lexer state converges with
+// the previous styling are actually restyled.
+// Returns the last line that was restyled (or [line_start] - 1 if none were)
+// -----------------------------------------------------------------------------
+int Lexer::doStyling(TextEditorCtrl* editor, int line_start, int line_end)
 {
-	if (start < 0)
-		start = 0;
-
-	int        line = editor->LineFromPosition(start);
-	LexerState state{ start, end, line, State::Unknown, 0, 0, false, editor };
+	// Clear line info if needed (eg. the language was changed)
+	if (reset_lines_)
+	{
+		invalidateLines(editor, 0, editor->GetLineCount() - 1);
+		reset_lines_ = false;
+	}
 
-#if wxMAJOR_VERSION < 3 || (wxMAJOR_VERSION == 3 && wxMINOR_VERSION < 1) \
-	|| (wxMAJOR_VERSION == 3 && wxMINOR_VERSION == 1 && wxRELEASE_NUMBER == 0)
-	editor->StartStyling(start, 31);
-#else
-	editor->StartStyling(start);
-#endif
+	line_start = std::max(line_start, 0);
+	line_end   = std::min(line_end, editor->GetLineCount() - 1);
 
 	if (debug_lexer)
-		log::debug(wxString::Format("START STYLING FROM %d TO %d (LINE %d)", start, end, line + 1));
+		log::debug("START STYLING FROM LINE {} TO {}", line_start + 1, line_end + 1);
 
-	bool done = false;
-	while (!done)
+	// Continue from the state at the end of the previous line
+	int comment      = line_start > 0 ? LineInfo::get(editor, line_start - 1).comment_end : 0;
+	int last_styled  = line_start - 1;
+	int styles_start = 0;
+
+	// Applies all styles for the text processed so far to the editor
+	const auto apply_styles = [&]() {
+		if (styles_.empty())
+			return;
+
+		lexerStartStyling(editor, styles_start);
+		editor->SetStylingEx(styles_.size(), styles_.data());
+		styles_.clear();
+	};
+
+	styles_.clear();
+	for (int line = line_start; line <= line_end; ++line)
 	{
-		auto cb = isWithinComment(state.position);
-		if (cb >= 0)
+		auto info = LineInfo::get(editor, line);
+
+		// Skip the line if its existing styling is still valid
+		if (info.lexed && info.comment_start == comment)
 		{
-			editor->SetStyling(comment_blocks_[cb].end_pos - state.position, Style::Comment);
-			state.position = comment_blocks_[cb].end_pos;
-			state.line     = editor->LineFromPosition(state.position);
-			state.state    = State::Unknown;
+			apply_styles();
+			comment = info.comment_end;
 			continue;
 		}
 
-		switch (state.state)
-		{
-		case State::Whitespace: done = processWhitespace(state); break;
-		case State::String: done = processString(state); break;
-		case State::Char: done = processChar(state); break;
-		case State::Word: done = processWord(state); break;
-		case State::Operator: done = processOperator(state); break;
-		default: done = processUnknown(state); break;
-		}
+		// Get line text
+		auto position = editor->PositionFromLine(line);
+		auto length   = editor->GetLineLength(line);
+		if (styles_.empty())
+			styles_start = position;
+
+		// Style line
+		LexerState state{ {}, 0, State::Unknown, 0, comment, 0, false, editor };
+		if (length > 0)
+			state.text = { editor->GetRangePointer(position, length), static_cast<size_t>(length) };
+		styleLine(state);
+
+		// Update line info
+		info.comment_start  = comment;
+		info.comment_end    = state.comment;
+		info.fold_increment = state.fold_increment;
+		info.has_word       = state.has_word;
+		info.lexed          = true;
+		info.set(editor, line);
+
+		comment     = state.comment;
+		last_styled = line;
 	}
+	apply_styles();
 
-	// Set current & next line's info
-	lines_[line].fold_increment = state.fold_increment;
-	lines_[line].has_word       = state.has_word;
+	// Everything up to the end of [line_end] is now styled (including any
+	// skipped lines)
+	auto end = line_end + 1 < editor->GetLineCount() ? editor->PositionFromLine(line_end + 1) : editor->GetLength();
+	if (editor->GetEndStyled() < end)
+		lexerStartStyling(editor, end);
+
+	return last_styled;
 }
 
-// ----------------------------------------------------------------------------
-// Updates and styles comments in [editor], for characters from [start] to
-// [end].
-// ----------------------------------------------------------------------------
-void Lexer::updateComments(TextEditorCtrl* editor, int start, int end)
+// -----------------------------------------------------------------------------
+// Marks lines [line_start] to [line_end] in [editor] as modified, so they
+// will be restyled the next time styling is needed
+// -----------------------------------------------------------------------------
+void Lexer::invalidateLines(TextEditorCtrl* editor, int line_start, int line_end) const
 {
-	if (!language_)
-		return;
-
-	// Block comment handling
-	auto& block_begin = language_->commentBeginL();
-	auto& block_end   = language_->commentEndL();
-	int   token_index;
-
-	// Extend start/end if either is within a comment
-	auto cb = isWithinComment(start);
-	if (cb >= 0)
-		start = comment_blocks_[cb].start_pos;
-	cb = isWithinComment(end);
-	if (cb >= 0)
-		end = comment_blocks_[cb].end_pos;
-
-	// Remove any existing comment blocks within start->end
-	for (int i = comment_blocks_.size() - 1; i >= 0; --i)
+	for (int line = line_start; line <= line_end; ++line)
 	{
-		if (comment_blocks_[i].start_pos >= start && comment_blocks_[i].end_pos <= end)
-			comment_blocks_.erase(comment_blocks_.begin() + i);
-	}
-
-	// Do not look for comments if no language is loaded
-	if (!language_)
-		return;
-
-	// Scan text
-	auto pos = start;
-	while (pos < end)
-	{
-		// Skip quoted strings
-		if (editor->GetCharAt(pos) == '\"')
-		{
-			while (pos++ < end)
-				if (editor->GetCharAt(pos) == '\"')
-					break;
-
-			++pos;
-			continue;
-		}
-
-		// Line comment
-		if (checkToken(editor, pos, language_->lineCommentL()))
-		{
-			const auto l_end = editor->GetLineEndPosition(editor->LineFromPosition(pos)) + 1;
-			comment_blocks_.push_back({ pos, l_end });
-			pos = l_end;
-			continue;
-		}
-
-		// Block comment
-		if (checkToken(editor, pos, block_begin, &token_index))
+		auto info = LineInfo::get(editor, line);
+		if (info.lexed)
 		{
-			auto& end_token = block_end[token_index];
-			auto  cb_start  = pos;
-			pos += block_begin[token_index].size();
-			while (pos < end)
-			{
-				if (checkToken(editor, pos, end_token))
-				{
-					pos += end_token.size();
-					break;
-				}
-				++pos;
-			}
-
-			comment_blocks_.push_back({ cb_start, pos });
-			continue;
+			info.lexed = false;
+			info.set(editor, line);
 		}
-
-		++pos;
 	}
 }
 
@@ -236,7 +290,8 @@ void Lexer::updateComments(TextEditorCtrl* editor, int start, int end)
 // -----------------------------------------------------------------------------
 void Lexer::addWord(string_view word, int style)
 {
-	word_list_[language_->caseSensitive() ? string{ word } : strutil::lower(word)].style = (char)style;
+	word_list_[language_->caseSensitive() ? string{ word } : strutil::lower(word)] = (char)style;
+	resetLineInfo();
 }
 
 // -----------------------------------------------------------------------------
@@ -245,21 +300,19 @@ void Lexer::addWord(string_view word, int style)
 // -----------------------------------------------------------------------------
 void Lexer::styleWord(LexerState& state, string_view word)
 {
-	string word_str{ word };
-	if (!language_->caseSensitive())
-		strutil::lowerIP(word_str);
+	const auto& key = wordKey(word, !language_->caseSensitive());
 
-	if (word_list_[word_str].style > 0)
-		state.editor->SetStyling(word.length(), word_list_[word_str].style);
-	else if (strutil::startsWith(word_str, language_->preprocessor()))
-		state.editor->SetStyling(word.length(), Style::Preprocessor);
+	if (auto it = word_list_.find(key); it != word_list_.end() && it->second > 0)
+		setStyle(word.length(), it->second);
+	else if (strutil::startsWith(key, language_->preprocessor()))
+		setStyle(word.length(), Style::Preprocessor);
 	else
 	{
-		// Check for number
-		if (strutil::isInteger(word) || strutil::isFloat(word))
-			state.editor->SetStyling(word.length(), Style::Number);
+		// Check for number (can only be a number if it starts with a digit)
+		if (isdigit(static_cast<u8>(word[0])) && (strutil::isInteger(key) || strutil::isFloat(key)))
+			setStyle(word.length(), Style::Number);
 		else
-			state.editor->SetStyling(word.length(), Style::Default);
+			setStyle(word.length(), Style::Default);
 	}
 }
 
@@ -268,9 +321,8 @@ void Lexer::styleWord(LexerState& state, string_view word)
 // -----------------------------------------------------------------------------
 void Lexer::setWordChars(string_view chars)
 {
-	word_chars_.clear();
-	for (auto&& a : chars)
-		word_chars_.push_back((unsigned char)a);
+	word_chars_ = chars;
+	updateCharClasses();
 }
 
 // -----------------------------------------------------------------------------
@@ -278,39 +330,74 @@ void Lexer::setWordChars(string_view chars)
 // -----------------------------------------------------------------------------
 void Lexer::setOperatorChars(string_view chars)
 {
-	operator_chars_.clear();
-	for (auto&& a : chars)
-		operator_chars_.push_back((unsigned char)a);
+	operator_chars_ = chars;
+	updateCharClasses();
 }
 
 // -----------------------------------------------------------------------------
-// Process unknown characters, updating [state].
-// Returns true if the end of the current text range was reached
+// Sets whether to fold preprocessor blocks
 // -----------------------------------------------------------------------------
-bool Lexer::processUnknown(LexerState& state)
+void Lexer::foldPreprocessor(bool fold)
 {
-	int    u_length = 0;
-	bool   end      = false;
-	bool   pp       = false;
-	string block_begin;
-	string block_end;
+	if (fold != fold_preprocessor_)
+	{
+		fold_preprocessor_ = fold;
+		resetLineInfo();
+	}
+}
 
-	if (language_)
+// -----------------------------------------------------------------------------
+// Styles the line of text in [state]
+// -----------------------------------------------------------------------------
+void Lexer::styleLine(LexerState& state)
+{
+	bool done = false;
+	while (!done)
 	{
-		block_begin = language_->blockBegin();
-		block_end   = language_->blockEnd();
+		// Within block comment
+		if (state.comment > 0)
+		{
+			done = processBlockComment(state);
+			continue;
+		}
+
+		switch (state.state)
+		{
+		case State::Whitespace: done = processWhitespace(state); break;
+		case State::String: done = processString(state); break;
+		case State::Char: done = processChar(state); break;
+		case State::Word: done = processWord(state); break;
+		case State::Operator: done = processOperator(state); break;
+		case State::LineComment: done = processLineComment(state); break;
+		default: done = processUnknown(state); break;
+		}
 	}
+}
+
+// -----------------------------------------------------------------------------
+// Process unknown characters, updating [state].
+// Returns true if the end of the current line was reached
+// -----------------------------------------------------------------------------
+bool Lexer::processUnknown(LexerState& state)
+{
+	int  u_length = 0;
+	bool end      = false;
+	bool pp       = false;
+
+	static const string no_block;
+	const auto&         block_begin = language_ ? language_->blockBegin() : no_block;
+	const auto&         block_end   = language_ ? language_->blockEnd() : no_block;
 
 	while (true)
 	{
 		// Check for end of line
-		if (state.position > state.end)
+		if (state.position >= state.text.size())
 		{
 			end = true;
 			break;
 		}
 
-		int c = state.editor->GetCharAt(state.position);
+		auto c = state.text[state.position];
 
 		// Start of string
 		if (c == '"')
@@ -330,6 +417,10 @@ bool Lexer::processUnknown(LexerState& state)
 			continue;
 		}
 
+		// Start of comment
+		else if (isClass(c, CharClass::CommentStart) && checkComment(state))
+			break;
+
 		// Start of char
 		else if (c == '\'')
 		{
@@ -341,7 +432,7 @@ bool Lexer::processUnknown(LexerState& state)
 		}
 
 		// Whitespace
-		else if (VECTOR_EXISTS(whitespace_chars_, c))
+		else if (isClass(c, CharClass::Whitespace))
 		{
 			state.state = State::Whitespace;
 			state.position++;
@@ -350,7 +441,7 @@ bool Lexer::processUnknown(LexerState& state)
 		}
 
 		// Preprocessor
-		else if (c == (unsigned char)language_->preprocessor()[0])
+		else if (c == preprocessor_char_)
 		{
 			pp = true;
 			u_length++;
@@ -359,7 +450,7 @@ bool Lexer::processUnknown(LexerState& state)
 		}
 
 		// Operator
-		else if (VECTOR_EXISTS(operator_chars_, c))
+		else if (isClass(c, CharClass::Operator))
 		{
 			state.position++;
 			state.state    = State::Operator;
@@ -369,7 +460,7 @@ bool Lexer::processUnknown(LexerState& state)
 		}
 
 		// Word
-		else if (VECTOR_EXISTS(word_chars_, c))
+		else if (isClass(c, CharClass::Word))
 		{
 			// Include preprocessor character if it was the previous character
 			if (pp)
@@ -385,15 +476,13 @@ bool Lexer::processUnknown(LexerState& state)
 		}
 
 		// Block begin
-		else if (checkToken(state.editor, state.position, block_begin))
+		else if (!block_begin.empty() && strutil::startsWith(state.text.substr(state.position), block_begin))
 			state.fold_increment++;
 
 		// Block end
-		else if (checkToken(state.editor, state.position, block_end))
+		else if (!block_end.empty() && strutil::startsWith(state.text.substr(state.position), block_end))
 			state.fold_increment--;
 
-		// if (debug_lexer)
-		// 	log::debug(wxString::Format("unknown char '%c' (%d)", c, c));
 		u_length++;
 		state.position++;
 		pp = false;
@@ -401,38 +490,32 @@ bool Lexer::processUnknown(LexerState& state)
 
 	if (debug_lexer && u_length > 0)
 		log::debug(wxString::Format("unknown: %d", u_length));
-	state.editor->SetStyling(u_length, Style::Default);
+	setStyle(u_length, Style::Default);
 
 	return end;
 }
 
 // ----------------------------------------------------------------------------
 // Process word characters, updating [state].
-// Returns true if the end of the current text range was reached
+// Returns true if the end of the current line was reached
 // -----------------------------------------------------------------------------
 bool Lexer::processWord(LexerState& state)
 {
-	vector<char> word;
-	bool         end = false;
-
-	// Add first letter
-	word.push_back((char)state.editor->GetCharAt(state.position++));
+	auto start = state.position++;
+	bool end   = false;
 
 	while (true)
 	{
 		// Check for end of line
-		if (state.position > state.end)
+		if (state.position >= state.text.size())
 		{
 			end = true;
 			break;
 		}
 
-		char c = (char)state.editor->GetCharAt(state.position);
-		if (VECTOR_EXISTS(word_chars_, c))
-		{
-			word.push_back(c);
+		auto c = state.text[state.position];
+		if (isClass(c, CharClass::Word) && !(isClass(c, CharClass::CommentStart) && checkComment(state, false)))
 			state.position++;
-		}
 		else
 		{
 			state.state = State::Unknown;
@@ -440,37 +523,24 @@ bool Lexer::processWord(LexerState& state)
 		}
 	}
 
-	// Get word as string
-	string word_string{ &word[0], word.size() };
-	auto   word_lower = strutil::lower(word_string);
+	auto word = state.text.substr(start, state.position - start);
 
-	// Check for preprocessor folding word
-	if (fold_preprocessor_ && word[0] == preprocessor_char_)
-	{
-		if (VECTOR_EXISTS(language_->ppBlockBegin(), word_lower))
-			state.fold_increment++;
-		else if (VECTOR_EXISTS(language_->ppBlockEnd(), word_lower))
-			state.fold_increment--;
-	}
-	else
-	{
-		if (VECTOR_EXISTS(language_->wordBlockBegin(), word_lower))
-			state.fold_increment++;
-		else if (VECTOR_EXISTS(language_->wordBlockEnd(), word_lower))
-			state.fold_increment--;
-	}
+	// Check for folding word
+	const auto& fold_words = fold_preprocessor_ && word[0] == preprocessor_char_ ? pp_fold_words_ : fold_words_;
+	if (auto it = fold_words.find(wordKey(word, true)); it != fold_words.end())
+		state.fold_increment += it->second;
 
 	if (debug_lexer)
-		log::debug("word: {}", word_string);
+		log::debug("word: {}", word);
 
-	styleWord(state, word_string);
+	styleWord(state, word);
 
 	return end;
 }
 
 // -----------------------------------------------------------------------------
 // Process string characters, updating [state].
-// Returns true if the end of the current text range was reached
+// Returns true if the end of the current line was reached
 // -----------------------------------------------------------------------------
 bool Lexer::processString(LexerState& state)
 {
@@ -479,15 +549,14 @@ bool Lexer::processString(LexerState& state)
 	while (true)
 	{
 		// Check for end of line
-		if (state.position > state.end)
+		if (state.position >= state.text.size())
 		{
 			end = true;
 			break;
 		}
 
 		// End of string
-		char c = (char)state.editor->GetCharAt(state.position);
-		if (c == '"')
+		if (state.text[state.position] == '"')
 		{
 			state.length++;
 			state.position++;
@@ -502,14 +571,14 @@ bool Lexer::processString(LexerState& state)
 	if (debug_lexer)
 		log::debug(wxString::Format("string: %lu", state.length));
 
-	state.editor->SetStyling(state.length, Style::String);
+	setStyle(state.length, Style::String);
 
 	return end;
 }
 
 // -----------------------------------------------------------------------------
 // Process char characters, updating [state].
-// Returns true if the end of the current text range was reached
+// Returns true if the end of the current line was reached
 // -----------------------------------------------------------------------------
 bool Lexer::processChar(LexerState& state)
 {
@@ -518,15 +587,14 @@ bool Lexer::processChar(LexerState& state)
 	while (true)
 	{
 		// Check for end of line
-		if (state.position > state.end)
+		if (state.position >= state.text.size())
 		{
 			end = true;
 			break;
 		}
 
 		// End of string
-		char c = (char)state.editor->GetCharAt(state.position);
-		if (c == '\'')
+		if (state.text[state.position] == '\'')
 		{
 			state.length++;
 			state.position++;
@@ -541,14 +609,14 @@ bool Lexer::processChar(LexerState& state)
 	if (debug_lexer)
 		log::debug(wxString::Format("char: %lu", state.length));
 
-	state.editor->SetStyling(state.length, Style::Char);
+	setStyle(state.length, Style::Char);
 
 	return end;
 }
 
 // -----------------------------------------------------------------------------
 // Process operator characters, updating [state].
-// Returns true if the end of the current text range was reached
+// Returns true if the end of the current line was reached
 // -----------------------------------------------------------------------------
 bool Lexer::processOperator(LexerState& state)
 {
@@ -557,14 +625,14 @@ bool Lexer::processOperator(LexerState& state)
 	while (true)
 	{
 		// Check for end of line
-		if (state.position > state.end)
+		if (state.position >= state.text.size())
 		{
 			end = true;
 			break;
 		}
 
-		char c = (char)state.editor->GetCharAt(state.position);
-		if (VECTOR_EXISTS(operator_chars_, c))
+		auto c = state.text[state.position];
+		if (isClass(c, CharClass::Operator) && !(isClass(c, CharClass::CommentStart) && checkComment(state, false)))
 		{
 			state.length++;
 			state.position++;
@@ -579,14 +647,14 @@ bool Lexer::processOperator(LexerState& state)
 	if (debug_lexer)
 		log::debug(wxString::Format("operator: %lu", state.length));
 
-	state.editor->SetStyling(state.length, Style::Operator);
+	setStyle(state.length, Style::Operator);
 
 	return end;
 }
 
 // -----------------------------------------------------------------------------
 // Process whitespace characters, updating [state].
-// Returns true if the end of the current text range was reached
+// Returns true if the end of the current line was reached
 // -----------------------------------------------------------------------------
 bool Lexer::processWhitespace(LexerState& state)
 {
@@ -595,14 +663,13 @@ bool Lexer::processWhitespace(LexerState& state)
 	while (true)
 	{
 		// Check for end of line
-		if (state.position > state.end)
+		if (state.position >= state.text.size())
 		{
 			end = true;
 			break;
 		}
 
-		char c = (char)state.editor->GetCharAt(state.position);
-		if (VECTOR_EXISTS(whitespace_chars_, c))
+		if (isClass(state.text[state.position], CharClass::Whitespace))
 		{
 			state.length++;
 			state.position++;
@@ -617,100 +684,233 @@ bool Lexer::processWhitespace(LexerState& state)
 	if (debug_lexer)
 		log::debug(wxString::Format("whitespace: %lu", state.length));
 
-	state.editor->SetStyling(state.length, Style::Default);
+	setStyle(state.length, Style::Default);
 
 	return end;
 }
 
 // -----------------------------------------------------------------------------
-// Checks if the text in [editor] starting from [pos] matches [token]
-// ----------------------------------------------------------------------------
-bool Lexer::checkToken(TextEditorCtrl* editor, int pos, string_view token) const
+// Process a line comment, updating [state].
+// Always returns true since a line comment goes to the end of the line
+// -----------------------------------------------------------------------------
+bool Lexer::processLineComment(LexerState& state)
+{
+	if (debug_lexer)
+		log::debug(wxString::Format("line comment: %lu", state.text.size() - state.position));
+
+	setStyle(state.text.size() - state.position, Style::Comment);
+	state.position = state.text.size();
+	state.state    = State::Unknown;
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Process block comment characters, updating [state].
+// Returns true if the end of the current line was reached
+// -----------------------------------------------------------------------------
+bool Lexer::processBlockComment(LexerState& state)
 {
-	if (!token.empty())
+	bool        end       = false;
+	const auto& end_token = language_->commentEndL()[state.comment - 1];
+
+	while (true)
 	{
-		unsigned long token_size = token.size();
-		for (unsigned i = 0; i < token_size; i++)
+		// Check for end of line
+		if (state.position >= state.text.size())
+		{
+			end = true;
+			break;
+		}
+
+		// End of comment
+		if (strutil::startsWith(state.text.substr(state.position), end_token))
 		{
-			if (editor->GetCharAt(pos + i) != (int)token[i])
-				return false;
+			state.length += end_token.size();
+			state.position += end_token.size();
+			state.comment = 0;
+			state.state   = State::Unknown;
+			break;
 		}
-		return true;
+
+		state.length++;
+		state.position++;
 	}
-	return false;
+
+	if (debug_lexer)
+		log::debug(wxString::Format("block comment: %lu", state.length));
+
+	setStyle(state.length, Style::Comment);
+	state.length = 0;
+
+	return end;
 }
 
 // -----------------------------------------------------------------------------
-// Checks if the text in [editor] starting from [pos] is present in [tokens].
-// Writes the fitst index that matched to [found_index] if a valid pointer
-// is passed. Returns true if there's a match, false if not.
-// ----------------------------------------------------------------------------
-bool Lexer::checkToken(TextEditorCtrl* editor, int pos, const vector<string>& tokens, int* found_idx) const
+// Adds [length] characters of [style] to the styles to be applied
+// -----------------------------------------------------------------------------
+void Lexer::setStyle(size_t length, int style)
+{
+	styles_.insert(styles_.end(), length, static_cast<char>(style));
+}
+
+// -----------------------------------------------------------------------------
+// Returns true if character [c] is of the given class
+// -----------------------------------------------------------------------------
+bool Lexer::isClass(char c, CharClass cls) const
+{
+	return char_class_[static_cast<u8>(c)] & static_cast<u8>(cls);
+}
+
+// -----------------------------------------------------------------------------
+// Checks if a line or block comment begins at the current position in
+// [state]. If [begin] is true and there is one, [state] is updated to be
+// within the comment
+// -----------------------------------------------------------------------------
+bool Lexer::checkComment(LexerState& state, bool begin) const
 {
-	if (!tokens.empty())
+	auto text = state.text.substr(state.position);
+
+	// Line comment
+	for (const auto& token : language_->lineCommentL())
+	{
+		if (!token.empty() && strutil::startsWith(text, token))
+		{
+			if (begin)
+				state.state = State::LineComment;
+
+			return true;
+		}
+	}
+
+	// Block comment
+	const auto& block_begin = language_->commentBeginL();
+	const auto  n_blocks    = std::min<size_t>({ block_begin.size(), language_->commentEndL().size(), 15 });
+	for (unsigned i = 0; i < n_blocks; ++i)
 	{
-		unsigned idx = 0;
-		string   token;
-		while (idx < tokens.size())
+		if (!block_begin[i].empty() && !language_->commentEndL()[i].empty()
+			&& strutil::startsWith(text, block_begin[i]))
 		{
-			token = tokens[idx];
-			if (checkToken(editor, pos, token))
+			if (begin)
 			{
-				if (found_idx)
-					*found_idx = idx;
-				return true;
+				state.comment = i + 1;
+				state.length  = block_begin[i].size();
+				state.position += block_begin[i].size();
 			}
-			else
-				idx++;
+
+			return true;
 		}
 	}
+
 	return false;
 }
 
-// ----------------------------------------------------------------------------
-// Checks if [pos] is within a block comment, and returns the index for
-// comment_blocks_ if it is (-1 otherwise)
-// ----------------------------------------------------------------------------
-int Lexer::isWithinComment(int pos)
+// -----------------------------------------------------------------------------
+// Returns [word] as a string for word list lookups, converted to lowercase if
+// [lower] is true
+// -----------------------------------------------------------------------------
+const string& Lexer::wordKey(string_view word, bool lower)
+{
+	word_buf_.assign(word.data(), word.size());
+	if (lower)
+		strutil::lowerIP(word_buf_);
+
+	return word_buf_;
+}
+
+// -----------------------------------------------------------------------------
+// Rebuilds the character class lookup table from the word, operator and
+// whitespace characters, and the current language's comment tokens
+// -----------------------------------------------------------------------------
+void Lexer::updateCharClasses()
 {
-	for (unsigned i = 0; i < comment_blocks_.size(); ++i)
-		if (pos >= comment_blocks_[i].start_pos && pos < comment_blocks_[i].end_pos)
-			return i;
+	char_class_.fill(0);
+
+	for (auto c : word_chars_)
+		char_class_[static_cast<u8>(c)] |= static_cast<u8>(CharClass::Word);
+	for (auto c : operator_chars_)
+		char_class_[static_cast<u8>(c)] |= static_cast<u8>(CharClass::Operator);
+	for (auto c : { ' ', '\n', '\r', '\t' })
+		char_class_[static_cast<u8>(c)] |= static_cast<u8>(CharClass::Whitespace);
 
-	return -1;
+	if (language_)
+	{
+		for (const auto& token : language_->lineCommentL())
+			if (!token.empty())
+				char_class_[static_cast<u8>(token[0])] |= static_cast<u8>(CharClass::CommentStart);
+		for (const auto& token : language_->commentBeginL())
+			if (!token.empty())
+				char_class_[static_cast<u8>(token[0])] |= static_cast<u8>(CharClass::CommentStart);
+	}
+
+	resetLineInfo();
 }
 
 // ---------------------------------------------------------------------------
-// Updates code folding levels in [editor], starting from line [line_start]
+// Updates code folding levels in [editor], starting from line [line_start].
+// Lines after [line_changed] are only updated until one is found with the same
+// fold level as before, since all lines after it will be unchanged
 // -----------------------------------------------------------------------------
-void Lexer::updateFolding(TextEditorCtrl* editor, int line_start)
+void Lexer::updateFolding(TextEditorCtrl* editor, int line_start, int line_changed)
 {
-	int fold_level = editor->GetFoldLevel(line_start) & wxSTC_FOLDLEVELNUMBERMASK;
+	auto n_lines = editor->GetLineCount();
+	if (line_start < 0 || line_start >= n_lines)
+		return;
 
-	for (int l = line_start; l < editor->GetLineCount(); l++)
+	// Start from the previous line, since its fold header can depend on the
+	// first line
+	if (line_start > 0)
+		line_start--;
+
+	// Get fold level at the start of the first line
+	int fold_level = wxSTC_FOLDLEVELBASE;
+	if (line_start > 0)
+	{
+		auto prev  = LineInfo::get(editor, line_start - 1);
+		fold_level = std::max(wxSTC_FOLDLEVELBASE, wxSTC_FOLDLEVELBASE + prev.fold_depth + prev.fold_increment);
+	}
+
+	auto info = LineInfo::get(editor, line_start);
+	for (int l = line_start; l < n_lines; l++)
 	{
+		auto next_info = l + 1 < n_lines ? LineInfo::get(editor, l + 1) : LineInfo{};
+
 		// Determine next line's fold level
-		int next_level = fold_level + lines_[l].fold_increment;
+		int next_level = fold_level + info.fold_increment;
 		if (next_level < wxSTC_FOLDLEVELBASE)
 			next_level = wxSTC_FOLDLEVELBASE;
 
 		// Check if we are going up a fold level
+		int level = fold_level;
 		if (next_level > fold_level)
 		{
-			if (!lines_[l].has_word)
-			{
-				// Line doesn't have any words (eg. only has an opening brace),
-				// move the fold header up a line
-				editor->SetFoldLevel(l - 1, fold_level | wxSTC_FOLDLEVELHEADERFLAG);
-				editor->SetFoldLevel(l, next_level);
-			}
+			// Line doesn't have any words (eg. only has an opening brace),
+			// the fold header goes on the line above
+			if (!info.has_word)
+				level = next_level;
 			else
-				editor->SetFoldLevel(l, fold_level | wxSTC_FOLDLEVELHEADERFLAG);
+				level = fold_level | wxSTC_FOLDLEVELHEADERFLAG;
+		}
+
+		// Move the fold header up from the next line if needed
+		if (next_info.fold_increment > 0 && !next_info.has_word)
+			level = next_level | wxSTC_FOLDLEVELHEADERFLAG;
+
+		// Stop if we're past the changed lines and nothing is different
+		auto depth = fold_level - wxSTC_FOLDLEVELBASE;
+		if (l > line_changed && info.fold_depth == depth && editor->GetFoldLevel(l) == level)
+			break;
+
+		if (editor->GetFoldLevel(l) != level)
+			editor->SetFoldLevel(l, level);
+		if (info.fold_depth != depth)
+		{
+			info.fold_depth = depth;
+			info.set(editor, l);
 		}
-		else
-			editor->SetFoldLevel(l, fold_level);
 
 		fold_level = next_level;
+		info       = next_info;
 	}
 }
 
@@ -723,7 +923,9 @@ bool Lexer::isFunction(TextEditorCtrl* editor, int start_pos, int end_pos)
 	auto word = editor->GetTextRange(start_pos, end_pos).ToStdString();
 	if (!language_->caseSensitive())
 		strutil::lowerIP(word);
-	return word_list_[word].style == (int)Style::Function;
+
+	auto it = word_list_.find(word);
+	return it != word_list_.end() && it->second == (int)Style::Function;
 }
 
 
@@ -741,7 +943,10 @@ bool Lexer::isFunction(TextEditorCtrl* editor, int start_pos, int end_pos)
 void ZScriptLexer::addWord(string_view word, int style)
 {
 	if (style == Style::Function)
-		functions_.push_back(language_->caseSensitive() ? string{ word } : strutil::lower(word));
+	{
+		functions_.insert(language_->caseSensitive() ? string{ word } : strutil::lower(word));
+		resetLineInfo();
+	}
 	else
 		Lexer::addWord(word, style);
 }
@@ -753,23 +958,15 @@ void ZScriptLexer::styleWord(LexerState& state, string_view word)
 {
 	// Skip whitespace after word
 	auto index = state.position;
-	while (index < state.end)
-	{
-		if (!(VECTOR_EXISTS(whitespace_chars_, state.editor->GetCharAt(index))))
-			break;
+	while (index < state.text.size() && isClass(state.text[index], CharClass::Whitespace))
 		++index;
-	}
 
 	// Check for '(' (possible function)
-	if (state.editor->GetCharAt(index) == '(')
+	if (index < state.text.size() && state.text[index] == '(')
 	{
-		string word_str{ word };
-		if (!language_->caseSensitive())
-			strutil::lowerIP(word_str);
-
-		if (VECTOR_EXISTS(functions_, word_str))
+		if (functions_.count(wordKey(word, !language_->caseSensitive())) > 0)
 		{
-			state.editor->SetStyling(word.length(), Style::Function);
+			setStyle(word.length(), Style::Function);
 			return;
 		}
 	}
@@ -799,7 +996,7 @@ bool ZScriptLexer::isFunction(TextEditorCtrl* editor, int start_pos, int end_pos
 	auto end   = editor->GetTextLength();
 	while (index < end)
 	{
-		if (!(VECTOR_EXISTS(whitespace_chars_, editor->GetCharAt(index))))
+		if (!isClass(static_cast<char>(editor->GetCharAt(index)), CharClass::Whitespace))
 			break;
 		++index;
 	}
@@ -810,5 +1007,5 @@ bool ZScriptLexer::isFunction(TextEditorCtrl* editor, int start_pos, int end_pos
 	auto word = editor->GetTextRange(start_pos, end_pos).ToStdString();
 	if (!language_->caseSensitive())
 		strutil::lowerIP(word);
-	return VECTOR_EXISTS(functions_, word);
+	return functions_.count(word) > 0;
 }
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <unordered_set>
+
 namespace slade
 {
 class TextEditorCtrl;
@@ -32,19 +34,23 @@ public:
 
 	virtual void loadLanguage(TextLanguage* language);
 
-	virtual void doStyling(TextEditorCtrl* editor, int start, int end);
-	void         updateComments(TextEditorCtrl* editor, int start, int end);
+	virtual int doStyling(TextEditorCtrl* editor, int line_start, int line_end);
+	void        invalidateLines(TextEditorCtrl* editor, int line_start, int line_end) const;
 
 	virtual void addWord(string_view word, int style);
-	virtual void clearWords() { word_list_.clear(); }
-	virtual void resetLineInfo() { lines_.clear(); }
+	virtual void clearWords()
+	{
+		word_list_.clear();
+		resetLineInfo();
+	}
+	virtual void resetLineInfo() { reset_lines_ = true; }
 
 	void setWordChars(string_view chars);
 	void setOperatorChars(string_view chars);
 
-	void updateFolding(TextEditorCtrl* editor, int line_start);
+	void updateFolding(TextEditorCtrl* editor, int line_start, int line_changed);
 	void foldComments(bool fold) { fold_comments_ = fold; }
-	void foldPreprocessor(bool fold) { fold_preprocessor_ = fold; }
+	void foldPreprocessor(bool fold);
 
 	virtual bool isFunction(TextEditorCtrl* editor, int start_pos, int end_pos);
 
@@ -58,49 +64,57 @@ protected:
 		Number,
 		Operator,
 		Whitespace,
+		LineComment,
 	};
 
-	vector<unsigned char> word_chars_;
-	vector<unsigned char> operator_chars_;
-	vector<unsigned char> whitespace_chars_;
-	TextLanguage*         language_ = nullptr;
-	wxRegEx               re_int1_;
-	wxRegEx               re_int2_;
-	wxRegEx               re_int3_;
-	wxRegEx               re_float_;
-	bool                  fold_comments_     = false;
-	bool                  fold_preprocessor_ = false;
-	char                  preprocessor_char_;
-
-	struct WLIndex
+	// Character class flags (for char_class_)
+	enum class CharClass : u8
 	{
-		char style;
-		WLIndex() : style(0) {}
+		Word         = 1,
+		Operator     = 2,
+		Whitespace   = 4,
+		CommentStart = 8, // First character of a line or block comment token
 	};
-	std::map<string, WLIndex> word_list_;
 
+	string              word_chars_;
+	string              operator_chars_;
+	std::array<u8, 256> char_class_{};
+	TextLanguage*       language_ = nullptr;
+	wxRegEx             re_int1_;
+	wxRegEx             re_int2_;
+	wxRegEx             re_int3_;
+	wxRegEx             re_float_;
+	bool                fold_comments_     = false;
+	bool                fold_preprocessor_ = false;
+	char                preprocessor_char_ = 0;
+
+	std::unordered_map<string, char> word_list_;     // Word -> style
+	std::unordered_map<string, int>  fold_words_;    // Word -> fold increment
+	std::unordered_map<string, int>  pp_fold_words_; // Preprocessor word -> fold increment
+
+	// Info for each line in the editor, stored as the editor's line state so
+	// that it stays with the line when lines are added or removed above it
 	struct LineInfo
 	{
-		int  fold_increment;
-		bool has_word;
-		LineInfo() : fold_increment{ 0 }, has_word{ false } {}
-	};
-	std::map<int, LineInfo> lines_;
-
-	struct CommentBlock
-	{
-		int start_pos = -1;
-		int end_pos   = -1;
+		int  comment_start  = 0; // Block comment the line starts within (index + 1, 0 if none)
+		int  comment_end    = 0; // Block comment the line ends within (index + 1, 0 if none)
+		int  fold_increment = 0;
+		int  fold_depth     = 0; // Fold level (above base) at the start of the line
+		bool has_word       = false;
+		bool lexed          = false; // False if the line has been modified since it was styled
+
+		static LineInfo get(const TextEditorCtrl* editor, int line);
+		void            set(TextEditorCtrl* editor, int line) const;
 	};
-	vector<CommentBlock> comment_blocks_;
+	bool reset_lines_ = true;
 
 	struct LexerState
 	{
-		int             position;
-		int             end;
-		int             line;
+		string_view     text; // Text of the line being styled
+		unsigned        position;
 		State           state;
 		size_t          length;
+		int             comment; // Block comment the lexer is within (index + 1, 0 if none)
 		int             fold_increment;
 		bool            has_word;
 		TextEditorCtrl* editor;
@@ -111,11 +125,21 @@ protected:
 	bool processChar(LexerState& state);
 	bool processOperator(LexerState& state);
 	bool processWhitespace(LexerState& state);
+	bool processLineComment(LexerState& state);
+	bool processBlockComment(LexerState& state);
+
+	virtual void  styleWord(LexerState& state, string_view word);
+	void          setStyle(size_t length, int style);
+	bool          isClass(char c, CharClass cls) const;
+	bool          checkComment(LexerState& state, bool begin = true) const;
+	const string& wordKey(string_view word, bool lower);
+
+private:
+	vector<char> styles_;   // Styles for the text being styled, applied to the editor in one go
+	string       word_buf_; // Word being looked up (avoids allocating for each word)
 
-	virtual void styleWord(LexerState& state, string_view word);
-	bool         checkToken(TextEditorCtrl* editor, int pos, string_view token) const;
-	bool checkToken(TextEditorCtrl* editor, int pos, const vector<string>& tokens, int* found_idx = nullptr) const;
-	int  isWithinComment(int pos);
+	void styleLine(LexerState& state);
+	void updateCharClasses();
 };
 
 class ZScriptLexer : public Lexer
@@ -131,6 +155,6 @@ protected:
 	bool isFunction(TextEditorCtrl* editor, int start_pos, int end_pos) override;
 
 private:
-	vector<string> functions_;
+	std::unordered_set<string> functions_;
 };
 } // namespace slade
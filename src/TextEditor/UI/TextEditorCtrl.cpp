@@ -214,6 +214,7 @@ TextEditorCtrl::TextEditorCtrl(wxWindow* parent, int id) :
 	Bind(wxEVT_STC_MARGINCLICK, &TextEditorCtrl::onMarginClick, this);
 	Bind(wxEVT_COMMAND_JTCALCULATOR_COMPLETED, &TextEditorCtrl::onJumpToCalculateComplete, this);
 	Bind(wxEVT_STC_CHANGE, &TextEditorCtrl::onModified, this);
+	Bind(wxEVT_STC_MODIFIED, &TextEditorCtrl::onTextModified, this);
 	Bind(wxEVT_TIMER, &TextEditorCtrl::onUpdateTimer, this);
 	Bind(wxEVT_STC_STYLENEEDED, &TextEditorCtrl::onStyleNeeded, this);
 }
@@ -1505,13 +1506,6 @@ void TextEditorCtrl::onCharAdded(wxStyledTextEvent& e)
 		// Comma, possibly update calltip
 		if (e.GetKey() == ',' && txed_calltips_parenthesis)
 			updateCalltip();
-
-		// Block comment ended
-		for (auto& end_token : language_->commentEndL())
-		{
-			if (GetTextRange(GetCurrentPos() - end_token.size(), GetCurrentPos()) == end_token)
-				block_comment_closed_ = true;
-		}
 	}
 
 	// Continue
@@ -1789,6 +1783,21 @@ void TextEditorCtrl::onModified(wxStyledTextEvent& e)
 	e.Skip();
 }
 
+// -----------------------------------------------------------------------------
+// Called when the text or styling is modified
+// -----------------------------------------------------------------------------
+void TextEditorCtrl::onTextModified(wxStyledTextEvent& e)
+{
+	// Lines with inserted or deleted text need to be restyled
+	if (e.GetModificationType() & (wxSTC_MOD_INSERTTEXT | wxSTC_MOD_DELETETEXT))
+	{
+		int line = LineFromPosition(e.GetPosition());
+		lexer_->invalidateLines(this, line, line + std::max(e.GetLinesAdded(), 0));
+	}
+
+	e.Skip();
+}
+
 // -----------------------------------------------------------------------------
 // Called when the update timer finishes
 // -----------------------------------------------------------------------------
@@ -1812,36 +1821,13 @@ void TextEditorCtrl::onStyleNeeded(wxStyledTextEvent& e)
 	int line_start = LineFromPosition(GetEndStyled());
 	int line_end   = LineFromPosition(e.GetPosition());
 
-	// If a block comment was just closed, we need to style to the end of the text
-	if (block_comment_closed_)
-	{
-		lexer_->resetLineInfo();
-		line_end              = GetNumberOfLines();
-		block_comment_closed_ = false;
-	}
-
-	// Update comment block info
-	lexer_->updateComments(
-		this, line_start == 0 ? 0 : GetLineEndPosition(line_start - 1), GetLineEndPosition(line_end));
-
-	// Lex until done (end of lines, end of file or end of block comment)
-	int l = line_start;
-	while (l <= GetNumberOfLines() && (l <= line_end))
-	{
-		int end   = GetLineEndPosition(l) - 1;
-		int start = end - GetLineLength(l) + 1;
-
-		if (start > end)
-			end = start;
-
-		lexer_->doStyling(this, start, end);
-		l++;
-	}
+	// Style lines, the lexer skips any lines that don't need to be restyled
+	int line_changed = lexer_->doStyling(this, line_start, line_end);
 
 	if (txed_fold_enable)
 	{
 		auto modified = last_modified_;
-		lexer_->updateFolding(this, line_start);
+		lexer_->updateFolding(this, line_start, line_changed);
 		last_modified_ = modified;
 	}
 }
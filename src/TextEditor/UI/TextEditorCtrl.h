@@ -106,10 +106,9 @@ private:
 	long              last_modified_ = 0;
 
 	// State tracking for updates
-	int  prev_cursor_pos_      = -1;
-	int  prev_text_length_     = -1;
-	int  prev_brace_match_     = -1;
-	bool block_comment_closed_ = false;
+	int prev_cursor_pos_  = -1;
+	int prev_text_length_ = -1;
+	int prev_brace_match_ = -1;
 
 	// Timed update stuff
 	wxTimer timer_update_;
@@ -142,6 +141,7 @@ private:
 	void onJumpToCalculateComplete(wxThreadEvent& e);
 	void onJumpToChoiceSelected(wxCommandEvent& e);
 	void onModified(wxStyledTextEvent& e);
+	void onTextModified(wxStyledTextEvent& e);
 	void onUpdateTimer(wxTimerEvent& e);
 	void onStyleNeeded(wxStyledTextEvent& e);
 };
@@ -32,6 +32,7 @@
 // -----------------------------------------------------------------------------
 #include "Main.h"
 #include "PaletteCanvas.h"
+#include "OpenGL/Drawing.h"
 
 using namespace slade;
 
@@ -92,6 +93,7 @@ void PaletteCanvas::draw()
 	int size   = std::min<int>(x_size, y_size);
 
 	// Draw palette
+	drawing::beginBatch();
 	int c = 0;
 	for (int y = 0; y < rows; y++)
 	{
@@ -101,62 +103,37 @@ void PaletteCanvas::draw()
 			gl::setColour(palette_.colour(c), gl::Blend::Normal);
 
 			// Draw square
-			glBegin(GL_QUADS);
-			glVertex2d(x * size + 1, y * size + 1);
-			glVertex2d(x * size + 1, y * size + size - 1);
-			glVertex2d(x * size + size - 1, y * size + size - 1);
-			glVertex2d(x * size + size - 1, y * size + 1);
-			glEnd();
+			drawing::drawFilledRect(x * size + 1, y * size + 1, x * size + size - 1, y * size + size - 1);
 
 			// Draw selection outline if needed
 			if (c >= sel_begin_ && c <= sel_end_)
 			{
 				gl::setColour(ColRGBA::WHITE);
-				glBegin(GL_LINES);
-				glVertex2d(x * size, y * size);
-				glVertex2d(x * size + size, y * size);
-				glVertex2d(x * size, y * size + size - 1);
-				glVertex2d(x * size + size, y * size + size - 1);
-				glEnd();
+				drawing::drawLine(x * size, y * size, x * size + size, y * size);
+				drawing::drawLine(x * size, y * size + size - 1, x * size + size, y * size + size - 1);
 
 				gl::setColour(ColRGBA::BLACK);
-				glBegin(GL_LINES);
-				glVertex2d(x * size + 1, y * size + 1);
-				glVertex2d(x * size + size - 1, y * size + 1);
-				glVertex2d(x * size + 1, y * size + size - 2);
-				glVertex2d(x * size + size - 1, y * size + size - 2);
-				glEnd();
+				drawing::drawLine(x * size + 1, y * size + 1, x * size + size - 1, y * size + 1);
+				drawing::drawLine(x * size + 1, y * size + size - 2, x * size + size - 1, y * size + size - 2);
 
 				// Selection beginning
 				if (c == sel_begin_)
 				{
 					gl::setColour(ColRGBA::WHITE);
-					glBegin(GL_LINES);
-					glVertex2d(x * size, y * size);
-					glVertex2d(x * size, y * size + size);
-					glEnd();
+					drawing::drawLine(x * size, y * size, x * size, y * size + size);
 
 					gl::setColour(ColRGBA::BLACK);
-					glBegin(GL_LINES);
-					glVertex2d(x * size + 1, y * size + 1);
-					glVertex2d(x * size + 1, y * size + size - 1);
-					glEnd();
+					drawing::drawLine(x * size + 1, y * size + 1, x * size + 1, y * size + size - 1);
 				}
 
 				// Selection ending
 				if (c == sel_end_)
 				{
 					gl::setColour(ColRGBA::WHITE);
-					glBegin(GL_LINES);
-					glVertex2d(x * size + size - 1, y * size + size - 2);
-					glVertex2d(x * size + size - 1, y * size);
-					glEnd();
+					drawing::drawLine(x * size + size - 1, y * size + size - 2, x * size + size - 1, y * size);
 
 					gl::setColour(ColRGBA::BLACK);
-					glBegin(GL_LINES);
-					glVertex2d(x * size + size - 2, y * size + 1);
-					glVertex2d(x * size + size - 2, y * size + size - 1);
-					glEnd();
+					drawing::drawLine(x * size + size - 2, y * size + 1, x * size + size - 2, y * size + size - 1);
 				}
 			}
 
@@ -170,6 +147,7 @@ void PaletteCanvas::draw()
 		if (c > 255)
 			break;
 	}
+	drawing::endBatch();
 
 	// Swap buffers (ie show what was drawn)
 	SwapBuffers();
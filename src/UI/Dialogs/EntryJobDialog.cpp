@@ -0,0 +1,229 @@
+
+// -----------------------------------------------------------------------------
+// SLADE - It's a Doom Editor
+// Copyright(C) 2008 - 2020 Simon Judd
+//
+// Email:       sirjuddington@gmail.com
+// Web:         http://slade.mancubus.net
+// Filename:    EntryJobDialog.cpp
+// Description: A non-modal dialog that shows the progress of an EntryJob
+//              running in the background, and commits the job once done
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301, USA.
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+//
+// Includes
+//
+// -----------------------------------------------------------------------------
+#include "Main.h"
+#include "EntryJobDialog.h"
+#include "App.h"
+#include "General/UI.h"
+#include "MainEditor/EntryJob.h"
+#include "UI/WxUtils.h"
+
+using namespace slade;
+
+
+// -----------------------------------------------------------------------------
+//
+// Variables
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// Time (in ms) a job has to run for before its progress dialog is shown, so
+// that the dialog doesn't just flash up for quick jobs
+constexpr long ENTRY_JOB_DIALOG_DELAY = 300;
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// EntryJobDialog Class Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// EntryJobDialog class constructor, starts processing [job]
+// -----------------------------------------------------------------------------
+EntryJobDialog::EntryJobDialog(wxWindow* parent, unique_ptr<EntryJob> job) :
+	wxDialog(parent, -1, job->title(), wxDefaultPosition, wxDefaultSize, wxCAPTION | wxCLOSE_BOX),
+	job_{ std::move(job) },
+	timer_{ this }
+{
+	// Setup main sizer
+	auto msizer = new wxBoxSizer(wxVERTICAL);
+	SetSizer(msizer);
+	auto sizer = new wxBoxSizer(wxVERTICAL);
+	msizer->Add(sizer, 1, wxEXPAND | wxALL, ui::padLarge());
+
+	// Progress
+	label_progress_ = new wxStaticText(this, -1, "");
+	gauge_progress_ = new wxGauge(this, -1, 1, wxDefaultPosition, wxutil::scaledSize(320, -1), wxGA_HORIZONTAL);
+	sizer->Add(label_progress_, 0, wxEXPAND | wxBOTTOM, ui::pad());
+	sizer->Add(gauge_progress_, 0, wxEXPAND | wxBOTTOM, ui::padLarge());
+
+	// Cancel button
+	btn_cancel_ = new wxButton(this, wxID_CANCEL, "Cancel");
+	sizer->Add(btn_cancel_, 0, wxALIGN_RIGHT);
+
+	// Bind events
+	Bind(wxEVT_TIMER, &EntryJobDialog::onTimer, this);
+	Bind(wxEVT_CLOSE_WINDOW, &EntryJobDialog::onClose, this);
+	btn_cancel_->Bind(wxEVT_BUTTON, &EntryJobDialog::onCancel, this);
+
+	wxWindowBase::Layout();
+	Fit();
+	CenterOnParent();
+
+	// Start the job
+	job_->start();
+	gauge_progress_->SetRange(std::max<int>(job_->numItems(), 1));
+	update();
+	start_time_ = app::runTimer();
+	timer_.Start(100);
+}
+
+// -----------------------------------------------------------------------------
+// EntryJobDialog class destructor
+// -----------------------------------------------------------------------------
+EntryJobDialog::~EntryJobDialog()
+{
+	timer_.Stop();
+
+	// Cancel the job if it's still running (eg. if the parent window was
+	// closed), deleting it waits for it to stop
+	job_->cancel();
+	job_.reset();
+}
+
+// -----------------------------------------------------------------------------
+// Runs [job] in the background, showing its progress in a new EntryJobDialog
+// (if it runs for long enough). The dialog deletes itself once done
+// -----------------------------------------------------------------------------
+void EntryJobDialog::run(wxWindow* parent, unique_ptr<EntryJob> job)
+{
+	new EntryJobDialog(parent, std::move(job));
+}
+
+// -----------------------------------------------------------------------------
+// Updates the progress display
+// -----------------------------------------------------------------------------
+void EntryJobDialog::update()
+{
+	if (job_->isCancelled())
+	{
+		label_progress_->SetLabel("Cancelling...");
+		return;
+	}
+
+	label_progress_->SetLabel(wxString::Format("%u of %u", job_->numProcessed(), job_->numItems()));
+	gauge_progress_->SetValue(std::min(job_->numProcessed(), job_->numItems()));
+}
+
+// -----------------------------------------------------------------------------
+// Commits the job (unless it was cancelled), reports any errors and closes the
+// dialog
+// -----------------------------------------------------------------------------
+void EntryJobDialog::finish()
+{
+	timer_.Stop();
+	Hide();
+
+	if (!job_->isCancelled())
+	{
+		// Freeze the parent window (eg. an archive panel's entry list) while
+		// committing, since many entries may be added at once
+		auto parent = GetParent();
+		if (parent)
+			parent->Freeze();
+		job_->commit();
+		if (parent)
+			parent->Thaw();
+	}
+
+	// Log errors
+	auto errors = job_->errors();
+	for (const auto& error : errors)
+		log::error(error);
+	if (!errors.empty() && !job_->isCancelled())
+		wxMessageBox(
+			wxString::Format("%lu error(s) occurred, see the console log for details", errors.size()),
+			job_->title(),
+			wxOK | wxICON_WARNING,
+			GetParent());
+
+	Destroy();
+}
+
+
+// -----------------------------------------------------------------------------
+//
+// EntryJobDialog Class Events
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Called when the update timer fires
+// -----------------------------------------------------------------------------
+void EntryJobDialog::onTimer(wxTimerEvent& e)
+{
+	if (job_->isProcessed())
+	{
+		finish();
+		return;
+	}
+
+	// Only show the dialog if the job has been running for a while
+	if (!IsShown() && !job_->isCancelled() && app::runTimer() - start_time_ >= ENTRY_JOB_DIALOG_DELAY)
+		Show();
+
+	update();
+}
+
+// -----------------------------------------------------------------------------
+// Called when the 'Cancel' button is clicked
+// -----------------------------------------------------------------------------
+void EntryJobDialog::onCancel(wxCommandEvent& e)
+{
+	// Cancel the job, the dialog will close once the items currently being
+	// processed are done
+	job_->cancel();
+	btn_cancel_->Disable();
+	update();
+}
+
+// -----------------------------------------------------------------------------
+// Called when the dialog is closed
+// -----------------------------------------------------------------------------
+void EntryJobDialog::onClose(wxCloseEvent& e)
+{
+	job_->cancel();
+
+	// Wait for the job to stop (the timer closes the dialog once it has)
+	if (e.CanVeto())
+	{
+		e.Veto();
+		Hide();
+	}
+	else
+		Destroy();
+}
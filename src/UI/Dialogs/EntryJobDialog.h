@@ -0,0 +1,34 @@
+#pragma once
+
+namespace slade
+{
+class EntryJob;
+
+// A non-modal dialog showing the progress of an EntryJob running in the
+// background, with a button to cancel it. Once the job has been processed it
+// is committed and the dialog closes itself
+class EntryJobDialog : public wxDialog
+{
+public:
+	EntryJobDialog(wxWindow* parent, unique_ptr<EntryJob> job);
+	~EntryJobDialog() override;
+
+	static void run(wxWindow* parent, unique_ptr<EntryJob> job);
+
+private:
+	unique_ptr<EntryJob> job_;
+	wxTimer              timer_;
+	wxStaticText*        label_progress_ = nullptr;
+	wxGauge*             gauge_progress_ = nullptr;
+	wxButton*            btn_cancel_     = nullptr;
+	long                 start_time_     = 0;
+
+	void update();
+	void finish();
+
+	// Events
+	void onTimer(wxTimerEvent& e);
+	void onCancel(wxCommandEvent& e);
+	void onClose(wxCloseEvent& e);
+};
+} // namespace slade
@@ -102,29 +102,8 @@ bool GfxConvDialog::nextItem()
 	}
 
 	// Load image if needed
-	if (!items_[current_item_].image.isValid())
-	{
-		// If loading images from entries
-		if (items_[current_item_].entry != nullptr)
-		{
-			if (!misc::loadImageFromEntry(&(items_[current_item_].image), items_[current_item_].entry))
-				return nextItem(); // Skip if not a valid image entry
-		}
-		// If loading images from textures
-		else if (items_[current_item_].texture != nullptr)
-		{
-			if (items_[current_item_].force_rgba)
-				items_[current_item_].image.convertRGBA(items_[current_item_].palette);
-			if (!items_[current_item_].texture->toImage(
-					items_[current_item_].image,
-					items_[current_item_].archive,
-					items_[current_item_].palette,
-					items_[current_item_].force_rgba))
-				return nextItem(); // Skip if not a valid image entry
-		}
-		else
-			return nextItem(); // Skip if not a valid image entry
-	}
+	if (!loadItemImage(items_[current_item_]))
+		return nextItem(); // Skip if not a valid image entry
 
 	// Update valid formats
 	combo_target_format_->Clear();
@@ -224,6 +203,30 @@ bool GfxConvDialog::nextItem()
 	return ok;
 }
 
+// -----------------------------------------------------------------------------
+// Loads the image for [item] if it isn't already loaded.
+// Returns false if the item isn't a valid image
+// -----------------------------------------------------------------------------
+bool GfxConvDialog::loadItemImage(ConvItem& item) const
+{
+	if (item.image.isValid())
+		return true;
+
+	// If loading images from entries
+	if (item.entry != nullptr)
+		return misc::loadImageFromEntry(&item.image, item.entry);
+
+	// If loading images from textures
+	if (item.texture != nullptr)
+	{
+		if (item.force_rgba)
+			item.image.convertRGBA(item.palette);
+		return item.texture->toImage(item.image, item.archive, item.palette, item.force_rgba);
+	}
+
+	return false;
+}
+
 // -----------------------------------------------------------------------------
 // Sets up the dialog UI layout
 // -----------------------------------------------------------------------------
@@ -500,6 +503,15 @@ void GfxConvDialog::updateControls() const
 // Writes the state of the conversion option controls to [opt]
 // -----------------------------------------------------------------------------
 void GfxConvDialog::convertOptions(SIFormat::ConvertOptions& opt)
+{
+	convertOptions(opt, items_[current_item_]);
+}
+
+// -----------------------------------------------------------------------------
+// Writes the state of the conversion option controls to [opt], using the
+// palettes for [item]
+// -----------------------------------------------------------------------------
+void GfxConvDialog::convertOptions(SIFormat::ConvertOptions& opt, const ConvItem& item) const
 {
 	// Set transparency options
 	opt.transparency = cb_enable_transparency_->GetValue();
@@ -517,8 +529,8 @@ void GfxConvDialog::convertOptions(SIFormat::ConvertOptions& opt)
 		opt.mask_source = SIFormat::Mask::Brightness;
 
 	// Set conversion palettes
-	opt.pal_current = pal_chooser_current_->selectedPalette(items_[current_item_].entry);
-	opt.pal_target  = pal_chooser_target_->selectedPalette(items_[current_item_].entry);
+	opt.pal_current = pal_chooser_current_->selectedPalette(item.entry);
+	opt.pal_target  = pal_chooser_target_->selectedPalette(item.entry);
 
 	// Set conversion colour format
 	opt.col_format = current_format_.coltype;
@@ -589,6 +601,70 @@ void GfxConvDialog::applyConversion()
 	item.palette    = pal_chooser_target_->selectedPalette(item.entry);
 }
 
+// -----------------------------------------------------------------------------
+// Applies the conversion to the current image and all following images, up to
+// (but not including) the first one that can't be written as the selected
+// format. The images are converted in parallel, without updating the previews
+// for each one
+// -----------------------------------------------------------------------------
+void GfxConvDialog::applyConversionToAll()
+{
+	ui::showSplash("Converting Gfx...", true, this);
+
+	// Load images and get conversion options for all items to convert (this
+	// has to be done on the main thread since it accesses archives)
+	vector<SIFormat::ConvertItem> batch;
+	vector<size_t>                batch_items;
+	auto                          stop_item = items_.size();
+	for (auto a = current_item_; a < items_.size(); a++)
+	{
+		ui::setSplashProgressMessage(fmt::format("Loading {} of {}", a + 1, items_.size()));
+		ui::setSplashProgress(static_cast<float>(a) / static_cast<float>(items_.size()));
+
+		// Skip if not a valid image
+		auto& item = items_[a];
+		if (!loadItemImage(item))
+			continue;
+
+		// Stop here if the image can't be written as the selected format,
+		// the user will need to select a format for it
+		if (current_format_.format->canWrite(item.image) == SIFormat::Writable::No
+			|| !current_format_.format->canWriteType(current_format_.coltype))
+		{
+			stop_item = a;
+			break;
+		}
+
+		auto& batch_item = batch.emplace_back();
+		batch_item.image = &item.image;
+		convertOptions(batch_item.opt, item);
+		batch_items.push_back(a);
+	}
+
+	// Convert
+	ui::setSplashProgressMessage(fmt::format("Converting {} images", batch.size()));
+	ui::setSplashProgress(-1.0f);
+	current_format_.format->convertAllWritable(batch);
+
+	// Update converted items (in order)
+	for (unsigned a = 0; a < batch.size(); a++)
+	{
+		if (!batch[a].converted)
+			continue;
+
+		auto& item      = items_[batch_items[a]];
+		item.modified   = true;
+		item.new_format = current_format_.format;
+		item.palette    = batch[a].opt.pal_target;
+	}
+
+	ui::hideSplash();
+
+	// Open the item conversion stopped at (or close if all were converted)
+	current_item_ = stop_item - 1;
+	nextItem();
+}
+
 
 // -----------------------------------------------------------------------------
 //
@@ -624,19 +700,7 @@ void GfxConvDialog::onBtnConvert(wxCommandEvent& e)
 // -----------------------------------------------------------------------------
 void GfxConvDialog::onBtnConvertAll(wxCommandEvent& e)
 {
-	// Show splash window
-	ui::showSplash("Converting Gfx...", true);
-
-	// Convert all images
-	for (size_t a = current_item_; a < items_.size(); a++)
-	{
-		applyConversion();
-		if (!nextItem())
-			break;
-	}
-
-	// Hide splash window
-	ui::hideSplash();
+	applyConversionToAll();
 }
 
 // -----------------------------------------------------------------------------
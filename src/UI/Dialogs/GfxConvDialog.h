@@ -59,6 +59,7 @@ public:
 	Palette*  itemPalette(int index);
 
 	void applyConversion();
+	void applyConversionToAll();
 
 private:
 	struct ConvFormat
@@ -124,6 +125,8 @@ private:
 	ColRGBA colour_trans_;
 
 	bool nextItem();
+	bool loadItemImage(ConvItem& item) const;
+	void convertOptions(SIFormat::ConvertOptions& opt, const ConvItem& item) const;
 
 	// Static
 	static wxString current_palette_name_;
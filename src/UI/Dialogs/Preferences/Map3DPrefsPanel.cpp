@@ -51,6 +51,8 @@ EXTERN_CVAR(Bool, camera_3d_show_distance)
 EXTERN_CVAR(Bool, mlook_invert_y)
 EXTERN_CVAR(Bool, render_shade_orthogonal_lines)
 EXTERN_CVAR(Int, render_fov)
+EXTERN_CVAR(Bool, render_3d_portal_vis)
+EXTERN_CVAR(Bool, render_3d_portal_closed)
 
 
 // -----------------------------------------------------------------------------
@@ -126,7 +128,9 @@ Map3DPrefsPanel::Map3DPrefsPanel(wxWindow* parent) : PrefsPanelBase(parent)
 		{ cb_render_sky_       = new wxCheckBox(this, -1, "Render sky preview"),
 		  cb_show_distance_    = new wxCheckBox(this, -1, "Show distance under crosshair"),
 		  cb_invert_y_         = new wxCheckBox(this, -1, "Invert mouse Y axis"),
-		  cb_shade_orthogonal_ = new wxCheckBox(this, -1, "Shade orthogonal lines") },
+		  cb_shade_orthogonal_ = new wxCheckBox(this, -1, "Shade orthogonal lines"),
+		  cb_portal_vis_       = new wxCheckBox(this, -1, "Only render sectors visible from the camera's sector"),
+		  cb_portal_closed_    = new wxCheckBox(this, -1, "Treat closed doors as solid walls when checking visibility") },
 		wxSizerFlags(0).Expand());
 
 	// Bind events
@@ -139,6 +143,7 @@ Map3DPrefsPanel::Map3DPrefsPanel(wxWindow* parent) : PrefsPanelBase(parent)
 	cb_max_thing_dist_lock_->Bind(wxEVT_CHECKBOX, [&](wxCommandEvent&) { updateDistanceControls(); });
 	cb_distance_unlimited_->Bind(wxEVT_CHECKBOX, [&](wxCommandEvent&) { updateDistanceControls(); });
 	slider_fov_->Bind(wxEVT_SLIDER, [&](wxCommandEvent&) { updateDistanceControls(); });
+	cb_portal_vis_->Bind(wxEVT_CHECKBOX, [&](wxCommandEvent&) { cb_portal_closed_->Enable(cb_portal_vis_->GetValue()); });
 }
 
 // -----------------------------------------------------------------------------
@@ -173,6 +178,9 @@ void Map3DPrefsPanel::init()
 	cb_show_distance_->SetValue(camera_3d_show_distance);
 	cb_invert_y_->SetValue(mlook_invert_y);
 	cb_shade_orthogonal_->SetValue(render_shade_orthogonal_lines);
+	cb_portal_vis_->SetValue(render_3d_portal_vis);
+	cb_portal_closed_->SetValue(render_3d_portal_closed);
+	cb_portal_closed_->Enable(render_3d_portal_vis);
 
 	updateDistanceControls();
 }
@@ -238,4 +246,6 @@ void Map3DPrefsPanel::applyPreferences()
 	mlook_invert_y                = cb_invert_y_->GetValue();
 	render_fov                    = slider_fov_->GetValue() * 10;
 	render_shade_orthogonal_lines = cb_shade_orthogonal_->GetValue();
+	render_3d_portal_vis          = cb_portal_vis_->GetValue();
+	render_3d_portal_closed       = cb_portal_closed_->GetValue();
 }
@@ -31,5 +31,7 @@ private:
 	wxCheckBox*   cb_shade_orthogonal_     = nullptr;
 	wxSlider*     slider_fov_              = nullptr;
 	wxStaticText* label_fov_               = nullptr;
+	wxCheckBox*   cb_portal_vis_           = nullptr;
+	wxCheckBox*   cb_portal_closed_        = nullptr;
 };
 } // namespace slade
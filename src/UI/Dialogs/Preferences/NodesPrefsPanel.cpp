@@ -45,6 +45,7 @@ using namespace slade;
 // -----------------------------------------------------------------------------
 EXTERN_CVAR(String, nodebuilder_id)
 EXTERN_CVAR(String, nodebuilder_options)
+EXTERN_CVAR(Bool, nodebuilder_builtin_fallback)
 
 
 // -----------------------------------------------------------------------------
@@ -89,6 +90,11 @@ NodesPrefsPanel::NodesPrefsPanel(wxWindow* parent, bool useframe) : PrefsPanelBa
 	clb_options_ = new wxCheckListBox(this, -1, wxDefaultPosition, wxDefaultSize);
 	sizer->Add(wxutil::createLabelVBox(this, "Options:", clb_options_), { 2, 0 }, { 1, 3 }, wxEXPAND);
 
+	// Built-in fallback
+	cb_builtin_fallback_ = new wxCheckBox(
+		this, -1, "Use the built-in node builder if the selected node builder's executable isn't found");
+	sizer->Add(cb_builtin_fallback_, { 3, 0 }, { 1, 3 }, wxEXPAND);
+
 	sizer->AddGrowableCol(1, 1);
 	sizer->AddGrowableRow(2, 1);
 
@@ -99,6 +105,7 @@ NodesPrefsPanel::NodesPrefsPanel(wxWindow* parent, bool useframe) : PrefsPanelBa
 	// Init
 	choice_nodebuilder_->Select(sel);
 	populateOptions(nodebuilder_options);
+	cb_builtin_fallback_->SetValue(nodebuilder_builtin_fallback);
 }
 
 // -----------------------------------------------------------------------------
@@ -117,6 +124,7 @@ void NodesPrefsPanel::init()
 	}
 	choice_nodebuilder_->Select(sel);
 	populateOptions(nodebuilder_options);
+	cb_builtin_fallback_->SetValue(nodebuilder_builtin_fallback);
 }
 
 // -----------------------------------------------------------------------------
@@ -127,7 +135,7 @@ void NodesPrefsPanel::populateOptions(const wxString& options) const
 {
 	// Get current builder
 	auto& builder = nodebuilders::builder(choice_nodebuilder_->GetSelection());
-	btn_browse_path_->Enable(builder.id != "none");
+	btn_browse_path_->Enable(builder.id != "none" && !builder.builtin);
 
 	// Set builder path
 	text_path_->SetValue(builder.path);
@@ -164,6 +172,8 @@ void NodesPrefsPanel::applyPreferences()
 		}
 	}
 	nodebuilder_options = opt;
+
+	nodebuilder_builtin_fallback = cb_builtin_fallback_->GetValue();
 }
 
 
@@ -19,10 +19,11 @@ public:
 	wxString pageTitle() override { return "Node Builders"; }
 
 private:
-	wxChoice*       choice_nodebuilder_ = nullptr;
-	wxButton*       btn_browse_path_    = nullptr;
-	wxTextCtrl*     text_path_          = nullptr;
-	wxCheckListBox* clb_options_        = nullptr;
+	wxChoice*       choice_nodebuilder_  = nullptr;
+	wxButton*       btn_browse_path_     = nullptr;
+	wxTextCtrl*     text_path_           = nullptr;
+	wxCheckListBox* clb_options_         = nullptr;
+	wxCheckBox*     cb_builtin_fallback_ = nullptr;
 
 	// Events
 	void onBtnBrowse(wxCommandEvent& e);
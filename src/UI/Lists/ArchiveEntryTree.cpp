@@ -41,6 +41,8 @@
 #include "General/UndoRedo.h"
 #include "Graphics/Icons.h"
 #include "UI/WxUtils.h"
+#include "Utility/StringUtils.h"
+#include "Utility/ThreadPool.h"
 #include <wx/headerctrl.h>
 
 using namespace slade;
@@ -71,6 +73,13 @@ CVAR(Bool, elist_rename_inplace, false, CVar::Save)
 CVAR(Bool, elist_rename_inplace, true, CVar::Save)
 #endif
 
+namespace
+{
+// Archives with at least this many entries have filters matched in the
+// background, so that typing in the filter box doesn't lag
+constexpr unsigned ENTRY_TREE_ASYNC_FILTER_MIN = 5000;
+} // namespace
+
 
 // -----------------------------------------------------------------------------
 //
@@ -102,6 +111,112 @@ bool archiveSupportsDirs(Archive* archive)
 }
 } // namespace slade::ui
 
+namespace
+{
+// -----------------------------------------------------------------------------
+// Returns the position of [type] in the list of all entry types sorted by
+// name, so entries can be sorted by type without comparing type names. Types
+// with the same name have the same position
+// -----------------------------------------------------------------------------
+int entryTypeSortOrder(const EntryType* type)
+{
+	static std::unordered_map<const EntryType*, int> type_order;
+
+	if (auto i = type_order.find(type); i != type_order.end())
+		return i->second;
+
+	// Not found, (re)build the list (types can be added after startup)
+	vector<const EntryType*> types;
+	for (auto* etype : EntryType::allTypes())
+		types.push_back(etype);
+	types.push_back(EntryType::unknownType());
+	types.push_back(EntryType::folderType());
+	types.push_back(type);
+	std::sort(
+		types.begin(), types.end(), [](const EntryType* t1, const EntryType* t2) { return t1->name() < t2->name(); });
+
+	type_order.clear();
+	int order = 0;
+	for (unsigned a = 0; a < types.size(); ++a)
+	{
+		if (a > 0 && types[a]->name() != types[a - 1]->name())
+			++order;
+		type_order[types[a]] = order;
+	}
+
+	return type_order[type];
+}
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// ArchiveViewModel::Filter Struct Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Filter struct constructor, processes the comma-separated name patterns in
+// [name]
+// -----------------------------------------------------------------------------
+ArchiveViewModel::Filter::Filter(string_view name, string_view category) : category{ category }
+{
+	for (const auto p : strutil::splitV(name, ','))
+	{
+		auto filter_part = strutil::trim(p);
+		if (filter_part.empty())
+			continue;
+
+		strutil::upperIP(filter_part);
+		filter_part += '*';
+
+		// Patterns with no wildcards other than the trailing * can be matched
+		// with a plain prefix compare
+		auto& pattern   = names.emplace_back();
+		pattern.prefix  = filter_part.find('*') == filter_part.size() - 1 && filter_part.find('?') == string::npos;
+		pattern.pattern = std::move(filter_part);
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Returns true if an entry with [upper_name] and [type] matches the filter
+// -----------------------------------------------------------------------------
+bool ArchiveViewModel::Filter::matches(const string& upper_name, const EntryType* type) const
+{
+	// Check for name match if needed
+	if (!names.empty())
+	{
+		for (const auto& p : names)
+		{
+			if (p.prefix)
+			{
+				if (upper_name.compare(0, p.pattern.size() - 1, p.pattern, 0, p.pattern.size() - 1) == 0)
+					return true;
+			}
+			else if (strutil::matches(upper_name, p.pattern))
+				return true;
+		}
+
+		return false;
+	}
+
+	// Check for category match if needed
+	if (!category.empty() && type != EntryType::folderType())
+		if (!strutil::equalCI(type->category(), category))
+			return false;
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Returns true if the task has finished matching (or was cancelled)
+// -----------------------------------------------------------------------------
+bool ArchiveViewModel::FilterTask::isDone() const
+{
+	return !matching.valid() || matching.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+}
+
 
 // -----------------------------------------------------------------------------
 //
@@ -115,8 +230,9 @@ bool archiveSupportsDirs(Archive* archive)
 // -----------------------------------------------------------------------------
 void ArchiveViewModel::openArchive(shared_ptr<Archive> archive, UndoManager* undo_manager)
 {
-	archive_      = archive;
-	undo_manager_ = undo_manager;
+	archive_              = archive;
+	undo_manager_         = undo_manager;
+	default_sort_by_name_ = archive->formatId() == "folder"; // Directory archives default to alphabetical order
 
 	// Add root items
 	wxDataViewItemArray items;
@@ -128,33 +244,45 @@ void ArchiveViewModel::openArchive(shared_ptr<Archive> archive, UndoManager* und
 
 	// Entry added
 	connections_ += archive->signals().entry_added.connect([this](Archive& archive, ArchiveEntry& entry) {
+		entriesChanged(true);
 		ItemAdded(createItemForDirectory(*entry.parentDir()), wxDataViewItem(&entry));
 	});
 
 	// Entry removed
 	connections_ += archive->signals().entry_removed.connect(
 		[this](Archive& archive, ArchiveDir& dir, ArchiveEntry& entry) {
+			entryChanged(entry);
+			entriesChanged(true);
 			ItemDeleted(createItemForDirectory(dir), wxDataViewItem(&entry));
 		});
 
 	// Entry modified
-	connections_ += archive->signals().entry_state_changed.connect(
-		[this](Archive& archive, ArchiveEntry& entry) { ItemChanged(wxDataViewItem(&entry)); });
+	connections_ += archive->signals().entry_state_changed.connect([this](Archive& archive, ArchiveEntry& entry) {
+		entryChanged(entry);
+		ItemChanged(wxDataViewItem(&entry));
+	});
+
+	// Entry renamed
+	connections_ += archive->signals().entry_renamed.connect(
+		[this](Archive& archive, ArchiveEntry& entry, string_view prev_name) { entryChanged(entry); });
 
 	// Dir added
 	connections_ += archive->signals().dir_added.connect([this](Archive& archive, ArchiveDir& dir) {
+		entriesChanged(true);
 		ItemAdded(createItemForDirectory(*dir.parent()), wxDataViewItem(dir.dirEntry()));
 	});
 
 	// Dir removed
 	connections_ += archive->signals().dir_removed.connect(
 		[this](Archive& archive, ArchiveDir& parent, ArchiveDir& dir) {
+			entriesChanged();
 			ItemDeleted(createItemForDirectory(parent), wxDataViewItem(dir.dirEntry()));
 		});
 
 	// Entries reordered within dir
 	connections_ += archive->signals().entries_swapped.connect(
 		[this](Archive& archive, ArchiveDir& dir, unsigned index1, unsigned index2) {
+			entriesChanged(true);
 			ItemChanged(wxDataViewItem(dir.entryAt(index1)));
 			ItemChanged(wxDataViewItem(dir.entryAt(index2)));
 		});
@@ -179,49 +307,81 @@ void ArchiveViewModel::openArchive(shared_ptr<Archive> archive, UndoManager* und
 // -----------------------------------------------------------------------------
 void ArchiveViewModel::setFilter(string_view name, string_view category)
 {
-	// Check any change is required
-	if (name.empty() && filter_name_.empty() && filter_category_ == category)
-		return;
+	updateFilteredItems({ name, category });
+}
 
-	// Get current root items (to remove)
-	wxDataViewItemArray prev_items;
-	if (auto* archive = archive_.lock().get())
-		getDirChildItems(prev_items, *archive->rootDir());
+// -----------------------------------------------------------------------------
+// Starts matching a filter with the given options against all entries in the
+// archive, on the thread pool. The filter can then be applied via applyFilter
+// once the returned task is done.
+// Returns nullptr if the filter wouldn't change anything
+// -----------------------------------------------------------------------------
+shared_ptr<ArchiveViewModel::FilterTask> ArchiveViewModel::startFilter(string_view name, string_view category) const
+{
+	auto archive = archive_.lock();
+	if (!archive)
+		return nullptr;
 
-	filter_category_ = category;
+	auto task    = std::make_shared<FilterTask>();
+	task->filter = { name, category };
+	if (task->filter.names.empty() && filter_.names.empty() && filter_.category == task->filter.category)
+		return nullptr;
+	task->archive_changes = archive_changes_;
 
-	// Process filter string
-	filter_name_.clear();
-	if (!name.empty())
+	// Copy the entry info needed for matching, since the archive can't be
+	// accessed from the thread pool
+	struct EntryInfo
 	{
-		auto filter_parts = strutil::splitV(name, ',');
-		for (const auto p : filter_parts)
-		{
-			auto filter_part = strutil::trim(p);
-			if (filter_part.empty())
-				continue;
-
-			strutil::upperIP(filter_part);
-			filter_part += '*';
-			filter_name_.push_back(filter_part);
-		}
+		const ArchiveEntry* entry;
+		string              upper_name;
+		const EntryType*    type;
+	};
+	vector<EntryInfo> entries;
+	entries.reserve(archive->numEntries());
+	auto dirs = archive->rootDir()->allDirectories();
+	dirs.push_back(archive->rootDir());
+	for (const auto& dir : dirs)
+	{
+		if (dir != archive->rootDir())
+			entries.push_back({ dir->dirEntry(), dir->dirEntry()->upperName(), dir->dirEntry()->type() });
+		for (const auto& entry : dir->entries())
+			entries.push_back({ entry.get(), entry->upperName(), entry->type() });
 	}
 
-	if (auto* archive = archive_.lock().get())
-	{
-		sort_enabled_ = false;
+	// Match
+	task->matching = app::threadPool().submit([task, entries = std::move(entries)]() {
+		vector<char> matches(entries.size());
+		app::threadPool().parallelFor(
+			entries.size(),
+			[&](size_t index) {
+				if (!task->cancelled)
+					matches[index] = task->filter.matches(entries[index].upper_name, entries[index].type);
+			},
+			256);
+
+		if (task->cancelled)
+			return;
+
+		task->matches.reserve(entries.size());
+		for (unsigned a = 0; a < entries.size(); ++a)
+			task->matches[entries[a].entry] = { entries[a].type, matches[a] != 0 };
+	});
 
-		// Remove previous root items
-		ItemsDeleted({}, prev_items);
+	return task;
+}
 
-		// Re-Add root items (filtered)
-		wxDataViewItemArray items;
-		getDirChildItems(items, *archive->rootDir());
-		ItemsAdded({}, items);
+// -----------------------------------------------------------------------------
+// Applies the filter from [task], which must be done. The matches from the
+// task are only used if the archive hasn't been modified since it was started
+// -----------------------------------------------------------------------------
+void ArchiveViewModel::applyFilter(FilterTask& task)
+{
+	task.matching.wait();
 
-		sort_enabled_ = true;
-		Resort();
-	}
+	if (task.archive_changes == archive_changes_)
+		updateFilteredItems(std::move(task.filter), &task.matches);
+	else
+		updateFilteredItems(std::move(task.filter));
 }
 
 // -----------------------------------------------------------------------------
@@ -504,25 +664,22 @@ int ArchiveViewModel::Compare(
 	if (!sort_enabled_)
 		return 0;
 
-	auto* e1       = static_cast<ArchiveEntry*>(item1.GetID());
-	auto* e1_type  = e1->type();
-	auto* e2       = static_cast<ArchiveEntry*>(item2.GetID());
-	auto* e2_type  = e2->type();
-	auto* t_folder = EntryType::folderType();
+	const auto& k1 = sortKey(static_cast<ArchiveEntry*>(item1.GetID()));
+	const auto& k2 = sortKey(static_cast<ArchiveEntry*>(item2.GetID()));
 
 	// Folder <-> Entry (always show folders first)
-	if (e1_type == t_folder && e2_type != t_folder)
+	if (k1.folder && !k2.folder)
 		return -1;
-	else if (e1_type != t_folder && e2_type == t_folder)
+	else if (!k1.folder && k2.folder)
 		return 1;
 
 	// Folder <-> Folder (always sort alphabetically for now)
-	else if (e1_type == t_folder && e2_type == t_folder)
+	else if (k1.folder && k2.folder)
 	{
 		if (column == 0 && !ascending)
-			return e2->upperName().compare(e1->upperName());
+			return k2.upper_name.compare(k1.upper_name);
 		else
-			return e1->upperName().compare(e2->upperName());
+			return k1.upper_name.compare(k2.upper_name);
 	}
 
 	// Entry <-> Entry
@@ -532,37 +689,37 @@ int ArchiveViewModel::Compare(
 
 		// Name column (order by name only)
 		if (column == 0)
-			cmpval = e1->upperName().compare(e2->upperName());
+			cmpval = k1.upper_name.compare(k2.upper_name);
 
 		// Size column (order by size -> name)
 		else if (column == 1)
 		{
-			if (e1->size() > e2->size())
+			if (k1.size > k2.size)
 				cmpval = 1;
-			else if (e1->size() < e2->size())
+			else if (k1.size < k2.size)
 				cmpval = -1;
 			else
-				cmpval = e1->upperName().compare(e2->upperName());
+				cmpval = k1.upper_name.compare(k2.upper_name);
 		}
 
 		// Type column (order by type name -> name)
 		else if (column == 2)
 		{
-			cmpval = e1_type->name().compare(e2_type->name());
+			cmpval = k1.type_order - k2.type_order;
 			if (cmpval == 0)
-				cmpval = e1->upperName().compare(e2->upperName());
+				cmpval = k1.upper_name.compare(k2.upper_name);
 		}
 
 		// Default
 		else
 		{
 			// Directory archives default to alphabetical order
-			if (const auto archive = archive_.lock(); archive->formatId() == "folder")
-				cmpval = e1->upperName().compare(e2->upperName());
+			if (default_sort_by_name_)
+				cmpval = k1.upper_name.compare(k2.upper_name);
 
 			// Everything else defaults to index order
 			else
-				cmpval = e1->index() > e2->index() ? 1 : -1;
+				cmpval = k1.index > k2.index ? 1 : -1;
 		}
 
 		return ascending ? cmpval : -cmpval;
@@ -590,22 +747,18 @@ wxDataViewItem ArchiveViewModel::createItemForDirectory(const ArchiveDir& dir) c
 // -----------------------------------------------------------------------------
 bool ArchiveViewModel::matchesFilter(const ArchiveEntry& entry) const
 {
-	// Check for name match if needed
-	if (!filter_name_.empty())
-	{
-		for (const auto& f : filter_name_)
-			if (strutil::matches(entry.upperName(), f))
-				return true;
+	if (filter_.isEmpty())
+		return true;
 
-		return false;
+	// Check for a previous match result
+	auto& match = filter_matches_[&entry];
+	if (match.type != entry.type())
+	{
+		match.type    = entry.type();
+		match.matches = filter_.matches(entry.upperName(), entry.type());
 	}
 
-	// Check for category match if needed
-	if (!filter_category_.empty() && entry.type() != EntryType::folderType())
-		if (!strutil::equalCI(entry.type()->category(), filter_category_))
-			return false;
-
-	return true;
+	return match.matches;
 }
 
 // -----------------------------------------------------------------------------
@@ -633,6 +786,108 @@ void ArchiveViewModel::getDirChildItems(wxDataViewItemArray& items, const Archiv
 }
 
 
+// -----------------------------------------------------------------------------
+// Sets the current filter to [filter] and updates the root items to match it.
+// If given, [matches] are used as the filter results for entries, otherwise
+// entries are matched as needed
+// -----------------------------------------------------------------------------
+void ArchiveViewModel::updateFilteredItems(Filter filter, FilterMatches* matches)
+{
+	// Check any change is required
+	if (filter.names.empty() && filter_.names.empty() && filter_.category == filter.category)
+		return;
+
+	// Get current root items (to remove)
+	wxDataViewItemArray prev_items;
+	if (auto* archive = archive_.lock().get())
+		getDirChildItems(prev_items, *archive->rootDir());
+
+	filter_ = std::move(filter);
+	if (matches)
+		filter_matches_ = std::move(*matches);
+	else
+		filter_matches_.clear();
+
+	if (auto* archive = archive_.lock().get())
+	{
+		sort_enabled_ = false;
+
+		// Remove previous root items
+		ItemsDeleted({}, prev_items);
+
+		// Re-Add root items (filtered)
+		wxDataViewItemArray items;
+		getDirChildItems(items, *archive->rootDir());
+		ItemsAdded({}, items);
+
+		sort_enabled_ = true;
+		Resort();
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Returns the sort key for [entry], (re)building it if needed
+// -----------------------------------------------------------------------------
+const ArchiveViewModel::SortKey& ArchiveViewModel::sortKey(ArchiveEntry* entry) const
+{
+	auto& key = sort_keys_[entry];
+
+	if (!key.valid)
+	{
+		key.valid         = true;
+		key.upper_name    = entry->upperName();
+		key.size          = entry->size();
+		key.type          = nullptr;
+		key.index_changes = index_changes_ - 1;
+	}
+
+	// The type can change without the entry being flagged as modified (eg.
+	// when detected after import), but it's quick to check
+	if (key.type != entry->type())
+	{
+		key.type       = entry->type();
+		key.folder     = key.type == EntryType::folderType();
+		key.type_order = entryTypeSortOrder(key.type);
+	}
+
+	if (key.index_changes != index_changes_)
+	{
+		key.index         = entry->index();
+		key.index_changes = index_changes_;
+	}
+
+	return key;
+}
+
+// -----------------------------------------------------------------------------
+// Clears any cached sort/filter info for [entry], called when it is modified
+// or removed
+// -----------------------------------------------------------------------------
+void ArchiveViewModel::entryChanged(const ArchiveEntry& entry)
+{
+	sort_keys_.erase(&entry);
+	filter_matches_.erase(&entry);
+	++archive_changes_;
+}
+
+// -----------------------------------------------------------------------------
+// Called when entries have been added, removed or moved. If [indices_only] is
+// false, all cached sort/filter info is cleared (eg. when a directory and all
+// its entries were removed)
+// -----------------------------------------------------------------------------
+void ArchiveViewModel::entriesChanged(bool indices_only)
+{
+	++index_changes_;
+	++archive_changes_;
+
+	if (!indices_only)
+	{
+		sort_keys_.clear();
+		filter_matches_.clear();
+	}
+}
+
+
 // -----------------------------------------------------------------------------
 //
 // ArchiveEntryTree Class Functions
@@ -678,6 +933,9 @@ ArchiveEntryTree::ArchiveEntryTree(wxWindow* parent, shared_ptr<Archive> archive
 	// Update column width cvars when we can
 	Bind(wxEVT_IDLE, [this](wxIdleEvent&) { saveColumnWidths(); });
 
+	// Apply background filter once it's done
+	filter_timer_.Bind(wxEVT_TIMER, [this](wxTimerEvent&) { checkFilterTask(); });
+
 	// Disable modified indicator (" *" after name) when in-place editing entry names
 	Bind(wxEVT_DATAVIEW_ITEM_EDITING_STARTED, [this](wxDataViewEvent& e) {
 		if (e.GetColumn() == 0)
@@ -749,6 +1007,18 @@ ArchiveEntryTree::ArchiveEntryTree(wxWindow* parent, shared_ptr<Archive> archive
 	});
 }
 
+// -----------------------------------------------------------------------------
+// ArchiveEntryTree class destructor
+// -----------------------------------------------------------------------------
+ArchiveEntryTree::~ArchiveEntryTree()
+{
+	// Stop any background filter (it doesn't access the tree, so no need to
+	// wait for it)
+	filter_timer_.Stop();
+	if (filter_task_)
+		filter_task_->cancelled = true;
+}
+
 // -----------------------------------------------------------------------------
 // Returns the ArchiveDir that [item] represents, or nullptr if it isn't a valid
 // directory item
@@ -1026,12 +1296,25 @@ vector<ArchiveDir*> ArchiveEntryTree::expandedDirs() const
 // -----------------------------------------------------------------------------
 void ArchiveEntryTree::setFilter(string_view name, string_view category)
 {
-	Freeze();
-	auto expanded = expandedDirs();
-	model_->setFilter(name, category);
-	for (auto* dir : expanded)
-		Expand(wxDataViewItem(dir->dirEntry()));
-	Thaw();
+	// Cancel any filter still being matched in the background
+	if (filter_task_)
+	{
+		filter_task_->cancelled = true;
+		filter_task_.reset();
+		filter_timer_.Stop();
+	}
+
+	// Match the filter in the background for large archives, it will be
+	// applied once done (unless cancelled by another filter change before then)
+	if (auto archive = archive_.lock(); archive && archive->numEntries() >= ENTRY_TREE_ASYNC_FILTER_MIN)
+	{
+		filter_task_ = model_->startFilter(name, category);
+		if (filter_task_)
+			filter_timer_.Start(20);
+		return;
+	}
+
+	updateFilter([&]() { model_->setFilter(name, category); });
 }
 
 // -----------------------------------------------------------------------------
@@ -1045,6 +1328,33 @@ void ArchiveEntryTree::collapseAll(const ArchiveDir& dir_start)
 	Collapse(wxDataViewItem(dir_start.dirEntry()));
 }
 
+// -----------------------------------------------------------------------------
+// Calls [apply_filter] to update the model's filter, keeping any currently
+// expanded directories expanded
+// -----------------------------------------------------------------------------
+void ArchiveEntryTree::updateFilter(const std::function<void()>& apply_filter)
+{
+	Freeze();
+	auto expanded = expandedDirs();
+	apply_filter();
+	for (auto* dir : expanded)
+		Expand(wxDataViewItem(dir->dirEntry()));
+	Thaw();
+}
+
+// -----------------------------------------------------------------------------
+// Applies the filter being matched in the background if it is done
+// -----------------------------------------------------------------------------
+void ArchiveEntryTree::checkFilterTask()
+{
+	if (!filter_task_ || !filter_task_->isDone())
+		return;
+
+	filter_timer_.Stop();
+	auto task = std::move(filter_task_);
+	updateFilter([&]() { model_->applyFilter(*task); });
+}
+
 // -----------------------------------------------------------------------------
 // Creates and sets up the tree columns
 // -----------------------------------------------------------------------------
@@ -1,6 +1,8 @@
 #pragma once
 
 #include "General/Sigslot.h"
+#include <atomic>
+#include <future>
 #include <wx/dataview.h>
 
 namespace slade
@@ -8,6 +10,7 @@ namespace slade
 class Archive;
 class ArchiveEntry;
 class ArchiveDir;
+class EntryType;
 class UndoManager;
 
 namespace ui
@@ -15,20 +18,83 @@ namespace ui
 	class ArchiveViewModel : public wxDataViewModel
 	{
 	public:
+		// Entry name/category filter, with name patterns pre-processed for
+		// quicker matching
+		struct Filter
+		{
+			struct NamePattern
+			{
+				string pattern;        // Uppercase, always ends with '*'
+				bool   prefix = false; // True if the only wildcard is the '*' at the end
+			};
+
+			vector<NamePattern> names;
+			string              category;
+
+			Filter() = default;
+			Filter(string_view name, string_view category);
+
+			bool isEmpty() const { return names.empty() && category.empty(); }
+			bool matches(const string& upper_name, const EntryType* type) const;
+		};
+
+		// Result of matching a filter for an entry (the type is kept since
+		// it can change without the entry being flagged as modified)
+		struct FilterMatch
+		{
+			const EntryType* type    = nullptr;
+			bool             matches = false;
+		};
+		typedef std::unordered_map<const ArchiveEntry*, FilterMatch> FilterMatches;
+
+		// A filter being matched against the archive's entries on the thread
+		// pool (see startFilter)
+		struct FilterTask
+		{
+			Filter            filter;
+			unsigned          archive_changes = 0;
+			std::atomic<bool> cancelled{ false };
+			std::future<void> matching;
+			FilterMatches     matches;
+
+			bool isDone() const;
+		};
+
 		ArchiveViewModel() = default;
 
-		void openArchive(shared_ptr<Archive> archive, UndoManager* undo_manager);
-		void setFilter(string_view name, string_view category);
-		void showModifiedIndicators(bool show) { modified_indicator_ = show; }
+		void                   openArchive(shared_ptr<Archive> archive, UndoManager* undo_manager);
+		void                   setFilter(string_view name, string_view category);
+		shared_ptr<FilterTask> startFilter(string_view name, string_view category) const;
+		void                   applyFilter(FilterTask& task);
+		void                   showModifiedIndicators(bool show) { modified_indicator_ = show; }
 
 	private:
+		// Info used to sort an entry, cached so that it doesn't need to be
+		// looked up from the entry on every comparison
+		struct SortKey
+		{
+			bool             valid = false;
+			bool             folder;
+			string           upper_name;
+			uint32_t         size;
+			const EntryType* type = nullptr;
+			int              type_order;
+			int              index;
+			unsigned         index_changes;
+		};
+
 		weak_ptr<Archive>    archive_;
 		ScopedConnectionList connections_;
-		vector<string>       filter_name_;
-		string               filter_category_;
-		UndoManager*         undo_manager_ = nullptr;
-		bool                 sort_enabled_ = true;
-		bool                 modified_indicator_ = true;
+		Filter               filter_;
+		UndoManager*         undo_manager_         = nullptr;
+		bool                 sort_enabled_         = true;
+		bool                 modified_indicator_   = true;
+		bool                 default_sort_by_name_ = false;
+		unsigned             archive_changes_      = 0; // Incremented whenever any entry is changed
+		unsigned             index_changes_        = 0; // Incremented whenever entry indices may have changed
+
+		mutable std::unordered_map<const ArchiveEntry*, SortKey> sort_keys_;
+		mutable FilterMatches                                    filter_matches_;
 
 		// wxDataViewModel
 		unsigned int   GetColumnCount() const override { return 4; }
@@ -47,12 +113,17 @@ namespace ui
 		wxDataViewItem createItemForDirectory(const ArchiveDir& dir) const;
 		bool           matchesFilter(const ArchiveEntry& entry) const;
 		void           getDirChildItems(wxDataViewItemArray& items, const ArchiveDir& dir, bool filter = true) const;
+		void           updateFilteredItems(Filter filter, FilterMatches* matches = nullptr);
+		const SortKey& sortKey(ArchiveEntry* entry) const;
+		void           entryChanged(const ArchiveEntry& entry);
+		void           entriesChanged(bool indices_only = false);
 	};
 
 	class ArchiveEntryTree : public wxDataViewCtrl
 	{
 	public:
 		ArchiveEntryTree(wxWindow* parent, shared_ptr<Archive> archive, UndoManager* undo_manager);
+		~ArchiveEntryTree() override;
 
 		ArchiveEntry* entryForItem(const wxDataViewItem& item) const
 		{
@@ -81,16 +152,20 @@ namespace ui
 		void collapseAll(const ArchiveDir& dir_start);
 
 	private:
-		weak_ptr<Archive> archive_;
-		ArchiveViewModel* model_     = nullptr;
-		wxDataViewColumn* col_name_  = nullptr;
-		wxDataViewColumn* col_size_  = nullptr;
-		wxDataViewColumn* col_type_  = nullptr;
-		wxDataViewColumn* col_index_ = nullptr;
+		weak_ptr<Archive>                        archive_;
+		ArchiveViewModel*                        model_     = nullptr;
+		wxDataViewColumn*                        col_name_  = nullptr;
+		wxDataViewColumn*                        col_size_  = nullptr;
+		wxDataViewColumn*                        col_type_  = nullptr;
+		wxDataViewColumn*                        col_index_ = nullptr;
+		shared_ptr<ArchiveViewModel::FilterTask> filter_task_; // Filter being matched in the background, if any
+		wxTimer                                  filter_timer_;
 
 		void setupColumns();
 		void saveColumnWidths() const;
 		void updateColumnWidths();
+		void updateFilter(const std::function<void()>& apply_filter);
+		void checkFilterTask();
 	};
 
 } // namespace ui
@@ -0,0 +1,341 @@
+
+// -----------------------------------------------------------------------------
+// SLADE - It's a Doom Editor
+// Copyright(C) 2008 - 2020 Simon Judd
+//
+// Email:       sirjuddington@gmail.com
+// Web:         http://slade.mancubus.net
+// Filename:    BVH.cpp
+// Description: BVH class, a bounding volume hierarchy of axis-aligned boxes,
+//              used to quickly find the nearest primitive hit by a ray.
+//              The hierarchy can be refitted to updated boxes without being
+//              rebuilt, as long as the number of primitives is unchanged
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301, USA.
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+//
+// Includes
+//
+// -----------------------------------------------------------------------------
+#include "Main.h"
+#include "BVH.h"
+
+using namespace slade;
+
+
+// -----------------------------------------------------------------------------
+//
+// Variables
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// Max number of primitives in a leaf node
+constexpr unsigned BVH_LEAF_SIZE = 4;
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// BVH::Box Struct Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Extends the box to include [point]
+// -----------------------------------------------------------------------------
+void BVH::Box::extend(const Vec3d& point)
+{
+	min.x = std::min(min.x, point.x);
+	min.y = std::min(min.y, point.y);
+	min.z = std::min(min.z, point.z);
+	max.x = std::max(max.x, point.x);
+	max.y = std::max(max.y, point.y);
+	max.z = std::max(max.z, point.z);
+}
+
+// -----------------------------------------------------------------------------
+// Extends the box to include [box] (if it is valid)
+// -----------------------------------------------------------------------------
+void BVH::Box::extend(const Box& box)
+{
+	if (!box.valid())
+		return;
+
+	extend(box.min);
+	extend(box.max);
+}
+
+// -----------------------------------------------------------------------------
+// Checks if the ray from [origin] (with direction reciprocal [inv_dir])
+// enters the box within [max_dist]. If it does, [dist] is set to the distance
+// along the ray where it enters (0 if [origin] is inside the box)
+// -----------------------------------------------------------------------------
+bool BVH::Box::intersectRay(const Vec3d& origin, const Vec3d& inv_dir, double max_dist, double& dist) const
+{
+	if (!valid())
+		return false;
+
+	double t_min = 0.;
+	double t_max = max_dist;
+
+	// Slab test on each axis
+	auto slab = [&t_min, &t_max](double o, double inv, double b_min, double b_max) {
+		auto t1 = (b_min - o) * inv;
+		auto t2 = (b_max - o) * inv;
+		if (t1 > t2)
+			std::swap(t1, t2);
+
+		// NaN (ray parallel to and on a slab boundary) counts as inside
+		if (t1 > t_min)
+			t_min = t1;
+		if (t2 < t_max)
+			t_max = t2;
+
+		return t_min <= t_max;
+	};
+
+	if (!slab(origin.x, inv_dir.x, min.x, max.x) || !slab(origin.y, inv_dir.y, min.y, max.y)
+		|| !slab(origin.z, inv_dir.z, min.z, max.z))
+		return false;
+
+	dist = t_min;
+	return true;
+}
+
+
+// -----------------------------------------------------------------------------
+//
+// BVH Class Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Builds the hierarchy for primitives with bounding [boxes]. Primitives with
+// invalid (empty) boxes are included but can't be hit until refitted with a
+// valid box
+// -----------------------------------------------------------------------------
+void BVH::build(const vector<Box>& boxes)
+{
+	clear();
+
+	n_primitives_ = boxes.size();
+	if (n_primitives_ == 0)
+		return;
+
+	prim_order_.resize(n_primitives_);
+	for (unsigned a = 0; a < n_primitives_; a++)
+		prim_order_[a] = a;
+
+	nodes_.reserve(n_primitives_ * 2 / BVH_LEAF_SIZE + 1);
+	nodes_.emplace_back();
+	buildNode(0, 0, n_primitives_, boxes);
+}
+
+// -----------------------------------------------------------------------------
+// Updates the bounds of all nodes from [boxes], keeping the current structure.
+// [boxes] must have the same number of primitives the hierarchy was built with
+// -----------------------------------------------------------------------------
+void BVH::refit(const vector<Box>& boxes)
+{
+	if (boxes.size() != n_primitives_)
+	{
+		build(boxes);
+		return;
+	}
+
+	if (!nodes_.empty())
+		refitNode(0, boxes);
+}
+
+// -----------------------------------------------------------------------------
+// Clears the hierarchy
+// -----------------------------------------------------------------------------
+void BVH::clear()
+{
+	nodes_.clear();
+	prim_order_.clear();
+	n_primitives_ = 0;
+}
+
+// -----------------------------------------------------------------------------
+// Finds the nearest primitive hit by the ray from [origin] along [dir], within
+// [max_dist]. [hit_test] is called for each primitive whose box is entered by
+// the ray before the nearest hit found so far.
+// Returns the distance to the nearest hit and sets [hit_index] to the index of
+// the primitive hit, or returns a negative value if nothing was hit
+// -----------------------------------------------------------------------------
+double BVH::nearestHit(
+	const Vec3d&   origin,
+	const Vec3d&   dir,
+	const HitTest& hit_test,
+	int&           hit_index,
+	double         max_dist) const
+{
+	hit_index = -1;
+	if (nodes_.empty())
+		return -1.;
+
+	Vec3d inv_dir{ 1. / dir.x, 1. / dir.y, 1. / dir.z };
+	auto  nearest = max_dist;
+
+	// Check root
+	double dist;
+	if (!nodes_[0].box.intersectRay(origin, inv_dir, nearest, dist))
+		return -1.;
+
+	// Nodes to check, with the distance the ray enters them
+	vector<std::pair<unsigned, double>> stack;
+	stack.reserve(64);
+	stack.emplace_back(0, dist);
+	while (!stack.empty())
+	{
+		auto [index, enter_dist] = stack.back();
+		stack.pop_back();
+
+		// Skip if something closer was hit since this node was added
+		if (enter_dist >= nearest)
+			continue;
+
+		auto& node = nodes_[index];
+
+		// Leaf, test primitives
+		if (node.count > 0)
+		{
+			for (unsigned a = node.first; a < node.first + node.count; a++)
+			{
+				auto prim = prim_order_[a];
+				auto hit  = hit_test(prim);
+				if (hit >= 0 && hit < nearest)
+				{
+					nearest   = hit;
+					hit_index = static_cast<int>(prim);
+				}
+			}
+			continue;
+		}
+
+		// Add children, nearest last so it is checked first
+		double d1, d2;
+		bool   hit1 = nodes_[node.first].box.intersectRay(origin, inv_dir, nearest, d1);
+		bool   hit2 = nodes_[node.first + 1].box.intersectRay(origin, inv_dir, nearest, d2);
+		if (hit1 && hit2)
+		{
+			if (d1 < d2)
+			{
+				stack.emplace_back(node.first + 1, d2);
+				stack.emplace_back(node.first, d1);
+			}
+			else
+			{
+				stack.emplace_back(node.first, d1);
+				stack.emplace_back(node.first + 1, d2);
+			}
+		}
+		else if (hit1)
+			stack.emplace_back(node.first, d1);
+		else if (hit2)
+			stack.emplace_back(node.first + 1, d2);
+	}
+
+	return hit_index >= 0 ? nearest : -1.;
+}
+
+// -----------------------------------------------------------------------------
+// Builds [node] for primitives [start] to [end] in prim_order_, splitting them
+// at the median along the longest axis of their centres
+// -----------------------------------------------------------------------------
+void BVH::buildNode(unsigned node, unsigned start, unsigned end, const vector<Box>& boxes)
+{
+	// Determine bounds
+	Box bounds, centres;
+	for (unsigned a = start; a < end; a++)
+	{
+		auto& box = boxes[prim_order_[a]];
+		bounds.extend(box);
+		if (box.valid())
+			centres.extend(box.centre());
+	}
+	nodes_[node].box = bounds;
+
+	// Leaf
+	auto count = end - start;
+	if (count <= BVH_LEAF_SIZE || !centres.valid())
+	{
+		nodes_[node].first = start;
+		nodes_[node].count = count;
+		return;
+	}
+
+	// Split along the longest axis
+	auto size = centres.max - centres.min;
+	int  axis = 0;
+	if (size.y > size.x && size.y >= size.z)
+		axis = 1;
+	else if (size.z > size.x && size.z > size.y)
+		axis = 2;
+
+	// (invalid boxes are sorted to the end)
+	auto centre_on_axis = [axis, &boxes](unsigned prim) {
+		auto& box = boxes[prim];
+		if (!box.valid())
+			return 1e300;
+		auto c = box.centre();
+		return axis == 0 ? c.x : axis == 1 ? c.y : c.z;
+	};
+	auto mid = start + count / 2;
+	std::nth_element(
+		prim_order_.begin() + start,
+		prim_order_.begin() + mid,
+		prim_order_.begin() + end,
+		[&centre_on_axis](unsigned left, unsigned right) { return centre_on_axis(left) < centre_on_axis(right); });
+
+	// Build children
+	auto children      = static_cast<unsigned>(nodes_.size());
+	nodes_[node].first = children;
+	nodes_[node].count = 0;
+	nodes_.emplace_back();
+	nodes_.emplace_back();
+	buildNode(children, start, mid, boxes);
+	buildNode(children + 1, mid, end, boxes);
+}
+
+// -----------------------------------------------------------------------------
+// Updates the bounds of [node] (and its children) from [boxes]
+// -----------------------------------------------------------------------------
+void BVH::refitNode(unsigned node, const vector<Box>& boxes)
+{
+	Box bounds;
+	if (nodes_[node].count > 0)
+	{
+		for (unsigned a = nodes_[node].first; a < nodes_[node].first + nodes_[node].count; a++)
+			bounds.extend(boxes[prim_order_[a]]);
+	}
+	else
+	{
+		auto first = nodes_[node].first;
+		refitNode(first, boxes);
+		refitNode(first + 1, boxes);
+		bounds.extend(nodes_[first].box);
+		bounds.extend(nodes_[first + 1].box);
+	}
+
+	nodes_[node].box = bounds;
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+namespace slade
+{
+class BVH
+{
+public:
+	struct Box
+	{
+		Vec3d min{ 1e300, 1e300, 1e300 };
+		Vec3d max{ -1e300, -1e300, -1e300 };
+
+		bool  valid() const { return min.x <= max.x && min.y <= max.y && min.z <= max.z; }
+		Vec3d centre() const { return (min + max) * 0.5; }
+		void  extend(const Vec3d& point);
+		void  extend(const Box& box);
+		bool  intersectRay(const Vec3d& origin, const Vec3d& inv_dir, double max_dist, double& dist) const;
+	};
+
+	// Tests the primitive at [index] against the ray, returns the distance
+	// along the ray to the hit, or a negative value if it wasn't hit
+	typedef std::function<double(unsigned index)> HitTest;
+
+	BVH()  = default;
+	~BVH() = default;
+
+	unsigned nPrimitives() const { return n_primitives_; }
+
+	void   build(const vector<Box>& boxes);
+	void   refit(const vector<Box>& boxes);
+	void   clear();
+	double nearestHit(
+		const Vec3d&   origin,
+		const Vec3d&   dir,
+		const HitTest& hit_test,
+		int&           hit_index,
+		double         max_dist = 1e300) const;
+
+private:
+	// Leaf nodes have [count] > 0, and refer to [count] primitives starting at
+	// [first] in prim_order_. Other nodes have their children at [first] and
+	// [first] + 1
+	struct Node
+	{
+		Box      box;
+		unsigned first = 0;
+		unsigned count = 0;
+	};
+
+	vector<Node>     nodes_;
+	vector<unsigned> prim_order_;
+	unsigned         n_primitives_ = 0;
+
+	void buildNode(unsigned node, unsigned start, unsigned end, const vector<Box>& boxes);
+	void refitNode(unsigned node, const vector<Box>& boxes);
+};
+} // namespace slade
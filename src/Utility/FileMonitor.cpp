@@ -7,7 +7,8 @@
 // Web:         http://slade.mancubus.net
 // Filename:    FileMonitor.cpp
 // Description: FileMonitor class, keeps track of a file and checks it for any
-//              modifications every second, also tracks an external process, and
+//              modifications (via a FileWatcher, so either on file system
+//              events or every second), also tracks an external process, and
 //              deletes itself when this process is terminated.
 //
 // This program is free software; you can redistribute it and/or modify it
@@ -57,23 +58,40 @@ FileMonitor::FileMonitor(string_view filename, bool start) : filename_{ filename
 	// Create process
 	process_ = std::make_unique<wxProcess>(this);
 
-	// Start timer (updates every 1 sec)
+	// Start monitoring
 	if (start)
-	{
-		file_modified_ = fileutil::fileModifiedTime(filename);
-		wxTimer::Start(1000);
-	}
+		startMonitoring();
 
 	// Bind events
 	Bind(wxEVT_END_PROCESS, &FileMonitor::onEndProcess, this);
 }
 
 // -----------------------------------------------------------------------------
-// Override of wxTimer::Notify, called each time the timer updates
+// Starts watching the file for modifications
 // -----------------------------------------------------------------------------
-void FileMonitor::Notify()
+void FileMonitor::startMonitoring()
+{
+	file_modified_ = fileutil::fileModifiedTime(filename_);
+
+	// Only react to changes to our own file
+	sc_file_changed_ = watcher_.signals().changed.connect([this](const vector<FileChange>& changes) {
+		for (const auto& change : changes)
+			if (change.type == FileChange::Type::Rescan
+				|| (change.type != FileChange::Type::Deleted && change.path == filename_))
+			{
+				checkModified();
+				return;
+			}
+	});
+	watcher_.watchFile(filename_);
+}
+
+// -----------------------------------------------------------------------------
+// Checks if the file has been modified since last update, and runs any custom
+// code if it has
+// -----------------------------------------------------------------------------
+void FileMonitor::checkModified()
 {
-	// Check if the file has been modified since last update
 	auto modified = fileutil::fileModifiedTime(filename_);
 	if (modified > file_modified_)
 	{
@@ -92,13 +110,7 @@ void FileMonitor::onEndProcess(wxProcessEvent& e)
 	processTerminated();
 
 	// Check if the file has been modified since last update
-	auto modified = fileutil::fileModifiedTime(filename_);
-	if (modified > file_modified_)
-	{
-		// Modified, update modification time and run any custom code
-		file_modified_ = modified;
-		fileModified();
-	}
+	checkModified();
 
 	// Delete this FileMonitor (its job is done)
 	delete this;
@@ -155,6 +167,11 @@ void DB2MapFileMonitor::fileModified()
 				break;
 			}
 
+			// If the map lumps are unchanged in layout, only update those
+			// whose data actually changed
+			if (updateChangedLumps(*wad, map.entries(*archive_, true)))
+				break;
+
 			// Delete existing map entries
 			auto entries = map.entries(*archive_);
 			for (auto entry : entries)
@@ -176,6 +193,38 @@ void DB2MapFileMonitor::fileModified()
 	}
 }
 
+// -----------------------------------------------------------------------------
+// Updates only the lumps in [map_entries] whose data differs from the matching
+// lump in the modified [wad].
+// Returns false if the lump layout differs (lumps added, removed or reordered),
+// in which case the whole map needs to be replaced
+// -----------------------------------------------------------------------------
+bool DB2MapFileMonitor::updateChangedLumps(Archive& wad, const vector<ArchiveEntry*>& map_entries) const
+{
+	// Check lump names match in order
+	if (wad.numEntries() != map_entries.size())
+		return false;
+	for (unsigned a = 0; a < map_entries.size(); a++)
+		if (wad.entryAt(a)->upperName() != map_entries[a]->upperName())
+			return false;
+
+	// Re-import any lumps with changed data
+	for (unsigned a = 0; a < map_entries.size(); a++)
+	{
+		auto& new_data = wad.entryAt(a)->data();
+		auto& old_data = map_entries[a]->data();
+		if (new_data.size() == old_data.size()
+			&& (new_data.size() == 0 || memcmp(new_data.data(), old_data.data(), new_data.size()) == 0))
+			continue;
+
+		map_entries[a]->unlock();
+		map_entries[a]->importMemChunk(new_data);
+		map_entries[a]->lock();
+	}
+
+	return true;
+}
+
 // -----------------------------------------------------------------------------
 // Called when the Doom Builder 2 process is terminated
 // -----------------------------------------------------------------------------
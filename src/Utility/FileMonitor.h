@@ -1,10 +1,13 @@
 #pragma once
 
+#include "FileWatcher.h"
+
 namespace slade
 {
 class Archive;
+class ArchiveEntry;
 
-class FileMonitor : public wxTimer
+class FileMonitor : public wxEvtHandler
 {
 public:
 	FileMonitor(string_view filename, bool start = true);
@@ -13,18 +16,22 @@ public:
 	wxProcess*    process() const { return process_.get(); }
 	const string& filename() const { return filename_; }
 
+	void         startMonitoring();
 	virtual void fileModified() {}
 	virtual void processTerminated() {}
 
-	void Notify() override;
 	void onEndProcess(wxProcessEvent& e);
 
 protected:
 	string filename_;
-	time_t file_modified_;
+	time_t file_modified_ = 0;
 
 private:
-	unique_ptr<wxProcess> process_;
+	unique_ptr<wxProcess>      process_;
+	FileWatcher                watcher_;
+	sigslot::scoped_connection sc_file_changed_;
+
+	void checkModified();
 };
 
 class DB2MapFileMonitor : public FileMonitor
@@ -39,5 +46,7 @@ public:
 private:
 	Archive* archive_ = nullptr;
 	string   map_name_;
+
+	bool updateChangedLumps(Archive& wad, const vector<ArchiveEntry*>& map_entries) const;
 };
 } // namespace slade
@@ -0,0 +1,801 @@
+
+// -----------------------------------------------------------------------------
+// SLADE - It's a Doom Editor
+// Copyright(C) 2008 - 2020 Simon Judd
+//
+// Email:       sirjuddington@gmail.com
+// Web:         http://slade.mancubus.net
+// Filename:    FileWatcher.cpp
+// Description: FileWatcher class, watches files and directory trees for changes
+//              on the file system. On Linux this is event driven via a single
+//              inotify instance and background thread shared by all watchers,
+//              other platforms fall back to polling modification times of
+//              watched files every second (directory watching is unavailable
+//              there, callers should use their own scan instead).
+//              Changes are collected in the background thread and delivered in
+//              batches via the 'changed' signal on the main thread.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301, USA.
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+//
+// Includes
+//
+// -----------------------------------------------------------------------------
+#include "Main.h"
+#include "FileWatcher.h"
+#include "FileUtils.h"
+#include "StringUtils.h"
+
+#ifdef __linux__
+#include <cerrno>
+#include <cstring>
+#include <dirent.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <thread>
+#include <unistd.h>
+#endif
+
+using namespace slade;
+
+
+// -----------------------------------------------------------------------------
+//
+// Variables
+//
+// -----------------------------------------------------------------------------
+CVAR(Bool, file_watcher_os_events, true, CVar::Flag::Save)
+wxDEFINE_EVENT(wxEVT_COMMAND_FILEWATCHER_CHANGES, wxThreadEvent);
+
+
+// -----------------------------------------------------------------------------
+//
+// Constants
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// How long to wait for further events before delivering a batch of changes
+constexpr int WATCHER_BATCH_DELAY_MS = 250;
+
+// Deliver a batch early if it grows past this many changes
+constexpr size_t WATCHER_MAX_BATCH = 8192;
+
+#ifdef __linux__
+constexpr uint32_t WATCHER_DIR_EVENTS = IN_CREATE | IN_MODIFY | IN_CLOSE_WRITE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO
+										| IN_ATTRIB | IN_DONT_FOLLOW | IN_ONLYDIR;
+#endif
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// -----------------------------------------------------------------------------
+// Adds [change] to the [pending] list, dropping it if it is a modification of a
+// path already created/modified within the same batch
+// -----------------------------------------------------------------------------
+void addPendingChange(vector<FileChange>& pending, FileChange change)
+{
+	if (change.type == FileChange::Type::Modified)
+	{
+		for (auto it = pending.rbegin(); it != pending.rend(); ++it)
+		{
+			if (it->path != change.path)
+				continue;
+
+			if (it->type == FileChange::Type::Created || it->type == FileChange::Type::Modified
+				|| it->type == FileChange::Type::Renamed)
+				return;
+
+			break;
+		}
+	}
+
+	pending.push_back(std::move(change));
+}
+} // namespace
+
+
+#ifdef __linux__
+// -----------------------------------------------------------------------------
+//
+// FileWatcher::Inotify Class
+//
+// -----------------------------------------------------------------------------
+namespace slade
+{
+// -----------------------------------------------------------------------------
+// The inotify instance and event thread shared by all FileWatchers. Watchers
+// register with it and add/remove directory watches on it, and events for each
+// watch descriptor are passed on to the watcher(s) that added it
+// -----------------------------------------------------------------------------
+class FileWatcher::Inotify
+{
+public:
+	bool addWatcher(FileWatcher* watcher);
+	void removeWatcher(FileWatcher* watcher);
+	int  addWatch(FileWatcher* watcher, const string& path);
+	void removeWatch(FileWatcher* watcher, int wd);
+
+private:
+	int                                 fd_      = -1;
+	int                                 wake_fd_ = -1;
+	std::thread                         thread_;
+	std::recursive_mutex                mutex_; // Recursive as watchers add/remove watches while handling events
+	std::set<FileWatcher*>              watchers_;
+	std::map<int, vector<FileWatcher*>> wd_watchers_; // Watch descriptor -> watchers using it
+
+	void run();
+	bool readEvents();
+};
+} // namespace slade
+
+// -----------------------------------------------------------------------------
+// Registers [watcher] with the shared inotify instance, initialising it and
+// starting the event thread if needed.
+// Returns false if inotify could not be initialised
+// -----------------------------------------------------------------------------
+bool FileWatcher::Inotify::addWatcher(FileWatcher* watcher)
+{
+	std::lock_guard lock(mutex_);
+
+	if (fd_ < 0)
+	{
+		fd_ = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+		if (fd_ < 0)
+		{
+			log::warning("Unable to initialise inotify: {}", strerror(errno));
+			return false;
+		}
+
+		wake_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+		if (wake_fd_ < 0)
+		{
+			log::warning("Unable to create file watcher wake event: {}", strerror(errno));
+			close(fd_);
+			fd_ = -1;
+			return false;
+		}
+
+		thread_ = std::thread([this]() { run(); });
+	}
+
+	watchers_.insert(watcher);
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Removes all of [watcher]'s watches and unregisters it. No more events will be
+// passed to [watcher] after this returns. The event thread is stopped and the
+// inotify instance closed once no watchers are left
+// -----------------------------------------------------------------------------
+void FileWatcher::Inotify::removeWatcher(FileWatcher* watcher)
+{
+	{
+		std::lock_guard lock(mutex_);
+
+		if (watchers_.erase(watcher) == 0)
+			return;
+
+		for (auto it = wd_watchers_.begin(); it != wd_watchers_.end();)
+		{
+			auto& watchers = it->second;
+			watchers.erase(std::remove(watchers.begin(), watchers.end(), watcher), watchers.end());
+			if (watchers.empty())
+			{
+				inotify_rm_watch(fd_, it->first);
+				it = wd_watchers_.erase(it);
+			}
+			else
+				++it;
+		}
+
+		if (!watchers_.empty())
+			return;
+	}
+
+	// No watchers left, stop the event thread
+	uint64_t wake = 1;
+	if (write(wake_fd_, &wake, sizeof(wake)) < 0)
+		log::warning("Unable to wake file watcher thread");
+	thread_.join();
+
+	close(fd_);
+	close(wake_fd_);
+	fd_      = -1;
+	wake_fd_ = -1;
+}
+
+// -----------------------------------------------------------------------------
+// Adds an inotify watch on the directory at [path] for [watcher]. If another
+// watcher already watches the directory the existing watch is shared.
+// Returns the watch descriptor, or -1 on failure
+// -----------------------------------------------------------------------------
+int FileWatcher::Inotify::addWatch(FileWatcher* watcher, const string& path)
+{
+	std::lock_guard lock(mutex_);
+
+	const int wd = inotify_add_watch(fd_, path.c_str(), WATCHER_DIR_EVENTS);
+	if (wd < 0)
+		return -1;
+
+	auto& watchers = wd_watchers_[wd];
+	if (std::find(watchers.begin(), watchers.end(), watcher) == watchers.end())
+		watchers.push_back(watcher);
+
+	return wd;
+}
+
+// -----------------------------------------------------------------------------
+// Removes [watcher] from the watch [wd], removing the inotify watch itself if
+// no other watchers are using it
+// -----------------------------------------------------------------------------
+void FileWatcher::Inotify::removeWatch(FileWatcher* watcher, int wd)
+{
+	std::lock_guard lock(mutex_);
+
+	auto it = wd_watchers_.find(wd);
+	if (it == wd_watchers_.end())
+		return;
+
+	auto& watchers = it->second;
+	watchers.erase(std::remove(watchers.begin(), watchers.end(), watcher), watchers.end());
+	if (watchers.empty())
+	{
+		inotify_rm_watch(fd_, wd);
+		wd_watchers_.erase(it);
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Event thread function, waits for inotify events and has each watcher post
+// its batch of changes to the main thread once no more events have arrived for
+// a short time
+// -----------------------------------------------------------------------------
+void FileWatcher::Inotify::run()
+{
+	pollfd fds[2];
+	fds[0] = { fd_, POLLIN, 0 };
+	fds[1] = { wake_fd_, POLLIN, 0 };
+
+	while (true)
+	{
+		// Only time out if there are changes waiting to be posted
+		int timeout = -1;
+		{
+			std::lock_guard lock(mutex_);
+			for (auto* watcher : watchers_)
+				if (!watcher->pending_.empty() || !watcher->moves_.empty() || watcher->overflow_)
+				{
+					timeout = WATCHER_BATCH_DELAY_MS;
+					break;
+				}
+		}
+
+		auto result = poll(fds, 2, timeout);
+		if (result < 0)
+		{
+			if (errno == EINTR)
+				continue;
+			break;
+		}
+
+		// Stop requested
+		if (fds[1].revents & POLLIN)
+			break;
+
+		// New events, read them and keep waiting unless a batch is already large
+		if (result > 0 && (fds[0].revents & POLLIN) && !readEvents())
+			continue;
+
+		std::lock_guard lock(mutex_);
+		for (auto* watcher : watchers_)
+			watcher->postPending();
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Reads all available inotify events and passes them on to the watchers using
+// each event's watch descriptor.
+// Returns true if any watcher's batch of changes should be posted now
+// -----------------------------------------------------------------------------
+bool FileWatcher::Inotify::readEvents()
+{
+	alignas(inotify_event) char buffer[64 * 1024];
+
+	std::lock_guard lock(mutex_);
+	while (true)
+	{
+		auto len = read(fd_, buffer, sizeof(buffer));
+		if (len <= 0)
+			break;
+
+		for (char* ptr = buffer; ptr < buffer + len;)
+		{
+			auto event = reinterpret_cast<const inotify_event*>(ptr);
+			ptr += sizeof(inotify_event) + event->len;
+
+			// Kernel event queue overflowed, every watcher has lost events
+			if (event->mask & IN_Q_OVERFLOW)
+			{
+				for (auto* watcher : watchers_)
+					watcher->overflow_ = true;
+				continue;
+			}
+
+			auto it = wd_watchers_.find(event->wd);
+			if (it == wd_watchers_.end())
+				continue;
+
+			// Copy the list, handling the event can add or remove watches
+			auto watchers = it->second;
+			for (auto* watcher : watchers)
+				watcher->handleEvent(*event);
+
+			// Watch removed (directory deleted or unmounted)
+			if (event->mask & IN_IGNORED)
+				wd_watchers_.erase(event->wd);
+		}
+	}
+
+	for (auto* watcher : watchers_)
+		if (watcher->pending_.size() >= WATCHER_MAX_BATCH || watcher->overflow_)
+			return true;
+
+	return false;
+}
+#endif
+
+
+// -----------------------------------------------------------------------------
+//
+// FileWatcher Class Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// FileWatcher class constructor
+// -----------------------------------------------------------------------------
+FileWatcher::FileWatcher()
+{
+	poll_timer_.SetOwner(this);
+
+	Bind(wxEVT_COMMAND_FILEWATCHER_CHANGES, &FileWatcher::onChanges, this);
+	Bind(wxEVT_TIMER, &FileWatcher::onPollTimer, this);
+}
+
+// -----------------------------------------------------------------------------
+// FileWatcher class destructor
+// -----------------------------------------------------------------------------
+FileWatcher::~FileWatcher()
+{
+	stop();
+}
+
+// -----------------------------------------------------------------------------
+// Returns true if changes are delivered from OS notifications rather than by
+// polling
+// -----------------------------------------------------------------------------
+bool FileWatcher::isEventDriven() const
+{
+#ifdef __linux__
+	return inotify_;
+#else
+	return false;
+#endif
+}
+
+// -----------------------------------------------------------------------------
+// Starts watching the file at [path]. Uses OS notifications if available,
+// otherwise the file's modification time is polled every second.
+// Returns false if the file could not be watched
+// -----------------------------------------------------------------------------
+bool FileWatcher::watchFile(string_view path)
+{
+	string file_path{ path };
+
+#ifdef __linux__
+	if (eventDrivenAvailable() && initInotify())
+	{
+		// Watch the parent directory rather than the file itself, since many
+		// editors save by writing a new file and renaming it over the old one
+		string dir{ strutil::Path::pathOf(file_path, false) };
+		if (dir.empty())
+			dir = ".";
+
+		{
+			std::lock_guard lock(mutex_);
+			watched_files_.insert(file_path);
+		}
+
+		if (addWatch(dir, false) >= 0)
+			return true;
+
+		std::lock_guard lock(mutex_);
+		watched_files_.erase(file_path);
+	}
+#endif
+
+	// Fall back to polling
+	polled_files_.push_back(
+		{ file_path, fileutil::fileModifiedTime(file_path), fileutil::fileExists(file_path) });
+	if (!poll_timer_.IsRunning())
+		poll_timer_.Start(1000);
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Starts watching the directory at [path] and all its subdirectories.
+// Returns false if directory watching isn't available (the caller is
+// responsible for scanning the directory for changes itself in that case)
+// -----------------------------------------------------------------------------
+bool FileWatcher::watchDir(string_view path)
+{
+#ifdef __linux__
+	if (!eventDrivenAvailable() || !initInotify())
+		return false;
+
+	string dir_path{ path };
+	strutil::removeSuffixIP(dir_path, '/');
+	if (addWatch(dir_path, true) >= 0)
+		return true;
+
+	// Couldn't watch the whole tree (most likely hit the inotify watch limit),
+	// remove any partial watches so we don't report an incomplete picture
+	log::warning("Unable to watch directory {} for changes: {}", dir_path, strerror(errno));
+	removeWatches(dir_path);
+	return false;
+#else
+	return false;
+#endif
+}
+
+// -----------------------------------------------------------------------------
+// Stops watching everything and shuts down the watcher thread (if any)
+// -----------------------------------------------------------------------------
+void FileWatcher::stop()
+{
+	poll_timer_.Stop();
+	polled_files_.clear();
+
+#ifdef __linux__
+	if (inotify_)
+		inotify().removeWatcher(this);
+	inotify_ = false;
+
+	watches_.clear();
+	watch_dirs_.clear();
+	watched_files_.clear();
+	pending_.clear();
+	moves_.clear();
+	overflow_ = false;
+#endif
+}
+
+// -----------------------------------------------------------------------------
+// Returns true if OS file change notifications are available and enabled
+// -----------------------------------------------------------------------------
+bool FileWatcher::eventDrivenAvailable()
+{
+#ifdef __linux__
+	return file_watcher_os_events;
+#else
+	return false;
+#endif
+}
+
+#ifdef __linux__
+// -----------------------------------------------------------------------------
+// Returns the inotify instance shared by all FileWatchers. It is never
+// destroyed, so watchers that outlive static destruction can still stop safely
+// -----------------------------------------------------------------------------
+FileWatcher::Inotify& FileWatcher::inotify()
+{
+	static auto* instance = new Inotify;
+	return *instance;
+}
+
+// -----------------------------------------------------------------------------
+// Registers this watcher with the shared inotify instance, if not already done.
+// Returns false if inotify could not be initialised
+// -----------------------------------------------------------------------------
+bool FileWatcher::initInotify()
+{
+	if (!inotify_)
+		inotify_ = inotify().addWatcher(this);
+
+	return inotify_;
+}
+
+// -----------------------------------------------------------------------------
+// Adds an inotify watch for the directory at [path]. If [recursive] is true,
+// all subdirectories are watched too, and if [created] is given, a Created
+// change is added to it for each file and directory found within [path].
+// Returns the watch descriptor for [path], or -1 on failure
+// -----------------------------------------------------------------------------
+int FileWatcher::addWatch(const string& path, bool recursive, vector<FileChange>* created)
+{
+	int wd = inotify().addWatch(this, path);
+	if (wd < 0)
+		return -1;
+
+	{
+		std::lock_guard lock(mutex_);
+		auto&           watch = watches_[wd];
+		watch.path            = path;
+		watch.recursive       = watch.recursive || recursive;
+		watch_dirs_[path]     = wd;
+	}
+
+	if (!recursive)
+		return wd;
+
+	// Add subdirectories (and report contents if needed)
+	auto dir = opendir(path.c_str());
+	if (!dir)
+		return wd;
+
+	while (auto ent = readdir(dir))
+	{
+		if (strcmp(ent->d_name, ".") == 0 || strcmp(ent->d_name, "..") == 0)
+			continue;
+
+		auto child  = fmt::format("{}/{}", path, ent->d_name);
+		bool is_dir = ent->d_type == DT_DIR;
+		if (ent->d_type == DT_UNKNOWN)
+			is_dir = fileutil::dirExists(child);
+
+		if (created)
+			created->emplace_back(FileChange::Type::Created, child, is_dir);
+
+		if (is_dir && addWatch(child, true, created) < 0)
+		{
+			closedir(dir);
+			return -1;
+		}
+	}
+	closedir(dir);
+
+	return wd;
+}
+
+// -----------------------------------------------------------------------------
+// Removes all watches for the directory at [path] and its subdirectories
+// -----------------------------------------------------------------------------
+void FileWatcher::removeWatches(const string& path)
+{
+	vector<int> removed;
+	{
+		std::lock_guard lock(mutex_);
+
+		auto prefix = path + '/';
+		for (auto it = watch_dirs_.lower_bound(path); it != watch_dirs_.end();)
+		{
+			if (it->first != path && !strutil::startsWith(it->first, prefix))
+				break;
+
+			removed.push_back(it->second);
+			watches_.erase(it->second);
+			it = watch_dirs_.erase(it);
+		}
+	}
+
+	// Not while holding the lock, the inotify thread locks the shared instance
+	// before any watcher
+	for (auto wd : removed)
+		inotify().removeWatch(this, wd);
+}
+
+// -----------------------------------------------------------------------------
+// Updates the paths of all watches at or below [old_path] after the directory
+// was renamed to [new_path]
+// -----------------------------------------------------------------------------
+void FileWatcher::renameWatches(const string& old_path, const string& new_path)
+{
+	std::lock_guard lock(mutex_);
+
+	auto                           prefix = old_path + '/';
+	vector<std::pair<string, int>> renamed;
+	for (auto it = watch_dirs_.lower_bound(old_path); it != watch_dirs_.end();)
+	{
+		if (it->first != old_path && !strutil::startsWith(it->first, prefix))
+			break;
+
+		renamed.emplace_back(new_path + it->first.substr(old_path.size()), it->second);
+		it = watch_dirs_.erase(it);
+	}
+
+	for (auto& [path, wd] : renamed)
+	{
+		watches_[wd].path = path;
+		watch_dirs_[path] = wd;
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Converts inotify [event] (for one of this watcher's watches) to a change in
+// the pending list. Unmatched IN_MOVED_FROM events are kept until their
+// IN_MOVED_TO counterpart arrives. Called from the inotify thread
+// -----------------------------------------------------------------------------
+void FileWatcher::handleEvent(const inotify_event& event)
+{
+	// Get the watched directory the event is for
+	Watch watch;
+	{
+		std::lock_guard lock(mutex_);
+		auto            it = watches_.find(event.wd);
+		if (it == watches_.end())
+			return;
+
+		// Watch removed (directory deleted or unmounted)
+		if (event.mask & IN_IGNORED)
+		{
+			watch_dirs_.erase(it->second.path);
+			watches_.erase(it);
+			return;
+		}
+
+		watch = it->second;
+	}
+
+	if (event.len == 0)
+		return;
+
+	auto path   = fmt::format("{}/{}", watch.path, event.name);
+	bool is_dir = event.mask & IN_ISDIR;
+
+	// Only interested in specific files within non-recursive watches
+	if (!watch.recursive)
+	{
+		std::lock_guard lock(mutex_);
+		if (watched_files_.count(path) == 0)
+			return;
+	}
+
+	// Created / moved into the watched tree
+	if (event.mask & IN_CREATE)
+	{
+		addPendingChange(pending_, { FileChange::Type::Created, path, is_dir });
+		if (is_dir && watch.recursive)
+			addWatch(path, true, &pending_);
+	}
+	else if (event.mask & IN_MOVED_TO)
+	{
+		auto move = moves_.find(event.cookie);
+		if (move != moves_.end())
+		{
+			// Renamed within the watched tree
+			if (is_dir)
+				renameWatches(move->second.path, path);
+			addPendingChange(pending_, { FileChange::Type::Renamed, path, is_dir, move->second.path });
+			moves_.erase(move);
+		}
+		else
+		{
+			addPendingChange(pending_, { FileChange::Type::Created, path, is_dir });
+			if (is_dir && watch.recursive)
+				addWatch(path, true, &pending_);
+		}
+	}
+
+	// Moved out of / within the watched tree (wait for the matching IN_MOVED_TO)
+	else if (event.mask & IN_MOVED_FROM)
+		moves_[event.cookie] = { FileChange::Type::Renamed, path, is_dir };
+
+	// Deleted
+	else if (event.mask & IN_DELETE)
+		addPendingChange(pending_, { FileChange::Type::Deleted, path, is_dir });
+
+	// Modified
+	else if ((event.mask & (IN_MODIFY | IN_CLOSE_WRITE | IN_ATTRIB)) && !is_dir)
+		addPendingChange(pending_, { FileChange::Type::Modified, path, false });
+}
+
+// -----------------------------------------------------------------------------
+// Sends the pending changes to the main thread. Called from the inotify thread
+// once no more events have arrived for a short time
+// -----------------------------------------------------------------------------
+void FileWatcher::postPending()
+{
+	// Things were moved out of the watched tree (or renamed between batches),
+	// treat as deleted
+	for (auto& move : moves_)
+	{
+		if (move.second.is_dir)
+			removeWatches(move.second.path);
+		move.second.type = FileChange::Type::Deleted;
+		pending_.push_back(std::move(move.second));
+	}
+	moves_.clear();
+
+	if (overflow_)
+	{
+		pending_.clear();
+		pending_.emplace_back(FileChange::Type::Rescan);
+		overflow_ = false;
+	}
+
+	postChanges(pending_);
+}
+#endif
+
+// -----------------------------------------------------------------------------
+// Sends [changes] to the main thread and clears it
+// -----------------------------------------------------------------------------
+void FileWatcher::postChanges(vector<FileChange>& changes)
+{
+	if (changes.empty())
+		return;
+
+	auto event = new wxThreadEvent(wxEVT_COMMAND_FILEWATCHER_CHANGES);
+	event->SetPayload<vector<FileChange>>(changes);
+	wxQueueEvent(this, event);
+
+	changes.clear();
+}
+
+
+// -----------------------------------------------------------------------------
+//
+// FileWatcher Class Events
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Called on the main thread when a batch of changes has been posted
+// -----------------------------------------------------------------------------
+void FileWatcher::onChanges(wxThreadEvent& e)
+{
+	auto changes = e.GetPayload<vector<FileChange>>();
+	signals_.changed(changes);
+}
+
+// -----------------------------------------------------------------------------
+// Called when the polling timer updates, checks all polled files for changes
+// -----------------------------------------------------------------------------
+void FileWatcher::onPollTimer(wxTimerEvent& e)
+{
+	vector<FileChange> changes;
+	for (auto& file : polled_files_)
+	{
+		bool exists   = fileutil::fileExists(file.path);
+		auto modified = exists ? fileutil::fileModifiedTime(file.path) : 0;
+
+		if (exists && !file.exists)
+			changes.emplace_back(FileChange::Type::Created, file.path);
+		else if (!exists && file.exists)
+			changes.emplace_back(FileChange::Type::Deleted, file.path);
+		else if (exists && modified > file.modified)
+			changes.emplace_back(FileChange::Type::Modified, file.path);
+
+		file.exists   = exists;
+		file.modified = modified;
+	}
+
+	if (!changes.empty())
+		signals_.changed(changes);
+}
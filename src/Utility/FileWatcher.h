@@ -0,0 +1,101 @@
+#pragma once
+
+#ifdef __linux__
+#include <mutex>
+
+struct inotify_event;
+#endif
+
+namespace slade
+{
+struct FileChange
+{
+	enum class Type
+	{
+		Created,
+		Modified,
+		Deleted,
+		Renamed,
+		Rescan // Events were lost (eg. kernel queue overflow), a full rescan is needed
+	};
+
+	Type   type;
+	string path;
+	string old_path; // Only set for Renamed
+	bool   is_dir;
+
+	FileChange(Type type = Type::Modified, string_view path = "", bool is_dir = false, string_view old_path = "") :
+		type{ type }, path{ path }, old_path{ old_path }, is_dir{ is_dir }
+	{
+	}
+};
+
+class FileWatcher : public wxEvtHandler
+{
+public:
+	FileWatcher();
+	~FileWatcher() override;
+
+	bool isEventDriven() const;
+
+	bool watchFile(string_view path);
+	bool watchDir(string_view path);
+	void stop();
+
+	// Signals
+	struct Signals
+	{
+		sigslot::signal<const vector<FileChange>&> changed;
+	};
+	Signals& signals() { return signals_; }
+
+	static bool eventDrivenAvailable();
+
+private:
+	// Polling fallback (single files only)
+	struct PolledFile
+	{
+		string path;
+		time_t modified;
+		bool   exists;
+	};
+	vector<PolledFile> polled_files_;
+	wxTimer            poll_timer_;
+
+#ifdef __linux__
+	struct Watch
+	{
+		string path;
+		bool   recursive = false;
+	};
+
+	// The inotify instance and event thread shared by all FileWatchers
+	class Inotify;
+	static Inotify& inotify();
+
+	bool                  inotify_ = false; // True if registered with the shared inotify instance
+	std::mutex            mutex_;
+	std::map<int, Watch>  watches_;       // Watch descriptor -> watched directory
+	std::map<string, int> watch_dirs_;    // Watched directory -> watch descriptor
+	std::set<string>      watched_files_; // Files watched via their (non-recursive) parent dir watch
+
+	// Changes not yet delivered, only used from the inotify thread
+	vector<FileChange>             pending_;
+	std::map<uint32_t, FileChange> moves_; // Unmatched IN_MOVED_FROM events by cookie
+	bool                           overflow_ = false;
+
+	bool initInotify();
+	int  addWatch(const string& path, bool recursive, vector<FileChange>* created = nullptr);
+	void removeWatches(const string& path);
+	void renameWatches(const string& old_path, const string& new_path);
+	void handleEvent(const inotify_event& event);
+	void postPending();
+#endif
+
+	Signals signals_;
+
+	void postChanges(vector<FileChange>& changes);
+	void onChanges(wxThreadEvent& e);
+	void onPollTimer(wxTimerEvent& e);
+};
+} // namespace slade
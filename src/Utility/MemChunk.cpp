@@ -551,6 +551,14 @@ uint32_t MemChunk::crc() const
 	return hasData() ? misc::crc(data_, size_) : 0;
 }
 
+// -----------------------------------------------------------------------------
+// Returns a 64-bit hash of the data (see misc::hash64)
+// -----------------------------------------------------------------------------
+uint64_t MemChunk::hash() const
+{
+	return misc::hash64(data_, hasData() ? size_ : 0);
+}
+
 
 // -----------------------------------------------------------------------------
 // Allocates [size] bytes of data and returns it, or null if the allocation
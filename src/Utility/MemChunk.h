@@ -60,6 +60,7 @@ public:
 	// Misc
 	bool     fillData(uint8_t val) const;
 	uint32_t crc() const;
+	uint64_t hash() const;
 
 	// Platform-independent functions to read values in little (L##) or big (B##) endian
 	uint16_t readL16(unsigned i) const { return data_[i] + (data_[i + 1] << 8); }
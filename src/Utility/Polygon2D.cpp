@@ -41,6 +41,30 @@
 using namespace slade;
 
 
+namespace
+{
+// Adds the outline edges of [sector] to [target] (a PolygonSplitter or
+// PolygonTriangulator), with the sector's interior to the right of each edge
+template<typename T> void addSectorEdges(MapSector* sector, T& target)
+{
+	for (auto& side : sector->connectedSides())
+	{
+		auto line = side->parentLine();
+
+		// Ignore this side if its parent line has the same sector on both sides
+		if (!line || line->doubleSector())
+			continue;
+
+		// Add the edge (direction depends on what side of the line this is)
+		if (line->s1() == side)
+			target.addEdge(line->v1()->xPos(), line->v1()->yPos(), line->v2()->xPos(), line->v2()->yPos());
+		else
+			target.addEdge(line->v2()->xPos(), line->v2()->yPos(), line->v1()->xPos(), line->v1()->yPos());
+	}
+}
+} // namespace
+
+
 // -----------------------------------------------------------------------------
 //
 // Polygon2D Class Functions
@@ -120,31 +144,22 @@ bool Polygon2D::openSector(MapSector* sector)
 	if (!sector)
 		return false;
 
-	// Init
-	PolygonSplitter splitter;
 	clear();
 
-	// Get list of sides connected to this sector
-	auto& sides = sector->connectedSides();
-
-	// Go through sides
-	MapLine* line;
-	for (auto& side : sides)
-	{
-		line = side->parentLine();
-
-		// Ignore this side if its parent line has the same sector on both sides
-		if (!line || line->doubleSector())
-			continue;
-
-		// Add the edge to the splitter (direction depends on what side of the line this is)
-		if (line->s1() == side)
-			splitter.addEdge(line->v1()->xPos(), line->v1()->yPos(), line->v2()->xPos(), line->v2()->yPos());
-		else
-			splitter.addEdge(line->v2()->xPos(), line->v2()->yPos(), line->v1()->xPos(), line->v1()->yPos());
-	}
+	// Triangulate the sector outline, and merge the triangles into convex
+	// sub-polygons. The triangulator is reused per-thread to avoid reallocating
+	// its buffers for every sector
+	thread_local PolygonTriangulator triangulator;
+	triangulator.clear();
+	addSectorEdges(sector, triangulator);
+	if (triangulator.triangulate(this))
+		return true;
 
-	// Split the polygon into convex sub-polygons
+	// Triangulation failed (unclosed or otherwise invalid sector), fall back to
+	// the splitter, which is slower but copes better with broken sectors
+	clear();
+	PolygonSplitter splitter;
+	addSectorEdges(sector, splitter);
 	return splitter.doSplitting(this);
 }
 
@@ -1079,3 +1094,528 @@ void PolygonSplitter::testRender()
 	}
 	glEnd();
 }
+
+
+// -----------------------------------------------------------------------------
+//
+// PolygonTriangulator Class Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// Returns the cross product of [a]->[b] and [a]->[c]
+// (positive if [a],[b],[c] are anticlockwise)
+template<typename P> double triangulatorCross(const P& a, const P& b, const P& c)
+{
+	return (b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x);
+}
+
+// Returns true if [p] is within (or on the edge of) triangle [a],[b],[c]
+template<typename P> bool triangulatorTriContains(const P& a, const P& b, const P& c, const P& p)
+{
+	double c1 = triangulatorCross(a, b, p);
+	double c2 = triangulatorCross(b, c, p);
+	double c3 = triangulatorCross(c, a, p);
+	return (c1 >= 0 && c2 >= 0 && c3 >= 0) || (c1 <= 0 && c2 <= 0 && c3 <= 0);
+}
+
+// Returns a key for the directed edge [v1]->[v2]
+uint64_t triangulatorEdgeKey(int v1, int v2)
+{
+	return (static_cast<uint64_t>(static_cast<uint32_t>(v1)) << 32) | static_cast<uint32_t>(v2);
+}
+} // namespace
+
+void PolygonTriangulator::clear()
+{
+	edge_points_.clear();
+}
+
+void PolygonTriangulator::addEdge(double x1, double y1, double x2, double y2)
+{
+	edge_points_.push_back({ x1, y1 });
+	edge_points_.push_back({ x2, y2 });
+}
+
+bool PolygonTriangulator::triangulate(Polygon2D* poly)
+{
+	if (edge_points_.size() < 6)
+		return false;
+
+	// Build list of unique points
+	points_.assign(edge_points_.begin(), edge_points_.end());
+	std::sort(points_.begin(), points_.end());
+	points_.erase(std::unique(points_.begin(), points_.end()), points_.end());
+
+	// Build list of unique edges (ignoring any zero-length ones)
+	edges_.clear();
+	for (unsigned a = 0; a < edge_points_.size(); a += 2)
+	{
+		int v1 = std::lower_bound(points_.begin(), points_.end(), edge_points_[a]) - points_.begin();
+		int v2 = std::lower_bound(points_.begin(), points_.end(), edge_points_[a + 1]) - points_.begin();
+		if (v1 != v2)
+			edges_.emplace_back(v1, v2);
+	}
+	std::sort(edges_.begin(), edges_.end());
+	edges_.erase(std::unique(edges_.begin(), edges_.end()), edges_.end());
+
+	// Edges are sorted by start point, so the outgoing edges for each point are contiguous
+	out_start_.assign(points_.size() + 1, 0);
+	for (auto& edge : edges_)
+		++out_start_[edge.first + 1];
+	for (unsigned a = 1; a < out_start_.size(); a++)
+		out_start_[a] += out_start_[a - 1];
+
+	// Trace outlines, fail if there are any unclosed ones
+	if (!traceLoops())
+		return false;
+
+	// Find the outer loop containing each hole (the smallest one, for nested sectors)
+	for (auto& hole : loops_)
+	{
+		if (hole.area <= 0)
+			continue;
+
+		// Test with a point just to the right of (ie. outside) the hole's first edge
+		auto&  p1 = points_[loop_points_[hole.start]];
+		auto&  p2  = points_[loop_points_[hole.start + 1]];
+		double dx  = p2.x - p1.x;
+		double dy  = p2.y - p1.y;
+		double len = std::sqrt(dx * dx + dy * dy);
+		double x   = (p1.x + p2.x) * 0.5 + dy / len * 0.01;
+		double y   = (p1.y + p2.y) * 0.5 - dx / len * 0.01;
+
+		for (unsigned a = 0; a < loops_.size(); a++)
+		{
+			auto& outer = loops_[a];
+			if (outer.area >= 0 || !pointInLoop(outer, x, y))
+				continue;
+			if (hole.outer < 0 || outer.area > loops_[hole.outer].area)
+				hole.outer = a;
+		}
+
+		// A hole that isn't within anything is something the splitter handles better
+		if (hole.outer < 0)
+			return false;
+	}
+
+	// Triangulate each outer loop along with its holes
+	triangles_.clear();
+	for (unsigned a = 0; a < loops_.size(); a++)
+	{
+		auto& outer = loops_[a];
+		if (outer.area >= 0)
+			continue;
+
+		// Build outline (anticlockwise)
+		ring_.clear();
+		ring_next_.clear();
+		ring_prev_.clear();
+		int last = -1;
+		for (int p = outer.start + outer.count - 1; p >= static_cast<int>(outer.start); p--)
+			last = addNode(loop_points_[p], last);
+
+		// Get holes, rightmost first
+		holes_.clear();
+		for (unsigned h = 0; h < loops_.size(); h++)
+			if (loops_[h].outer == static_cast<int>(a))
+				holes_.push_back(h);
+		std::sort(holes_.begin(), holes_.end(), [this](int h1, int h2) { return loops_[h1].max_x > loops_[h2].max_x; });
+
+		// Bridge holes into the outline
+		for (int h : holes_)
+		{
+			// Add hole outline (clockwise), as a separate ring
+			auto& hole      = loops_[h];
+			int   rightmost = -1;
+			last            = -1;
+			for (int p = hole.start + hole.count - 1; p >= static_cast<int>(hole.start); p--)
+			{
+				last = addNode(loop_points_[p], last);
+				if (rightmost < 0 || nodePoint(last).x > nodePoint(rightmost).x)
+					rightmost = last;
+			}
+
+			if (!bridgeHole(rightmost))
+				return false;
+		}
+
+		// Clip
+		if (!clipEars())
+			return false;
+	}
+
+	if (triangles_.empty())
+		return false;
+
+	// Merge triangles into convex polygons
+	mergeTriangles(poly);
+
+	return true;
+}
+
+int PolygonTriangulator::addNode(int point, int after)
+{
+	int node = ring_.size();
+	ring_.push_back(point);
+
+	// Start a new ring if there is nothing to link after
+	if (after < 0)
+	{
+		ring_next_.push_back(node);
+		ring_prev_.push_back(node);
+		return node;
+	}
+
+	ring_next_.push_back(ring_next_[after]);
+	ring_prev_.push_back(after);
+	ring_prev_[ring_next_[after]] = node;
+	ring_next_[after]             = node;
+
+	return node;
+}
+
+bool PolygonTriangulator::traceLoops()
+{
+	edge_used_.assign(edges_.size(), false);
+	loop_points_.clear();
+	loops_.clear();
+
+	for (unsigned start = 0; start < edges_.size(); start++)
+	{
+		if (edge_used_[start])
+			continue;
+
+		Loop loop{ static_cast<unsigned>(loop_points_.size()), 0, 0., points_[edges_[start].first].x };
+		int  edge = start;
+		while (true)
+		{
+			edge_used_[edge] = true;
+			int   v1         = edges_[edge].first;
+			int   v2         = edges_[edge].second;
+			auto& p1         = points_[v1];
+			auto& p2         = points_[v2];
+			loop_points_.push_back(v1);
+			loop.area += p1.x * p2.y - p2.x * p1.y;
+			loop.max_x = std::max(loop.max_x, p1.x);
+
+			// Find the next edge, turning as far right as possible
+			// (the interior of the polygon is on the right of each edge)
+			int    next       = -1;
+			double next_angle = 0.;
+			for (int e = out_start_[v2]; e < out_start_[v2 + 1]; e++)
+			{
+				if ((edge_used_[e] && e != static_cast<int>(start)) || edges_[e].second == v1)
+					continue;
+
+				auto&  p3    = points_[edges_[e].second];
+				double ix    = p1.x - p2.x;
+				double iy    = p1.y - p2.y;
+				double ox    = p3.x - p2.x;
+				double oy    = p3.y - p2.y;
+				double angle = std::atan2(ix * oy - iy * ox, ix * ox + iy * oy);
+				if (angle <= 0.)
+					angle += math::PI * 2;
+
+				if (next < 0 || angle < next_angle)
+				{
+					next       = e;
+					next_angle = angle;
+				}
+			}
+
+			// Unclosed outline
+			if (next < 0)
+				return false;
+
+			// Back at the start
+			if (next == static_cast<int>(start))
+				break;
+
+			edge = next;
+		}
+
+		loop.count = loop_points_.size() - loop.start;
+		loop.area *= 0.5;
+		loops_.push_back(loop);
+	}
+
+	return true;
+}
+
+bool PolygonTriangulator::pointInLoop(const Loop& loop, double x, double y) const
+{
+	bool inside = false;
+	for (unsigned a = 0; a < loop.count; a++)
+	{
+		auto& p1 = points_[loop_points_[loop.start + a]];
+		auto& p2 = points_[loop_points_[loop.start + (a + 1) % loop.count]];
+		if ((p1.y > y) != (p2.y > y) && x < p1.x + (y - p1.y) * (p2.x - p1.x) / (p2.y - p1.y))
+			inside = !inside;
+	}
+
+	return inside;
+}
+
+bool PolygonTriangulator::locallyInside(int node, int other) const
+{
+	auto& prev = nodePoint(ring_prev_[node]);
+	auto& p    = nodePoint(node);
+	auto& next = nodePoint(ring_next_[node]);
+	auto& o    = nodePoint(other);
+
+	// Convex vertex, [other] must be within the angle
+	if (triangulatorCross(prev, p, next) >= 0)
+		return triangulatorCross(prev, p, o) >= 0 && triangulatorCross(p, next, o) >= 0;
+
+	// Reflex vertex, [other] must not be within the outside angle
+	return triangulatorCross(prev, p, o) > 0 || triangulatorCross(p, next, o) > 0;
+}
+
+bool PolygonTriangulator::bridgeHole(int hole)
+{
+	// Cast a ray to the right from the hole's rightmost point,
+	// and find the closest outline edge it hits
+	auto&  m      = nodePoint(hole);
+	int    bridge = -1;
+	double hit_x  = 0.;
+	int    node   = 0;
+	do
+	{
+		int   next = ring_next_[node];
+		auto& p1   = nodePoint(node);
+		auto& p2   = nodePoint(next);
+		if (p1.y <= m.y && m.y <= p2.y && p1.y != p2.y)
+		{
+			double x = p1.x + (m.y - p1.y) * (p2.x - p1.x) / (p2.y - p1.y);
+			if (x >= m.x && (bridge < 0 || x < hit_x))
+			{
+				hit_x  = x;
+				bridge = p1.x > p2.x ? node : next;
+
+				// Hole touches the edge
+				if (x == m.x)
+					break;
+			}
+		}
+		node = next;
+	} while (node != 0);
+
+	if (bridge < 0)
+		return false;
+
+	// The edge endpoint may not be visible from the hole, if there are any reflex
+	// vertices within the triangle between the hole point, the hit point and the
+	// endpoint, use the one with the smallest angle to the ray instead
+	if (hit_x != m.x)
+	{
+		Point  hit{ hit_x, m.y };
+		Point  end     = nodePoint(bridge);
+		double tan_min = -1.;
+		int    stop    = bridge;
+		node           = bridge;
+		do
+		{
+			auto& p = nodePoint(node);
+			if (p.x > m.x && p.x <= end.x && triangulatorTriContains(m, hit, end, p))
+			{
+				double tan = std::fabs(m.y - p.y) / (p.x - m.x);
+				if (locallyInside(node, hole)
+					&& (tan_min < 0 || tan < tan_min || (tan == tan_min && p.x < nodePoint(bridge).x)))
+				{
+					bridge  = node;
+					tan_min = tan;
+				}
+			}
+			node = ring_next_[node];
+		} while (node != stop);
+	}
+
+	// Splice the hole into the outline, via a pair of edges between the hole
+	// point and the bridge point (bridge -> hole ... hole -> bridge)
+	int bridge_next = ring_next_[bridge];
+	int hole_prev   = ring_prev_[hole];
+	int bridge2     = addNode(ring_[bridge], -1);
+	int hole2       = addNode(ring_[hole], -1);
+
+	ring_next_[bridge]      = hole;
+	ring_prev_[hole]        = bridge;
+	ring_next_[bridge2]     = bridge_next;
+	ring_prev_[bridge_next] = bridge2;
+	ring_next_[hole2]       = bridge2;
+	ring_prev_[bridge2]     = hole2;
+	ring_next_[hole_prev]   = hole2;
+	ring_prev_[hole2]       = hole_prev;
+
+	return true;
+}
+
+bool PolygonTriangulator::isEar(int prev, int ear, int next) const
+{
+	auto& a = nodePoint(prev);
+	auto& b = nodePoint(ear);
+	auto& c = nodePoint(next);
+
+	// Can't be an ear if any reflex (or straight) vertex is within the triangle
+	for (int node = ring_next_[next]; node != prev; node = ring_next_[node])
+	{
+		auto& p = nodePoint(node);
+		if (p == a || p == b || p == c)
+			continue;
+
+		if (triangulatorCross(nodePoint(ring_prev_[node]), p, nodePoint(ring_next_[node])) <= 0
+			&& triangulatorTriContains(a, b, c, p))
+			return false;
+	}
+
+	return true;
+}
+
+bool PolygonTriangulator::clipEars()
+{
+	// Clip ears off the outline until there's only one triangle left. If no ears
+	// can be found, remove any straight or degenerate vertices and try again
+	int  remaining = ring_.size();
+	int  ear       = 0;
+	int  stop      = 0;
+	bool cleanup   = false;
+	while (remaining > 3)
+	{
+		int    prev  = ring_prev_[ear];
+		int    next  = ring_next_[ear];
+		double cross = triangulatorCross(nodePoint(prev), nodePoint(ear), nodePoint(next));
+
+		bool clip = false;
+		if (!cleanup && cross > 0 && isEar(prev, ear, next))
+		{
+			triangles_.push_back(ring_[prev]);
+			triangles_.push_back(ring_[ear]);
+			triangles_.push_back(ring_[next]);
+			clip = true;
+		}
+		else if (cleanup && std::fabs(cross) < 1e-9)
+			clip = true;
+
+		if (clip)
+		{
+			ring_next_[prev] = next;
+			ring_prev_[next] = prev;
+			remaining--;
+			ear     = next;
+			stop    = next;
+			cleanup = false;
+			continue;
+		}
+
+		// Went all the way around without clipping anything
+		ear = next;
+		if (ear == stop)
+		{
+			if (cleanup)
+				return false;
+			cleanup = true;
+		}
+	}
+
+	// Last triangle
+	int prev = ring_prev_[ear];
+	int next = ring_next_[ear];
+	if (triangulatorCross(nodePoint(prev), nodePoint(ear), nodePoint(next)) > 0)
+	{
+		triangles_.push_back(ring_[prev]);
+		triangles_.push_back(ring_[ear]);
+		triangles_.push_back(ring_[next]);
+	}
+
+	return true;
+}
+
+void PolygonTriangulator::mergeTriangles(Polygon2D* poly)
+{
+	// Each triangle starts as its own piece
+	unsigned n_triangles = triangles_.size() / 3;
+	piece_parent_.resize(n_triangles);
+	if (pieces_.size() < n_triangles)
+		pieces_.resize(n_triangles);
+	edge_owner_.clear();
+	for (unsigned t = 0; t < n_triangles; t++)
+	{
+		piece_parent_[t] = t;
+		pieces_[t].assign(triangles_.begin() + t * 3, triangles_.begin() + t * 3 + 3);
+		for (unsigned a = 0; a < 3; a++)
+			edge_owner_[triangulatorEdgeKey(triangles_[t * 3 + a], triangles_[t * 3 + (a + 1) % 3])] = t;
+	}
+
+	auto root = [this](int piece) {
+		while (piece_parent_[piece] != piece)
+			piece = piece_parent_[piece] = piece_parent_[piece_parent_[piece]];
+		return piece;
+	};
+
+	// Remove diagonals between pieces wherever the merged piece is still convex
+	for (unsigned t = 0; t < n_triangles; t++)
+	{
+		for (unsigned a = 0; a < 3; a++)
+		{
+			int  u     = triangles_[t * 3 + a];
+			int  v     = triangles_[t * 3 + (a + 1) % 3];
+			auto other = edge_owner_.find(triangulatorEdgeKey(v, u));
+			if (other == edge_owner_.end())
+				continue;
+
+			int p1 = root(t);
+			int p2 = root(other->second);
+			if (p1 == p2)
+				continue;
+
+			// Find the diagonal in each piece (u->v in the first, v->u in the second)
+			auto& piece1 = pieces_[p1];
+			auto& piece2 = pieces_[p2];
+			int   n1     = piece1.size();
+			int   n2     = piece2.size();
+			int   i      = 0;
+			int   j      = 0;
+			while (i < n1 && !(piece1[i] == u && piece1[(i + 1) % n1] == v))
+				i++;
+			while (j < n2 && !(piece2[j] == v && piece2[(j + 1) % n2] == u))
+				j++;
+			if (i == n1 || j == n2)
+				continue;
+
+			// Check the merged piece is convex at both ends of the diagonal
+			auto& pu = points_[u];
+			auto& pv = points_[v];
+			if (triangulatorCross(points_[piece1[(i + n1 - 1) % n1]], pu, points_[piece2[(j + 2) % n2]]) < -1e-6
+				|| triangulatorCross(points_[piece2[(j + n2 - 1) % n2]], pv, points_[piece1[(i + 2) % n1]]) < -1e-6)
+				continue;
+
+			// Merge (v ... u from the first piece, then the rest of the second)
+			merged_.clear();
+			for (int k = 1; k <= n1; k++)
+				merged_.push_back(piece1[(i + k) % n1]);
+			for (int k = 2; k < n2; k++)
+				merged_.push_back(piece2[(j + k) % n2]);
+
+			piece1.swap(merged_);
+			piece2.clear();
+			piece_parent_[p2] = p1;
+		}
+	}
+
+	// Add pieces to the polygon (clockwise, as with PolygonSplitter)
+	for (unsigned t = 0; t < n_triangles; t++)
+	{
+		if (piece_parent_[t] != static_cast<int>(t) || pieces_[t].size() < 3)
+			continue;
+
+		poly->addSubPoly();
+		auto& vertices = poly->subPoly(poly->nSubPolys() - 1)->vertices;
+		vertices.resize(pieces_[t].size());
+		for (unsigned a = 0; a < pieces_[t].size(); a++)
+		{
+			auto& point   = points_[pieces_[t][pieces_[t].size() - 1 - a]];
+			vertices[a].x = point.x;
+			vertices[a].y = point.y;
+		}
+	}
+}
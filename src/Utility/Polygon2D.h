@@ -143,4 +143,70 @@ private:
 	bool            verbose_           = false;
 	double          last_angle_        = 0.;
 };
+
+
+// Triangulates a polygon given as a set of directed edges (interior on the
+// right, like sector sides) by ear clipping, with support for holes. The
+// triangles are then merged back into convex sub-polygons (Hertel-Mehlhorn).
+// Scratch buffers are kept between uses, so reusing a triangulator for many
+// polygons avoids most allocations
+class PolygonTriangulator
+{
+public:
+	PolygonTriangulator()  = default;
+	~PolygonTriangulator() = default;
+
+	void clear();
+	void addEdge(double x1, double y1, double x2, double y2);
+	bool triangulate(Polygon2D* poly);
+
+private:
+	struct Point
+	{
+		double x, y;
+		bool   operator<(const Point& rhs) const { return x < rhs.x || (x == rhs.x && y < rhs.y); }
+		bool   operator==(const Point& rhs) const { return x == rhs.x && y == rhs.y; }
+	};
+
+	// A closed outline traced from the edges, its points are
+	// loop_points_[start] to loop_points_[start + count - 1]
+	struct Loop
+	{
+		unsigned start;
+		unsigned count;
+		double   area;
+		double   max_x;
+		int      outer = -1; // For holes, the outer loop containing it
+	};
+
+	// Input
+	vector<Point> edge_points_; // Pairs of edge start/end points
+
+	// Scratch buffers
+	vector<Point>                     points_;
+	vector<std::pair<int, int>>       edges_;     // Sorted by start point
+	vector<int>                       out_start_; // First outgoing edge for each point
+	vector<bool>                      edge_used_;
+	vector<int>                       loop_points_;
+	vector<Loop>                      loops_;
+	vector<int>                       holes_;
+	vector<int>                       ring_; // Point index for each node in the outline being clipped
+	vector<int>                       ring_next_;
+	vector<int>                       ring_prev_;
+	vector<int>                       triangles_;
+	vector<int>                       piece_parent_;
+	vector<vector<int>>               pieces_;
+	vector<int>                       merged_;
+	std::unordered_map<uint64_t, int> edge_owner_;
+
+	const Point& nodePoint(int node) const { return points_[ring_[node]]; }
+	int          addNode(int point, int after);
+	bool         traceLoops();
+	bool         pointInLoop(const Loop& loop, double x, double y) const;
+	bool         locallyInside(int node, int other) const;
+	bool         bridgeHole(int hole);
+	bool         isEar(int prev, int ear, int next) const;
+	bool         clipEars();
+	void         mergeTriangles(Polygon2D* poly);
+};
 } // namespace slade
@@ -0,0 +1,268 @@
+
+// -----------------------------------------------------------------------------
+// SLADE - It's a Doom Editor
+// Copyright(C) 2008 - 2020 Simon Judd
+//
+// Email:       sirjuddington@gmail.com
+// Web:         http://slade.mancubus.net
+// Filename:    TaskGraph.cpp
+// Description: TaskGraph class, runs a set of named tasks with dependencies
+//              between them. Tasks run as soon as all their dependencies have
+//              finished, either on a ThreadPool worker or (if flagged as such)
+//              on the calling thread, and the time each task takes is recorded.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301, USA.
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+//
+// Includes
+//
+// -----------------------------------------------------------------------------
+#include "Main.h"
+#include "TaskGraph.h"
+#include "ThreadPool.h"
+#include <chrono>
+#include <deque>
+
+using namespace slade;
+
+
+// -----------------------------------------------------------------------------
+//
+// TaskGraph Class Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Adds a task [id] that runs [func] once all tasks in [depends] have finished.
+// If [main_thread] is true the task will always run on the thread calling
+// run(), otherwise it can run on any worker thread.
+// [func] should return false if the task failed, in which case any tasks that
+// depend on it won't be run
+// -----------------------------------------------------------------------------
+void TaskGraph::add(string_view id, std::function<bool()> func, const vector<string>& depends, bool main_thread)
+{
+	Task task;
+	task.id          = id;
+	task.func        = std::move(func);
+	task.depends     = depends;
+	task.main_thread = main_thread;
+	tasks_.push_back(std::move(task));
+}
+
+// -----------------------------------------------------------------------------
+// Runs all tasks, using [pool] for any tasks that don't need to run on the
+// calling thread, and returns once all have finished (or been skipped).
+// Returns false if any task failed
+// -----------------------------------------------------------------------------
+bool TaskGraph::run(ThreadPool& pool)
+{
+	using Clock     = std::chrono::steady_clock;
+	auto time_start = Clock::now();
+	auto elapsed_ms = [time_start]() {
+		return std::chrono::duration<double, std::milli>(Clock::now() - time_start).count();
+	};
+
+	timings_.clear();
+	timings_.resize(tasks_.size());
+
+	// Resolve dependencies
+	for (unsigned a = 0; a < tasks_.size(); a++)
+	{
+		auto& task          = tasks_[a];
+		task.state          = State::Waiting;
+		task.deps_remaining = 0;
+		task.dependents.clear();
+		timings_[a].id          = task.id;
+		timings_[a].main_thread = task.main_thread;
+	}
+	for (unsigned a = 0; a < tasks_.size(); a++)
+	{
+		for (const auto& dep : tasks_[a].depends)
+		{
+			auto index = taskIndex(dep);
+			if (index < 0)
+			{
+				log::warning("Task \"{}\" depends on unknown task \"{}\"", tasks_[a].id, dep);
+				continue;
+			}
+
+			tasks_[index].dependents.push_back(a);
+			tasks_[a].deps_remaining++;
+		}
+	}
+
+	// Finished worker tasks are passed back to this thread via this queue
+	std::mutex              mutex;
+	std::condition_variable cv;
+	std::deque<unsigned>    completed;
+
+	std::deque<unsigned> main_ready;
+	unsigned             finished   = 0;
+	auto                 start_task = [&](unsigned index) {
+		auto& task = tasks_[index];
+		task.state = State::Running;
+		if (task.main_thread)
+		{
+			main_ready.push_back(index);
+			return;
+		}
+
+		pool.submit([this, index, &mutex, &cv, &completed, &elapsed_ms]() {
+			auto& timing    = timings_[index];
+			timing.start_ms = elapsed_ms();
+			try
+			{
+				timing.ok = tasks_[index].func();
+			}
+			catch (const std::exception& ex)
+			{
+				log::error("Task \"{}\" failed: {}", tasks_[index].id, ex.what());
+				timing.ok = false;
+			}
+			timing.duration_ms = elapsed_ms() - timing.start_ms;
+
+			std::lock_guard lock(mutex);
+			completed.push_back(index);
+			cv.notify_one();
+		});
+	};
+	auto finish_task = [&](unsigned index) {
+		auto& task = tasks_[index];
+		finished++;
+		if (!timings_[index].ok)
+		{
+			task.state = State::Failed;
+			skipDependents(index, finished);
+			return;
+		}
+
+		task.state = State::Done;
+		for (auto dependent : task.dependents)
+			if (--tasks_[dependent].deps_remaining == 0 && tasks_[dependent].state == State::Waiting)
+				start_task(dependent);
+	};
+
+	// Start all tasks with no dependencies
+	for (unsigned a = 0; a < tasks_.size(); a++)
+		if (tasks_[a].deps_remaining == 0)
+			start_task(a);
+
+	while (finished < tasks_.size())
+	{
+		// Run the next main thread task if any are ready
+		if (!main_ready.empty())
+		{
+			auto index = main_ready.front();
+			main_ready.pop_front();
+
+			auto& timing       = timings_[index];
+			timing.start_ms    = elapsed_ms();
+			timing.ok          = tasks_[index].func();
+			timing.duration_ms = elapsed_ms() - timing.start_ms;
+			finish_task(index);
+		}
+
+		// Process any finished worker tasks
+		std::deque<unsigned> done;
+		{
+			std::unique_lock lock(mutex);
+			if (main_ready.empty() && completed.empty() && finished < tasks_.size())
+				cv.wait(lock, [&completed]() { return !completed.empty(); });
+			done.swap(completed);
+		}
+		for (auto index : done)
+			finish_task(index);
+	}
+
+	total_ms_ = elapsed_ms();
+
+	for (const auto& task : tasks_)
+		if (task.state != State::Done)
+			return false;
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Returns true if the task [id] failed or was skipped due to a failed
+// dependency
+// -----------------------------------------------------------------------------
+bool TaskGraph::failed(string_view id) const
+{
+	auto index = taskIndex(id);
+	return index >= 0 && (tasks_[index].state == State::Failed || tasks_[index].state == State::Skipped);
+}
+
+// -----------------------------------------------------------------------------
+// Writes the timings of each task from the last run to the log
+// -----------------------------------------------------------------------------
+void TaskGraph::logTimings() const
+{
+	// Sort by start time
+	auto sorted = timings_;
+	std::sort(sorted.begin(), sorted.end(), [](const Timing& left, const Timing& right) {
+		return left.start_ms < right.start_ms;
+	});
+
+	double sum = 0.;
+	for (const auto& timing : sorted)
+	{
+		log::info(
+			"{:<28} start {:>8.1f}ms  took {:>8.1f}ms  {}{}",
+			timing.id,
+			timing.start_ms,
+			timing.duration_ms,
+			timing.main_thread ? "[main]" : "[worker]",
+			timing.ok ? "" : " FAILED");
+		sum += timing.duration_ms;
+	}
+
+	log::info("Total {:.1f}ms (sum of tasks {:.1f}ms)", total_ms_, sum);
+}
+
+// -----------------------------------------------------------------------------
+// Returns the index of the task [id], or -1 if not found
+// -----------------------------------------------------------------------------
+int TaskGraph::taskIndex(string_view id) const
+{
+	for (unsigned a = 0; a < tasks_.size(); a++)
+		if (tasks_[a].id == id)
+			return static_cast<int>(a);
+
+	return -1;
+}
+
+// -----------------------------------------------------------------------------
+// Marks all tasks depending (directly or indirectly) on the task at [index] as
+// skipped, incrementing [finished] for each
+// -----------------------------------------------------------------------------
+void TaskGraph::skipDependents(unsigned index, unsigned& finished)
+{
+	for (auto dependent : tasks_[index].dependents)
+	{
+		auto& task = tasks_[dependent];
+		if (task.state != State::Waiting)
+			continue;
+
+		log::warning("Skipping task \"{}\", dependency \"{}\" failed", task.id, tasks_[index].id);
+		task.state = State::Skipped;
+		finished++;
+		skipDependents(dependent, finished);
+	}
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+namespace slade
+{
+class ThreadPool;
+
+class TaskGraph
+{
+public:
+	struct Timing
+	{
+		string id;
+		double start_ms    = 0.; // Relative to the start of the run
+		double duration_ms = 0.;
+		bool   main_thread = false;
+		bool   ok          = false;
+	};
+
+	TaskGraph()  = default;
+	~TaskGraph() = default;
+
+	const vector<Timing>& timings() const { return timings_; }
+	double                totalTime() const { return total_ms_; }
+
+	void add(
+		string_view           id,
+		std::function<bool()> func,
+		const vector<string>& depends     = {},
+		bool                  main_thread = false);
+	bool run(ThreadPool& pool);
+	bool failed(string_view id) const;
+	void logTimings() const;
+
+private:
+	enum class State
+	{
+		Waiting,
+		Running,
+		Done,
+		Failed,
+		Skipped
+	};
+
+	struct Task
+	{
+		string                id;
+		std::function<bool()> func;
+		vector<string>        depends;
+		vector<unsigned>      dependents;
+		unsigned              deps_remaining = 0;
+		bool                  main_thread    = false;
+		State                 state          = State::Waiting;
+	};
+
+	vector<Task>   tasks_;
+	vector<Timing> timings_;
+	double         total_ms_ = 0.;
+
+	int  taskIndex(string_view id) const;
+	void skipDependents(unsigned index, unsigned& finished);
+};
+} // namespace slade
@@ -0,0 +1,237 @@
+
+// -----------------------------------------------------------------------------
+// SLADE - It's a Doom Editor
+// Copyright(C) 2008 - 2020 Simon Judd
+//
+// Email:       sirjuddington@gmail.com
+// Web:         http://slade.mancubus.net
+// Filename:    ThreadPool.cpp
+// Description: ThreadPool class, a simple fixed-size pool of worker threads
+//              that run queued jobs. Also provides parallelFor, which splits a
+//              range of indices up between the workers and the calling thread.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301, USA.
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+//
+// Includes
+//
+// -----------------------------------------------------------------------------
+#include "Main.h"
+#include "ThreadPool.h"
+#include <atomic>
+
+using namespace slade;
+
+
+// -----------------------------------------------------------------------------
+//
+// Variables
+//
+// -----------------------------------------------------------------------------
+CVAR(Int, max_worker_threads, 0, CVar::Flag::Save) // 0 = use number of cores
+namespace
+{
+thread_local const ThreadPool* current_pool = nullptr;
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// ThreadPool Class Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// ThreadPool class constructor, starts [num_threads] worker threads (or the
+// default number if 0)
+// -----------------------------------------------------------------------------
+ThreadPool::ThreadPool(unsigned num_threads)
+{
+	if (num_threads == 0)
+		num_threads = defaultNumThreads();
+
+	for (unsigned a = 0; a < num_threads; a++)
+		threads_.emplace_back([this]() { workerLoop(); });
+}
+
+// -----------------------------------------------------------------------------
+// ThreadPool class destructor, finishes any queued jobs and stops all worker
+// threads
+// -----------------------------------------------------------------------------
+ThreadPool::~ThreadPool()
+{
+	{
+		std::lock_guard lock(mutex_);
+		stopping_ = true;
+	}
+	cv_.notify_all();
+
+	for (auto& thread : threads_)
+		thread.join();
+}
+
+// -----------------------------------------------------------------------------
+// Returns true if the calling thread is one of this pool's worker threads
+// -----------------------------------------------------------------------------
+bool ThreadPool::isWorkerThread() const
+{
+	return current_pool == this;
+}
+
+// -----------------------------------------------------------------------------
+// Runs [func] for each index from 0 to [count]-1, split into batches of
+// [batch_size] indices between the worker threads and the calling thread.
+// Returns once all indices have been processed. If [func] throws, the first
+// exception is rethrown here.
+//
+// The calling thread always takes part, so this is safe to call from within a
+// job running on the pool (even if all other workers are busy)
+// -----------------------------------------------------------------------------
+void ThreadPool::parallelFor(size_t count, const std::function<void(size_t)>& func, size_t batch_size)
+{
+	if (count == 0)
+		return;
+	if (batch_size == 0)
+		batch_size = 1;
+
+	// Just run directly if there's nothing to split up
+	auto num_batches = (count + batch_size - 1) / batch_size;
+	if (threads_.empty() || num_batches == 1)
+	{
+		for (size_t a = 0; a < count; a++)
+			func(a);
+		return;
+	}
+
+	struct State
+	{
+		std::atomic<size_t>                 next_batch{ 0 };
+		std::atomic<size_t>                 batches_done{ 0 };
+		size_t                              num_batches;
+		size_t                              batch_size;
+		size_t                              count;
+		const std::function<void(size_t)>* func;
+		std::mutex                          mutex;
+		std::condition_variable             cv;
+		std::exception_ptr                  error;
+	};
+	auto state         = std::make_shared<State>();
+	state->num_batches = num_batches;
+	state->batch_size  = batch_size;
+	state->count       = count;
+	state->func        = &func;
+
+	// Work function, keeps taking batches until there are none left.
+	// Helpers that only get to start after everything is done just exit,
+	// [func] is never accessed once all batches have been claimed
+	auto work = [state]() {
+		while (true)
+		{
+			auto batch = state->next_batch.fetch_add(1);
+			if (batch >= state->num_batches)
+				return;
+
+			auto start = batch * state->batch_size;
+			auto end   = std::min(start + state->batch_size, state->count);
+			try
+			{
+				for (auto a = start; a < end; a++)
+					(*state->func)(a);
+			}
+			catch (...)
+			{
+				std::lock_guard lock(state->mutex);
+				if (!state->error)
+					state->error = std::current_exception();
+			}
+
+			if (state->batches_done.fetch_add(1) + 1 == state->num_batches)
+			{
+				std::lock_guard lock(state->mutex);
+				state->cv.notify_all();
+			}
+		}
+	};
+
+	// Start helpers and join in on the calling thread
+	auto helpers = std::min<size_t>(threads_.size(), num_batches - 1);
+	for (size_t a = 0; a < helpers; a++)
+		enqueue(work);
+	work();
+
+	// Wait for batches taken by helpers to finish
+	{
+		std::unique_lock lock(state->mutex);
+		state->cv.wait(lock, [&state]() { return state->batches_done == state->num_batches; });
+	}
+
+	if (state->error)
+		std::rethrow_exception(state->error);
+}
+
+// -----------------------------------------------------------------------------
+// Returns the default number of worker threads to use, which is the number of
+// hardware threads available (unless overridden by max_worker_threads)
+// -----------------------------------------------------------------------------
+unsigned ThreadPool::defaultNumThreads()
+{
+	unsigned num = std::thread::hardware_concurrency();
+	if (num == 0)
+		num = 2;
+	if (max_worker_threads > 0 && static_cast<unsigned>(max_worker_threads) < num)
+		num = max_worker_threads;
+
+	return num;
+}
+
+// -----------------------------------------------------------------------------
+// Adds [job] to the queue and wakes a worker thread to run it
+// -----------------------------------------------------------------------------
+void ThreadPool::enqueue(std::function<void()> job)
+{
+	{
+		std::lock_guard lock(mutex_);
+		queue_.push_back(std::move(job));
+	}
+	cv_.notify_one();
+}
+
+// -----------------------------------------------------------------------------
+// Worker thread function, runs queued jobs until the pool is stopped
+// -----------------------------------------------------------------------------
+void ThreadPool::workerLoop()
+{
+	current_pool = this;
+
+	while (true)
+	{
+		std::function<void()> job;
+		{
+			std::unique_lock lock(mutex_);
+			cv_.wait(lock, [this]() { return stopping_ || !queue_.empty(); });
+			if (queue_.empty())
+				return;
+
+			job = std::move(queue_.front());
+			queue_.pop_front();
+		}
+
+		job();
+	}
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <future>
+#include <mutex>
+#include <thread>
+
+namespace slade
+{
+class ThreadPool
+{
+public:
+	ThreadPool(unsigned num_threads = 0);
+	~ThreadPool();
+
+	unsigned numThreads() const { return static_cast<unsigned>(threads_.size()); }
+	bool     isWorkerThread() const;
+
+	// Queues [func] to run on a worker thread, returns a future for its result
+	template<typename F> auto submit(F&& func) -> std::future<decltype(func())>
+	{
+		using R     = decltype(func());
+		auto task   = std::make_shared<std::packaged_task<R()>>(std::forward<F>(func));
+		auto result = task->get_future();
+		enqueue([task]() { (*task)(); });
+		return result;
+	}
+
+	void parallelFor(size_t count, const std::function<void(size_t)>& func, size_t batch_size = 1);
+
+	static unsigned defaultNumThreads();
+
+private:
+	vector<std::thread>               threads_;
+	std::deque<std::function<void()>> queue_;
+	std::mutex                        mutex_;
+	std::condition_variable           cv_;
+	bool                              stopping_ = false;
+
+	void enqueue(std::function<void()> job);
+	void workerLoop();
+};
+} // namespace slade